@@ -43,18 +43,15 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  LOG_INFO("here6");
   latch_.lock();
   if (page_id == INVALID_PAGE_ID) {
     latch_.unlock();
     return nullptr;
   }
-  LOG_INFO("here7");
   if (page_table_.find(page_id) != page_table_.end()) {
 
     frame_id_t frame_id = page_table_[page_id];
     pages_[frame_id].IncPinCount();
-    LOG_INFO("STILL IN PAGETABLE %d page %d pincount %d pointer %p",page_id,pages_[frame_id].page_id_,pages_[frame_id].pin_count_,&pages_[frame_id]);
     replacer_->Pin(frame_id);
     latch_.unlock();
     return &pages_[frame_id];
@@ -65,7 +62,6 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
     replace_frame_id = free_list_.back();
     free_list_.pop_back();
   } else {
-    LOG_INFO("erase page table");
     bool ok = replacer_->Victim(&replace_frame_id);
     if (!ok) {
       latch_.unlock();
@@ -87,7 +83,6 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   pages_[replace_frame_id].IncPinCount();
   disk_manager_->ReadPage(page_id, pages_[replace_frame_id].data_);
   latch_.unlock();
-  LOG_INFO("replace PAGETABLE %d page %d pincount %d pointer %p",page_id,pages_[replace_frame_id].page_id_,pages_[replace_frame_id].pin_count_,&pages_[replace_frame_id]);
   return &pages_[replace_frame_id];
 }
 
@@ -109,7 +104,6 @@ bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
   if (pages_[frame_id].pin_count_ == 0) {
     replacer_->Unpin(frame_id);
   }
-  LOG_INFO("unpin page %d pincount %d",page_id,pages_[frame_id].pin_count_);
   latch_.unlock();
   return true;
 }
@@ -177,9 +171,12 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   }
   frame_id_t frame_id = page_table_[page_id];
   if (pages_[frame_id].GetPinCount() > 0) {
+    latch_.unlock();
     return false;
   }
   page_table_.erase(page_id);
+  // the frame goes back to the free list, it must not be picked as a victim any more
+  replacer_->Pin(frame_id);
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
   pages_[frame_id].is_dirty_ = false;
@@ -0,0 +1,434 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPage(&root_page_id_);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *root_page = reinterpret_cast<HashTableRootDirectoryPage *>(page->GetData());
+  root_page->SetPageId(root_page_id_);
+  page_id_t segment_page_id;
+  Page *segment = buffer_pool_manager_->NewPage(&segment_page_id);
+  if (segment == nullptr) {
+    throw "out of memory";
+  }
+  auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(segment->GetData());
+  directory_page->SetPageId(segment_page_id);
+  root_page->SetSegmentPageId(0, segment_page_id);
+  page_id_t bucket_page_id;
+  if (buffer_pool_manager_->NewPage(&bucket_page_id) == nullptr) {
+    throw "out of memory";
+  }
+  directory_page->SetBucketPageId(0, bucket_page_id);
+  directory_page->SetLocalDepth(0, 0);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(segment_page_id, true);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+// the directory is indexed by the low bits of the hash
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableRootDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchRootPage() {
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  return reinterpret_cast<HashTableRootDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *EXTENDIBLE_HASH_TABLE_TYPE::FetchSegmentPage(HashTableRootDirectoryPage *root_page,
+                                                                     uint32_t slot) {
+  Page *page = buffer_pool_manager_->FetchPage(
+      root_page->GetSegmentPageId(HashTableRootDirectoryPage::SegmentIndex(slot)));
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  return reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+std::pair<page_id_t, uint32_t> EXTENDIBLE_HASH_TABLE_TYPE::GetBucket(HashTableRootDirectoryPage *root_page,
+                                                                     uint32_t slot) {
+  HashTableDirectoryPage *segment = FetchSegmentPage(root_page, slot);
+  uint32_t offset = HashTableRootDirectoryPage::SegmentOffset(slot);
+  std::pair<page_id_t, uint32_t> bucket{segment->GetBucketPageId(offset), segment->GetLocalDepth(offset)};
+  buffer_pool_manager_->UnpinPage(segment->GetPageId(), false);
+  return bucket;
+}
+
+/*
+ * The slots a step of 2^depth apart, fetching each directory page once. They
+ * are unpinned dirty if dirty is set.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+void EXTENDIBLE_HASH_TABLE_TYPE::ForEachSlot(HashTableRootDirectoryPage *root_page, uint32_t slot, uint32_t depth,
+                                             bool dirty, Visitor &&visit) {
+  uint32_t step = 1U << depth;
+  HashTableDirectoryPage *segment = nullptr;
+  for (uint32_t i = slot & (step - 1); i < root_page->Size(); i += step) {
+    if (segment == nullptr || HashTableRootDirectoryPage::SegmentOffset(i) < step) {
+      if (segment != nullptr) {
+        buffer_pool_manager_->UnpinPage(segment->GetPageId(), dirty);
+      }
+      segment = FetchSegmentPage(root_page, i);
+    }
+    visit(segment, HashTableRootDirectoryPage::SegmentOffset(i), i);
+  }
+  buffer_pool_manager_->UnpinPage(segment->GetPageId(), dirty);
+}
+
+/*
+ * Doubling a directory of one page copies its lower half to the upper half.
+ * Past that every directory page gets a copy that holds the new slots.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Grow(HashTableRootDirectoryPage *root_page) {
+  uint32_t segments = root_page->GetGlobalDepth() < HashTableRootDirectoryPage::SEGMENT_DEPTH
+                          ? 0
+                          : root_page->NumSegments();
+  std::vector<page_id_t> copies;
+  for (uint32_t i = 0; i < segments; i++) {
+    page_id_t copy_page_id;
+    Page *copy = buffer_pool_manager_->NewPage(&copy_page_id);
+    if (copy == nullptr) {
+      for (page_id_t page_id : copies) {
+        buffer_pool_manager_->DeletePage(page_id);
+      }
+      throw "out of memory";
+    }
+    buffer_pool_manager_->UnpinPage(copy_page_id, true);
+    copies.push_back(copy_page_id);
+  }
+  for (uint32_t i = 0; i < root_page->NumSegments(); i++) {
+    HashTableDirectoryPage *segment = FetchSegmentPage(root_page, i * DIRECTORY_ARRAY_SIZE);
+    segment->IncrGlobalDepth();
+    if (segments != 0) {
+      Page *copy = buffer_pool_manager_->FetchPage(copies[i]);
+      if (copy == nullptr) {
+        buffer_pool_manager_->UnpinPage(segment->GetPageId(), true);
+        throw "out of memory";
+      }
+      memcpy(copy->GetData(), reinterpret_cast<char *>(segment), PAGE_SIZE);
+      reinterpret_cast<HashTableDirectoryPage *>(copy->GetData())->SetPageId(copies[i]);
+      buffer_pool_manager_->UnpinPage(copies[i], true);
+      root_page->SetSegmentPageId(segments + i, copies[i]);
+    }
+    buffer_pool_manager_->UnpinPage(segment->GetPageId(), true);
+  }
+  root_page->IncrGlobalDepth();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::CanShrink(HashTableRootDirectoryPage *root_page) {
+  bool can_shrink = true;
+  for (uint32_t i = 0; i < root_page->NumSegments() && can_shrink; i++) {
+    HashTableDirectoryPage *segment = FetchSegmentPage(root_page, i * DIRECTORY_ARRAY_SIZE);
+    can_shrink = segment->CanShrink();
+    buffer_pool_manager_->UnpinPage(segment->GetPageId(), false);
+  }
+  return can_shrink;
+}
+
+// the upper half of the directory pages go away once the directory is more than one page
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Shrink(HashTableRootDirectoryPage *root_page) {
+  uint32_t segments = root_page->NumSegments();
+  uint32_t kept = root_page->GetGlobalDepth() > HashTableRootDirectoryPage::SEGMENT_DEPTH ? segments / 2 : segments;
+  for (uint32_t i = kept; i < segments; i++) {
+    buffer_pool_manager_->DeletePage(root_page->GetSegmentPageId(i));
+  }
+  for (uint32_t i = 0; i < kept; i++) {
+    HashTableDirectoryPage *segment = FetchSegmentPage(root_page, i * DIRECTORY_ARRAY_SIZE);
+    segment->DecrGlobalDepth();
+    buffer_pool_manager_->UnpinPage(segment->GetPageId(), true);
+  }
+  root_page->DecrGlobalDepth();
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  table_latch_.RLock();
+  HashTableRootDirectoryPage *root_page = FetchRootPage();
+  page_id_t bucket_page_id = GetBucket(root_page, Hash(key) & root_page->GetGlobalDepthMask()).first;
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->RLatch();
+  bool found = reinterpret_cast<BucketPage *>(page->GetData())->GetValue(key, comparator_, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableRootDirectoryPage *root_page = FetchRootPage();
+  page_id_t bucket_page_id = GetBucket(root_page, Hash(key) & root_page->GetGlobalDepthMask()).first;
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<BucketPage *>(page->GetData());
+  bool full = bucket_page->IsFull();
+  bool inserted = !full && bucket_page->Insert(key, value, comparator_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (!full) {
+    return inserted;
+  }
+  return SplitInsert(key, value);
+}
+
+/*
+ * Split the bucket of key by one more hash bit: the slots of the directory
+ * that have the new bit set and the pairs whose hash has it move to a new
+ * bucket. The directory doubles first if the bucket already uses every bit of
+ * it. All pairs may end up on one side, so this repeats until the bucket of
+ * key has room.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableRootDirectoryPage *root_page = FetchRootPage();
+  bool inserted = false;
+  while (true) {
+    uint32_t bucket_idx = Hash(key) & root_page->GetGlobalDepthMask();
+    page_id_t bucket_page_id;
+    uint32_t local_depth;
+    std::tie(bucket_page_id, local_depth) = GetBucket(root_page, bucket_idx);
+    Page *page = FetchBucketPage(bucket_page_id);
+    auto *bucket_page = reinterpret_cast<BucketPage *>(page->GetData());
+    if (!bucket_page->IsFull()) {
+      inserted = bucket_page->Insert(key, value, comparator_);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+    std::vector<ValueType> values;
+    bucket_page->GetValue(key, comparator_, &values);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    page_id_t image_page_id;
+    Page *image_page = nullptr;
+    try {
+      if (local_depth == root_page->GetGlobalDepth()) {
+        if (root_page->GetGlobalDepth() == HashTableRootDirectoryPage::MAX_DEPTH) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "hash table bucket is full and cannot split");
+        }
+        Grow(root_page);
+      }
+      image_page = buffer_pool_manager_->NewPage(&image_page_id);
+      if (image_page == nullptr) {
+        throw "out of memory";
+      }
+    } catch (...) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(root_page_id_, true);
+      table_latch_.WUnlock();
+      throw;
+    }
+    auto *image_bucket_page = reinterpret_cast<BucketPage *>(image_page->GetData());
+    uint32_t split_bit = 1U << local_depth;
+    ForEachSlot(root_page, bucket_idx, local_depth, true,
+                [&](HashTableDirectoryPage *segment, uint32_t offset, uint32_t slot) {
+                  segment->SetLocalDepth(offset, local_depth + 1);
+                  if ((slot & split_bit) != 0) {
+                    segment->SetBucketPageId(offset, image_page_id);
+                  }
+                });
+    for (slot_offset_t slot = 0; slot < BUCKET_ARRAY_SIZE; slot++) {
+      if (bucket_page->IsReadable(slot) && (Hash(bucket_page->KeyAt(slot)) & split_bit) != 0) {
+        image_bucket_page->Insert(bucket_page->KeyAt(slot), bucket_page->ValueAt(slot), comparator_);
+        bucket_page->RemoveAt(slot);
+      }
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  HashTableRootDirectoryPage *root_page = FetchRootPage();
+  auto [bucket_page_id, local_depth] = GetBucket(root_page, Hash(key) & root_page->GetGlobalDepthMask());
+  bool mergeable = local_depth > 0;
+  Page *page = FetchBucketPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<BucketPage *>(page->GetData());
+  bool removed = bucket_page->Remove(key, value, comparator_);
+  bool empty = bucket_page->IsEmpty();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  table_latch_.RUnlock();
+
+  if (removed && empty && mergeable) {
+    Merge(key);
+  }
+  return removed;
+}
+
+/*
+ * Fold the empty bucket of key into its split image if the image has the
+ * same local depth, and repeat while the merged bucket is empty as well. Then
+ * halve the directory as often as it can be.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(const KeyType &key) {
+  table_latch_.WLock();
+  HashTableRootDirectoryPage *root_page = FetchRootPage();
+  uint32_t bucket_idx = Hash(key) & root_page->GetGlobalDepthMask();
+  while (true) {
+    page_id_t bucket_page_id;
+    uint32_t local_depth;
+    std::tie(bucket_page_id, local_depth) = GetBucket(root_page, bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    // the split image differs in the highest of the local depth bits
+    uint32_t image_idx = (bucket_idx ^ (1U << (local_depth - 1))) & ((1U << local_depth) - 1);
+    auto [image_page_id, image_depth] = GetBucket(root_page, image_idx);
+    if (image_depth != local_depth) {
+      break;
+    }
+    Page *page = FetchBucketPage(bucket_page_id);
+    bool empty = reinterpret_cast<BucketPage *>(page->GetData())->IsEmpty();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      // the image may be the empty one after an insert in between, it is merged on its next remove
+      break;
+    }
+    page_id_t merged_page_id = image_page_id;
+    ForEachSlot(root_page, image_idx, local_depth - 1, true,
+                [&](HashTableDirectoryPage *segment, uint32_t offset, uint32_t /* slot */) {
+                  segment->SetBucketPageId(offset, merged_page_id);
+                  segment->SetLocalDepth(offset, local_depth - 1);
+                });
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+  }
+  while (CanShrink(root_page)) {
+    Shrink(root_page);
+  }
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = FetchRootPage()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+/*****************************************************************************
+ * VERIFY INTEGRITY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::VerifyIntegrity() {
+  table_latch_.RLock();
+  HashTableRootDirectoryPage *root_page = FetchRootPage();
+  uint32_t global_depth = root_page->GetGlobalDepth();
+  std::vector<std::pair<page_id_t, uint32_t>> buckets;
+  ForEachSlot(root_page, 0, 0, false, [&](HashTableDirectoryPage *segment, uint32_t offset, uint32_t /* slot */) {
+    assert(segment->GetGlobalDepth() == global_depth);
+    buckets.emplace_back(segment->GetBucketPageId(offset), segment->GetLocalDepth(offset));
+  });
+  std::unordered_map<page_id_t, uint32_t> slot_count;
+  std::unordered_map<page_id_t, uint32_t> local_depth;
+  for (uint32_t i = 0; i < buckets.size(); i++) {
+    auto [page_id, depth] = buckets[i];
+    assert(depth <= global_depth);
+    assert(local_depth.count(page_id) == 0 || local_depth[page_id] == depth);
+    // the slots of a bucket agree on its local depth bits
+    assert(buckets[i & ((1U << depth) - 1)].first == page_id);
+    local_depth[page_id] = depth;
+    slot_count[page_id]++;
+  }
+  for (const auto &[page_id, count] : slot_count) {
+    if (count != 1U << (global_depth - local_depth[page_id])) {
+      LOG_WARN("bucket page %d has %u slots at local depth %u", page_id, count, local_depth[page_id]);
+      assert(false);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  table_latch_.RUnlock();
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
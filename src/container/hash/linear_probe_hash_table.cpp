@@ -10,59 +10,398 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "container/hash/linear_probe_hash_table.h"
 
 namespace bustub {
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  table_ = NewTable(num_buckets);
+  header_page_id_ = table_->header_page_id_;
+}
+
+/*****************************************************************************
+ * TABLES
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+std::unique_ptr<typename HASH_TABLE_TYPE::Table> HASH_TABLE_TYPE::NewTable(size_t num_buckets) {
+  size_t num_blocks = std::min(std::max<size_t>((num_buckets + BlockPage::SLOT_COUNT - 1) / BlockPage::SLOT_COUNT, 1),
+                               HashTableHeaderPage::MAX_BLOCKS);
+  auto table = std::make_unique<Table>();
+  Page *page = buffer_pool_manager_->NewPage(&table->header_page_id_);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header_page->SetPageId(table->header_page_id_);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id;
+    if (buffer_pool_manager_->NewPage(&block_page_id) == nullptr) {
+      throw "out of memory";
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+    header_page->AddBlockPageId(block_page_id);
+    table->block_page_ids_.push_back(block_page_id);
+  }
+  table->num_buckets_ = num_blocks * BlockPage::SLOT_COUNT;
+  header_page->SetSize(table->num_buckets_);
+  buffer_pool_manager_->UnpinPage(table->header_page_id_, true);
+  return table;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+void HASH_TABLE_TYPE::DeleteTable(Table *table) {
+  for (page_id_t block_page_id : table->block_page_ids_) {
+    buffer_pool_manager_->DeletePage(block_page_id);
+  }
+  buffer_pool_manager_->DeletePage(table->header_page_id_);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+Page *HASH_TABLE_TYPE::FetchBlock(const Table &table, size_t block) {
+  Page *page = buffer_pool_manager_->FetchPage(table.block_page_ids_[block]);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+Page *HASH_TABLE_TYPE::LatchHome(const Table &table, const KeyType &key) {
+  Page *page = FetchBlock(table, hash_fn_.GetHash(key) % table.num_buckets_ / BlockPage::SLOT_COUNT);
+  page->WLatch();
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+void HASH_TABLE_TYPE::UnlatchHome(Page *page) {
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
+/*
+ * The candidates of a group are matched before its first empty bucket is
+ * handled, and the group is matched once, so buckets claimed after that are
+ * skipped like in a probe that passed them before.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+template <typename Visitor, typename EmptyVisitor>
+void HASH_TABLE_TYPE::Probe(const Table &table, const KeyType &key, bool dirty, Visitor visit,
+                            EmptyVisitor at_empty) {
+  uint64_t hash = hash_fn_.GetHash(key);
+  uint8_t tag = BlockPage::Tag(hash);
+  size_t bucket = hash % table.num_buckets_;
+  size_t remaining = table.num_buckets_;
+  Page *page = nullptr;
+  size_t block = 0;
+  bool done = false;
+  while (!done && remaining > 0) {
+    if (page == nullptr || bucket / BlockPage::SLOT_COUNT != block) {
+      if (page != nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+      }
+      block = bucket / BlockPage::SLOT_COUNT;
+      page = FetchBlock(table, block);
+    }
+    auto *block_page = reinterpret_cast<BlockPage *>(page->GetData());
+    auto slot = static_cast<slot_offset_t>(bucket % BlockPage::SLOT_COUNT);
+    slot_offset_t group_start = slot / BlockPage::GROUP_SIZE * BlockPage::GROUP_SIZE;
+    auto end = static_cast<slot_offset_t>(std::min<size_t>(
+        {group_start + BlockPage::GROUP_SIZE, BlockPage::SLOT_COUNT, slot + remaining}));
+    // the buckets of the probe sequence in this group
+    auto range = static_cast<uint32_t>(((uint64_t{1} << (end - group_start)) - 1) &
+                                       ~((uint64_t{1} << (slot - group_start)) - 1));
+    uint32_t candidates;
+    uint32_t empty;
+    block_page->MatchGroup(group_start, tag, &candidates, &empty);
+    candidates &= range;
+    empty &= range;
+    while (!done) {
+      // the candidates before the first empty bucket
+      uint32_t before = empty == 0 ? candidates : candidates & ((empty & -empty) - 1);
+      for (; before != 0 && !done; before &= before - 1) {
+        done = visit(block_page, group_start + __builtin_ctz(before));
+      }
+      if (done || empty == 0) {
+        break;
+      }
+      slot_offset_t first_empty = __builtin_ctz(empty);
+      done = at_empty(block_page, group_start + first_empty);
+      // the bucket was claimed, go on past it
+      uint32_t passed = (uint32_t{2} << first_empty) - 1;
+      candidates &= ~passed;
+      empty &= ~passed;
+    }
+    remaining -= end - slot;
+    bucket = (bucket + end - slot) % table.num_buckets_;
+  }
+  if (page != nullptr) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+  }
+}
+
+/*
+ * The visitors compare the keys of the candidates only, a candidate was
+ * readable when its group was matched.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+typename HASH_TABLE_TYPE::InsertResult HASH_TABLE_TYPE::InsertInto(Table *table, const KeyType &key,
+                                                                   const ValueType &value) {
+  uint8_t tag = BlockPage::Tag(hash_fn_.GetHash(key));
+  bool duplicate = false;
+  bool inserted = false;
+  Probe(
+      *table, key, true,
+      [&](BlockPage *block_page, slot_offset_t slot) {
+        duplicate = comparator_(block_page->KeyAt(slot), key) == 0 && block_page->ValueAt(slot) == value;
+        return duplicate;
+      },
+      [&](BlockPage *block_page, slot_offset_t slot) {
+        // fails if an insert of another key claimed the bucket first
+        inserted = block_page->Insert(slot, key, value, tag);
+        return inserted;
+      });
+  if (duplicate) {
+    return InsertResult::DUPLICATE;
+  }
+  if (!inserted) {
+    return InsertResult::FULL;
+  }
+  table->occupied_++;
+  return InsertResult::SUCCESS;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+bool HASH_TABLE_TYPE::FindPair(const Table &table, const KeyType &key, const ValueType &value, bool remove) {
+  bool found = false;
+  Probe(
+      table, key, remove,
+      [&](BlockPage *block_page, slot_offset_t slot) {
+        if (comparator_(block_page->KeyAt(slot), key) != 0 || !(block_page->ValueAt(slot) == value)) {
+          return false;
+        }
+        if (remove) {
+          block_page->Remove(slot);
+        }
+        found = true;
+        return true;
+      },
+      [](BlockPage *block_page, slot_offset_t slot) { return true; });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+void HASH_TABLE_TYPE::CollectValues(const Table &table, const KeyType &key, std::vector<ValueType> *result) {
+  Probe(
+      table, key, false,
+      [&](BlockPage *block_page, slot_offset_t slot) {
+        if (comparator_(block_page->KeyAt(slot), key) == 0) {
+          result->push_back(block_page->ValueAt(slot));
+        }
+        return false;
+      },
+      [](BlockPage *block_page, slot_offset_t slot) { return true; });
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+/*
+ * During a resize the old table is read first: a pair is put into the new
+ * table before it is removed from the old one, so a pair that moves while it
+ * is looked up is found at least once.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  size_t first = result->size();
+  table_latch_.RLock();
+  if (old_table_ != nullptr) {
+    CollectValues(*old_table_, key, result);
+    size_t moved = result->size();
+    CollectValues(*table_, key, result);
+    auto old_end = result->begin() + moved;
+    result->erase(std::remove_if(old_end, result->end(),
+                                 [&](const ValueType &value) {
+                                   return std::find(result->begin() + first, old_end, value) != old_end;
+                                 }),
+                  result->end());
+  } else {
+    CollectValues(*table_, key, result);
+  }
+  table_latch_.RUnlock();
+  return result->size() > first;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+/*
+ * Inserts go to the current table. The table is resized once more than half
+ * of its buckets are claimed, to twice its size, or to the same size if
+ * mostly tombstones fill it. A table of MAX_BLOCKS blocks cannot grow, it is
+ * only rehashed for its tombstones, and an insert into it that finds no free
+ * bucket throws.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  while (true) {
+    table_latch_.RLock();
+    bool finished = HelpResize();
+    Page *old_home = old_table_ != nullptr ? LatchHome(*old_table_, key) : nullptr;
+    Page *home = LatchHome(*table_, key);
+    InsertResult result = InsertResult::DUPLICATE;
+    if (old_home == nullptr || !FindPair(*old_table_, key, value, false)) {
+      result = InsertInto(table_.get(), key, value);
+    }
+    UnlatchHome(home);
+    if (old_home != nullptr) {
+      UnlatchHome(old_home);
+    }
+    size_t num_buckets = table_->num_buckets_;
+    bool grow = table_->occupied_ * 2 > num_buckets;
+    bool can_grow = table_->block_page_ids_.size() < HashTableHeaderPage::MAX_BLOCKS;
+    bool resizing = old_table_ != nullptr;
+    table_latch_.RUnlock();
+
+    if (finished) {
+      FinishResize();
+    }
+    if (result == InsertResult::SUCCESS) {
+      num_entries_++;
+    }
+    // a table that holds few pairs is rehashed at the same size to drop its tombstones
+    bool rehash = num_entries_ * 4 <= num_buckets;
+    if ((grow || result == InsertResult::FULL) && (can_grow || rehash)) {
+      Resize(rehash ? num_buckets / 2 : num_buckets);
+    } else if (result == InsertResult::FULL && !resizing) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "hash table is full and cannot grow");
+    }
+    if (result != InsertResult::FULL) {
+      return result == InsertResult::SUCCESS;
+    }
+  }
 }
 
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  table_latch_.RLock();
+  bool finished = HelpResize();
+  Page *old_home = old_table_ != nullptr ? LatchHome(*old_table_, key) : nullptr;
+  Page *home = LatchHome(*table_, key);
+  bool removed = FindPair(*table_, key, value, true) || (old_home != nullptr && FindPair(*old_table_, key, value, true));
+  UnlatchHome(home);
+  if (old_home != nullptr) {
+    UnlatchHome(old_home);
+  }
+  table_latch_.RUnlock();
+
+  if (finished) {
+    FinishResize();
+  }
+  if (removed) {
+    num_entries_--;
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+/*
+ * Only allocates the new table and swaps it in, the pairs are moved by the
+ * following inserts and removes. Nothing happens if a resize is in progress.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  if (resizing_.exchange(true)) {
+    return;
+  }
+  std::unique_ptr<Table> table = NewTable(2 * initial_size);
+  table_latch_.WLock();
+  old_table_ = std::move(table_);
+  table_ = std::move(table);
+  header_page_id_ = table_->header_page_id_;
+  next_migrate_block_ = 0;
+  migrated_blocks_ = 0;
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+bool HASH_TABLE_TYPE::HelpResize() {
+  if (old_table_ == nullptr) {
+    return false;
+  }
+  size_t num_blocks = old_table_->block_page_ids_.size();
+  size_t block = next_migrate_block_++;
+  if (block >= num_blocks) {
+    return false;
+  }
+  MigrateBlock(block);
+  return ++migrated_blocks_ == num_blocks;
+}
+
+/*
+ * A pair is moved under the latches of its home blocks in both tables, like
+ * any other write of its key.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+void HASH_TABLE_TYPE::MigrateBlock(size_t block) {
+  Page *page = FetchBlock(*old_table_, block);
+  auto *block_page = reinterpret_cast<BlockPage *>(page->GetData());
+  for (slot_offset_t slot = 0; slot < BlockPage::SLOT_COUNT; slot++) {
+    if (!block_page->IsReadable(slot)) {
+      continue;
+    }
+    KeyType key = block_page->KeyAt(slot);
+    ValueType value = block_page->ValueAt(slot);
+    Page *old_home = LatchHome(*old_table_, key);
+    Page *home = LatchHome(*table_, key);
+    // removed since it was read
+    if (block_page->IsReadable(slot)) {
+      [[maybe_unused]] InsertResult result = InsertInto(table_.get(), key, value);
+      BUSTUB_ASSERT(result == InsertResult::SUCCESS, "The new table has room for every pair of the old one.");
+      block_page->Remove(slot);
+    }
+    UnlatchHome(home);
+    UnlatchHome(old_home);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
+void HASH_TABLE_TYPE::FinishResize() {
+  table_latch_.WLock();
+  std::unique_ptr<Table> old_table = std::move(old_table_);
+  table_latch_.WUnlock();
+  DeleteTable(old_table.get());
+  resizing_ = false;
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator, typename BlockPage>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = table_->num_buckets_;
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -73,4 +412,17 @@ template class LinearProbeHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class LinearProbeHashTable<int, int, IntComparator, HashTableTagBlockPage<int, int, IntComparator>>;
+
+template class LinearProbeHashTable<GenericKey<4>, RID, GenericComparator<4>,
+                                    HashTableTagBlockPage<GenericKey<4>, RID, GenericComparator<4>>>;
+template class LinearProbeHashTable<GenericKey<8>, RID, GenericComparator<8>,
+                                    HashTableTagBlockPage<GenericKey<8>, RID, GenericComparator<8>>>;
+template class LinearProbeHashTable<GenericKey<16>, RID, GenericComparator<16>,
+                                    HashTableTagBlockPage<GenericKey<16>, RID, GenericComparator<16>>>;
+template class LinearProbeHashTable<GenericKey<32>, RID, GenericComparator<32>,
+                                    HashTableTagBlockPage<GenericKey<32>, RID, GenericComparator<32>>>;
+template class LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>,
+                                    HashTableTagBlockPage<GenericKey<64>, RID, GenericComparator<64>>>;
+
 }  // namespace bustub
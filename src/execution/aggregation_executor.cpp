@@ -29,48 +29,57 @@ const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return c
 
 void AggregationExecutor::Init() {
   child_->Init();
-  Tuple tuple;
-  RID rid;
-  while (child_->Next(&tuple, &rid)) {
-    LOG_INFO("insert one");
-    aht_.InsertCombine(MakeKey(&tuple), MakeVal(&tuple));
+  ResetNextFromBatch();
+  // the group by and aggregate expressions are evaluated a child batch at a time, then the rows go into the table
+  const auto &group_bys = plan_->GetGroupBys();
+  const auto &aggregates = plan_->GetAggregates();
+  std::vector<std::vector<Value>> keys(group_bys.size());
+  std::vector<std::vector<Value>> vals(aggregates.size());
+  TupleBatch batch(exec_ctx_->GetBatchSize());
+  while (child_->NextBatch(&batch)) {
+    for (size_t i = 0; i < group_bys.size(); i++) {
+      group_bys[i]->EvaluateBatch(batch, batch.Selection(), &keys[i]);
+    }
+    for (size_t i = 0; i < aggregates.size(); i++) {
+      aggregates[i]->EvaluateBatch(batch, batch.Selection(), &vals[i]);
+    }
+    AggregateKey key;
+    AggregateValue val;
+    key.group_bys_.resize(group_bys.size());
+    val.aggregates_.resize(aggregates.size());
+    for (uint32_t row : batch.Selection()) {
+      for (size_t i = 0; i < group_bys.size(); i++) {
+        key.group_bys_[i] = keys[i][row];
+      }
+      for (size_t i = 0; i < aggregates.size(); i++) {
+        val.aggregates_[i] = vals[i][row];
+      }
+      aht_.InsertCombine(key, val);
+    }
   }
-  LOG_INFO("INIT END");
   aht_iterator_ = aht_.Begin();
   aht_end_ = aht_.End();
 }
 
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
-  if (aht_iterator_ == aht_end_) {
-    LOG_INFO("aht iter==aht end");
-    return false;
-  }
-  Value ok(BOOLEAN, 1);
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
 
-  do {
-    AggregateValue value = aht_iterator_.Val();
-    AggregateKey key = aht_iterator_.Key();
-    ++aht_iterator_;
-
-    std::vector<Value> aggregate_values(GetOutputSchema()->GetColumnCount());
-    LOG_INFO("AGGREGATE");
-    for (size_t i = 0; i < GetOutputSchema()->GetColumnCount(); ++i) {
-      aggregate_values[i] =
-          GetOutputSchema()->GetColumn(i).GetExpr()->EvaluateAggregate(key.group_bys_, value.aggregates_);
+bool AggregationExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  std::vector<Value> aggregate_values(GetOutputSchema()->GetColumnCount());
+  while (!batch->IsFull() && aht_iterator_ != aht_end_) {
+    const AggregateKey &key = aht_iterator_.Key();
+    const AggregateValue &value = aht_iterator_.Val();
+    if (plan_->GetHaving() == nullptr ||
+        plan_->GetHaving()->EvaluateAggregate(key.group_bys_, value.aggregates_).GetAs<bool>()) {
+      for (size_t i = 0; i < GetOutputSchema()->GetColumnCount(); ++i) {
+        aggregate_values[i] =
+            GetOutputSchema()->GetColumn(i).GetExpr()->EvaluateAggregate(key.group_bys_, value.aggregates_);
+      }
+      batch->AppendRow(aggregate_values, RID());
     }
-    Tuple aggregate_tuple(aggregate_values, GetOutputSchema());
-    LOG_INFO("AGGREGATE FINISHED");
-    if (plan_->GetHaving()!= nullptr){
-
-      ok = plan_->GetHaving()->EvaluateAggregate(key.group_bys_,value.aggregates_);
-
-    }
-    LOG_INFO("HAVING FINISHED");
-    *tuple = aggregate_tuple;
-
-  } while (!ok.GetAs<bool>() && aht_iterator_ != aht_end_);
-
-  return ok.GetAs<bool>();
+    ++aht_iterator_;
+  }
+  return batch->SelectedCount() > 0;
 }
 
 }  // namespace bustub
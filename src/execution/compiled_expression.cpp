@@ -0,0 +1,374 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.cpp
+//
+// Identification: src/execution/compiled_expression.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/compiled_expression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/filter_kernels.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+// calls f with a value of the C++ type of a numeric type id, nullptr for the other types
+template <typename F>
+auto ForType(TypeId type, F &&f) -> decltype(f(int32_t{})) {
+  switch (type) {
+    case TypeId::TINYINT:
+      return f(int8_t{});
+    case TypeId::SMALLINT:
+      return f(int16_t{});
+    case TypeId::INTEGER:
+      return f(int32_t{});
+    case TypeId::BIGINT:
+      return f(int64_t{});
+    case TypeId::DECIMAL:
+      return f(double{});
+    default:
+      return nullptr;
+  }
+}
+
+// the type two operands are compared in, INVALID if they cannot be compared here
+TypeId CompareType(TypeId lhs, TypeId rhs) {
+  if (lhs == rhs) {
+    return lhs;
+  }
+  if (lhs == TypeId::BOOLEAN || rhs == TypeId::BOOLEAN) {
+    return TypeId::INVALID;
+  }
+  if (lhs == TypeId::DECIMAL || rhs == TypeId::DECIMAL) {
+    return TypeId::DECIMAL;
+  }
+  return TypeId::BIGINT;
+}
+
+// true if values of type from can be loaded as type to
+bool CanLoadAs(TypeId from, TypeId to) {
+  return from == to || (from != TypeId::BOOLEAN && (to == TypeId::BIGINT || to == TypeId::DECIMAL));
+}
+
+// the comparison with its operands swapped, a < b is b > a
+ComparisonType Mirror(ComparisonType op) {
+  switch (op) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return op;
+  }
+}
+
+// how a null of type T is stored in the data of a tuple, Value::DeserializeFrom() reads it back as a null
+template <typename T>
+T StoredNull() {
+  if constexpr (std::is_same_v<T, int8_t>) {
+    return BUSTUB_INT8_NULL;
+  } else if constexpr (std::is_same_v<T, int16_t>) {
+    return BUSTUB_INT16_NULL;
+  } else if constexpr (std::is_same_v<T, int32_t>) {
+    return BUSTUB_INT32_NULL;
+  } else if constexpr (std::is_same_v<T, int64_t>) {
+    return BUSTUB_INT64_NULL;
+  } else {
+    return BUSTUB_DECIMAL_NULL;
+  }
+}
+
+// the value of a constant expression as type
+Value ConstantAs(const AbstractExpression *expr, TypeId type) {
+  Value constant = expr->Evaluate(nullptr, nullptr);
+  return constant.GetTypeId() == type ? constant : constant.CastAs(type);
+}
+
+}  // namespace
+
+template <typename From, typename To>
+void CompiledExpression::LoadColumn(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                                    std::vector<Register> *registers) {
+  Register &out = (*registers)[step.out_];
+  To *data = out.Data<To>(rows.size());
+  uint64_t *nulls = out.Nulls(rows.size());
+  std::fill(nulls, nulls + BitmapWords(rows.size()), 0);
+  if (input.batch_ != nullptr) {
+    const std::vector<Value> &column = input.batch_->Column(step.col_idx_);
+    for (size_t i = 0; i < rows.size(); i++) {
+      const Value &value = column[rows[i]];
+      data[i] = static_cast<To>(value.GetAs<From>());
+      nulls[i / 64] |= uint64_t{value.IsNull()} << (i % 64);
+    }
+    return;
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    From value;
+    memcpy(&value, (*input.tuples_)[rows[i]].GetData() + step.col_offset_, sizeof(From));
+    data[i] = static_cast<To>(value);
+    nulls[i / 64] |= uint64_t{value == StoredNull<From>()} << (i % 64);
+  }
+}
+
+void CompiledExpression::LoadBooleanColumn(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                                           std::vector<Register> *registers) {
+  Register &out = (*registers)[step.out_];
+  uint64_t *bits = out.Bits(rows.size());
+  uint64_t *nulls = out.Nulls(rows.size());
+  std::fill(bits, bits + BitmapWords(rows.size()), 0);
+  std::fill(nulls, nulls + BitmapWords(rows.size()), 0);
+  for (size_t i = 0; i < rows.size(); i++) {
+    int8_t value;
+    if (input.batch_ != nullptr) {
+      value = input.batch_->Column(step.col_idx_)[rows[i]].GetAs<int8_t>();
+    } else {
+      memcpy(&value, (*input.tuples_)[rows[i]].GetData() + step.col_offset_, sizeof(int8_t));
+    }
+    bits[i / 64] |= uint64_t{value != 0} << (i % 64);
+    nulls[i / 64] |= uint64_t{value == BUSTUB_BOOLEAN_NULL} << (i % 64);
+  }
+}
+
+template <typename T>
+void CompiledExpression::LoadConstant(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                                      std::vector<Register> *registers) {
+  Register &out = (*registers)[step.out_];
+  T *data = out.Data<T>(rows.size());
+  std::fill(data, data + rows.size(), step.constant_.GetAs<T>());
+  uint64_t *nulls = out.Nulls(rows.size());
+  std::fill(nulls, nulls + BitmapWords(rows.size()), step.constant_.IsNull() ? ~uint64_t{0} : 0);
+}
+
+void CompiledExpression::LoadBooleanConstant(const Step &step, const Input &input,
+                                             const std::vector<uint32_t> &rows, std::vector<Register> *registers) {
+  Register &out = (*registers)[step.out_];
+  uint64_t *bits = out.Bits(rows.size());
+  std::fill(bits, bits + BitmapWords(rows.size()), step.constant_.GetAs<int8_t>() != 0 ? ~uint64_t{0} : 0);
+  uint64_t *nulls = out.Nulls(rows.size());
+  std::fill(nulls, nulls + BitmapWords(rows.size()), step.constant_.IsNull() ? ~uint64_t{0} : 0);
+}
+
+template <typename T>
+void CompiledExpression::CompareRegisters(const Step &step, const Input &input,
+                                          const std::vector<uint32_t> &rows, std::vector<Register> *registers) {
+  const Register &lhs = (*registers)[step.lhs_];
+  const Register &rhs = (*registers)[step.rhs_];
+  Register &out = (*registers)[step.out_];
+  auto filter = reinterpret_cast<FilterKernel<T>>(step.filter_);
+  filter(lhs.Data<T>(), rhs.Data<T>(), T{}, rows.size(), out.Bits(rows.size()));
+  uint64_t *nulls = out.Nulls(rows.size());
+  for (size_t i = 0; i < BitmapWords(rows.size()); i++) {
+    nulls[i] = lhs.nulls_[i] | rhs.nulls_[i];
+  }
+}
+
+template <typename T>
+void CompiledExpression::CompareConstant(const Step &step, const Input &input,
+                                         const std::vector<uint32_t> &rows, std::vector<Register> *registers) {
+  const Register &lhs = (*registers)[step.lhs_];
+  Register &out = (*registers)[step.out_];
+  auto filter = reinterpret_cast<FilterKernel<T>>(step.filter_);
+  filter(lhs.Data<T>(), nullptr, step.constant_.GetAs<T>(), rows.size(), out.Bits(rows.size()));
+  uint64_t *nulls = out.Nulls(rows.size());
+  uint64_t constant_null = step.constant_.IsNull() ? ~uint64_t{0} : 0;
+  for (size_t i = 0; i < BitmapWords(rows.size()); i++) {
+    nulls[i] = lhs.nulls_[i] | constant_null;
+  }
+}
+
+template <ComparisonType OP>
+void CompiledExpression::CompareBooleans(const Step &step, const Input &input,
+                                         const std::vector<uint32_t> &rows, std::vector<Register> *registers) {
+  const Register &lhs = (*registers)[step.lhs_];
+  const Register &rhs = (*registers)[step.rhs_];
+  Register &out = (*registers)[step.out_];
+  const uint64_t *left = lhs.Data<uint64_t>();
+  const uint64_t *right = rhs.Data<uint64_t>();
+  uint64_t *bits = out.Bits(rows.size());
+  uint64_t *nulls = out.Nulls(rows.size());
+  // false < true, a whole word of rows at a time; the bits past the rows may be set and are never read
+  for (size_t i = 0; i < BitmapWords(rows.size()); i++) {
+    uint64_t a = left[i];
+    uint64_t b = right[i];
+    if constexpr (OP == ComparisonType::Equal) {
+      bits[i] = ~(a ^ b);
+    } else if constexpr (OP == ComparisonType::NotEqual) {
+      bits[i] = a ^ b;
+    } else if constexpr (OP == ComparisonType::LessThan) {
+      bits[i] = ~a & b;
+    } else if constexpr (OP == ComparisonType::LessThanOrEqual) {
+      bits[i] = ~a | b;
+    } else if constexpr (OP == ComparisonType::GreaterThan) {
+      bits[i] = a & ~b;
+    } else {
+      bits[i] = a | ~b;
+    }
+    nulls[i] = lhs.nulls_[i] | rhs.nulls_[i];
+  }
+}
+
+std::unique_ptr<CompiledExpression> CompiledExpression::Compile(const AbstractExpression *expr,
+                                                                const Schema *schema) {
+  if (expr == nullptr || expr->GetReturnType() != TypeId::BOOLEAN) {
+    return nullptr;
+  }
+  std::unique_ptr<CompiledExpression> program(new CompiledExpression());
+  if (!program->Emit(expr, schema, TypeId::BOOLEAN, &program->result_)) {
+    return nullptr;
+  }
+  return program;
+}
+
+bool CompiledExpression::Emit(const AbstractExpression *expr, const Schema *schema, TypeId type, uint32_t *out) {
+  if (!CanLoadAs(expr->GetReturnType(), type)) {
+    return false;
+  }
+  Step step{};
+  if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+    if (column->GetColIdx() >= schema->GetColumnCount() ||
+        schema->GetColumn(column->GetColIdx()).GetType() != expr->GetReturnType()) {
+      return false;
+    }
+    step.col_idx_ = column->GetColIdx();
+    step.col_offset_ = schema->GetColumn(column->GetColIdx()).GetOffset();
+    if (type == TypeId::BOOLEAN) {
+      step.kernel_ = &LoadBooleanColumn;
+    } else {
+      step.kernel_ = ForType(expr->GetReturnType(), [type](auto from) -> Kernel {
+        using From = decltype(from);
+        return ForType(type, [](auto to) -> Kernel { return &LoadColumn<From, decltype(to)>; });
+      });
+    }
+  } else if (dynamic_cast<const ConstantValueExpression *>(expr) != nullptr) {
+    step.constant_ = ConstantAs(expr, type);
+    if (type == TypeId::BOOLEAN) {
+      step.kernel_ = &LoadBooleanConstant;
+    } else {
+      step.kernel_ = ForType(type, [](auto tag) -> Kernel { return &LoadConstant<decltype(tag)>; });
+    }
+  } else if (const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr); comparison != nullptr) {
+    if (!EmitComparison(comparison, schema, &step)) {
+      return false;
+    }
+  }
+  if (step.kernel_ == nullptr) {
+    return false;
+  }
+  step.out_ = static_cast<uint32_t>(registers_.size());
+  registers_.emplace_back();
+  steps_.push_back(step);
+  *out = step.out_;
+  return true;
+}
+
+bool CompiledExpression::EmitComparison(const ComparisonExpression *expr, const Schema *schema, Step *step) {
+  const AbstractExpression *lhs = expr->GetChildAt(0);
+  const AbstractExpression *rhs = expr->GetChildAt(1);
+  TypeId operand_type = CompareType(lhs->GetReturnType(), rhs->GetReturnType());
+  if (operand_type == TypeId::INVALID) {
+    return false;
+  }
+  ComparisonType op = expr->GetComparisonType();
+
+  if (operand_type == TypeId::BOOLEAN) {
+    if (!Emit(lhs, schema, operand_type, &step->lhs_) || !Emit(rhs, schema, operand_type, &step->rhs_)) {
+      return false;
+    }
+    switch (op) {
+      case ComparisonType::Equal:
+        step->kernel_ = &CompareBooleans<ComparisonType::Equal>;
+        break;
+      case ComparisonType::NotEqual:
+        step->kernel_ = &CompareBooleans<ComparisonType::NotEqual>;
+        break;
+      case ComparisonType::LessThan:
+        step->kernel_ = &CompareBooleans<ComparisonType::LessThan>;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        step->kernel_ = &CompareBooleans<ComparisonType::LessThanOrEqual>;
+        break;
+      case ComparisonType::GreaterThan:
+        step->kernel_ = &CompareBooleans<ComparisonType::GreaterThan>;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        step->kernel_ = &CompareBooleans<ComparisonType::GreaterThanOrEqual>;
+        break;
+    }
+    return true;
+  }
+
+  // a constant operand goes into the kernel instead of a register, on the right
+  bool lhs_constant = dynamic_cast<const ConstantValueExpression *>(lhs) != nullptr;
+  bool rhs_constant = dynamic_cast<const ConstantValueExpression *>(rhs) != nullptr;
+  if (lhs_constant && !rhs_constant) {
+    std::swap(lhs, rhs);
+    std::swap(lhs_constant, rhs_constant);
+    op = Mirror(op);
+  }
+  if (!Emit(lhs, schema, operand_type, &step->lhs_)) {
+    return false;
+  }
+  if (rhs_constant) {
+    step->constant_ = ConstantAs(rhs, operand_type);
+  } else if (!Emit(rhs, schema, operand_type, &step->rhs_)) {
+    return false;
+  }
+  step->kernel_ = ForType(operand_type, [step, op, rhs_constant](auto tag) -> Kernel {
+    using T = decltype(tag);
+    step->filter_ = reinterpret_cast<AnyFilterKernel>(GetFilterKernel<T>(op));
+    return rhs_constant ? &CompareConstant<T> : &CompareRegisters<T>;
+  });
+  return true;
+}
+
+void CompiledExpression::Filter(TupleBatch *batch) {
+  std::vector<uint32_t> selection;
+  Run(Input{batch, nullptr}, batch->Selection(), &selection);
+  batch->SetSelection(std::move(selection));
+}
+
+void CompiledExpression::FilterTuples(const std::vector<Tuple> &tuples, std::vector<uint32_t> *selection) {
+  std::vector<uint32_t> rows;
+  rows.swap(*selection);
+  Run(Input{nullptr, &tuples}, rows, selection);
+}
+
+void CompiledExpression::Run(const Input &input, const std::vector<uint32_t> &rows, std::vector<uint32_t> *selection) {
+  for (const auto &step : steps_) {
+    step.kernel_(step, input, rows, &registers_);
+  }
+  const Register &result = registers_[result_];
+  const auto *bits = result.Data<uint64_t>();
+  selection->clear();
+  selection->reserve(rows.size());
+  for (size_t i = 0; i < BitmapWords(rows.size()); i++) {
+    // a null result keeps the row, as GetAs<bool>() of a null boolean is true
+    uint64_t keep = bits[i] | result.nulls_[i];
+    if (rows.size() - i * 64 < 64) {
+      keep &= (uint64_t{1} << (rows.size() - i * 64)) - 1;
+    }
+    for (; keep != 0; keep &= keep - 1) {
+      selection->push_back(rows[i * 64 + __builtin_ctzll(keep)]);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,332 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels.cpp
+//
+// Identification: src/execution/filter_kernels.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/filter_kernels.h"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BUSTUB_FILTER_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+template <typename T, ComparisonType OP>
+inline bool CompareValues(T lhs, T rhs) {
+  if constexpr (OP == ComparisonType::Equal) {
+    return lhs == rhs;
+  } else if constexpr (OP == ComparisonType::NotEqual) {
+    return lhs != rhs;
+  } else if constexpr (OP == ComparisonType::LessThan) {
+    return lhs < rhs;
+  } else if constexpr (OP == ComparisonType::LessThanOrEqual) {
+    return lhs <= rhs;
+  } else if constexpr (OP == ComparisonType::GreaterThan) {
+    return lhs > rhs;
+  } else {
+    return lhs >= rhs;
+  }
+}
+
+// sets the bits of the values from begin to n, one at a time into a word of the bitmap kept in a register
+template <typename T, ComparisonType OP>
+void ScalarTail(const T *lhs, const T *rhs, T constant, size_t begin, size_t n, uint64_t *bitmap) {
+  for (size_t i = begin; i < n;) {
+    size_t word = i / 64;
+    size_t end = std::min(n, (word + 1) * 64);
+    uint64_t bits = 0;
+    for (; i < end; i++) {
+      bits |= uint64_t{CompareValues<T, OP>(lhs[i], rhs == nullptr ? constant : rhs[i])} << (i % 64);
+    }
+    bitmap[word] |= bits;
+  }
+}
+
+template <typename T, ComparisonType OP>
+void ScalarKernel(const T *lhs, const T *rhs, T constant, size_t n, uint64_t *bitmap) {
+  std::fill(bitmap, bitmap + (n + 63) / 64, 0);
+  ScalarTail<T, OP>(lhs, rhs, constant, 0, n, bitmap);
+}
+
+#ifdef BUSTUB_FILTER_KERNELS_X86
+
+#define BUSTUB_TARGET_AVX2 __attribute__((target("avx2")))
+#define BUSTUB_TARGET_SSE42 __attribute__((target("sse4.2")))
+
+/*
+ * Avx2Lanes<T> and Sse42Lanes<T> wrap the vector instructions for values of
+ * type T: a vector holds WIDTH of them, and a comparison of two vectors
+ * returns one bit per value. WIDTH divides 64, so the bits of one vector never
+ * straddle two words of the bitmap. The integer instructions only have > and
+ * ==, >= and != are their complements within the WIDTH bits.
+ */
+template <typename T>
+struct Avx2Lanes;
+
+template <>
+struct Avx2Lanes<int8_t> {
+  using Vec = __m256i;
+  static constexpr size_t WIDTH = 32;
+  static constexpr uint32_t ALL = 0xFFFFFFFFU;
+  BUSTUB_TARGET_AVX2 static Vec Load(const int8_t *p) { return _mm256_loadu_si256(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_AVX2 static Vec Broadcast(int8_t value) { return _mm256_set1_epi8(value); }
+  BUSTUB_TARGET_AVX2 static uint32_t Mask(Vec cmp) { return static_cast<uint32_t>(_mm256_movemask_epi8(cmp)); }
+  BUSTUB_TARGET_AVX2 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm256_cmpgt_epi8(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_AVX2 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm256_cmpeq_epi8(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Avx2Lanes<int16_t> {
+  using Vec = __m256i;
+  static constexpr size_t WIDTH = 16;
+  static constexpr uint32_t ALL = 0xFFFFU;
+  BUSTUB_TARGET_AVX2 static Vec Load(const int16_t *p) { return _mm256_loadu_si256(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_AVX2 static Vec Broadcast(int16_t value) { return _mm256_set1_epi16(value); }
+  BUSTUB_TARGET_AVX2 static uint32_t Mask(Vec cmp) {
+    // packing narrows each 128-bit half separately, the bytes of the values are 0-7 and 16-23
+    auto bytes = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_packs_epi16(cmp, _mm256_setzero_si256())));
+    return (bytes & 0xFFU) | ((bytes >> 8) & 0xFF00U);
+  }
+  BUSTUB_TARGET_AVX2 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm256_cmpgt_epi16(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_AVX2 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm256_cmpeq_epi16(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Avx2Lanes<int32_t> {
+  using Vec = __m256i;
+  static constexpr size_t WIDTH = 8;
+  static constexpr uint32_t ALL = 0xFFU;
+  BUSTUB_TARGET_AVX2 static Vec Load(const int32_t *p) { return _mm256_loadu_si256(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_AVX2 static Vec Broadcast(int32_t value) { return _mm256_set1_epi32(value); }
+  BUSTUB_TARGET_AVX2 static uint32_t Mask(Vec cmp) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(cmp)));
+  }
+  BUSTUB_TARGET_AVX2 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm256_cmpgt_epi32(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_AVX2 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm256_cmpeq_epi32(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Avx2Lanes<int64_t> {
+  using Vec = __m256i;
+  static constexpr size_t WIDTH = 4;
+  static constexpr uint32_t ALL = 0xFU;
+  BUSTUB_TARGET_AVX2 static Vec Load(const int64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_AVX2 static Vec Broadcast(int64_t value) { return _mm256_set1_epi64x(value); }
+  BUSTUB_TARGET_AVX2 static uint32_t Mask(Vec cmp) {
+    return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(cmp)));
+  }
+  BUSTUB_TARGET_AVX2 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm256_cmpgt_epi64(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_AVX2 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm256_cmpeq_epi64(a, b)); }
+  BUSTUB_TARGET_AVX2 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+// the ordered predicates are false and != is true for NaN, as with the C++ operators
+template <>
+struct Avx2Lanes<double> {
+  using Vec = __m256d;
+  static constexpr size_t WIDTH = 4;
+  BUSTUB_TARGET_AVX2 static Vec Load(const double *p) { return _mm256_loadu_pd(p); }
+  BUSTUB_TARGET_AVX2 static Vec Broadcast(double value) { return _mm256_set1_pd(value); }
+  BUSTUB_TARGET_AVX2 static uint32_t Mask(Vec cmp) { return static_cast<uint32_t>(_mm256_movemask_pd(cmp)); }
+  BUSTUB_TARGET_AVX2 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+  BUSTUB_TARGET_AVX2 static uint32_t GreaterEqual(Vec a, Vec b) { return Mask(_mm256_cmp_pd(a, b, _CMP_GE_OQ)); }
+  BUSTUB_TARGET_AVX2 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm256_cmp_pd(a, b, _CMP_EQ_OQ)); }
+  BUSTUB_TARGET_AVX2 static uint32_t NotEqual(Vec a, Vec b) { return Mask(_mm256_cmp_pd(a, b, _CMP_NEQ_UQ)); }
+};
+
+template <typename T>
+struct Sse42Lanes;
+
+template <>
+struct Sse42Lanes<int8_t> {
+  using Vec = __m128i;
+  static constexpr size_t WIDTH = 16;
+  static constexpr uint32_t ALL = 0xFFFFU;
+  BUSTUB_TARGET_SSE42 static Vec Load(const int8_t *p) { return _mm_loadu_si128(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_SSE42 static Vec Broadcast(int8_t value) { return _mm_set1_epi8(value); }
+  BUSTUB_TARGET_SSE42 static uint32_t Mask(Vec cmp) { return static_cast<uint32_t>(_mm_movemask_epi8(cmp)); }
+  BUSTUB_TARGET_SSE42 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm_cmpgt_epi8(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_SSE42 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm_cmpeq_epi8(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Sse42Lanes<int16_t> {
+  using Vec = __m128i;
+  static constexpr size_t WIDTH = 8;
+  static constexpr uint32_t ALL = 0xFFU;
+  BUSTUB_TARGET_SSE42 static Vec Load(const int16_t *p) { return _mm_loadu_si128(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_SSE42 static Vec Broadcast(int16_t value) { return _mm_set1_epi16(value); }
+  BUSTUB_TARGET_SSE42 static uint32_t Mask(Vec cmp) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_packs_epi16(cmp, _mm_setzero_si128())));
+  }
+  BUSTUB_TARGET_SSE42 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm_cmpgt_epi16(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_SSE42 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm_cmpeq_epi16(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Sse42Lanes<int32_t> {
+  using Vec = __m128i;
+  static constexpr size_t WIDTH = 4;
+  static constexpr uint32_t ALL = 0xFU;
+  BUSTUB_TARGET_SSE42 static Vec Load(const int32_t *p) { return _mm_loadu_si128(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_SSE42 static Vec Broadcast(int32_t value) { return _mm_set1_epi32(value); }
+  BUSTUB_TARGET_SSE42 static uint32_t Mask(Vec cmp) {
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(cmp)));
+  }
+  BUSTUB_TARGET_SSE42 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm_cmpgt_epi32(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_SSE42 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm_cmpeq_epi32(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Sse42Lanes<int64_t> {
+  using Vec = __m128i;
+  static constexpr size_t WIDTH = 2;
+  static constexpr uint32_t ALL = 0x3U;
+  BUSTUB_TARGET_SSE42 static Vec Load(const int64_t *p) { return _mm_loadu_si128(reinterpret_cast<const Vec *>(p)); }
+  BUSTUB_TARGET_SSE42 static Vec Broadcast(int64_t value) { return _mm_set1_epi64x(value); }
+  BUSTUB_TARGET_SSE42 static uint32_t Mask(Vec cmp) {
+    return static_cast<uint32_t>(_mm_movemask_pd(_mm_castsi128_pd(cmp)));
+  }
+  BUSTUB_TARGET_SSE42 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm_cmpgt_epi64(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t GreaterEqual(Vec a, Vec b) { return ALL & ~Greater(b, a); }
+  BUSTUB_TARGET_SSE42 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm_cmpeq_epi64(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t NotEqual(Vec a, Vec b) { return ALL & ~Equal(a, b); }
+};
+
+template <>
+struct Sse42Lanes<double> {
+  using Vec = __m128d;
+  static constexpr size_t WIDTH = 2;
+  BUSTUB_TARGET_SSE42 static Vec Load(const double *p) { return _mm_loadu_pd(p); }
+  BUSTUB_TARGET_SSE42 static Vec Broadcast(double value) { return _mm_set1_pd(value); }
+  BUSTUB_TARGET_SSE42 static uint32_t Mask(Vec cmp) { return static_cast<uint32_t>(_mm_movemask_pd(cmp)); }
+  BUSTUB_TARGET_SSE42 static uint32_t Greater(Vec a, Vec b) { return Mask(_mm_cmpgt_pd(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t GreaterEqual(Vec a, Vec b) { return Mask(_mm_cmpge_pd(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t Equal(Vec a, Vec b) { return Mask(_mm_cmpeq_pd(a, b)); }
+  BUSTUB_TARGET_SSE42 static uint32_t NotEqual(Vec a, Vec b) { return Mask(_mm_cmpneq_pd(a, b)); }
+};
+
+/*
+ * The kernel of one instruction set: whole vectors of values, then the rest
+ * one at a time. It is defined once per instruction set since the target
+ * attribute, which lets the compiler inline the intrinsics, cannot be a
+ * template argument.
+ */
+#define BUSTUB_DEFINE_SIMD_KERNEL(NAME, TARGET)                                                      \
+  template <typename T, ComparisonType OP, typename Lanes>                                           \
+  TARGET void NAME(const T *lhs, const T *rhs, T constant, size_t n, uint64_t *bitmap) {             \
+    using Vec = typename Lanes::Vec;                                                                 \
+    std::fill(bitmap, bitmap + (n + 63) / 64, 0);                                                    \
+    const Vec broadcast = Lanes::Broadcast(constant);                                                \
+    size_t i = 0;                                                                                    \
+    for (; i + Lanes::WIDTH <= n; i += Lanes::WIDTH) {                                               \
+      Vec left = Lanes::Load(lhs + i);                                                               \
+      Vec right = rhs == nullptr ? broadcast : Lanes::Load(rhs + i);                                 \
+      uint32_t mask;                                                                                 \
+      if constexpr (OP == ComparisonType::Equal) {                                                   \
+        mask = Lanes::Equal(left, right);                                                            \
+      } else if constexpr (OP == ComparisonType::NotEqual) {                                         \
+        mask = Lanes::NotEqual(left, right);                                                         \
+      } else if constexpr (OP == ComparisonType::LessThan) {                                         \
+        mask = Lanes::Greater(right, left);                                                          \
+      } else if constexpr (OP == ComparisonType::LessThanOrEqual) {                                  \
+        mask = Lanes::GreaterEqual(right, left);                                                     \
+      } else if constexpr (OP == ComparisonType::GreaterThan) {                                      \
+        mask = Lanes::Greater(left, right);                                                          \
+      } else {                                                                                       \
+        mask = Lanes::GreaterEqual(left, right);                                                     \
+      }                                                                                              \
+      bitmap[i / 64] |= uint64_t{mask} << (i % 64);                                                  \
+    }                                                                                                \
+    ScalarTail<T, OP>(lhs, rhs, constant, i, n, bitmap);                                             \
+  }
+
+BUSTUB_DEFINE_SIMD_KERNEL(Avx2Kernel, BUSTUB_TARGET_AVX2)
+BUSTUB_DEFINE_SIMD_KERNEL(Sse42Kernel, BUSTUB_TARGET_SSE42)
+
+#endif
+
+template <typename T, ComparisonType OP>
+FilterKernel<T> KernelFor(SimdLevel level) {
+#ifdef BUSTUB_FILTER_KERNELS_X86
+  if (level == SimdLevel::AVX2) {
+    return &Avx2Kernel<T, OP, Avx2Lanes<T>>;
+  }
+  if (level == SimdLevel::SSE42) {
+    return &Sse42Kernel<T, OP, Sse42Lanes<T>>;
+  }
+#endif
+  return &ScalarKernel<T, OP>;
+}
+
+}  // namespace
+
+SimdLevel DetectSimdLevel() {
+#ifdef BUSTUB_FILTER_KERNELS_X86
+  static const SimdLevel level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+      return SimdLevel::SSE42;
+    }
+    return SimdLevel::SCALAR;
+  }();
+  return level;
+#else
+  return SimdLevel::SCALAR;
+#endif
+}
+
+template <typename T>
+FilterKernel<T> GetFilterKernel(ComparisonType op, SimdLevel level) {
+  level = std::min(level, DetectSimdLevel());
+  switch (op) {
+    case ComparisonType::Equal:
+      return KernelFor<T, ComparisonType::Equal>(level);
+    case ComparisonType::NotEqual:
+      return KernelFor<T, ComparisonType::NotEqual>(level);
+    case ComparisonType::LessThan:
+      return KernelFor<T, ComparisonType::LessThan>(level);
+    case ComparisonType::LessThanOrEqual:
+      return KernelFor<T, ComparisonType::LessThanOrEqual>(level);
+    case ComparisonType::GreaterThan:
+      return KernelFor<T, ComparisonType::GreaterThan>(level);
+    case ComparisonType::GreaterThanOrEqual:
+      return KernelFor<T, ComparisonType::GreaterThanOrEqual>(level);
+  }
+  return nullptr;
+}
+
+template FilterKernel<int8_t> GetFilterKernel<int8_t>(ComparisonType op, SimdLevel level);
+template FilterKernel<int16_t> GetFilterKernel<int16_t>(ComparisonType op, SimdLevel level);
+template FilterKernel<int32_t> GetFilterKernel<int32_t>(ComparisonType op, SimdLevel level);
+template FilterKernel<int64_t> GetFilterKernel<int64_t>(ComparisonType op, SimdLevel level);
+template FilterKernel<double> GetFilterKernel<double>(ComparisonType op, SimdLevel level);
+
+}  // namespace bustub
@@ -11,33 +11,175 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+
+#include "common/exception.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx),plan_(plan),table_name_(exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())->table_name_){
-}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_name_(exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())->table_name_) {}
 
 void IndexScanExecutor::Init() {
-  if (plan_->GetPredicate()!= nullptr){
-    iter=(reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>*>
-     (exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())->index_.get()))
-               ->GetBeginIterator(plan_->GetPredicate()->Evaluate(nullptr, nullptr).GetAs<GenericKey<8>>());
-  }else{
-    iter=(reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>*>
-            (exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())->index_.get()))->GetBeginIterator();
-  }
-  end=(reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>*>
-         (exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())->index_.get()))->GetEndIterator();
+  IndexInfo *index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  // the scan reads the index through the iterator of a B+ tree of 8 byte keys, no other index has one
+  IndexType index_type = index_info->index_type_;
+  if ((index_type != IndexType::B_PLUS_TREE && index_type != IndexType::BUFFERED_B_PLUS_TREE) ||
+      index_info->key_size_ != 8) {
+    throw NotImplementedException("index scans only support B+ tree indexes with 8 byte keys");
+  }
+  auto *index = reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info->index_.get());
+  // the bounds go into the iterator, which stops at the end of the range instead of running to the last leaf
+  IndexKeyRange<GenericKey<8>> range;
+  if (!plan_->GetLowerBound().empty()) {
+    range.SetLower(MakeKey(plan_->GetLowerBound(), &index_info->key_schema_), plan_->IsLowerInclusive());
+  }
+  if (!plan_->GetUpperBound().empty()) {
+    range.SetUpper(MakeKey(plan_->GetUpperBound(), &index_info->key_schema_), plan_->IsUpperInclusive());
+  }
+  StopWorkers();
+  end = index->GetEndIterator();
+  if (plan_->GetParallelism() <= 1) {
+    iter = index->GetRangeIterator(range, plan_->IsReverse());
+    return;
+  }
+
+  // the sub-ranges are scanned concurrently, and Next() returns them one after the other
+  std::vector<IndexKeyRange<GenericKey<8>>> ranges = index->PartitionRange(range, plan_->GetParallelism());
+  if (plan_->IsReverse()) {
+    std::reverse(ranges.begin(), ranges.end());
+  }
+  stop_ = false;
+  partition_index_ = 0;
+  for (const auto &sub_range : ranges) {
+    partitions_.push_back(std::make_unique<Partition>());
+    workers_.push_back(std::async(std::launch::async, &IndexScanExecutor::ScanPartition, this, sub_range,
+                                  partitions_.back().get()));
+  }
+}
+
+void IndexScanExecutor::ScanPartition(const IndexKeyRange<GenericKey<8>> &range, Partition *partition) {
+  IndexInfo *index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  auto *index = reinterpret_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info->index_.get());
+  TableHeap *table = exec_ctx_->GetCatalog()->GetTable(table_name_)->table_.get();
+  try {
+    for (auto it = index->GetRangeIterator(range, plan_->IsReverse()); it != end && !stop_; ++it) {
+      RID rid = (*it).second;
+      Tuple tuple;
+      if (!FetchTuple(table, rid, &tuple)) {
+        continue;
+      }
+      if (plan_->GetPredicate() != nullptr &&
+          !plan_->GetPredicate()->Evaluate(&tuple, plan_->OutputSchema()).GetAs<bool>()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> guard(partition->latch_);
+      partition->cv_.wait(guard, [&] { return partition->rows_.size() < PARTITION_QUEUE_SIZE || stop_; });
+      if (stop_) {
+        break;
+      }
+      partition->rows_.emplace_back(rid, tuple);
+      guard.unlock();
+      partition->cv_.notify_all();
+    }
+  } catch (...) {
+    // Next() finds the exception in the future of the worker once the partition is done
+    std::lock_guard<std::mutex> guard(partition->latch_);
+    partition->done_ = true;
+    partition->cv_.notify_all();
+    throw;
+  }
+  std::lock_guard<std::mutex> guard(partition->latch_);
+  partition->done_ = true;
+  partition->cv_.notify_all();
+}
+
+bool IndexScanExecutor::FetchTuple(TableHeap *table, const RID &rid, Tuple *tuple) {
+  if (!enable_logging) {
+    return table->GetTuple(rid, tuple, exec_ctx_->GetTransaction());
+  }
+  // with logging on the tuple is read under a shared lock, which is taken here rather than in TablePage::GetTuple
+  // so that only locking excludes the other workers
+  Transaction *txn = exec_ctx_->GetTransaction();
+  txn_latch_.WLock();
+  try {
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) &&
+        !exec_ctx_->GetLockManager()->LockShared(txn, rid)) {
+      txn_latch_.WUnlock();
+      return false;
+    }
+  } catch (...) {
+    txn_latch_.WUnlock();
+    throw;
+  }
+  txn_latch_.WUnlock();
+  txn_latch_.RLock();
+  bool found = table->GetTuple(rid, tuple, txn);
+  txn_latch_.RUnlock();
+  return found;
+}
+
+bool IndexScanExecutor::NextFromPartitions(Tuple *tuple, RID *rid) {
+  while (partition_index_ < partitions_.size()) {
+    Partition *partition = partitions_[partition_index_].get();
+    std::unique_lock<std::mutex> guard(partition->latch_);
+    partition->cv_.wait(guard, [&] { return !partition->rows_.empty() || partition->done_; });
+    if (!partition->rows_.empty()) {
+      *rid = partition->rows_.front().first;
+      *tuple = partition->rows_.front().second;
+      partition->rows_.pop_front();
+      guard.unlock();
+      partition->cv_.notify_all();
+      return true;
+    }
+    guard.unlock();
+    // rethrows what ended the worker early
+    workers_[partition_index_].get();
+    partition_index_++;
+  }
+  return false;
+}
+
+void IndexScanExecutor::StopWorkers() {
+  stop_ = true;
+  for (auto &partition : partitions_) {
+    std::lock_guard<std::mutex> guard(partition->latch_);
+    partition->cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    if (worker.valid()) {
+      worker.wait();
+    }
+  }
+  workers_.clear();
+  partitions_.clear();
+}
+
+GenericKey<8> IndexScanExecutor::MakeKey(const std::vector<const AbstractExpression *> &bound, Schema *key_schema) {
+  std::vector<Value> values;
+  for (const auto *expr : bound) {
+    values.push_back(expr->Evaluate(nullptr, nullptr));
+  }
+  GenericKey<8> key;
+  key.SetFromKey(Tuple(values, key_schema));
+  return key;
 }
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
-  if (iter==end){
-    return false;
-  }
-  auto pair=*iter;
-  ++iter;
-  *rid=pair.second;
-  exec_ctx_->GetCatalog()->GetTable(table_name_)->table_.get()->GetTuple(*rid,tuple,exec_ctx_->GetTransaction());
-  return true;
+  if (plan_->GetParallelism() > 1) {
+    return NextFromPartitions(tuple, rid);
+  }
+  while (iter != end) {
+    *rid = (*iter).second;
+    ++iter;
+    exec_ctx_->GetCatalog()->GetTable(table_name_)->table_.get()->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
+    if (plan_->GetPredicate() == nullptr ||
+        plan_->GetPredicate()->Evaluate(tuple, plan_->OutputSchema()).GetAs<bool>()) {
+      return true;
+    }
+  }
+  return false;
 }
 
 }  // namespace bustub
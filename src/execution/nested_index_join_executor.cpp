@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/nested_index_join_executor.h"
+
 #include <execution/executor_factory.h>
 #include <execution/executors/index_scan_executor.h>
 
@@ -22,33 +23,67 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
       plan_(plan),
       table_name(exec_ctx_->GetCatalog()->GetTable(plan_->GetInnerTableOid())->name_),
       child_executor_(std::move(child_executor)),
-      index_info(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexName(), table_name)) {}
+      index_info(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexName(), table_name)),
+      outer_batch_(plan->GetBatchSize()) {}
 
-void NestIndexJoinExecutor::Init() { child_executor_->Init(); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  ResetNextFromBatch();
+  left_tuples_.clear();
+  matches_.clear();
+  left_index_ = 0;
+  match_index_ = 0;
+}
 
-bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  Tuple left_tuple;
-  RID left_rid;
+bool NestIndexJoinExecutor::NextOuterBatch() {
+  left_tuples_.clear();
+  if (!child_executor_->NextBatch(&outer_batch_)) {
+    return false;
+  }
+  // the outer tuples are read with the outer table schema, as the child's tuples
+  for (uint32_t row : outer_batch_.Selection()) {
+    left_tuples_.push_back(outer_batch_.RowTuple(row));
+  }
+  std::vector<Tuple> index_tuples;
+  index_tuples.reserve(left_tuples_.size());
+  for (auto &left : left_tuples_) {
+    index_tuples.push_back(
+        left.KeyFromTuple(*plan_->OuterTableSchema(), index_info->key_schema_, index_info->index_->GetKeyAttrs()));
+  }
+  // the index sorts the keys of the batch and walks them left to right
+  index_info->index_->ScanKeys(index_tuples, &matches_, exec_ctx_->GetTransaction());
+  left_index_ = 0;
+  match_index_ = 0;
+  return true;
+}
+
+bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
+
+bool NestIndexJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
   Tuple right_tuple;
-  RID right_rid;
   std::vector<Value> join_value(GetOutputSchema()->GetColumnCount());
-  while (child_executor_->Next(&left_tuple, &left_rid)) {
-
-    Tuple index_tuple = left_tuple.KeyFromTuple(*plan_->OuterTableSchema(), index_info->key_schema_,index_info->index_->GetKeyAttrs());
-    std::vector<RID> result;
-    index_info->index_->ScanKey(index_tuple,&result,exec_ctx_->GetTransaction());
-    if (result.size()!=0){
-      exec_ctx_->GetCatalog()->GetTable(table_name)->table_->GetTuple(result[0],&right_tuple,exec_ctx_->GetTransaction());
-      for (uint32_t i = 0; i < GetOutputSchema()->GetColumnCount(); ++i) {
-        Value value=GetOutputSchema()->GetColumn(i).GetExpr()->EvaluateJoin(&left_tuple,plan_->OuterTableSchema(),&right_tuple,plan_->InnerTableSchema());
-        join_value[i]=value;
+  TableHeap *inner_table = exec_ctx_->GetCatalog()->GetTable(table_name)->table_.get();
+  while (!batch->IsFull()) {
+    // every inner tuple with the outer key joins, not only the first one
+    if (left_index_ == left_tuples_.size() || match_index_ == matches_[left_index_].size()) {
+      if (left_index_ < left_tuples_.size()) {
+        left_index_++;
+        match_index_ = 0;
+      } else if (!NextOuterBatch()) {
+        break;
       }
-      Tuple join_tuple=Tuple(join_value,GetOutputSchema());
-      *tuple=join_tuple;
-      return true;
+      continue;
+    }
+    Tuple &left_tuple = left_tuples_[left_index_];
+    inner_table->GetTuple(matches_[left_index_][match_index_++], &right_tuple, exec_ctx_->GetTransaction());
+    for (uint32_t i = 0; i < GetOutputSchema()->GetColumnCount(); ++i) {
+      join_value[i] = GetOutputSchema()->GetColumn(i).GetExpr()->EvaluateJoin(&left_tuple, plan_->OuterTableSchema(),
+                                                                             &right_tuple, plan_->InnerTableSchema());
     }
+    batch->AppendRow(join_value, RID());
   }
-  return false;
+  return batch->SelectedCount() > 0;
 }
 
 }  // namespace bustub
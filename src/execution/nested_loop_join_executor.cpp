@@ -18,7 +18,8 @@ namespace bustub {
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx),plan_(plan),left_executor_(std::move(left_executor)),right_executor_(std::move(right_executor)) {}
+    : AbstractExecutor(exec_ctx),plan_(plan),left_executor_(std::move(left_executor)),right_executor_(std::move(right_executor)),
+      left_batch_(exec_ctx->GetBatchSize()) {}
 
 void NestedLoopJoinExecutor::Init() {
   LOG_INFO("LEFT INIT START");
@@ -27,38 +28,75 @@ void NestedLoopJoinExecutor::Init() {
   LOG_INFO("RIGHT INIT START");
   right_executor_->Init();
   LOG_INFO("RIGHT INIT END");
+  ResetNextFromBatch();
+  right_batches_.clear();
+  right_read_ = false;
+  left_batch_.SetSelection({});
+  left_pos_ = 0;
+  right_index_ = 0;
+  matches_.clear();
+  match_pos_ = 0;
 }
 
-bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) {
+bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
 
-  Tuple left_tuple;
-  RID left_rid;
-  Tuple right_tuple;
-  RID right_rid;
-  std::vector<Value> res(GetOutputSchema()->GetColumnCount());
-  
-  Value ok(BOOLEAN,0);
-  while (left_executor_->Next(&left_tuple,&left_rid)){
-    LOG_INFO("HERE444");
-    while (right_executor_->Next(&right_tuple,&right_rid)){
-      LOG_INFO("HERE333");
-      ok=plan_->Predicate()->EvaluateJoin(&left_tuple,plan_->GetLeftPlan()->OutputSchema(),&right_tuple,plan_->GetRightPlan()->OutputSchema());
-      if (ok.GetAs<bool>()){
-        for (uint32_t i = 0; i < GetOutputSchema()->GetColumnCount(); ++i) {
-          Value value=GetOutputSchema()->GetColumn(i).GetExpr()->EvaluateJoin(&left_tuple,plan_->GetLeftPlan()->OutputSchema(),&right_tuple,plan_->GetRightPlan()->OutputSchema());
-          res[i]=value;
-        }
+bool NestedLoopJoinExecutor::NextBatch(TupleBatch *batch) {
+  if (!right_read_) {
+    right_batches_.emplace_back(exec_ctx_->GetBatchSize());
+    while (right_executor_->NextBatch(&right_batches_.back())) {
+      right_batches_.emplace_back(exec_ctx_->GetBatchSize());
+    }
+    right_batches_.pop_back();
+    right_read_ = true;
+  }
 
-        Tuple join_tuple(res,GetOutputSchema());
-        *tuple=join_tuple;
-        return true;
+  const Schema *output_schema = GetOutputSchema();
+  batch->Reset(output_schema);
+  join_values_.resize(output_schema->GetColumnCount());
+  std::vector<Value> row_values(output_schema->GetColumnCount());
+  while (!batch->IsFull()) {
+    if (match_pos_ < matches_.size()) {
+      uint32_t row = matches_[match_pos_++];
+      for (uint32_t i = 0; i < output_schema->GetColumnCount(); ++i) {
+        row_values[i] = join_values_[i][row];
+      }
+      batch->AppendRow(row_values, RID());
+      continue;
+    }
+    if (left_pos_ < left_batch_.SelectedCount() && right_index_ < right_batches_.size()) {
+      // join the left row with the next right batch, the output columns of all matches at once
+      uint32_t left_row = left_batch_.Selection()[left_pos_];
+      const TupleBatch &right = right_batches_[right_index_++];
+      matches_.clear();
+      match_pos_ = 0;
+      if (plan_->Predicate() == nullptr) {
+        matches_ = right.Selection();
+      } else {
+        plan_->Predicate()->EvaluateJoinBatch(left_batch_, left_row, right, right.Selection(), &predicate_result_);
+        for (uint32_t row : right.Selection()) {
+          if (predicate_result_[row].GetAs<bool>()) {
+            matches_.push_back(row);
+          }
+        }
+      }
+      for (uint32_t i = 0; i < output_schema->GetColumnCount(); ++i) {
+        output_schema->GetColumn(i).GetExpr()->EvaluateJoinBatch(left_batch_, left_row, right, matches_,
+                                                                 &join_values_[i]);
       }
+      continue;
+    }
+    if (left_pos_ < left_batch_.SelectedCount()) {
+      left_pos_++;
+      right_index_ = 0;
+      continue;
     }
-    right_executor_->Init();
+    if (!left_executor_->NextBatch(&left_batch_)) {
+      break;
+    }
+    left_pos_ = 0;
+    right_index_ = 0;
   }
-  
-  return false;
-
+  return batch->SelectedCount() > 0;
 }
 
 }  // namespace bustub
@@ -9,6 +9,9 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <utility>
+#include <vector>
+
 #include "execution/executors/seq_scan_executor.h"
 
 namespace bustub {
@@ -17,36 +20,56 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
     : AbstractExecutor(exec_ctx), plan_(plan) {}
 
 void SeqScanExecutor::Init() {
-  LOG_INFO("ITER INIT");
-  iter = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_->Begin(exec_ctx_->GetTransaction());
-  LOG_INFO("END INIT");
-  end = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())->table_->End();
+  TableMetadata *table_info = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  table_heap_ = table_info->table_.get();
+  cursor_.Set(table_heap_->GetFirstPageId(), 0);
+  table_schema_ = &table_info->schema_;
+  compiled_predicate_ = CompiledExpression::Compile(plan_->GetPredicate(), table_schema_);
+  ResetNextFromBatch();
 }
 
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
-  LOG_INFO("child find next");
-  if (iter == end) {
-    LOG_INFO("iter=end");
-    return false;
-  }
-  Value ok(BOOLEAN, 1);
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) { return NextFromBatch(tuple, rid); }
 
+bool SeqScanExecutor::NextBatch(TupleBatch *batch) {
+  Transaction *txn = GetExecutorContext()->GetTransaction();
+  // the tuples of one page, still under its latch: the compiled predicate picks the ones copied into the batch
+  auto filter_page = [this, batch](const std::vector<Tuple> &tuples) {
+    page_selection_.resize(tuples.size());
+    for (uint32_t i = 0; i < tuples.size(); i++) {
+      page_selection_[i] = i;
+    }
+    if (compiled_predicate_ != nullptr) {
+      compiled_predicate_->FilterTuples(tuples, &page_selection_);
+    }
+    for (uint32_t i : page_selection_) {
+      batch->AppendTuple(tuples[i], tuples[i].GetRid());
+    }
+  };
+  // a batch without a row that passes the predicate is not handed out, the scan goes on
   do {
-    if (GetExecutorContext()->GetTransaction()->GetIsolationLevel()!=IsolationLevel::READ_UNCOMMITTED){
-      TryShardLock(iter->GetRid());
+    batch->Reset(table_schema_);
+    while (!batch->IsFull() &&
+           table_heap_->ScanInPlace(&cursor_, batch->GetCapacity() - batch->Size(), filter_page, txn)) {
     }
-    *tuple = *iter++;
-
-    if (plan_->GetPredicate() != nullptr) {
-      ok = plan_->GetPredicate()->Evaluate(tuple, plan_->OutputSchema());
+    if (compiled_predicate_ == nullptr && plan_->GetPredicate() != nullptr && batch->Size() > 0) {
+      plan_->GetPredicate()->EvaluateBatch(*batch, batch->Selection(), &predicate_result_);
+      std::vector<uint32_t> selection;
+      selection.reserve(batch->Size());
+      for (uint32_t row : batch->Selection()) {
+        if (predicate_result_[row].GetAs<bool>()) {
+          selection.push_back(row);
+        }
+      }
+      batch->SetSelection(std::move(selection));
     }
-
-  } while (!ok.GetAs<bool>() && iter != end);
-  if (ok.GetAs<bool>()) {
-    *rid = tuple->GetRid();
-  }
-
-  return ok.GetAs<bool>();
+    // the rows are locked once their page is unlatched, a lock request may wait
+    if (txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
+      for (uint32_t row : batch->Selection()) {
+        TryShardLock(batch->GetRid(row));
+      }
+    }
+  } while (batch->SelectedCount() == 0 && cursor_.GetPageId() != INVALID_PAGE_ID);
+  return batch->SelectedCount() > 0;
 }
 
 }  // namespace bustub
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include "execution/tuple_batch.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  // the column vectors keep their memory from one batch to the next
+  columns_.resize(schema->GetColumnCount());
+  for (auto &column : columns_) {
+    column.clear();
+    column.reserve(capacity_);
+  }
+  tuple_data_.clear();
+  tuple_offsets_.clear();
+  rids_.clear();
+  selection_.clear();
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, const RID &rid) {
+  BUSTUB_ASSERT(tuple_offsets_.size() == rids_.size(), "a batch of tuples cannot have rows of values");
+  tuple_offsets_.push_back(static_cast<uint32_t>(tuple_data_.size()));
+  tuple_data_.insert(tuple_data_.end(), tuple.GetData(), tuple.GetData() + tuple.GetLength());
+  selection_.push_back(static_cast<uint32_t>(rids_.size()));
+  rids_.push_back(rid);
+}
+
+void TupleBatch::AppendRow(const std::vector<Value> &values, const RID &rid) {
+  BUSTUB_ASSERT(tuple_offsets_.empty(), "a batch of values cannot have rows of tuples");
+  for (uint32_t i = 0; i < columns_.size(); i++) {
+    columns_[i].push_back(values[i]);
+  }
+  selection_.push_back(static_cast<uint32_t>(rids_.size()));
+  rids_.push_back(rid);
+}
+
+void TupleBatch::ReadColumn(uint32_t col_idx) const {
+  std::vector<Value> &column = columns_[col_idx];
+  // a tuple that points into tuple_data_ and does not own it
+  Tuple tuple;
+  for (size_t row = column.size(); row < tuple_offsets_.size(); row++) {
+    tuple.data_ = const_cast<char *>(tuple_data_.data()) + tuple_offsets_[row];
+    column.push_back(tuple.GetValue(schema_, col_idx));
+  }
+}
+
+Tuple TupleBatch::RowTuple(uint32_t row) const {
+  if (row < tuple_offsets_.size()) {
+    size_t end = row + 1 < tuple_offsets_.size() ? tuple_offsets_[row + 1] : tuple_data_.size();
+    Tuple tuple(rids_[row]);
+    tuple.allocated_ = true;
+    tuple.size_ = end - tuple_offsets_[row];
+    tuple.data_ = new char[tuple.size_];
+    memcpy(tuple.data_, tuple_data_.data() + tuple_offsets_[row], tuple.size_);
+    return tuple;
+  }
+  std::vector<Value> values;
+  values.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values.push_back(column[row]);
+  }
+  Tuple tuple(values, schema_);
+  tuple.SetRid(rids_[row]);
+  return tuple;
+}
+
+}  // namespace bustub
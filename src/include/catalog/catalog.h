@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -8,8 +11,12 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "storage/index/art_index.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/buffered_b_plus_tree_index.h"
 #include "storage/index/index.h"
+#include "storage/index/varlen_b_plus_tree_index.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -33,40 +40,77 @@ struct TableMetadata {
   table_oid_t oid_;
 };
 
+/**
+ * The kinds of index the catalog builds.
+ * B_PLUS_TREE: BPlusTreeIndex over fixed-width GenericKeys, longer keys are truncated
+ * VARLEN_B_PLUS_TREE: VarlenBPlusTreeIndex over whole keys of any width
+ * BUFFERED_B_PLUS_TREE: BufferedBPlusTreeIndex, a B_PLUS_TREE that buffers inserts and deletes for insert-heavy tables
+ * ART: ArtIndex, an in-memory adaptive radix tree over whole keys for fast point lookups
+ */
+enum class IndexType { B_PLUS_TREE = 0, VARLEN_B_PLUS_TREE, BUFFERED_B_PLUS_TREE, ART };
+
 /**
  * Metadata about a index
  */
 struct IndexInfo {
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::B_PLUS_TREE,
+            bool unique_keys = true)
       : key_schema_(std::move(key_schema)),
         name_(std::move(name)),
         index_(std::move(index)),
         index_oid_(index_oid),
         table_name_(std::move(table_name)),
-        key_size_(key_size) {}
+        key_size_(key_size),
+        index_type_(index_type),
+        unique_keys_(unique_keys) {}
   Schema key_schema_;
   std::string name_;
   std::unique_ptr<Index> index_;
   index_oid_t index_oid_;
   std::string table_name_;
+  // width of the GenericKey, 0 for variable-length keys
   const size_t key_size_;
+  const IndexType index_type_;
+  // false if a B+ tree index keeps a posting list of every rid of a key
+  const bool unique_keys_;
 };
 
 /**
- * Catalog is a non-persistent catalog that is designed for the executor to use.
+ * Catalog is a catalog that is designed for the executor to use.
  * It handles table creation and table lookup.
+ *
+ * A persistent catalog also writes the metadata of its tables and indexes to a
+ * chain of catalog pages whenever a table or an index is created, and records
+ * the first page in the header page. A persistent catalog opened on the same
+ * database file later reads them back: tables are reopened at their first
+ * page and indexes at the root the header page keeps for them, so neither is
+ * scanned or rebuilt.
+ *
+ * Catalog page format (size in byte):
+ *  -------------------------------------------------
+ * | NextPageId (4) | Size (4) | Metadata bytes ... |
+ *  -------------------------------------------------
  */
 class Catalog {
  public:
+  /** name of the header page record pointing to the first catalog page */
+  static constexpr const char *CATALOG_RECORD_NAME = "__catalog";
+
   /**
    * Creates a new catalog object.
    * @param bpm the buffer pool manager backing tables created by this catalog
    * @param lock_manager the lock manager in use by the system
    * @param log_manager the log manager in use by the system
+   * @param persistent whether the catalog keeps its metadata in the database file, which then needs the header page.
+   * The tables and indexes an earlier persistent catalog of the database created are reopened.
    */
-  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager)
-      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
+  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager, bool persistent = false)
+      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager}, persistent_{persistent} {
+    if (persistent_) {
+      Load();
+    }
+  }
 
   /**
    * Create a new table and return its metadata.
@@ -84,6 +128,9 @@ class Catalog {
         new TableMetadata(schema, table_name, std::move(table_heap), this_table_index));
     names_[table_name] = this_table_index;
     tables_[this_table_index] = std::move(table_metadata);
+    if (persistent_) {
+      Persist();
+    }
     return tables_[this_table_index].get();
   }
 
@@ -105,6 +152,7 @@ class Catalog {
 
   /**
    * Create a new index, populate existing data of the table and return its metadata.
+   * The existing tuples are sorted by key and bulk loaded into the tree instead of being inserted one at a time.
    * @param txn the transaction in which the table is being created
    * @param index_name the name of the new index
    * @param table_name the name of the table
@@ -112,46 +160,141 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param fill_factor how full bulk loading packs the index pages
+   * @param index_type B_PLUS_TREE or BUFFERED_B_PLUS_TREE
+   * @param unique_keys false to keep every rid of a key in a posting list instead of only the first one
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
+                         size_t keysize, double fill_factor = DEFAULT_FILL_FACTOR,
+                         IndexType index_type = IndexType::B_PLUS_TREE, bool unique_keys = true) {
     if (names_.count(table_name)==0){
       throw "table cannot found";
     }
 
     index_oid_t iot = ++next_index_oid_;
 
-    IndexMetadata *index_metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs);
+    IndexMetadata *index_metadata =
+        new IndexMetadata(index_name, table_name, &schema, key_attrs, IndexRecordName(iot));
 
-    std::unique_ptr<Index> index(new BPlusTreeIndex<KeyType, ValueType, KeyComparator>(index_metadata, bpm_));
+    auto *tree_index = NewTreeIndex<KeyType, ValueType, KeyComparator>(index_metadata, index_type, unique_keys);
+    std::unique_ptr<Index> index(tree_index);
 
-    //add entry into index
+    // sort the keys of every existing tuple and build the tree bottom-up
+    ExternalMergeSort<KeyType, ValueType, KeyComparator> sorter{KeyComparator(index_metadata->GetKeySchema())};
+    TableHeap *table = tables_[names_[table_name]]->table_.get();
+    for (auto iter = table->Begin(txn); iter != table->End(); ++iter) {
+      KeyType index_key;
+      index_key.SetFromKey(iter->KeyFromTuple(schema, key_schema, key_attrs));
+      sorter.Add(index_key, iter->GetRid());
+    }
+    tree_index->BulkLoad(&sorter, fill_factor);
 
+    std::unique_ptr<IndexInfo> index_info(
+        new IndexInfo(key_schema, index_name, std::move(index), iot, table_name, keysize, index_type, unique_keys));
 
-    auto begin=tables_[names_[table_name]].get()->table_->Begin(txn);
-    auto end=tables_[names_[table_name]].get()->table_->End();
-    while(begin!=end){
-      Tuple tuple=*begin;
-      Tuple index_tuple=tuple.KeyFromTuple(schema,key_schema,key_attrs);
-      LOG_INFO("tuple %s",index_tuple.ToString(&schema).c_str());
-      begin++;
-      index->InsertEntry(index_tuple,tuple.GetRid(),txn);
+    indexes_[iot] = std::move(index_info);
+    index_names_[table_name][index_name] = iot;
+    if (persistent_) {
+      Persist();
+    }
+
+    return indexes_[iot].get();
+  }
 
+  /**
+   * Create a new index of the given type, populate existing data of the table and return its metadata. A
+   * B_PLUS_TREE or BUFFERED_B_PLUS_TREE index gets the narrowest GenericKey that holds the key. A GenericKey would cut
+   * VARCHAR columns off at its width, keys with one need a VARLEN_B_PLUS_TREE index.
+   * @param txn the transaction in which the table is being created
+   * @param index_name the name of the new index
+   * @param table_name the name of the table
+   * @param schema the schema of the table
+   * @param key_schema the schema of the key
+   * @param key_attrs key attributes
+   * @param index_type the kind of index
+   * @param unique_keys false to keep a posting list of every rid of a key, B_PLUS_TREE and BUFFERED_B_PLUS_TREE only
+   * @return a pointer to the metadata of the new index
+   */
+  IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                         const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                         IndexType index_type, bool unique_keys = true) {
+    if (index_type == IndexType::B_PLUS_TREE || index_type == IndexType::BUFFERED_B_PLUS_TREE) {
+      if (!key_schema.IsInlined()) {
+        throw NotImplementedException("VARCHAR keys need a VARLEN_B_PLUS_TREE index");
+      }
+      uint32_t key_size = key_schema.GetLength();
+      if (key_size <= 4) {
+        return CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(txn, index_name, table_name, schema, key_schema,
+                                                                     key_attrs, 4, DEFAULT_FILL_FACTOR, index_type,
+                                                                     unique_keys);
+      }
+      if (key_size <= 8) {
+        return CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, index_name, table_name, schema, key_schema,
+                                                                     key_attrs, 8, DEFAULT_FILL_FACTOR, index_type,
+                                                                     unique_keys);
+      }
+      if (key_size <= 16) {
+        return CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(txn, index_name, table_name, schema,
+                                                                       key_schema, key_attrs, 16, DEFAULT_FILL_FACTOR,
+                                                                       index_type, unique_keys);
+      }
+      if (key_size <= 32) {
+        return CreateIndex<GenericKey<32>, RID, GenericComparator<32>>(txn, index_name, table_name, schema,
+                                                                       key_schema, key_attrs, 32, DEFAULT_FILL_FACTOR,
+                                                                       index_type, unique_keys);
+      }
+      if (key_size <= 64) {
+        return CreateIndex<GenericKey<64>, RID, GenericComparator<64>>(txn, index_name, table_name, schema,
+                                                                       key_schema, key_attrs, 64, DEFAULT_FILL_FACTOR,
+                                                                       index_type, unique_keys);
+      }
+      throw Exception(ExceptionType::OUT_OF_RANGE, "key is too wide for a B_PLUS_TREE index");
     }
 
+    if (names_.count(table_name) == 0) {
+      throw "table cannot found";
+    }
+    index_oid_t iot = ++next_index_oid_;
+    IndexMetadata *index_metadata =
+        new IndexMetadata(index_name, table_name, &schema, key_attrs, IndexRecordName(iot));
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::ART) {
+      index = std::make_unique<ArtIndex>(index_metadata);
+    } else {
+      index = std::make_unique<VarlenBPlusTreeIndex>(index_metadata, bpm_);
+    }
+    PopulateIndex(index.get(), txn);
 
     std::unique_ptr<IndexInfo> index_info(
-        new IndexInfo(key_schema, index_name, std::move(index), iot, table_name, keysize));
-
+        new IndexInfo(key_schema, index_name, std::move(index), iot, table_name, 0, index_type));
     indexes_[iot] = std::move(index_info);
     index_names_[table_name][index_name] = iot;
-
+    if (persistent_) {
+      Persist();
+    }
     return indexes_[iot].get();
   }
 
+  /**
+   * Give an index a Bloom filter over its keys, so that lookups of keys it does not have skip it. The filter is built
+   * from a scan of the table, and built again that way on a background thread once deletes made it stale. It is not
+   * persisted.
+   * @param index_info the index
+   */
+  void EnableBloomFilter(IndexInfo *index_info) {
+    Index *index = index_info->index_.get();
+    TableMetadata *table_metadata = GetTable(index_info->table_name_);
+    index->EnableBloomFilter([table_metadata, index](const std::function<void(const Tuple &)> &add) {
+      TableHeap *table = table_metadata->table_.get();
+      for (auto iter = table->Begin(nullptr); iter != table->End(); ++iter) {
+        add(iter->KeyFromTuple(table_metadata->schema_, *index->GetKeySchema(), index->GetKeyAttrs()));
+      }
+    });
+  }
+
   IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
     if (index_names_.count(table_name) == 0) {
       throw std::out_of_range("can not find index");
@@ -184,6 +327,266 @@ class Catalog {
   }
 
  private:
+  static constexpr size_t CATALOG_PAGE_HEADER_SIZE = sizeof(page_id_t) + sizeof(uint32_t);
+  static constexpr size_t CATALOG_PAGE_DATA_SIZE = PAGE_SIZE - CATALOG_PAGE_HEADER_SIZE;
+
+  /**
+   * @return the name of the header page record keeping the root of the tree of an index. Index names are only unique
+   * per table, the oid is unique in the database and always fits in the record.
+   */
+  static std::string IndexRecordName(index_oid_t index_oid) { return "__index_" + std::to_string(index_oid); }
+
+  template <class KeyType, class ValueType, class KeyComparator>
+  BPlusTreeIndex<KeyType, ValueType, KeyComparator> *NewTreeIndex(IndexMetadata *index_metadata,
+                                                                  IndexType index_type, bool unique_keys) {
+    if (index_type == IndexType::BUFFERED_B_PLUS_TREE) {
+      return new BufferedBPlusTreeIndex<KeyType, ValueType, KeyComparator>(index_metadata, bpm_,
+                                                                           DEFAULT_INDEX_BUFFER_SIZE, unique_keys);
+    }
+    return new BPlusTreeIndex<KeyType, ValueType, KeyComparator>(index_metadata, bpm_, unique_keys);
+  }
+
+  /** insert the key of every tuple of the table of index */
+  void PopulateIndex(Index *index, Transaction *txn) {
+    const std::string &table_name = index->GetMetadata()->GetTableName();
+    TableMetadata *table_metadata = GetTable(table_name);
+    TableHeap *table = table_metadata->table_.get();
+    for (auto iter = table->Begin(txn); iter != table->End(); ++iter) {
+      index->InsertEntry(iter->KeyFromTuple(table_metadata->schema_, *index->GetKeySchema(), index->GetKeyAttrs()),
+                         iter->GetRid(), txn);
+    }
+  }
+
+  /**
+   * reopen the index an earlier catalog created, its tree is found through the header page. ART indexes live in
+   * memory only and are rebuilt from their table.
+   */
+  Index *OpenIndex(IndexMetadata *index_metadata, IndexType index_type, size_t key_size, bool unique_keys) {
+    if (index_type == IndexType::ART) {
+      auto *index = new ArtIndex(index_metadata);
+      PopulateIndex(index, nullptr);
+      return index;
+    }
+    switch (key_size) {
+      case 0: {
+        auto *index = new VarlenBPlusTreeIndex(index_metadata, bpm_);
+        index->Open();
+        return index;
+      }
+      case 4:
+        return OpenTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(index_metadata, index_type, unique_keys);
+      case 8:
+        return OpenTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(index_metadata, index_type, unique_keys);
+      case 16:
+        return OpenTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(index_metadata, index_type, unique_keys);
+      case 32:
+        return OpenTreeIndex<GenericKey<32>, RID, GenericComparator<32>>(index_metadata, index_type, unique_keys);
+      case 64:
+        return OpenTreeIndex<GenericKey<64>, RID, GenericComparator<64>>(index_metadata, index_type, unique_keys);
+      default:
+        throw Exception(ExceptionType::INVALID, "catalog page has an index of unknown key size");
+    }
+  }
+
+  template <class KeyType, class ValueType, class KeyComparator>
+  Index *OpenTreeIndex(IndexMetadata *index_metadata, IndexType index_type, bool unique_keys) {
+    auto *tree_index = NewTreeIndex<KeyType, ValueType, KeyComparator>(index_metadata, index_type, unique_keys);
+    tree_index->Open();
+    return tree_index;
+  }
+
+  /**
+   * Serialization of the metadata, fixed-size values are copied as they are and strings are prefixed by their length.
+   */
+  template <typename T>
+  static void WriteValue(std::string *buf, const T &value) {
+    buf->append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  static void WriteString(std::string *buf, const std::string &str) {
+    WriteValue(buf, static_cast<uint32_t>(str.size()));
+    buf->append(str);
+  }
+
+  template <typename T>
+  static T ReadValue(const std::string &buf, size_t *offset) {
+    T value;
+    memcpy(&value, buf.data() + *offset, sizeof(T));
+    *offset += sizeof(T);
+    return value;
+  }
+
+  static std::string ReadString(const std::string &buf, size_t *offset) {
+    auto size = ReadValue<uint32_t>(buf, offset);
+    std::string str = buf.substr(*offset, size);
+    *offset += size;
+    return str;
+  }
+
+  static void WriteSchema(std::string *buf, const Schema &schema) {
+    WriteValue(buf, schema.GetColumnCount());
+    for (const Column &column : schema.GetColumns()) {
+      WriteString(buf, column.GetName());
+      WriteValue(buf, column.GetType());
+      WriteValue(buf, column.GetLength());
+    }
+  }
+
+  static Schema ReadSchema(const std::string &buf, size_t *offset) {
+    std::vector<Column> columns;
+    auto column_count = ReadValue<uint32_t>(buf, offset);
+    for (uint32_t i = 0; i < column_count; i++) {
+      std::string name = ReadString(buf, offset);
+      auto type = ReadValue<TypeId>(buf, offset);
+      auto length = ReadValue<uint32_t>(buf, offset);
+      if (type == TypeId::VARCHAR) {
+        columns.emplace_back(name, type, length);
+      } else {
+        columns.emplace_back(name, type);
+      }
+    }
+    return Schema(columns);
+  }
+
+  /**
+   * Write the metadata of every table and index to the catalog pages, and record the first one in the header page
+   * when it is new. The pages of the chain are reused, it only grows.
+   */
+  void Persist() {
+    std::string buf;
+    WriteValue(&buf, next_table_oid_.load());
+    WriteValue(&buf, next_index_oid_.load());
+    WriteValue(&buf, static_cast<uint32_t>(tables_.size()));
+    for (const auto &entry : tables_) {
+      const TableMetadata *table = entry.second.get();
+      WriteValue(&buf, table->oid_);
+      WriteString(&buf, table->name_);
+      WriteValue(&buf, table->table_->GetFirstPageId());
+      WriteSchema(&buf, table->schema_);
+    }
+    WriteValue(&buf, static_cast<uint32_t>(indexes_.size()));
+    for (const auto &entry : indexes_) {
+      const IndexInfo *index = entry.second.get();
+      WriteValue(&buf, index->index_oid_);
+      WriteString(&buf, index->name_);
+      WriteString(&buf, index->table_name_);
+      WriteValue(&buf, index->index_type_);
+      WriteValue(&buf, static_cast<uint32_t>(index->key_size_));
+      WriteValue(&buf, index->unique_keys_);
+      const std::vector<uint32_t> &key_attrs = index->index_->GetKeyAttrs();
+      WriteValue(&buf, static_cast<uint32_t>(key_attrs.size()));
+      for (uint32_t attr : key_attrs) {
+        WriteValue(&buf, attr);
+      }
+    }
+
+    size_t page_count = std::max<size_t>((buf.size() + CATALOG_PAGE_DATA_SIZE - 1) / CATALOG_PAGE_DATA_SIZE, 1);
+    while (catalog_pages_.size() < page_count) {
+      page_id_t page_id;
+      if (bpm_->NewPage(&page_id) == nullptr) {
+        throw "out of memory";
+      }
+      bpm_->UnpinPage(page_id, false);
+      if (catalog_pages_.empty()) {
+        RecordFirstPage(page_id);
+      }
+      catalog_pages_.push_back(page_id);
+    }
+    // pages past the metadata stay in the chain with nothing in them
+    size_t offset = 0;
+    for (size_t i = 0; i < catalog_pages_.size(); i++) {
+      Page *page = bpm_->FetchPage(catalog_pages_[i]);
+      if (page == nullptr) {
+        throw "out of memory";
+      }
+      auto size = static_cast<uint32_t>(std::min(buf.size() - offset, CATALOG_PAGE_DATA_SIZE));
+      page_id_t next_page_id = i + 1 < catalog_pages_.size() ? catalog_pages_[i + 1] : INVALID_PAGE_ID;
+      memcpy(page->GetData(), &next_page_id, sizeof(page_id_t));
+      memcpy(page->GetData() + sizeof(page_id_t), &size, sizeof(uint32_t));
+      memcpy(page->GetData() + CATALOG_PAGE_HEADER_SIZE, buf.data() + offset, size);
+      offset += size;
+      bpm_->UnpinPage(catalog_pages_[i], true);
+    }
+  }
+
+  /** Read back the tables and indexes recorded in the catalog pages, if the header page has any. */
+  void Load() {
+    Page *header = bpm_->FetchPage(HEADER_PAGE_ID);
+    if (header == nullptr) {
+      throw "out of memory";
+    }
+    page_id_t page_id = INVALID_PAGE_ID;
+    header->RLatch();
+    static_cast<HeaderPage *>(header)->GetRootId(CATALOG_RECORD_NAME, &page_id);
+    header->RUnlatch();
+    bpm_->UnpinPage(HEADER_PAGE_ID, false);
+
+    std::string buf;
+    while (page_id != INVALID_PAGE_ID) {
+      Page *page = bpm_->FetchPage(page_id);
+      if (page == nullptr) {
+        throw "out of memory";
+      }
+      catalog_pages_.push_back(page_id);
+      uint32_t size;
+      memcpy(&size, page->GetData() + sizeof(page_id_t), sizeof(uint32_t));
+      buf.append(page->GetData() + CATALOG_PAGE_HEADER_SIZE, size);
+      memcpy(&page_id, page->GetData(), sizeof(page_id_t));
+      bpm_->UnpinPage(catalog_pages_.back(), false);
+    }
+    if (buf.empty()) {
+      return;
+    }
+
+    size_t offset = 0;
+    next_table_oid_ = ReadValue<table_oid_t>(buf, &offset);
+    next_index_oid_ = ReadValue<index_oid_t>(buf, &offset);
+    auto table_count = ReadValue<uint32_t>(buf, &offset);
+    for (uint32_t i = 0; i < table_count; i++) {
+      auto oid = ReadValue<table_oid_t>(buf, &offset);
+      std::string name = ReadString(buf, &offset);
+      auto first_page_id = ReadValue<page_id_t>(buf, &offset);
+      Schema schema = ReadSchema(buf, &offset);
+      std::unique_ptr<TableHeap> table_heap(new TableHeap(bpm_, lock_manager_, log_manager_, first_page_id));
+      names_[name] = oid;
+      tables_[oid] = std::make_unique<TableMetadata>(schema, name, std::move(table_heap), oid);
+    }
+    auto index_count = ReadValue<uint32_t>(buf, &offset);
+    for (uint32_t i = 0; i < index_count; i++) {
+      auto oid = ReadValue<index_oid_t>(buf, &offset);
+      std::string name = ReadString(buf, &offset);
+      std::string table_name = ReadString(buf, &offset);
+      auto index_type = ReadValue<IndexType>(buf, &offset);
+      auto key_size = ReadValue<uint32_t>(buf, &offset);
+      auto unique_keys = ReadValue<bool>(buf, &offset);
+      std::vector<uint32_t> key_attrs(ReadValue<uint32_t>(buf, &offset));
+      for (uint32_t &attr : key_attrs) {
+        attr = ReadValue<uint32_t>(buf, &offset);
+      }
+      auto *index_metadata =
+          new IndexMetadata(name, table_name, &GetTable(table_name)->schema_, key_attrs, IndexRecordName(oid));
+      Schema key_schema = *index_metadata->GetKeySchema();
+      std::unique_ptr<Index> index(OpenIndex(index_metadata, index_type, key_size, unique_keys));
+      indexes_[oid] = std::make_unique<IndexInfo>(key_schema, name, std::move(index), oid, table_name, key_size,
+                                                  index_type, unique_keys);
+      index_names_[table_name][name] = oid;
+    }
+  }
+
+  void RecordFirstPage(page_id_t page_id) {
+    Page *header = bpm_->FetchPage(HEADER_PAGE_ID);
+    if (header == nullptr) {
+      throw "out of memory";
+    }
+    header->WLatch();
+    bool inserted = static_cast<HeaderPage *>(header)->InsertRecord(CATALOG_RECORD_NAME, page_id);
+    header->WUnlatch();
+    bpm_->UnpinPage(HEADER_PAGE_ID, inserted);
+    if (!inserted) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "header page is full");
+    }
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
@@ -200,5 +603,9 @@ class Catalog {
   std::unordered_map<std::string, std::unordered_map<std::string, index_oid_t>> index_names_;
   /** The next index identifier to be used */
   std::atomic<index_oid_t> next_index_oid_{0};
+  /** whether the metadata is kept in the catalog pages */
+  const bool persistent_;
+  /** the chain of catalog pages, in order */
+  std::vector<page_id_t> catalog_pages_;
 };
 }  // namespace bustub
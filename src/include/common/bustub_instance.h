@@ -13,6 +13,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -40,12 +41,23 @@ class BustubInstance {
 
     // checkpoints
     checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
+
+    // a new database file starts with its header page, an existing one gets its tables and indexes back
+    if (disk_manager_->GetNumPages() == 0) {
+      page_id_t header_page_id;
+      buffer_pool_manager_->NewPage(&header_page_id);
+      buffer_pool_manager_->UnpinPage(header_page_id, true);
+    }
+    catalog_ = new Catalog(buffer_pool_manager_, lock_manager_, log_manager_, true);
   }
 
   ~BustubInstance() {
     if (enable_logging) {
       log_manager_->StopFlushThread();
     }
+    // the catalog and its indexes write their last pages when deleted, the buffer pool would drop them unflushed
+    delete catalog_;
+    buffer_pool_manager_->FlushAllPages();
     delete checkpoint_manager_;
     delete log_manager_;
     delete buffer_pool_manager_;
@@ -60,6 +72,7 @@ class BustubInstance {
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  Catalog *catalog_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+#include "storage/page/hash_table_root_directory_page.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hash table that is backed by a buffer pool
+ * manager. Non-unique keys are supported. Supports insert and delete.
+ *
+ * The directory maps the low bits of the hash of a key to a bucket page. It
+ * starts as a single directory page, and once it is deeper than a page holds
+ * the root directory page points to several of them.
+ * A full bucket is split in two by one more hash bit, and only the directory
+ * doubles when the bucket already used all of its bits; no other bucket is
+ * touched. An emptied bucket is merged back into its split image, and the
+ * directory halves once no bucket needs all of its bits.
+ *
+ * Concurrency: lookups, and inserts and removes that do not change the
+ * directory, read latch table_latch_ and latch only their bucket page. Splits
+ * and merges write latch table_latch_.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable with a single bucket
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false if the pair is there already
+   * @throws Exception if the bucket of key is full and the directory has reached its maximum depth
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * @return the global depth of the directory
+   */
+  uint32_t GetGlobalDepth();
+
+  /**
+   * Asserts that the local depths are at most the global depth, and that every bucket of local depth d is shared by
+   * exactly 2^(GlobalDepth - d) slots with the same local depth.
+   */
+  void VerifyIntegrity();
+
+ private:
+  using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+
+  uint32_t Hash(const KeyType &key);
+
+  HashTableRootDirectoryPage *FetchRootPage();
+  // the directory page that holds slot
+  HashTableDirectoryPage *FetchSegmentPage(HashTableRootDirectoryPage *root_page, uint32_t slot);
+  Page *FetchBucketPage(page_id_t bucket_page_id);
+  // the bucket page id and the local depth of slot
+  std::pair<page_id_t, uint32_t> GetBucket(HashTableRootDirectoryPage *root_page, uint32_t slot);
+
+  // call visit(segment_page, offset, slot) on the slots that agree with slot on its depth low bits
+  template <typename Visitor>
+  void ForEachSlot(HashTableRootDirectoryPage *root_page, uint32_t slot, uint32_t depth, bool dirty,
+                   Visitor &&visit);
+  // double or halve the directory, under the write latch of table_latch_
+  void Grow(HashTableRootDirectoryPage *root_page);
+  bool CanShrink(HashTableRootDirectoryPage *root_page);
+  void Shrink(HashTableRootDirectoryPage *root_page);
+
+  // split the bucket of key until the pair fits, under the write latch of table_latch_
+  bool SplitInsert(const KeyType &key, const ValueType &value);
+  // merge the empty bucket of key into its split image, under the write latch of table_latch_
+  void Merge(const KeyType &key);
+
+  // member variable
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers are inserts, removes and lookups, writers are splits and merges
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+};
+
+}  // namespace bustub
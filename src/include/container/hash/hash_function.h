@@ -13,11 +13,18 @@
 #pragma once
 
 #include <cstdint>
-
-#include "murmur3/MurmurHash3.h"
+#include <cstring>
+#include <type_traits>
 
 namespace bustub {
 
+/**
+ * The hash function of the hash tables, picked at compile time from the key
+ * type: a multiply and fold of the value for integers, and a wyhash style
+ * hash over the bytes of other keys such as GenericKey, whose length is a
+ * constant. Every bit of the key affects the low bits of the hash, which pick
+ * the bucket, and the high bits, which LinearProbeHashTable uses for tags.
+ */
 template <typename KeyType>
 class HashFunction {
  public:
@@ -25,11 +32,41 @@ class HashFunction {
    * @param key the key to be hashed
    * @return the hashed value
    */
-  virtual uint64_t GetHash(KeyType key) {
-    uint64_t hash[2];
-    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
-                                 reinterpret_cast<void *>(&hash));
-    return hash[0];
+  uint64_t GetHash(const KeyType &key) const {
+    if constexpr (std::is_integral_v<KeyType>) {
+      return Mix(static_cast<uint64_t>(key) ^ SECRET[0], SECRET[1]);
+    } else {
+      return HashBytes<sizeof(KeyType)>(reinterpret_cast<const char *>(&key));
+    }
+  }
+
+ private:
+  static constexpr uint64_t SECRET[3] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL};
+
+  // the high and the low half of the 128 bit product folded together
+  static uint64_t Mix(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  }
+
+  // up to 8 bytes as a word, missing bytes are 0
+  static uint64_t Read(const char *data, size_t length) {
+    uint64_t word = 0;
+    memcpy(&word, data, length < 8 ? length : 8);
+    return word;
+  }
+
+  // 16 bytes per step, the loops unroll as Length is a constant
+  template <size_t Length>
+  static uint64_t HashBytes(const char *data) {
+    uint64_t seed = SECRET[0];
+    size_t i = 0;
+    for (; i + 16 < Length; i += 16) {
+      seed = Mix(Read(data + i, 8) ^ SECRET[1], Read(data + i + 8, 8) ^ seed);
+    }
+    uint64_t a = Read(data + i, Length - i);
+    uint64_t b = Length - i > 8 ? Read(data + i + 8, Length - i - 8) : 0;
+    return Mix(SECRET[1] ^ Length, Mix(a ^ SECRET[1], b ^ seed));
   }
 };
 
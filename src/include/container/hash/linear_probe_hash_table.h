@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <queue>
 #include <string>
 #include <vector>
@@ -23,17 +25,37 @@
 #include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
 #include "storage/page/hash_table_page_defs.h"
+#include "storage/page/hash_table_tag_block_page.h"
 
 namespace bustub {
 
-#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
+#define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator, BlockPage>
 
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Concurrency: the block page of the home bucket of a key is write latched by
+ * inserts and removes of that key, so writers of one key are serialized while
+ * writers of other keys probe and claim slots with the atomic flags of the
+ * block pages. Slots are never reused before a resize, so readers take no
+ * block latches.
+ *
+ * Resizing is incremental. A resize allocates the new table and then only
+ * swaps it in, the old table stays in place and every following insert or
+ * remove moves the pairs of one of its blocks. Until the old table is empty,
+ * lookups check both tables and writers latch the home blocks of both, old
+ * table first. table_latch_ is write latched only to swap the tables.
+ *
+ * BlockPage is the layout of the blocks, HashTableBlockPage or
+ * HashTableTagBlockPage. Probes go a group of slots at a time: the block page
+ * matches the group against the tag of the key, and only the keys of the
+ * candidate slots are compared. HashTableBlockPage has no tags, so there every
+ * readable slot is a candidate.
  */
-template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename KeyType, typename ValueType, typename KeyComparator,
+          typename BlockPage = HashTableBlockPage<KeyType, ValueType, KeyComparator>>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
  public:
   /**
@@ -52,7 +74,8 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
-   * @return true if insert succeeded, false otherwise
+   * @return true if insert succeeded, false if the pair is already there
+   * @throws Exception if the table is full and has as many blocks as the header page holds
    */
   bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
 
@@ -87,16 +110,72 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  enum class InsertResult { SUCCESS, DUPLICATE, FULL };
+
+  // one generation of the table, the block page ids of its header page are cached
+  struct Table {
+    page_id_t header_page_id_;
+    std::vector<page_id_t> block_page_ids_;
+    size_t num_buckets_;
+    // claimed slots, tombstones included
+    std::atomic<size_t> occupied_{0};
+  };
+
+  // allocate a table of at least num_buckets buckets, capped at the blocks a header page holds
+  std::unique_ptr<Table> NewTable(size_t num_buckets);
+  void DeleteTable(Table *table);
+
+  Page *FetchBlock(const Table &table, size_t block);
+
+  // fetch and write latch the block page of the home bucket of key
+  Page *LatchHome(const Table &table, const KeyType &key);
+  void UnlatchHome(Page *page);
+
+  /**
+   * Walk the probe sequence of key. visit is called for the candidate buckets
+   * before the first never occupied bucket, and at_empty for that bucket.
+   * Both return true to end the probe; if at_empty returns false the bucket
+   * was claimed in the meantime and the probe goes on past it.
+   */
+  template <typename Visitor, typename EmptyVisitor>
+  void Probe(const Table &table, const KeyType &key, bool dirty, Visitor visit, EmptyVisitor at_empty);
+
+  // insert the pair into its first free bucket, the caller holds the latch of the home block
+  InsertResult InsertInto(Table *table, const KeyType &key, const ValueType &value);
+  // find the pair, and turn it into a tombstone if remove is set
+  bool FindPair(const Table &table, const KeyType &key, const ValueType &value, bool remove);
+  void CollectValues(const Table &table, const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Move the pairs of one block of the old table, the caller holds a read
+   * latch on table_latch_.
+   * @return true if that was the last block, the caller then calls FinishResize()
+   */
+  bool HelpResize();
+  void MigrateBlock(size_t block);
+  void FinishResize();
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts, removes and lookups, writer only swaps the tables in a resize
   ReaderWriterLatch table_latch_;
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  std::unique_ptr<Table> table_;
+  // the table being moved to table_, nullptr if no resize is in progress
+  std::unique_ptr<Table> old_table_;
+  // set from the start of a resize until the old table is deleted
+  std::atomic<bool> resizing_{false};
+  // blocks of the old table handed out to and finished by HelpResize()
+  std::atomic<size_t> next_migrate_block_{0};
+  std::atomic<size_t> migrated_blocks_{0};
+  // pairs in the table
+  std::atomic<size_t> num_entries_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_expression.h
+//
+// Identification: src/include/execution/compiled_expression.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/tuple_batch.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CompiledExpression is a predicate turned from an expression tree into a
+ * flat program, for evaluating it a batch at a time without virtual calls and
+ * Value objects per row.
+ *
+ * Every step of the program is one kernel, a function template instantiated
+ * for the C++ type of its operands: load a column of the batch, load a
+ * constant, or compare a register with another one or with a constant (e.g.
+ * int32_t < int32_t). A register holds one plain value per row being
+ * evaluated, or one bit per row for a boolean, and a bitmap of the rows that
+ * are null. The operands of a comparison are loaded as the type they are
+ * compared in, as Value does it: their own type if it is the same, double if
+ * either is a DECIMAL, and int64_t for two different integer types. Numeric
+ * comparisons run as the SIMD kernels of filter_kernels.h, picked for the CPU
+ * when the expression compiles.
+ *
+ * Only comparisons of columns, constants and other comparisons over the
+ * numeric and boolean types compile; Compile() returns nullptr for anything
+ * else and the caller evaluates the expression as before. Nulls behave as
+ * with Evaluate(): a comparison with a null is null, and a null predicate
+ * keeps the row.
+ */
+class CompiledExpression {
+ public:
+  /**
+   * Compiles a predicate over batches of the given schema.
+   * @return the program, nullptr if the expression does not compile
+   */
+  static std::unique_ptr<CompiledExpression> Compile(const AbstractExpression *expr, const Schema *schema);
+
+  // keep the selected rows of batch for which the predicate is not false
+  void Filter(TupleBatch *batch);
+
+  /**
+   * Keep the tuples for which the predicate is not false, reading their columns from the tuple data, e.g. of tuples
+   * still inside a table page.
+   * @param tuples tuples of the schema the predicate was compiled for
+   * @param[in,out] selection the indexes of the tuples to evaluate, in order; the ones kept
+   */
+  void FilterTuples(const std::vector<Tuple> &tuples, std::vector<uint32_t> *selection);
+
+  size_t GetStepCount() const { return steps_.size(); }
+
+ private:
+  struct Register {
+    // room for count values of type T
+    template <typename T>
+    T *Data(size_t count) {
+      data_.resize((count * sizeof(T) + sizeof(int64_t) - 1) / sizeof(int64_t));
+      return reinterpret_cast<T *>(data_.data());
+    }
+    template <typename T>
+    const T *Data() const {
+      return reinterpret_cast<const T *>(data_.data());
+    }
+
+    // room for a bitmap of count rows
+    uint64_t *Bits(size_t count) { return Data<uint64_t>(BitmapWords(count)); }
+    uint64_t *Nulls(size_t count) {
+      nulls_.resize(BitmapWords(count));
+      return nulls_.data();
+    }
+
+    // int64_t elements keep the values of every type aligned
+    std::vector<int64_t> data_;
+    std::vector<uint64_t> nulls_;
+  };
+
+  static size_t BitmapWords(size_t count) { return (count + 63) / 64; }
+
+  // what the columns are loaded from, a batch or tuples
+  struct Input {
+    const TupleBatch *batch_;
+    const std::vector<Tuple> *tuples_;
+  };
+
+  struct Step;
+  // a kernel evaluates its step for the given rows of the input, into dense registers of rows.size() values
+  using Kernel = void (*)(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                          std::vector<Register> *registers);
+
+  // the FilterKernel<T> of a comparison, cast back to its type by the kernel of the step
+  using AnyFilterKernel = void (*)();
+
+  struct Step {
+    Kernel kernel_;
+    AnyFilterKernel filter_{nullptr};
+    uint32_t out_;
+    uint32_t lhs_{0};
+    uint32_t rhs_{0};
+    uint32_t col_idx_{0};
+    // where the column is in the data of a tuple
+    uint32_t col_offset_{0};
+    Value constant_;
+  };
+
+  CompiledExpression() = default;
+
+  /*
+   * The kernels, instantiated in compiled_expression.cpp. Each one writes rows.size() values or bits and null flags
+   * to the out register of its step, the i-th one for row rows[i] of the input.
+   */
+  template <typename From, typename To>
+  static void LoadColumn(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                         std::vector<Register> *registers);
+  static void LoadBooleanColumn(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                                std::vector<Register> *registers);
+  template <typename T>
+  static void LoadConstant(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                           std::vector<Register> *registers);
+  static void LoadBooleanConstant(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                                  std::vector<Register> *registers);
+  template <typename T>
+  static void CompareRegisters(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                               std::vector<Register> *registers);
+  template <typename T>
+  static void CompareConstant(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                              std::vector<Register> *registers);
+  template <ComparisonType OP>
+  static void CompareBooleans(const Step &step, const Input &input, const std::vector<uint32_t> &rows,
+                              std::vector<Register> *registers);
+
+  /**
+   * Appends the steps that evaluate expr into a new register.
+   * @param type the type to load expr as, which must be the type of expr or wider
+   * @param[out] out the register of expr
+   * @return false if expr does not compile
+   */
+  bool Emit(const AbstractExpression *expr, const Schema *schema, TypeId type, uint32_t *out);
+  // the steps of a comparison, in step
+  bool EmitComparison(const ComparisonExpression *expr, const Schema *schema, Step *step);
+
+  // runs the program for the given rows of input, the ones it keeps go to selection
+  void Run(const Input &input, const std::vector<uint32_t> &rows, std::vector<uint32_t> *selection);
+
+  std::vector<Step> steps_;
+  std::vector<Register> registers_;
+  uint32_t result_{0};
+};
+
+}  // namespace bustub
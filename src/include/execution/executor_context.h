@@ -18,6 +18,7 @@
 
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
+#include "execution/tuple_batch.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
@@ -60,12 +61,19 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the number of rows the executors put into one batch */
+  size_t GetBatchSize() const { return batch_size_; }
+
+  /** Sets the number of rows the executors put into one batch, to be called before they are created. */
+  void SetBatchSize(size_t batch_size) { batch_size_ = batch_size; }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  size_t batch_size_{DEFAULT_BATCH_SIZE};
 };
 
 }  // namespace bustub
@@ -13,11 +13,15 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
- * AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
+ * AbstractExecutor implements the Volcano iterator model, tuple-at-a-time with Next() or batch-at-a-time with
+ * NextBatch(). An executor implements one of them and gets the other one as an adapter: NextBatch() collects the
+ * tuples of Next() by default, and executors with their own NextBatch() implement Next() with NextFromBatch().
+ * Both must not be mixed on one executor.
  */
 class AbstractExecutor {
  public:
@@ -25,7 +29,7 @@ class AbstractExecutor {
    * Constructs a new AbstractExecutor.
    * @param exec_ctx the executor context that the executor runs with
    */
-  explicit AbstractExecutor(ExecutorContext *exec_ctx) : exec_ctx_{exec_ctx} {}
+  explicit AbstractExecutor(ExecutorContext *exec_ctx) : exec_ctx_{exec_ctx}, row_batch_(exec_ctx->GetBatchSize()) {}
 
   /** Virtual destructor. */
   virtual ~AbstractExecutor() = default;
@@ -44,6 +48,22 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Produces the next batch of tuples from this executor, the tuples Next() would produce one at a time, in the
+   * same order and stored column by column. The batch schema tells how to read them.
+   * @param[out] batch reset and filled with up to its capacity tuples
+   * @return true if at least one tuple was selected into the batch, false if there are no more tuples
+   */
+  virtual bool NextBatch(TupleBatch *batch) {
+    batch->Reset(GetOutputSchema());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->SelectedCount() > 0;
+  }
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
@@ -79,6 +99,31 @@ class AbstractExecutor {
 
 
  protected:
+  /** Next() of an executor that implements NextBatch(): the selected tuples of one batch after the other. */
+  bool NextFromBatch(Tuple *tuple, RID *rid) {
+    while (row_batch_pos_ == row_batch_.SelectedCount()) {
+      if (!NextBatch(&row_batch_)) {
+        return false;
+      }
+      row_batch_pos_ = 0;
+    }
+    uint32_t row = row_batch_.Selection()[row_batch_pos_++];
+    *tuple = row_batch_.RowTuple(row);
+    *rid = row_batch_.GetRid(row);
+    return true;
+  }
+
+  /** Drops what is left of the batch of NextFromBatch(), to be called from Init(). */
+  void ResetNextFromBatch() {
+    row_batch_.SetSelection({});
+    row_batch_pos_ = 0;
+  }
+
   ExecutorContext *exec_ctx_;
+
+ private:
+  /** The batch NextFromBatch() hands out, and the position of the next tuple in its selection. */
+  TupleBatch row_batch_;
+  size_t row_batch_pos_{0};
 };
 }  // namespace bustub
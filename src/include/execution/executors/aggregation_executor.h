@@ -97,12 +97,12 @@ class SimpleAggregationHashTable {
    * @param agg_val the value to be inserted
    */
   void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht.count(agg_key) == 0) {
-      LOG_INFO("INSERT NULL");
-      ht.insert({agg_key, GenerateInitialAggregateValue()});
+    // one lookup of the key, the initial value is only made for a new group
+    auto iter = ht.find(agg_key);
+    if (iter == ht.end()) {
+      iter = ht.insert({agg_key, GenerateInitialAggregateValue()}).first;
     }
-    LOG_INFO("INSERT HAVE");
-    CombineAggregateValues(&ht[agg_key], agg_val);
+    CombineAggregateValues(&iter->second, agg_val);
   }
 
   /**
@@ -174,6 +174,9 @@ class AggregationExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /** Batches hold the groups that pass the having clause, in the output schema. */
+  bool NextBatch(TupleBatch *batch) override;
+
   /** @return the tuple as an AggregateKey */
   AggregateKey MakeKey(const Tuple *tuple) {
     std::vector<Value> keys;
@@ -12,9 +12,18 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "common/rid.h"
+#include "common/rwlatch.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
@@ -35,6 +44,8 @@ class IndexScanExecutor : public AbstractExecutor {
    */
   IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan);
 
+  ~IndexScanExecutor() override { StopWorkers(); }
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); };
 
   void Init() override;
@@ -42,11 +53,43 @@ class IndexScanExecutor : public AbstractExecutor {
   bool Next(Tuple *tuple, RID *rid) override;
 
  private:
+  // the index key of a bound of the plan
+  static GenericKey<8> MakeKey(const std::vector<const AbstractExpression *> &bound, Schema *key_schema);
+
+  // how many rows a worker of a parallel scan runs ahead of Next()
+  static constexpr size_t PARTITION_QUEUE_SIZE = 256;
+
+  // the rows of one sub-range of a parallel scan, queued by its worker until Next() takes them
+  struct Partition {
+    std::mutex latch_;
+    std::condition_variable cv_;
+    std::deque<std::pair<RID, Tuple>> rows_;
+    bool done_{false};
+  };
+
+  // scan one sub-range into partition, waiting whenever its queue is full
+  void ScanPartition(const IndexKeyRange<GenericKey<8>> &range, Partition *partition);
+
+  // read the tuple of rid for a worker, false if it is gone
+  bool FetchTuple(TableHeap *table, const RID &rid, Tuple *tuple);
+
+  bool NextFromPartitions(Tuple *tuple, RID *rid);
+
+  // make the workers of a parallel scan give up and wait for them
+  void StopWorkers();
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   IndexIterator<GenericKey<8>, RID, GenericComparator<8>> iter;
   IndexIterator<GenericKey<8>, RID, GenericComparator<8>> end;
   std::string table_name_;
-
+  /** The parallel scan: one partition and worker per sub-range, returned in order. */
+  std::vector<std::unique_ptr<Partition>> partitions_;
+  std::vector<std::future<void>> workers_;
+  size_t partition_index_{0};
+  std::atomic<bool> stop_{false};
+  /** The lock sets of the transaction are not thread safe: workers lock rows under the write latch and read under
+   * the read latch. */
+  ReaderWriterLatch txn_latch_;
 };
 }  // namespace bustub
@@ -47,11 +47,22 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
  private:
+  // pull the next batch of outer tuples and look up their keys, false once the outer table is exhausted
+  bool NextOuterBatch();
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
   std::string table_name;
   std::unique_ptr<AbstractExecutor> child_executor_;
   IndexInfo *index_info;
+  /** The current batch of outer tuples and the inner RIDs that match the key of each. */
+  TupleBatch outer_batch_;
+  std::vector<Tuple> left_tuples_;
+  std::vector<std::vector<RID>> matches_;
+  size_t left_index_{0};
+  size_t match_index_{0};
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -45,10 +46,29 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Joins one left row with a whole right batch at a time. The right side is read into batches once and kept, the
+   * left side is read a batch at a time.
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
  private:
   /** The NestedLoop plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_executor_;
   std::unique_ptr<AbstractExecutor> right_executor_;
+  /** All batches of the right side, read by the first NextBatch(). */
+  std::vector<TupleBatch> right_batches_;
+  bool right_read_{false};
+  /** The current left batch and the position of the current left row in its selection. */
+  TupleBatch left_batch_;
+  size_t left_pos_{0};
+  /** The right batch after the one the current left row was last joined with. */
+  size_t right_index_{0};
+  /** The rows of that right batch that join with the current left row, and the output values of all of them. */
+  std::vector<uint32_t> matches_;
+  size_t match_pos_{0};
+  std::vector<std::vector<Value>> join_values_;
+  std::vector<Value> predicate_result_;
 };
 }  // namespace bustub
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
+#include "execution/compiled_expression.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -37,12 +39,26 @@ class SeqScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  /**
+   * Batches hold whole table tuples in the table schema, like the tuples of Next(), after the predicate. A compiled
+   * predicate runs on the tuples inside their table page, and only the tuples it keeps are copied into the batch.
+   */
+  bool NextBatch(TupleBatch *batch) override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
-  TableIterator iter;
-  TableIterator end;
+  TableHeap *table_heap_{nullptr};
+  /** The next tuple to read, see TableHeap::ScanInPlace(). */
+  RID cursor_;
+  const Schema *table_schema_{nullptr};
+  /** The predicate compiled for the table schema, nullptr if it does not compile and is evaluated as an expression. */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The predicate value of every row of the current batch. */
+  std::vector<Value> predicate_result_;
+  /** The tuples of the current page that the predicate keeps. */
+  std::vector<uint32_t> page_selection_;
 };
 }  // namespace bustub
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -58,6 +59,40 @@ class AbstractExpression {
    */
   virtual Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const = 0;
 
+  /**
+   * Evaluates the expression for some rows of a batch, as Evaluate() would for each row on its own.
+   * The default implementation does exactly that, expressions that can work on whole columns override it.
+   * @param batch the rows, read with the schema of the batch
+   * @param rows the rows to evaluate, e.g. the selection of the batch
+   * @param[out] result resized to the rows of the batch, only the given rows are set
+   */
+  virtual void EvaluateBatch(const TupleBatch &batch, const std::vector<uint32_t> &rows,
+                             std::vector<Value> *result) const {
+    result->resize(batch.Size());
+    for (uint32_t row : rows) {
+      Tuple tuple = batch.RowTuple(row);
+      (*result)[row] = Evaluate(&tuple, batch.GetSchema());
+    }
+  }
+
+  /**
+   * Evaluates a join of one left row with some rows of a right batch, as EvaluateJoin() would for each pair.
+   * @param left the left rows
+   * @param left_row the left row to join
+   * @param right the right rows
+   * @param rows the right rows to join
+   * @param[out] result resized to the rows of the right batch, only the given rows are set
+   */
+  virtual void EvaluateJoinBatch(const TupleBatch &left, uint32_t left_row, const TupleBatch &right,
+                                 const std::vector<uint32_t> &rows, std::vector<Value> *result) const {
+    result->resize(right.Size());
+    Tuple left_tuple = left.RowTuple(left_row);
+    for (uint32_t row : rows) {
+      Tuple right_tuple = right.RowTuple(row);
+      (*result)[row] = EvaluateJoin(&left_tuple, left.GetSchema(), &right_tuple, right.GetSchema());
+    }
+  }
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpression *GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
@@ -41,6 +41,31 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(right_schema, col_idx_);
   }
 
+  void EvaluateBatch(const TupleBatch &batch, const std::vector<uint32_t> &rows,
+                     std::vector<Value> *result) const override {
+    const std::vector<Value> &column = batch.Column(col_idx_);
+    result->resize(batch.Size());
+    for (uint32_t row : rows) {
+      (*result)[row] = column[row];
+    }
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, uint32_t left_row, const TupleBatch &right,
+                         const std::vector<uint32_t> &rows, std::vector<Value> *result) const override {
+    result->resize(right.Size());
+    if (tuple_idx_ == 0) {
+      const Value &value = left.Column(col_idx_)[left_row];
+      for (uint32_t row : rows) {
+        (*result)[row] = value;
+      }
+    } else {
+      const std::vector<Value> &column = right.Column(col_idx_);
+      for (uint32_t row : rows) {
+        (*result)[row] = column[row];
+      }
+    }
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
@@ -47,13 +47,43 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  void EvaluateBatch(const TupleBatch &batch, const std::vector<uint32_t> &rows,
+                     std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateBatch(batch, rows, &lhs);
+    GetChildAt(1)->EvaluateBatch(batch, rows, &rhs);
+    CompareBatch(lhs, rhs, rows, result);
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, uint32_t left_row, const TupleBatch &right,
+                         const std::vector<uint32_t> &rows, std::vector<Value> *result) const override {
+    std::vector<Value> lhs;
+    std::vector<Value> rhs;
+    GetChildAt(0)->EvaluateJoinBatch(left, left_row, right, rows, &lhs);
+    GetChildAt(1)->EvaluateJoinBatch(left, left_row, right, rows, &rhs);
+    CompareBatch(lhs, rhs, rows, result);
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
     Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /** @return the type of the comparison */
+  ComparisonType GetComparisonType() const { return comp_type_; }
+
  private:
+  // the comparison of lhs[row] and rhs[row] for every given row
+  void CompareBatch(const std::vector<Value> &lhs, const std::vector<Value> &rhs, const std::vector<uint32_t> &rows,
+                    std::vector<Value> *result) const {
+    result->resize(lhs.size());
+    for (uint32_t row : rows) {
+      (*result)[row] = ValueFactory::GetBooleanValue(PerformComparison(lhs[row], rhs[row]));
+    }
+  }
+
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
     switch (comp_type_) {
       case ComparisonType::Equal:
@@ -32,6 +32,22 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  void EvaluateBatch(const TupleBatch &batch, const std::vector<uint32_t> &rows,
+                     std::vector<Value> *result) const override {
+    result->resize(batch.Size());
+    for (uint32_t row : rows) {
+      (*result)[row] = val_;
+    }
+  }
+
+  void EvaluateJoinBatch(const TupleBatch &left, uint32_t left_row, const TupleBatch &right,
+                         const std::vector<uint32_t> &rows, std::vector<Value> *result) const override {
+    result->resize(right.Size());
+    for (uint32_t row : rows) {
+      (*result)[row] = val_;
+    }
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     return val_;
   }
@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels.h
+//
+// Identification: src/include/execution/filter_kernels.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "execution/expressions/comparison_expression.h"
+
+namespace bustub {
+
+/**
+ * The instruction sets a filter kernel can use. The kernels are compiled for
+ * every one of them and GetFilterKernel() picks one when it runs, so a binary
+ * built for any x86-64 machine still uses AVX2 where the CPU has it.
+ */
+enum class SimdLevel { SCALAR, SSE42, AVX2 };
+
+// the widest instruction set this CPU supports, SCALAR on other architectures
+SimdLevel DetectSimdLevel();
+
+/**
+ * A filter kernel compares n fixed-width values against n others, or against
+ * one constant if rhs is nullptr, and writes the result as a bitmap: bit
+ * i % 64 of bitmap[i / 64] is set iff lhs[i] OP rhs[i] (or lhs[i] OP constant).
+ * The bitmap has (n + 63) / 64 words, the bits past n are zero.
+ *
+ * There are kernels for int8_t, int16_t, int32_t, int64_t and double, the
+ * types of TINYINT, SMALLINT, INTEGER, BIGINT and DECIMAL values.
+ */
+template <typename T>
+using FilterKernel = void (*)(const T *lhs, const T *rhs, T constant, size_t n, uint64_t *bitmap);
+
+/**
+ * @param level the instruction set to use, lowered to the one of this CPU if it does not support it
+ * @return the kernel of comparison op over values of type T
+ */
+template <typename T>
+FilterKernel<T> GetFilterKernel(ComparisonType op, SimdLevel level = DetectSimdLevel());
+
+}  // namespace bustub
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
@@ -19,6 +22,11 @@
 namespace bustub {
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * The scan can be limited to a key range: a bound gives one constant expression per key
+ * column, and an empty bound leaves that side open. With reverse set the keys come in
+ * descending order, so ORDER BY ... DESC LIMIT n reads only the leaves it returns.
+ * With parallelism above one the range is cut into that many sub-ranges, which are
+ * scanned by worker threads; the tuples still come out in key order.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -28,9 +36,26 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
    * @param table_oid the identifier of table to be scanned
+   * @param lower_bound the smallest key to scan, or empty
+   * @param lower_inclusive whether lower_bound itself is scanned
+   * @param upper_bound the largest key to scan, or empty
+   * @param upper_inclusive whether upper_bound itself is scanned
+   * @param reverse whether to scan the keys in descending order
+   * @param parallelism the number of threads that scan the range
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    std::vector<const AbstractExpression *> lower_bound = {}, bool lower_inclusive = true,
+                    std::vector<const AbstractExpression *> upper_bound = {}, bool upper_inclusive = true,
+                    bool reverse = false, int parallelism = 1)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        lower_bound_(std::move(lower_bound)),
+        lower_inclusive_(lower_inclusive),
+        upper_bound_(std::move(upper_bound)),
+        upper_inclusive_(upper_inclusive),
+        reverse_(reverse),
+        parallelism_(parallelism) {}
 
   PlanType GetType() const override { return PlanType::IndexScan; }
 
@@ -40,11 +65,34 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return the key columns of the lower bound, empty if the range is open below */
+  const std::vector<const AbstractExpression *> &GetLowerBound() const { return lower_bound_; }
+
+  bool IsLowerInclusive() const { return lower_inclusive_; }
+
+  /** @return the key columns of the upper bound, empty if the range is open above */
+  const std::vector<const AbstractExpression *> &GetUpperBound() const { return upper_bound_; }
+
+  bool IsUpperInclusive() const { return upper_inclusive_; }
+
+  /** @return true if the keys are scanned in descending order */
+  bool IsReverse() const { return reverse_; }
+
+  /** @return the number of threads that scan the range */
+  int GetParallelism() const { return parallelism_; }
+
  private:
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** The key range to scan. */
+  std::vector<const AbstractExpression *> lower_bound_;
+  bool lower_inclusive_;
+  std::vector<const AbstractExpression *> upper_bound_;
+  bool upper_inclusive_;
+  bool reverse_;
+  int parallelism_;
 };
 
 }  // namespace bustub
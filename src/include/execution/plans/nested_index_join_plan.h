@@ -22,22 +22,28 @@
 
 namespace bustub {
 
+// outer tuples whose keys are looked up in the index together
+static constexpr size_t DEFAULT_INDEX_JOIN_BATCH_SIZE = 128;
+
 /**
  * NestedIndexJoinPlanNode is used to represent performing a nested index join between two tables
  * The outer table tuples are propogated using a child executor, but the inner table tuples should be
  * obtained using the outer table tuples as well as the index from the catalog.
+ * The keys of batch_size outer tuples at a time are probed with one Index::ScanKeys() call.
  */
 class NestedIndexJoinPlanNode : public AbstractPlanNode {
  public:
   NestedIndexJoinPlanNode(const Schema *output_schema, std::vector<const AbstractPlanNode *> &&children,
                           const AbstractExpression *predicate, table_oid_t inner_table_oid, std::string index_name,
-                          const Schema *outer_table_schema, const Schema *inner_table_schema)
+                          const Schema *outer_table_schema, const Schema *inner_table_schema,
+                          size_t batch_size = DEFAULT_INDEX_JOIN_BATCH_SIZE)
       : AbstractPlanNode(output_schema, std::move(children)),
         predicate_(predicate),
         inner_table_oid_(inner_table_oid),
         index_name_(std::move(index_name)),
         outer_table_schema_(outer_table_schema),
-        inner_table_schema_(inner_table_schema) {}
+        inner_table_schema_(inner_table_schema),
+        batch_size_(batch_size) {}
 
   PlanType GetType() const override { return PlanType::NestedIndexJoin; }
 
@@ -59,6 +65,9 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   /** @return Schema with needed columns in from the inner table */
   const Schema *InnerTableSchema() const { return inner_table_schema_; }
 
+  /** @return the number of outer tuples whose keys are looked up together */
+  size_t GetBatchSize() const { return batch_size_; }
+
  private:
   /** The nested index join predicate. */
   const AbstractExpression *predicate_;
@@ -66,5 +75,6 @@ class NestedIndexJoinPlanNode : public AbstractPlanNode {
   const std::string index_name_;
   const Schema *outer_table_schema_;
   const Schema *inner_table_schema_;
+  size_t batch_size_;
 };
 }  // namespace bustub
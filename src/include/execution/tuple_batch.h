@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+// rows an executor puts into one batch unless its executor context says otherwise
+static constexpr size_t DEFAULT_BATCH_SIZE = 1024;
+
+/**
+ * TupleBatch is what AbstractExecutor::NextBatch() produces: up to capacity
+ * rows, stored column by column as one vector of values per column of the
+ * schema, and the RID of every row.
+ *
+ * The selection vector lists the rows that are part of the batch, in order.
+ * A filter drops rows by shrinking the selection instead of moving the
+ * columns, so consumers must only read the selected rows.
+ *
+ * A row appended as a tuple keeps a copy of the tuple data, and its values
+ * are read from it when their column is asked for the first time. Columns
+ * that no consumer reads, e.g. the ones a scan's parent does not project, are
+ * never turned into values.
+ */
+class TupleBatch {
+ public:
+  explicit TupleBatch(size_t capacity = DEFAULT_BATCH_SIZE) : capacity_(capacity < 1 ? 1 : capacity) {}
+
+  // empty the batch, its rows will have the columns of schema
+  void Reset(const Schema *schema);
+
+  // append a row with the values of tuple, read with the schema of the batch, and select it
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+
+  // append a row with one value per column of the schema and select it, not in a batch of tuples
+  void AppendRow(const std::vector<Value> &values, const RID &rid);
+
+  // the selected rows become the ones in selection, which must be a subset of them
+  void SetSelection(std::vector<uint32_t> &&selection) { selection_ = std::move(selection); }
+
+  // the row as a tuple of the schema of the batch
+  Tuple RowTuple(uint32_t row) const;
+
+  const Schema *GetSchema() const { return schema_; }
+  size_t GetCapacity() const { return capacity_; }
+  // rows appended since the last Reset(), selected or not
+  size_t Size() const { return rids_.size(); }
+  bool IsFull() const { return Size() >= capacity_; }
+  const std::vector<uint32_t> &Selection() const { return selection_; }
+  size_t SelectedCount() const { return selection_.size(); }
+  const std::vector<Value> &Column(uint32_t col_idx) const {
+    if (columns_[col_idx].size() < tuple_offsets_.size()) {
+      ReadColumn(col_idx);
+    }
+    return columns_[col_idx];
+  }
+  const RID &GetRid(uint32_t row) const { return rids_[row]; }
+
+ private:
+  // read the values of the tuples appended since the column was last read
+  void ReadColumn(uint32_t col_idx) const;
+
+  const Schema *schema_{nullptr};
+  size_t capacity_;
+  // filled by Column() for the rows appended as tuples
+  mutable std::vector<std::vector<Value>> columns_;
+  // the data of the tuples one after the other, the i-th one from tuple_offsets_[i] up to the next one
+  std::vector<char> tuple_data_;
+  std::vector<uint32_t> tuple_offsets_;
+  std::vector<RID> rids_;
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace bustub
@@ -91,6 +91,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of pages allocated in the database file, 0 for a new file */
+  inline int GetNumPages() const { return next_page_id_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+// prefix bytes an inner node stores, longer prefixes are checked against the leaf at the end of a lookup
+static constexpr uint32_t ART_MAX_PREFIX = 8;
+// retired nodes an ArtEpochManager collects before it tries to free them
+static constexpr size_t ART_RECLAIM_BATCH = 128;
+
+/**
+ * Epoch based reclamation for the lock-free readers of AdaptiveRadixTree.
+ *
+ * Readers take no latches, so a node that a writer unlinks from the tree can
+ * still be read by operations that started before. Every operation runs
+ * within an epoch (see ArtEpochGuard), and an unlinked node is retired with
+ * the epoch it was unlinked in. It is freed once every running operation
+ * started in a later epoch. One manager serves all trees.
+ */
+class ArtEpochManager {
+ public:
+  static ArtEpochManager &Instance();
+
+  ~ArtEpochManager();
+
+  // enter and exit the epoch of the calling thread, calls nest
+  void Enter();
+  void Exit();
+
+  // free node with deleter once no running operation can reach it
+  void Retire(void *node, void (*deleter)(void *));
+
+ private:
+  struct Slot {
+    // the epoch the thread entered in, 0 when it runs no operation
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<bool> in_use_{false};
+    int depth_{0};
+  };
+
+  struct Retired {
+    void *node_;
+    void (*deleter_)(void *);
+    uint64_t epoch_;
+  };
+
+  Slot *ThreadSlot();
+
+  // free the retired nodes no operation can reach, latch_ must be held
+  void Reclaim();
+
+  std::atomic<uint64_t> global_epoch_{1};
+  std::mutex latch_;
+  // one slot per thread, a slot is reused once its thread exits
+  std::deque<Slot> slots_;
+  std::vector<Retired> retired_;
+};
+
+// keeps the calling thread in an epoch for its lifetime
+class ArtEpochGuard {
+ public:
+  ArtEpochGuard() { ArtEpochManager::Instance().Enter(); }
+  ~ArtEpochGuard() { ArtEpochManager::Instance().Exit(); }
+  ArtEpochGuard(const ArtEpochGuard &) = delete;
+  ArtEpochGuard &operator=(const ArtEpochGuard &) = delete;
+};
+
+/**
+ * In-memory adaptive radix tree (Leis et al., ICDE 2013) over byte string
+ * keys, e.g. keys built by KeyEncoder. Keys are unique, and no key may be a
+ * prefix of another one, so every key ends at a leaf.
+ *
+ * An inner node branches on one key byte and grows from 4 to 16, 48 and 256
+ * children as needed, and shrinks back on deletes. Chains of nodes with a
+ * single child are compressed into the prefix of the node below them; a node
+ * stores up to ART_MAX_PREFIX prefix bytes, and longer prefixes are only
+ * checked against the key of the leaf a lookup ends at. Leaves hold the whole
+ * key and the value and are never changed once in the tree.
+ *
+ * Concurrency: optimistic lock coupling (Leis et al., DaMoN 2016). Every inner
+ * node has a version. Readers take no latches, they read a node and validate
+ * its version afterwards, and restart from the root if it changed. Writers
+ * descend the same way and write lock only the one or two nodes they modify,
+ * by upgrading the version they read. Replaced nodes are marked obsolete and
+ * freed through the ArtEpochManager. The root is a node with 256 children that
+ * is never replaced.
+ */
+template <typename ValueType>
+class AdaptiveRadixTree {
+ public:
+  AdaptiveRadixTree();
+
+  ~AdaptiveRadixTree();
+
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  AdaptiveRadixTree &operator=(const AdaptiveRadixTree &) = delete;
+
+  // Insert a key-value pair, false if the key is already there.
+  bool Insert(const std::string &key, const ValueType &value);
+
+  // Remove a key and its value, false if the key is not there.
+  bool Remove(const std::string &key);
+
+  // return the value associated with a given key
+  bool GetValue(const std::string &key, ValueType *value);
+
+  // append the values of every key starting with prefix to result, in key order
+  void ScanPrefix(const std::string &prefix, std::vector<ValueType> *result);
+
+ private:
+  enum class NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+  // the outcome of one attempt of an operation, RESTART if a node changed under it
+  enum class OpResult { RESTART, SUCCESS, FAILURE };
+
+  struct Node {
+    explicit Node(NodeType type) : type_(type) {}
+
+    // start an optimistic read, false if the node is write locked or obsolete
+    bool ReadLock(uint64_t *version) const {
+      *version = version_.load(std::memory_order_acquire);
+      return (*version & 3) == 0;
+    }
+    // true if the node did not change since ReadLock() returned version
+    bool Validate(uint64_t version) const {
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return version_.load(std::memory_order_relaxed) == version;
+    }
+    // turn the read of version into a write lock, false if the node changed since
+    bool Upgrade(uint64_t version) { return version_.compare_exchange_strong(version, version + 2); }
+    void WriteUnlock() { version_.fetch_add(2, std::memory_order_release); }
+    // unlock a node that was replaced, readers that see it restart
+    void WriteUnlockObsolete() { version_.fetch_add(3, std::memory_order_release); }
+
+    // bit 0: obsolete, bit 1: write locked
+    std::atomic<uint64_t> version_{0};
+    const NodeType type_;
+    uint16_t count_{0};
+    uint32_t prefix_length_{0};
+    uint8_t prefix_[ART_MAX_PREFIX]{};
+  };
+
+  struct Node4 : Node {
+    Node4() : Node(NodeType::NODE4) {}
+    uint8_t keys_[4]{};
+    Node *children_[4]{};
+  };
+
+  struct Node16 : Node {
+    Node16() : Node(NodeType::NODE16) {}
+    uint8_t keys_[16]{};
+    Node *children_[16]{};
+  };
+
+  struct Node48 : Node {
+    Node48() : Node(NodeType::NODE48) {}
+    // slot of the child of every byte plus one, 0 for none
+    uint8_t child_index_[256]{};
+    Node *children_[48]{};
+  };
+
+  struct Node256 : Node {
+    Node256() : Node(NodeType::NODE256) {}
+    Node *children_[256]{};
+  };
+
+  struct Leaf {
+    Leaf(std::string key, ValueType value) : key_(std::move(key)), value_(value) {}
+    std::string key_;
+    ValueType value_;
+  };
+
+  // leaves are told apart from inner nodes by the low bit of the child pointer
+  static bool IsLeaf(const Node *node) { return (reinterpret_cast<uintptr_t>(node) & 1) != 0; }
+  static Leaf *AsLeaf(const Node *node) { return reinterpret_cast<Leaf *>(reinterpret_cast<uintptr_t>(node) & ~1); }
+  static Node *MakeLeaf(const std::string &key, const ValueType &value) {
+    return reinterpret_cast<Node *>(reinterpret_cast<uintptr_t>(new Leaf(key, value)) | 1);
+  }
+
+  static uint8_t KeyByte(const std::string &key, size_t depth) { return static_cast<uint8_t>(key[depth]); }
+
+  OpResult InsertOnce(const std::string &key, const ValueType &value);
+  OpResult RemoveOnce(const std::string &key);
+  OpResult GetValueOnce(const std::string &key, ValueType *value);
+  // the leaves that may start with prefix, the caller checks their keys
+  OpResult ScanOnce(const std::string &prefix, std::vector<const Leaf *> *leaves);
+
+  /*
+   * Node content, the callers hold the write lock for changes or validate the
+   * version after a read.
+   */
+  static Node *NewNode(NodeType type);
+  static int Capacity(NodeType type);
+  static Node *FindChild(const Node *node, uint8_t byte);
+  // the node must have room
+  static void AddChild(Node *node, uint8_t byte, Node *child);
+  static void RemoveChild(Node *node, uint8_t byte);
+  static void ChangeChild(Node *node, uint8_t byte, Node *child);
+  // the (byte, child) pairs of node in byte order, returns their number
+  static int Children(const Node *node, uint8_t *bytes, Node **children);
+  // a copy of node of the given type without the child of skip (if skip >= 0)
+  static Node *CopyNode(const Node *node, NodeType type, int skip);
+  // the whole prefix of node, whose subtree starts at depth of the keys below it
+  static std::string FullPrefix(const Node *node, size_t depth);
+  static void SetPrefix(Node *node, const char *prefix, uint32_t length);
+  // compare the stored prefix bytes of node with key at depth, the bytes past ART_MAX_PREFIX are skipped
+  static bool PrefixMatches(const Node *node, const std::string &key, size_t depth);
+
+  static void DeleteNode(void *node);
+  static void DeleteLeaf(void *leaf);
+  static void FreeSubtree(Node *node);
+
+  // collect the leaves below node in key order, false if a node changed on the way
+  static bool CollectLeaves(const Node *node, std::vector<const Leaf *> *leaves);
+
+  Node256 *root_;
+};
+
+}  // namespace bustub
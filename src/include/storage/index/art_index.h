@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+#include "storage/index/key_encoder.h"
+
+namespace bustub {
+
+/**
+ * In-memory index on top of AdaptiveRadixTree, for point lookups that should
+ * not go through the buffer pool. Entries are built as in
+ * VarlenBPlusTreeIndex: the KeyEncoder encoding of the key followed by the
+ * RID, so that equal keys get distinct entries and no entry is a prefix of
+ * another one. Nothing is written to disk, the index is rebuilt from its table
+ * when the catalog is reopened.
+ */
+class ArtIndex : public Index {
+ public:
+  explicit ArtIndex(IndexMetadata *metadata);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+ protected:
+  std::string EncodeKey(const Tuple &key) const;
+
+  std::string EncodeEntry(const Tuple &key, RID rid) const;
+
+  KeyEncoder encoder_;
+  // container
+  AdaptiveRadixTree<RID> container_;
+};
+
+}  // namespace bustub
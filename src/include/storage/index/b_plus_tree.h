@@ -10,40 +10,98 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "storage/index/external_sort.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
 enum class LockMode { READ = 0, WRITE };
-enum class Operation {SEARCH=0,INSERT,DELETE};
+// COMPACT descends like DELETE, but keeps a leaf's parent latched whenever the leaf is below half full
+enum class Operation {SEARCH=0,INSERT,DELETE,COMPACT};
+
+// fraction of a page that bulk loading fills, the rest is left for later inserts
+static constexpr double DEFAULT_FILL_FACTOR = 0.9;
+// fraction of a leaf below which a delete merges or redistributes it, 0.5 keeps leaves half full
+static constexpr double DEFAULT_MERGE_THRESHOLD = 0.5;
+// subtrees between the bounds of a range that EstimateRangeCount() samples for their size
+static constexpr int RANGE_ESTIMATE_SAMPLES = 8;
+
+// a buffered insert or delete of one value, see BPlusTree::ApplyMessages()
+template <typename KeyType, typename ValueType>
+struct BPlusTreeMessage {
+  KeyType key_;
+  ValueType value_;
+  bool insert_;
+};
+
+// structure modifications done by a tree since it was created
+struct BPlusTreeStats {
+  uint64_t splits_;
+  uint64_t merges_;
+  uint64_t redistributions_;
+  // merges done by Compact(), they are also counted in merges_
+  uint64_t compactions_;
+};
 
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the tree is created with unique_keys = false:
+ *     then a key with several values keeps them in a posting list
+ *     (see BPlusTreePostingPage) and the key itself is stored only once
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency: writers first descend optimistically, read latching the
+ * internal pages and write latching only the leaf. If the leaf would split or
+ * underflow they release it and restart with pessimistic crabbing, write
+ * latching every page that may be modified (kept in the transaction's page
+ * set) and releasing the ancestors as soon as a safe page is reached.
+ * Point lookups use optimistic lock coupling instead: they take no latch,
+ * remember each page's version and validate it after reading, restarting if
+ * a writer got in between.
+ *
+ * An empty tree can also be bulk loaded bottom-up from sorted input, see
+ * BulkLoad().
+ *
+ * Deletes merge lazily: a leaf is only merged or redistributed once it falls
+ * below merge_threshold of its capacity (with 0 only when it is empty), so a
+ * workload that deletes and inserts around half full does not keep merging
+ * and splitting the same pages. The sparse leaves this leaves behind are
+ * re-packed by Compact(), which can run next to the other operations, e.g.
+ * from the background thread of StartCompaction().
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using PostingPage = BPlusTreePostingPage<ValueType>;
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool unique_keys = true, double merge_threshold = DEFAULT_MERGE_THRESHOLD);
+
+  ~BPlusTree() { StopCompaction(); }
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -51,19 +109,54 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  // Build an empty tree bottom-up from the pairs in sorter, filling pages to fill_factor of their capacity.
+  bool BulkLoad(ExternalMergeSort<KeyType, ValueType, KeyComparator> *sorter, double fill_factor = DEFAULT_FILL_FACTOR);
 
+  // Attach to the tree an earlier instance of this index left on disk, the root is read from the header page.
+  // Returns false if the header page has no record of the index.
+  bool Open();
 
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove one value of a key, the key goes away with its last value.
+  bool Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // apply inserts and deletes of values sorted by key, descending once per leaf instead of once per message
+  void ApplyMessages(const std::vector<BPlusTreeMessage<KeyType, ValueType>> &messages,
+                     Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // batched point lookups, (*results)[i] gets the values of keys[i]
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
+  // iterator over the keys in range, in descending order if reverse is set; it compares equal to end() when done
+  INDEXITERATOR_TYPE Begin(const IndexKeyRange<KeyType> &range, bool reverse = false);
   INDEXITERATOR_TYPE end();
 
+  // merge every leaf below half full into a neighbor it fits into, returns the number of merges
+  size_t Compact(Transaction *transaction = nullptr);
+
+  // run Compact() every interval on a background thread until StopCompaction()
+  void StartCompaction(std::chrono::milliseconds interval);
+  void StopCompaction();
+
+  BPlusTreeStats GetStats() const {
+    return {splits_.load(), merges_.load(), redistributions_.load(), compactions_.load()};
+  }
+
+  // cut range into at most parts consecutive sub-ranges at internal page separators, to scan them in parallel
+  std::vector<IndexKeyRange<KeyType>> PartitionRange(const IndexKeyRange<KeyType> &range, int parts);
+
+  // approximate number of entries in range from the pages on the paths to its bounds, in O(log n) page reads
+  size_t EstimateRangeCount(const IndexKeyRange<KeyType> &range);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -82,28 +175,107 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
-  Page *FindLeafPage(const KeyType &key,Operation op, bool leftMost = false);
+  // read latches the path and returns the leaf latched for op, or nullptr if the tree is empty; if upper is given,
+  // it is set to the separator that bounds the leaf on the right, *has_upper is false for the rightmost leaf
+  Page *FindLeafPage(const KeyType &key, Operation op, bool leftMost = false, bool rightMost = false,
+                     KeyType *upper = nullptr, bool *has_upper = nullptr);
 
  private:
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  // build one internal level on top of level, a list of (first key, page id) that is replaced by the new level
+  void BuildInternalLevel(std::vector<std::pair<KeyType, page_id_t>> *level, double fill_factor);
+
+  // latch-free lookup, returns false if a concurrent write was detected and the lookup has to restart
+  bool OptimisticLookup(const KeyType &key, ValueType *value, bool *found);
+
+  // a page on the path of a batched lookup, kept pinned together with the version it was read at
+  struct PathEntry {
+    Page *page_;
+    uint64_t version_;
+  };
+
+  // latch-free lookup that resumes from the deepest page of path covering key, false if it has to fall back
+  bool PathLookup(const KeyType &key, std::vector<PathEntry> *path, std::vector<ValueType> *result);
+
+  void ReleasePath(std::vector<PathEntry> *path);
+
+  // collect the separators inside range of the read latched internal page and of its subtree down to depth
+  void EstimatePath(const KeyType *key, bool past_key, std::vector<std::pair<int, int>> *path,
+                    const std::vector<std::pair<int, int>> *upper_path = nullptr,
+                    std::vector<std::vector<int>> *samples = nullptr);
+  void SamplePath(Page *page, std::vector<int> *sizes);
+  void CollectSeparators(Page *page, const IndexKeyRange<KeyType> &range, int depth, std::vector<KeyType> *separators,
+                         bool *deeper);
+
+  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction);
 
+  // apply message to the write latched leaf, false if it would split or merge the leaf and was not applied
+  bool ApplyToLeaf(LeafPage *node, const BPlusTreeMessage<KeyType, ValueType> &message);
+
+  // removes value from key, or the whole key if value is nullptr
+  bool RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  bool RemoveFromLeaf(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  // collect the first key of every leaf below half full in the subtree of the read latched internal page
+  void CollectSparseLeaves(Page *page, std::vector<KeyType> *keys);
+
+  // merge the leaf of key into a neighbor if it is below half full and fits, true if it was merged
+  bool CompactLeaf(const KeyType &key, Transaction *transaction);
+
+  // true if value is a posting list reference, always false for a tree with unique keys
+  bool IsPostingList(const ValueType &value) const { return !unique_keys_ && PostingPage::IsPostingList(value); }
+
+  // the posting list helpers must be called with the leaf write latched
+  bool AddToPostingList(LeafPage *node, int index, const ValueType &value);
+
+  bool RemoveFromPostingList(LeafPage *node, int index, const ValueType &value);
+
+  void CollectPostingList(const ValueType &reference, std::vector<ValueType> *result);
+
+  void DeletePostingList(const ValueType &reference);
+
+  // @return a reference to an empty segment of size_class, the page class starts a page in front of next_page_id
+  ValueType NewPostingSegment(int size_class, page_id_t next_page_id);
+
+  void FreePostingSegment(const ValueType &reference);
+
+  PostingPage *FetchPostingPage(page_id_t page_id);
+
+  // write latches the path, keeping the unsafe ancestors in the transaction's page set
+  Page *FindLeafPageExclusive(const KeyType &key, Operation op, Transaction *transaction);
+
+  // unlatch and unpin every page in the transaction's page set, nullptr stands for the root latch
+  void ReleaseLatchedPages(Transaction *transaction, bool is_dirty);
+
+  void DeleteReleasedPages(Transaction *transaction);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
 
-  void LockPage(Page *page,LockMode mode);
+  void LatchPage(Page *page, LockMode mode);
 
-  template <typename N>
-  void UnlockAndUnpinPageOfNode(N* node,bool is_dirty, LockMode mode);
+  void UnlatchAndUnpinPage(Page *page, LockMode mode, bool is_dirty);
+
+  void SetPrevLink(page_id_t page_id, page_id_t prev_page_id);
+
+  // the pinned leaf holding the greatest key below key, where a reverse iterator goes on when a prev link is stale
+  Page *FindLeafBefore(const KeyType &key, int *index);
+
+  // a page is safe if op cannot split or merge it, so its ancestors can be released
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
+  // size below which a delete merges or redistributes node, see merge_threshold_
+  int MergeSize(BPlusTreePage *node) const;
 
   template <typename N>
   N *Split(N *node);
 
+  // with merge_only the pages are left alone if they do not fit into one
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr, bool merge_only = false);
 
   template <typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
@@ -122,15 +294,30 @@ class BPlusTree {
   void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
 
   // member variable
-  std::mutex latch_;
+  // protects root_page_id_ for writers, optimistic readers load it without the latch
+  ReaderWriterLatch root_latch_;
   std::string index_name_;
-  page_id_t root_page_id_;
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
-  std::unordered_map<page_id_t ,Page*> lock_map_;
-
+  bool unique_keys_;
+  // leaves (but not internal pages) merge below this fraction of leaf_max_size_
+  double merge_threshold_;
+  std::atomic<uint64_t> splits_{0};
+  std::atomic<uint64_t> merges_{0};
+  std::atomic<uint64_t> redistributions_{0};
+  std::atomic<uint64_t> compactions_{0};
+  // the compaction thread sleeps on compaction_cv_, so that StopCompaction() need not wait out the interval
+  std::thread compaction_thread_;
+  std::mutex compaction_latch_;
+  std::condition_variable compaction_cv_;
+  bool enable_compaction_{false};
+  // serializes segment allocation, which changes the header of posting pages shared by several leaves
+  std::mutex posting_latch_;
+  // per size class a posting page that has free segments, or INVALID_PAGE_ID
+  page_id_t posting_free_page_[POSTING_PAGE_CLASS];
 };
 
 }  // namespace bustub
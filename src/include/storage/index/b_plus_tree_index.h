@@ -25,7 +25,8 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+  // with unique_keys unset every key keeps a posting list of all the rids inserted under it
+  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager, bool unique_keys = true);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -33,9 +34,29 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
-  INDEXITERATOR_TYPE GetBeginIterator();
+  // probes the keys in sorted order, sharing the path from the root between neighbors
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
 
-  INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
+  // build the still empty index bottom-up from the (key, rid) pairs collected in sorter
+  bool BulkLoad(ExternalMergeSort<KeyType, ValueType, KeyComparator> *sorter, double fill_factor = DEFAULT_FILL_FACTOR);
+
+  // reopen the tree this index left on disk, false if there is none
+  bool Open();
+
+  // the iterators are virtual so that an index that defers writes can apply them before a scan
+  virtual INDEXITERATOR_TYPE GetBeginIterator();
+
+  virtual INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
+
+  // iterator over the keys in range, descending if reverse is set
+  virtual INDEXITERATOR_TYPE GetRangeIterator(const IndexKeyRange<KeyType> &range, bool reverse = false);
+
+  // cut range into at most parts sub-ranges that can be scanned in parallel
+  std::vector<IndexKeyRange<KeyType>> PartitionRange(const IndexKeyRange<KeyType> &range, int parts);
+
+  // approximate number of entries in range, for choosing between a sequential and an index scan
+  virtual size_t EstimateRangeCount(const IndexKeyRange<KeyType> &range);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+// filter bits per key the filter is sized for
+static constexpr size_t BLOOM_FILTER_BITS_PER_KEY = 12;
+// keys a filter is sized for at least
+static constexpr size_t BLOOM_FILTER_MIN_KEYS = 1024;
+
+/**
+ * Blocked Bloom filter over 64 bit hashes, in the split block layout of
+ * Putze et al. and Apache Impala. The filter is an array of 256 bit blocks
+ * of eight 32 bit words, and a hash sets one bit in every word of a single
+ * block. A lookup thus reads one half of a cache line, and checks the eight
+ * bits at once with AVX2 where available.
+ *
+ * Inserts are atomic, so keys can be added while the filter is read. There
+ * is no delete; see IndexBloomFilter for filters whose keys go away.
+ */
+class BlockedBloomFilter {
+ public:
+  // a filter sized for num_keys keys
+  explicit BlockedBloomFilter(size_t num_keys);
+
+  void Insert(uint64_t hash);
+
+  // false if the hash was never inserted, true if it probably was
+  bool MayContain(uint64_t hash) const;
+
+  size_t GetBlockCount() const { return blocks_.size(); }
+
+ private:
+  struct alignas(32) Block {
+    uint32_t words_[8];
+  };
+
+  // the block of the high half of hash
+  size_t BlockIndex(uint64_t hash) const {
+    return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(blocks_.size())) >> 32);
+  }
+
+  std::vector<Block> blocks_;
+};
+
+/**
+ * Bloom filter over the keys of an index, consulted by ScanKey() before the
+ * index itself so that lookups of missing keys skip the descent or probe.
+ * Keys are hashed from their tuple bytes, so one filter fits every index type.
+ *
+ * Deleted keys cannot be taken out of a Bloom filter, they only add false
+ * positives. Once the deletes since the last build pass half the keys the
+ * filter was built with, it is built again from scratch with the keys the
+ * refill function supplies, e.g. from a scan of the table. That happens on a
+ * background thread, so the delete that triggers it does not wait for the
+ * scan. Lookups go on against the old filter meanwhile, and keys added during
+ * the rebuild are put into both.
+ */
+class IndexBloomFilter {
+ public:
+  // calls its argument with every key of the index
+  using Refill = std::function<void(const std::function<void(const Tuple &)> &)>;
+
+  // builds the filter from the keys refill supplies
+  explicit IndexBloomFilter(Refill refill);
+
+  ~IndexBloomFilter() { WaitForRebuild(); }
+
+  // to be called before the key goes into the index
+  void Add(const Tuple &key);
+
+  // to be called after the key left the index, may start a rebuild of the filter in the background
+  void Remove(const Tuple &key);
+
+  // false if the index does not have key
+  bool MayContain(const Tuple &key) const;
+
+  // build the filter again from the keys refill supplies, sized for their number
+  void Rebuild();
+
+  // wait for the background rebuild that Remove() started, if any
+  void WaitForRebuild();
+
+  // number of builds so far, the first one included
+  size_t GetBuildCount() const { return builds_; }
+
+ private:
+  static uint64_t Hash(const Tuple &key);
+
+  // the rebuild itself, the caller has set rebuilding_
+  void Build();
+
+  Refill refill_;
+  std::shared_ptr<BlockedBloomFilter> filter_;
+  // keys the current filter was built with or got added since, and deletes since it was built
+  std::atomic<size_t> keys_{0};
+  std::atomic<size_t> deletes_{0};
+
+  // set while a rebuild scans, latch_ guards pending_ and the end of a rebuild
+  std::atomic<bool> rebuilding_{false};
+  std::mutex latch_;
+  // the hashes of the keys added during the rebuild
+  std::vector<uint64_t> pending_;
+  std::atomic<size_t> builds_{0};
+  // the thread of the last background rebuild, thread_latch_ guards starting and joining it
+  std::thread rebuild_thread_;
+  std::mutex thread_latch_;
+};
+
+}  // namespace bustub
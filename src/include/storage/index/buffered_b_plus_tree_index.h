@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/buffered_b_plus_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "storage/index/b_plus_tree_index.h"
+
+namespace bustub {
+
+#define BUFFERED_BPLUSTREE_INDEX_TYPE BufferedBPlusTreeIndex<KeyType, ValueType, KeyComparator>
+
+// number of inserts and deletes a BufferedBPlusTreeIndex holds back before it flushes them into the tree
+static constexpr size_t DEFAULT_INDEX_BUFFER_SIZE = 4096;
+
+/**
+ * Write-optimized B+ tree index, after the message buffers of a B-epsilon
+ * tree. Inserts and deletes do not descend the tree, they are queued as
+ * messages in a buffer in front of the root. Once the buffer is full its
+ * messages are flushed down in key order with BPlusTree::ApplyMessages(),
+ * which descends once per leaf instead of once per message, so an insert
+ * heavy workload fetches and writes each leaf about once per flush instead of
+ * once per insert. An insert and a delete of the same entry that meet in the
+ * buffer cancel out; like in the tree, the values of a key are expected to be
+ * distinct.
+ *
+ * Point lookups merge the buffered messages of the key into the values found
+ * in the tree, scans flush the buffer first. The buffer lives in memory, so
+ * messages that were not flushed yet are lost with the index.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class BufferedBPlusTreeIndex : public BPlusTreeIndex<KeyType, ValueType, KeyComparator> {
+  using Message = BPlusTreeMessage<KeyType, ValueType>;
+
+ public:
+  BufferedBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+                         size_t buffer_size = DEFAULT_INDEX_BUFFER_SIZE, bool unique_keys = true);
+
+  ~BufferedBPlusTreeIndex() override { Flush(); }
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  INDEXITERATOR_TYPE GetBeginIterator() override;
+
+  INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key) override;
+
+  INDEXITERATOR_TYPE GetRangeIterator(const IndexKeyRange<KeyType> &range, bool reverse = false) override;
+
+  // the estimate of the tree plus the buffered inserts in range, less the buffered deletes
+  size_t EstimateRangeCount(const IndexKeyRange<KeyType> &range) override;
+
+  // apply every buffered message to the tree
+  void Flush(Transaction *transaction = nullptr);
+
+  // number of messages waiting in the buffer
+  size_t GetBufferedCount();
+
+ private:
+  struct KeyLess {
+    bool operator()(const KeyType &a, const KeyType &b) const { return comparator_(a, b) < 0; }
+    KeyComparator comparator_;
+  };
+
+  // the buffer latch must be held in write mode
+  void AddMessage(const KeyType &key, const ValueType &value, bool insert, Transaction *transaction);
+
+  void FlushBuffer(Transaction *transaction);
+
+  // apply the buffered messages of key to the values read from the tree, the buffer latch must be held
+  void MergeMessages(const KeyType &key, std::vector<ValueType> *result);
+
+  // protects the buffer, and is held in write mode while it is flushed so that lookups never miss a message
+  ReaderWriterLatch buffer_latch_;
+  // the messages of every key, in the order they were made
+  std::map<KeyType, std::vector<std::pair<ValueType, bool>>, KeyLess> buffer_;
+  size_t buffered_count_{0};
+  size_t buffer_size_;
+};
+
+}  // namespace bustub
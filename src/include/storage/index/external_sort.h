@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+/**
+ * Sorts (key, value) pairs that may not fit in memory, used to feed
+ * BPlusTree::BulkLoad().
+ *
+ * Pairs are collected in memory until memory_limit bytes are used. The full
+ * buffer is then sorted and spilled to an anonymous temporary file as one run.
+ * Finish() sorts the last buffer; if nothing was spilled the pairs are returned
+ * straight from memory, otherwise all runs are k-way merged while Next() is
+ * called. The temporary files are removed when the sorter is destroyed.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExternalMergeSort {
+  using ItemType = std::pair<KeyType, ValueType>;
+
+ public:
+  static constexpr size_t DEFAULT_MEMORY_LIMIT = 32 << 20;
+
+  explicit ExternalMergeSort(const KeyComparator &comparator, size_t memory_limit = DEFAULT_MEMORY_LIMIT)
+      : comparator_(comparator), run_capacity_(std::max<size_t>(memory_limit / sizeof(ItemType), 1)) {}
+
+  ~ExternalMergeSort() {
+    for (auto *run : runs_) {
+      fclose(run);
+    }
+  }
+
+  ExternalMergeSort(const ExternalMergeSort &) = delete;
+  ExternalMergeSort &operator=(const ExternalMergeSort &) = delete;
+
+  /** Add a pair, spilling the buffer as a sorted run once it is full. Must not be called after Finish(). */
+  void Add(const KeyType &key, const ValueType &value) {
+    buffer_.emplace_back(key, value);
+    if (buffer_.size() >= run_capacity_) {
+      SpillRun();
+    }
+  }
+
+  /** Sort what is still buffered and prepare the merge, Next() can be called afterwards. */
+  void Finish() {
+    if (runs_.empty()) {
+      SortBuffer();
+      next_ = 0;
+      return;
+    }
+    if (!buffer_.empty()) {
+      SpillRun();
+    }
+    std::vector<ItemType>().swap(buffer_);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      rewind(runs_[i]);
+      ItemType item;
+      if (ReadItem(runs_[i], &item)) {
+        heap_.push(HeapEntry{item, i});
+      }
+    }
+  }
+
+  /** Get the next pair in key order. @return false once every pair was returned */
+  bool Next(KeyType *key, ValueType *value) {
+    if (runs_.empty()) {
+      if (next_ >= buffer_.size()) {
+        return false;
+      }
+      *key = buffer_[next_].first;
+      *value = buffer_[next_].second;
+      next_++;
+      return true;
+    }
+    if (heap_.empty()) {
+      return false;
+    }
+    HeapEntry top = heap_.top();
+    heap_.pop();
+    *key = top.item_.first;
+    *value = top.item_.second;
+    ItemType item;
+    if (ReadItem(runs_[top.run_], &item)) {
+      heap_.push(HeapEntry{item, top.run_});
+    }
+    return true;
+  }
+
+  /** @return the number of runs spilled to disk, 0 if the input was sorted in memory */
+  size_t GetRunCount() const { return runs_.size(); }
+
+ private:
+  struct HeapEntry {
+    ItemType item_;
+    size_t run_;
+  };
+
+  // orders the merge heap so that the smallest key is on top
+  struct HeapGreater {
+    const KeyComparator *comparator_;
+    bool operator()(const HeapEntry &lhs, const HeapEntry &rhs) const {
+      return (*comparator_)(lhs.item_.first, rhs.item_.first) > 0;
+    }
+  };
+
+  void SortBuffer() {
+    std::sort(buffer_.begin(), buffer_.end(), [this](const ItemType &lhs, const ItemType &rhs) {
+      return comparator_(lhs.first, rhs.first) < 0;
+    });
+  }
+
+  void SpillRun() {
+    SortBuffer();
+    FILE *run = tmpfile();
+    if (run == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot create a temporary file for the sort run");
+    }
+    runs_.push_back(run);
+    if (fwrite(buffer_.data(), sizeof(ItemType), buffer_.size(), run) != buffer_.size()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot write the sort run");
+    }
+    buffer_.clear();
+  }
+
+  static bool ReadItem(FILE *run, ItemType *item) { return fread(item, sizeof(ItemType), 1, run) == 1; }
+
+  KeyComparator comparator_;
+  size_t run_capacity_;
+  std::vector<ItemType> buffer_;
+  size_t next_{0};
+  std::vector<FILE *> runs_;
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, HeapGreater> heap_{HeapGreater{&comparator_}};
+};
+
+}  // namespace bustub
@@ -12,9 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 
 #include "storage/table/tuple.h"
+#include "type/limits.h"
 #include "type/value.h"
 #include "common/logger.h"
 namespace bustub {
@@ -72,35 +74,135 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * The key schema is compiled into a fixed table of (type, offset) pairs when
+ * the comparator is constructed, so a comparison reads the raw column bytes
+ * and compares them as native integers / doubles / strings without building
+ * Value objects. NULL columns sort before every other value: their storage
+ * sentinel is the minimum value of their type, except for TIMESTAMP, whose
+ * sentinel is the maximum and which is compared plus one, wrapping it around
+ * to zero.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
+    if (int64_key_) {
+      return Compare(Load<int64_t>(lhs.data_), Load<int64_t>(rhs.data_));
+    }
+    for (uint32_t i = 0; i < column_count_; i++) {
+      int result = CompareColumn(columns_[i], lhs.data_, rhs.data_);
+      if (result != 0) {
+        return result;
       }
     }
     // equals
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : int64_key_{other.int64_key_}, column_count_{other.column_count_} {
+    memcpy(columns_, other.columns_, sizeof(KeyColumn) * column_count_);
+  }
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema)
+      : int64_key_(key_schema->GetColumnCount() == 1 && key_schema->GetColumn(0).GetType() == TypeId::BIGINT &&
+                   key_schema->GetColumn(0).GetOffset() == 0 && KeySize >= sizeof(int64_t)),
+        column_count_(0) {
+    for (const auto &col : key_schema->GetColumns()) {
+      // columns that do not fit into the key were truncated away by SetFromKey
+      if (col.GetOffset() + col.GetFixedLength() > KeySize) {
+        break;
+      }
+      columns_[column_count_++] = KeyColumn{col.GetType(), col.GetOffset()};
+    }
+  }
+
+  /**
+   * @return true if the key is a single BIGINT column stored at offset 0, i.e. the first 8 bytes of the key can be
+   * compared as a plain int64_t. Key searches use this to pick a SIMD path.
+   */
+  inline bool IsInt64Key() const { return int64_key_; }
 
  private:
-  Schema *key_schema_;
+  struct KeyColumn {
+    TypeId type_;
+    uint32_t offset_;
+  };
+  // every column takes at least one byte of the key, so the columns that fit into it always have a slot
+  static constexpr uint32_t MAX_COLUMNS = KeySize;
+
+  template <typename T>
+  static inline T Load(const char *data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+  }
+
+  template <typename T>
+  static inline int Compare(T lhs, T rhs) {
+    return (lhs > rhs) - (lhs < rhs);
+  }
+
+  static inline int CompareColumn(const KeyColumn &col, const char *lhs, const char *rhs) {
+    switch (col.type_) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return Compare(Load<int8_t>(lhs + col.offset_), Load<int8_t>(rhs + col.offset_));
+      case TypeId::SMALLINT:
+        return Compare(Load<int16_t>(lhs + col.offset_), Load<int16_t>(rhs + col.offset_));
+      case TypeId::INTEGER:
+        return Compare(Load<int32_t>(lhs + col.offset_), Load<int32_t>(rhs + col.offset_));
+      case TypeId::BIGINT:
+        return Compare(Load<int64_t>(lhs + col.offset_), Load<int64_t>(rhs + col.offset_));
+      case TypeId::DECIMAL:
+        return Compare(Load<double>(lhs + col.offset_), Load<double>(rhs + col.offset_));
+      case TypeId::TIMESTAMP:
+        return Compare(Load<uint64_t>(lhs + col.offset_) + 1, Load<uint64_t>(rhs + col.offset_) + 1);
+      case TypeId::VARCHAR:
+        return CompareVarchar(lhs, rhs, col.offset_);
+      default:
+        return 0;
+    }
+  }
+
+  // the column holds the offset of a (uint32 length, bytes) pair stored behind the fixed-size columns
+  static inline int CompareVarchar(const char *lhs, const char *rhs, uint32_t offset) {
+    const char *lhs_str;
+    const char *rhs_str;
+    int lhs_len = VarcharAt(lhs, offset, &lhs_str);
+    int rhs_len = VarcharAt(rhs, offset, &rhs_str);
+    if (lhs_len < 0 || rhs_len < 0) {
+      return Compare(lhs_len, rhs_len);
+    }
+    int result = memcmp(lhs_str, rhs_str, static_cast<size_t>(std::min(lhs_len, rhs_len)));
+    if (result == 0) {
+      return Compare(lhs_len, rhs_len);
+    }
+    return result < 0 ? -1 : 1;
+  }
+
+  // @return the string length without the trailing '\0' (clamped to the key), or -1 for NULL
+  static inline int VarcharAt(const char *data, uint32_t offset, const char **str) {
+    auto varlen_offset = static_cast<uint32_t>(Load<int32_t>(data + offset));
+    if (varlen_offset + sizeof(uint32_t) > KeySize) {
+      *str = data;
+      return 0;
+    }
+    uint32_t len = Load<uint32_t>(data + varlen_offset);
+    if (len == BUSTUB_VALUE_NULL) {
+      return -1;
+    }
+    *str = data + varlen_offset + sizeof(uint32_t);
+    uint32_t available = KeySize - varlen_offset - sizeof(uint32_t);
+    len = len == 0 ? 0 : len - 1;
+    return static_cast<int>(std::min(len, available));
+  }
+
+  bool int64_key_;
+  uint32_t column_count_;
+  KeyColumn columns_[MAX_COLUMNS];
 };
 
 }  // namespace bustub
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -37,8 +38,11 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, std::string root_record_name = "")
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        root_record_name_(root_record_name.empty() ? name_ : std::move(root_record_name)) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -48,6 +52,9 @@ class IndexMetadata {
 
   inline const std::string &GetTableName() { return table_name_; }
 
+  // Returns the name of the header page record that keeps the root of a tree index, the index name by default
+  inline const std::string &GetRootRecordName() const { return root_record_name_; }
+
   // Returns a schema object pointer that represents the indexed key
   inline Schema *GetKeySchema() const { return key_schema_; }
 
@@ -80,6 +87,8 @@ class IndexMetadata {
   const std::vector<uint32_t> key_attrs_;
   // schema of the indexed key
   Schema *key_schema_;
+  // name of the header page record of the index
+  std::string root_record_name_;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -137,11 +146,63 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  // look up a batch of keys, (*results)[i] gets the rids of keys[i]. Indexes
+  // that can share work between the keys override this; by default every key
+  // is scanned on its own.
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                        Transaction *transaction) {
+    results->assign(keys.size(), std::vector<RID>());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*results)[i], transaction);
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Bloom filter
+  ///////////////////////////////////////////////////////////////////
+  // keep a Bloom filter over the keys, built from refill, that lookups of
+  // missing keys stop at. To be called before the index is shared.
+  void EnableBloomFilter(IndexBloomFilter::Refill refill) {
+    bloom_filter_ = std::make_unique<IndexBloomFilter>(std::move(refill));
+  }
+
+  // nullptr if the index has no Bloom filter
+  IndexBloomFilter *GetBloomFilter() const { return bloom_filter_.get(); }
+
+ protected:
+  // the index types call these in InsertEntry(), DeleteEntry() and ScanKey()
+  void FilterAdd(const Tuple &key) {
+    if (bloom_filter_ != nullptr) {
+      bloom_filter_->Add(key);
+    }
+  }
+
+  void FilterRemove(const Tuple &key) {
+    if (bloom_filter_ != nullptr) {
+      bloom_filter_->Remove(key);
+    }
+  }
+
+  bool FilterMayContain(const Tuple &key) const { return bloom_filter_ == nullptr || bloom_filter_->MayContain(key); }
+
+  // the positions of the keys the Bloom filter does not rule out, for ScanKeys()
+  std::vector<size_t> FilterKeys(const std::vector<Tuple> &keys) const {
+    std::vector<size_t> positions;
+    positions.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (FilterMayContain(keys[i])) {
+        positions.push_back(i);
+      }
+    }
+    return positions;
+  }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
   //===--------------------------------------------------------------------===//
   IndexMetadata *metadata_;
+  std::unique_ptr<IndexBloomFilter> bloom_filter_;
 };
 
 }  // namespace bustub
@@ -14,12 +14,47 @@
  */
 #pragma once
 
+#include <functional>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/*
+ * Key range of a bounded scan. A bound that is not set leaves its side of
+ * the range open.
+ */
+template <typename KeyType>
+struct IndexKeyRange {
+  void SetLower(const KeyType &key, bool inclusive) {
+    has_lower_ = true;
+    lower_ = key;
+    lower_inclusive_ = inclusive;
+  }
+  void SetUpper(const KeyType &key, bool inclusive) {
+    has_upper_ = true;
+    upper_ = key;
+    upper_inclusive_ = inclusive;
+  }
+
+  bool has_lower_{false};
+  KeyType lower_;
+  bool lower_inclusive_{true};
+  bool has_upper_{false};
+  KeyType upper_;
+  bool upper_inclusive_{true};
+};
+
+/*
+ * Iterates the (key, value) pairs of the leaves in key order, or in reverse
+ * key order through the prev links of the leaves. With posting_lists set, a
+ * key with a posting list is returned once per value. An iterator with a stop
+ * key turns into the end iterator as soon as it moves past that key, and lets
+ * go of its pages right away.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
@@ -29,37 +64,78 @@ class IndexIterator {
     index_=0;
     buffer_pool_manager_= nullptr;
   }
-  IndexIterator(page_id_t p_id, BufferPoolManager *buffer_pool_manager_, int specific_index = 0);
+  IndexIterator(page_id_t p_id, BufferPoolManager *buffer_pool_manager_, int specific_index = 0,
+                bool posting_lists = false, bool reverse = false);
   ~IndexIterator();
 
-  bool isEnd();
+  // end the iteration once it moves past key, in the direction of the iterator
+  void SetStopKey(const KeyType &key, bool inclusive, const KeyComparator &comparator);
+
+  // returns the pinned leaf of the greatest key below key and its index there, see BPlusTree::FindLeafBefore()
+  using LeafFinder = std::function<Page *(const KeyType &key, int *index)>;
+  // where a reverse iterator re-descends when the prev link of a leaf is stale
+  void SetLeafFinder(LeafFinder finder, const KeyComparator &comparator);
+
+  bool isEnd() const;
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
+  // every iterator that reached its end is equal to end(), whatever its direction and bound
   bool operator==(const IndexIterator &itr) const {
-
-    return cur_node_->GetPageId() == itr.cur_node_->GetPageId() && index_ == itr.index_;
+    if (isEnd() || itr.isEnd()) {
+      return isEnd() && itr.isEnd();
+    }
+    return cur_node_->GetPageId() == itr.cur_node_->GetPageId() && index_ == itr.index_ &&
+           PostingPageId() == itr.PostingPageId() && posting_segment_ == itr.posting_segment_ &&
+           posting_index_ == itr.posting_index_;
   }
 
-  bool operator!=(const IndexIterator &itr) const {
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
-    return cur_node_->GetPageId() != itr.cur_node_->GetPageId() || index_ != itr.index_;
-  }
-  INDEXITERATOR_TYPE &operator=(const INDEXITERATOR_TYPE &other){
-    cur_node_=other.cur_node_;
-    index_=other.index_;
-    buffer_pool_manager_=other.buffer_pool_manager_;
-    return *this;
-  }
+  // the copy pins the pages on its own, every iterator unpins its pages when destroyed
+  IndexIterator(const INDEXITERATOR_TYPE &other) : IndexIterator() { *this = other; }
+  INDEXITERATOR_TYPE &operator=(const INDEXITERATOR_TYPE &other);
 
  private:
   // add your own private member variables here
 
+  using PostingPage = BPlusTreePostingPage<ValueType>;
+
+  page_id_t PostingPageId() const { return posting_page_ == nullptr ? INVALID_PAGE_ID : posting_page_->GetPageId(); }
+
+  // step over the ends of the leaves in the direction of the iterator
+  void MoveToEntry();
+
+  // become the end iterator if the current key is past the stop key
+  void CheckStopKey();
+
+  // start on the posting list of the current entry, if it has one
+  void EnterPostingList();
+
+  void Unpin();
+
   B_PLUS_TREE_LEAF_PAGE_TYPE *cur_node_;
   int index_;
   BufferPoolManager *buffer_pool_manager_;
+  bool posting_lists_{false};
+  PostingPage *posting_page_{nullptr};
+  int posting_segment_{0};
+  int posting_index_{0};
+  // the pair returned while iterating a posting list
+  MappingType current_;
+  bool reverse_{false};
+  bool has_stop_key_{false};
+  KeyType stop_key_;
+  bool stop_inclusive_{true};
+  const KeyComparator *comparator_{nullptr};
+  // set once the iterator moved past its stop key
+  bool stopped_{false};
+  LeafFinder find_leaf_before_;
+  // the lowest first key of the leaves a reverse iterator has left
+  bool has_low_key_{false};
+  KeyType low_key_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.h
+//
+// Identification: src/include/storage/index/key_encoder.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * Encodes index keys into byte strings whose memcmp order is the order of
+ * GenericComparator, so that keys can be compared, prefix compressed and
+ * truncated as plain bytes (see VarlenBPlusTree).
+ *
+ * Integers are stored big-endian with the sign bit flipped, DECIMAL as the
+ * IEEE bits with the usual sign fix-up, TIMESTAMP big-endian plus one, which
+ * wraps its NULL (the maximum value) around to zero. A VARCHAR is 0x01, its
+ * bytes with every 0x00 escaped as 0x00 0xFF, and a 0x00 0x00 terminator,
+ * while a NULL VARCHAR is a single 0x00. NULLs of the other types are their
+ * minimum value in storage and need no special care. Every column
+ * encoding is self-delimiting, so no encoded key is a prefix of another one.
+ */
+class KeyEncoder {
+ public:
+  explicit KeyEncoder(Schema *key_schema);
+
+  // encode a tuple of the key schema
+  void Encode(const Tuple &key, std::string *out) const { Encode(key.GetData(), key.GetLength(), out); }
+
+  /**
+   * Encode a key in tuple layout, e.g. the data_ of a GenericKey. Columns and
+   * VARCHAR bytes past size are cut off, the same way GenericComparator drops
+   * and clamps them.
+   */
+  void Encode(const char *data, uint32_t size, std::string *out) const;
+
+ private:
+  struct KeyColumn {
+    TypeId type_;
+    uint32_t offset_;
+    uint32_t fixed_length_;
+  };
+
+  std::vector<KeyColumn> columns_;
+};
+
+}  // namespace bustub
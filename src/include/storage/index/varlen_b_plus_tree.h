@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/varlen_b_plus_tree.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/index/varlen_index_iterator.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/**
+ * B+ tree over variable-length byte string keys compared with memcmp, e.g.
+ * keys built by KeyEncoder. Keys are unique and at most
+ * SLOTTED_PAGE_MAX_KEY_SIZE bytes long.
+ *
+ * The pages (see BPlusTreeSlottedPage) are filled by bytes instead of by
+ * number of entries, and are compressed two ways to raise the fan-out:
+ * (1) every page stores the common prefix of its keys only once
+ * (2) a leaf split pushes the shortest separator that still tells the two
+ *     leaves apart into the parent instead of the first key of the new leaf
+ *     (suffix truncation), so internal pages hold short keys
+ *
+ * Pages are split at the middle of their bytes. A page that drops below half
+ * of its capacity is merged with a sibling when the two fit into one page;
+ * there is no redistribution between siblings.
+ *
+ * Concurrency: a tree-wide reader/writer latch, writers are serialized.
+ */
+template <typename ValueType>
+class VarlenBPlusTree {
+  using LeafPage = BPlusTreeSlottedPage<ValueType>;
+  using InternalPage = BPlusTreeSlottedPage<page_id_t>;
+
+ public:
+  explicit VarlenBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager);
+
+  // Returns true if this B+ tree has no keys and values.
+  bool IsEmpty() const;
+
+  // Attach to the tree an earlier instance of this index left on disk, false if the header page has no record of it.
+  bool Open();
+
+  // Insert a key-value pair into this B+ tree, false if the key is already there.
+  bool Insert(const std::string &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value from this B+ tree.
+  void Remove(const std::string &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const std::string &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  // index iterator
+  VarlenIndexIterator<ValueType> begin();
+  VarlenIndexIterator<ValueType> Begin(const std::string &key);
+  VarlenIndexIterator<ValueType> end();
+
+  // number of levels, 0 for an empty tree
+  int GetHeight();
+
+ private:
+  // pins the path one page at a time and returns the leaf pinned, the caller holds the tree latch
+  Page *FindLeafPage(const std::string &key, bool left_most = false);
+
+  void StartNewTree(const std::string &key, const ValueType &value);
+
+  // move the upper half of node's bytes into a new page, middle_key is set to the key that separates them
+  template <typename N>
+  N *Split(N *node, std::string *middle_key);
+
+  void InsertIntoParent(BPlusTreePage *old_node, const std::string &key, BPlusTreePage *new_node);
+
+  // merge node with a sibling if it is underfull and they fit into one page, unpins node
+  void CoalesceIfUnderfull(BPlusTreePage *node);
+
+  template <typename N>
+  bool Coalesce(N *node, InternalPage *parent, int index);
+
+  void SetParentPageId(page_id_t child_page_id, page_id_t parent_page_id);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  // member variable
+  ReaderWriterLatch latch_;
+  std::string index_name_;
+  page_id_t root_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+}  // namespace bustub
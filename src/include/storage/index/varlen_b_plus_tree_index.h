@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/varlen_b_plus_tree_index.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/key_encoder.h"
+#include "storage/index/varlen_b_plus_tree.h"
+
+namespace bustub {
+
+/**
+ * Index over whole keys of any width, VARCHAR columns included, on top of
+ * VarlenBPlusTree. The tree key of an entry is the KeyEncoder encoding of the
+ * index key followed by the RID, so that tuples with equal keys get distinct
+ * entries that sort by RID. The key encoding is self-delimiting, so the
+ * entries of one key are exactly those starting with its encoding.
+ */
+class VarlenBPlusTreeIndex : public Index {
+ public:
+  // longest encoded key the index takes, longer ones are rejected on insert instead of being truncated
+  static constexpr size_t MAX_KEY_SIZE = SLOTTED_PAGE_MAX_KEY_SIZE - sizeof(int64_t);
+
+  VarlenBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  // reopen the tree this index left on disk, false if there is none
+  bool Open();
+
+  // iterators over (tree key, rid) pairs, the tree key is the encoded key followed by the rid
+  VarlenIndexIterator<RID> GetBeginIterator();
+
+  VarlenIndexIterator<RID> GetBeginIterator(const Tuple &key);
+
+  VarlenIndexIterator<RID> GetEndIterator();
+
+ protected:
+  std::string EncodeKey(const Tuple &key) const;
+
+  std::string EncodeEntry(const Tuple &key, RID rid) const;
+
+  KeyEncoder encoder_;
+  // container
+  VarlenBPlusTree<RID> container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/varlen_index_iterator.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+/**
+ * varlen_index_iterator.h
+ * For range scan of the variable-length key b+ tree
+ */
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/*
+ * Iterates the (key, value) pairs of VarlenBPlusTree in key order. The
+ * iterator keeps its leaf pinned; it can be moved but not copied. The end
+ * iterator holds no page.
+ */
+template <typename ValueType>
+class VarlenIndexIterator {
+  using LeafPage = BPlusTreeSlottedPage<ValueType>;
+
+ public:
+  VarlenIndexIterator() = default;
+  // takes over the pin of leaf_page
+  VarlenIndexIterator(BufferPoolManager *buffer_pool_manager, Page *leaf_page, int index);
+  VarlenIndexIterator(VarlenIndexIterator &&other) noexcept;
+  VarlenIndexIterator &operator=(VarlenIndexIterator &&other) noexcept;
+  VarlenIndexIterator(const VarlenIndexIterator &) = delete;
+  VarlenIndexIterator &operator=(const VarlenIndexIterator &) = delete;
+  ~VarlenIndexIterator();
+
+  bool IsEnd() const { return leaf_ == nullptr; }
+
+  const std::pair<std::string, ValueType> &operator*();
+
+  VarlenIndexIterator &operator++();
+
+  bool operator==(const VarlenIndexIterator &other) const {
+    if (IsEnd() || other.IsEnd()) {
+      return IsEnd() == other.IsEnd();
+    }
+    return leaf_->GetPageId() == other.leaf_->GetPageId() && index_ == other.index_;
+  }
+
+  bool operator!=(const VarlenIndexIterator &other) const { return !(*this == other); }
+
+ private:
+  // move on to the next leaf while the current one has no entry left, unpin the last one at the end
+  void SkipExhaustedLeaves();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  LeafPage *leaf_{nullptr};
+  int index_{0};
+  std::pair<std::string, ValueType> current_;
+};
+
+}  // namespace bustub
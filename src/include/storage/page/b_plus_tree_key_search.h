@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_key_search.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * Branchless binary search over the sorted (key, value) array of a B+ tree
+ * page: every probe only selects the next base offset, so the loop has no data
+ * dependent branch and always runs log2(n) iterations.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class BranchlessKeySearch {
+  using Item = std::pair<KeyType, ValueType>;
+
+ public:
+  /** @return the first index i in [begin, end) with array[i].first >= key, or end if there is none */
+  static int LowerBound(const Item *array, int begin, int end, const KeyType &key, const KeyComparator &comparator) {
+    if (end <= begin) {
+      return begin;
+    }
+    const Item *base = array + begin;
+    int n = end - begin;
+    while (n > 1) {
+      int half = n / 2;
+      base = comparator(base[half - 1].first, key) < 0 ? base + half : base;
+      n -= half;
+    }
+    return static_cast<int>(base - array) + (comparator(base->first, key) < 0 ? 1 : 0);
+  }
+
+  /** @return the first index i in [begin, end) with array[i].first > key, or end if there is none */
+  static int UpperBound(const Item *array, int begin, int end, const KeyType &key, const KeyComparator &comparator) {
+    if (end <= begin) {
+      return begin;
+    }
+    const Item *base = array + begin;
+    int n = end - begin;
+    while (n > 1) {
+      int half = n / 2;
+      base = comparator(base[half - 1].first, key) <= 0 ? base + half : base;
+      n -= half;
+    }
+    return static_cast<int>(base - array) + (comparator(base->first, key) <= 0 ? 1 : 0);
+  }
+};
+
+/**
+ * Key search used by the B+ tree pages. The primary template is the branchless
+ * binary search above.
+ *
+ * It is specialized at compile time for 8-byte generic keys. When the
+ * comparator reports that the key is a single inlined BIGINT, the keys are
+ * compared as plain int64 values and the last SEARCH_WINDOW candidates are
+ * counted with AVX2 compares instead of further halving.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class KeySearch : public BranchlessKeySearch<KeyType, ValueType, KeyComparator> {};
+
+template <typename ValueType>
+class KeySearch<GenericKey<8>, ValueType, GenericComparator<8>> {
+  using Item = std::pair<GenericKey<8>, ValueType>;
+  // once the candidate range is this small it is counted in one SIMD pass
+  static constexpr int SEARCH_WINDOW = 16;
+
+ public:
+  static int LowerBound(const Item *array, int begin, int end, const GenericKey<8> &key,
+                        const GenericComparator<8> &comparator) {
+    if (!comparator.IsInt64Key()) {
+      return BranchlessKeySearch<GenericKey<8>, ValueType, GenericComparator<8>>::LowerBound(array, begin, end, key,
+                                                                                            comparator);
+    }
+    // keys strictly smaller than the target are counted, which yields the lower bound
+    return CountBelow(array, begin, end, Load(key), false);
+  }
+
+  static int UpperBound(const Item *array, int begin, int end, const GenericKey<8> &key,
+                        const GenericComparator<8> &comparator) {
+    if (!comparator.IsInt64Key()) {
+      return BranchlessKeySearch<GenericKey<8>, ValueType, GenericComparator<8>>::UpperBound(array, begin, end, key,
+                                                                                            comparator);
+    }
+    return CountBelow(array, begin, end, Load(key), true);
+  }
+
+ private:
+  static inline int64_t Load(const GenericKey<8> &key) {
+    int64_t value;
+    memcpy(&value, key.data_, sizeof(int64_t));
+    return value;
+  }
+
+  /*
+   * Return begin + the number of keys in [begin, end) that are < target (or <= target when inclusive is set).
+   * The array is sorted, so that count is exactly the lower (upper) bound.
+   */
+  static int CountBelow(const Item *array, int begin, int end, int64_t target, bool inclusive) {
+    const Item *base = array + begin;
+    int n = end - begin;
+    while (n > SEARCH_WINDOW) {
+      int half = n / 2;
+      int64_t probe = Load(base[half - 1].first);
+      base = (probe < target || (inclusive && probe == target)) ? base + half : base;
+      n -= half;
+    }
+    // an inclusive count of keys <= target equals the count of keys < target + 1
+    if (inclusive) {
+      if (target == INT64_MAX) {
+        return static_cast<int>(base - array) + n;
+      }
+      target++;
+    }
+    int count = 0;
+    int i = 0;
+#ifdef __AVX2__
+    const __m256i target_vec = _mm256_set1_epi64x(target);
+    for (; i + 4 <= n; i += 4) {
+      __m256i keys = _mm256_set_epi64x(Load(base[i + 3].first), Load(base[i + 2].first), Load(base[i + 1].first),
+                                       Load(base[i].first));
+      int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(target_vec, keys)));
+      count += __builtin_popcount(mask);
+    }
+#endif
+    for (; i < n; i++) {
+      count += Load(base[i].first) < target ? 1 : 0;
+    }
+    return static_cast<int>(base - array) + count;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_POSTING_PAGE_TYPE BPlusTreePostingPage<ValueType>
+#define POSTING_PAGE_HEADER_SIZE 52
+// size classes of the posting lists, a list moves to the next class when it outgrows its segment
+#define POSTING_SIZE_CLASSES 8
+#define POSTING_PAGE_CLASS (POSTING_SIZE_CLASSES - 1)
+
+/**
+ * Posting lists of the keys with duplicates in a non-unique B+ tree.
+ *
+ * The key is stored once in its leaf, and instead of a value the leaf entry
+ * holds a reference (page id, segment) to the posting list, which packs the
+ * values of the key without repeating it. A posting page is cut into equal
+ * segments of one size class (2, 4, 8, ... 128 values) that are shared by many
+ * keys, so a key with a handful of duplicates does not take a page of its own.
+ * Lists longer than that take whole pages of the last class, chained through
+ * NextPageId: new values go to the first page, and once it is full a new first
+ * page is pushed in front of it. Values are kept in no particular order.
+ *
+ * Posting page format:
+ *  ---------------------------------------------------------------------------
+ * | PageId (4) | NextPageId (4) | SizeClass (4) | SegmentCount (4) | Used (4) |
+ *  ---------------------------------------------------------------------------
+ *  -------------------------------------------------------------------------
+ * | UsedBitmap (32) | SIZE(1) + VALUES(1) | ... | SIZE(n) + VALUES(n) |
+ *  -------------------------------------------------------------------------
+ */
+template <typename ValueType>
+class BPlusTreePostingPage {
+ public:
+  // @return the number of values a segment of size_class holds
+  static int SegmentCapacity(int size_class);
+
+  void Init(page_id_t page_id, int size_class, page_id_t next_page_id = INVALID_PAGE_ID);
+
+  page_id_t GetPageId() const { return page_id_; }
+  page_id_t GetNextPageId() const { return next_page_id_; }
+  int GetSizeClass() const { return size_class_; }
+  bool HasFreeSegment() const { return used_count_ < segment_count_; }
+  bool IsEmpty() const { return used_count_ == 0; }
+
+  // segment allocation, the B+ tree serializes it with its posting latch
+  int AllocateSegment();
+  void FreeSegment(int segment);
+
+  int GetSize(int segment) const { return *SegmentSize(segment); }
+  bool IsFull(int segment) const { return GetSize(segment) >= SegmentCapacity(size_class_); }
+  ValueType ValueAt(int segment, int index) const { return SegmentValues(segment)[index]; }
+  void SetValueAt(int segment, int index, const ValueType &value) { SegmentValues(segment)[index] = value; }
+  void Append(int segment, const ValueType &value);
+  // remove the value at index, the last value of the segment takes its place
+  ValueType RemoveAt(int segment, int index);
+  // @return the index of value in the segment, or -1 if it is not there
+  int ValueIndex(int segment, const ValueType &value) const;
+
+  // leaf entries tell posting list references and plain values apart by these
+  static bool IsPostingList(const ValueType &value);
+  static ValueType MakeReference(page_id_t page_id, int segment);
+  static page_id_t ReferencedPageId(const ValueType &value);
+  static int ReferencedSegment(const ValueType &value);
+
+ private:
+  static constexpr int MAX_SEGMENTS = 256;
+
+  static int SegmentBytes(int size_class) {
+    return static_cast<int>(sizeof(int32_t) + SegmentCapacity(size_class) * sizeof(ValueType));
+  }
+  int32_t *SegmentSize(int segment) { return reinterpret_cast<int32_t *>(data_ + segment * SegmentBytes(size_class_)); }
+  const int32_t *SegmentSize(int segment) const {
+    return reinterpret_cast<const int32_t *>(data_ + segment * SegmentBytes(size_class_));
+  }
+  ValueType *SegmentValues(int segment) { return reinterpret_cast<ValueType *>(SegmentSize(segment) + 1); }
+  const ValueType *SegmentValues(int segment) const {
+    return reinterpret_cast<const ValueType *>(SegmentSize(segment) + 1);
+  }
+
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  int size_class_;
+  int segment_count_;
+  int used_count_;
+  uint32_t used_[MAX_SEGMENTS / 32];
+  char data_[0];
+};
+
+}  // namespace bustub
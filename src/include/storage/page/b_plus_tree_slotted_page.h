@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_slotted_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_SLOTTED_PAGE_TYPE BPlusTreeSlottedPage<ValueType>
+#define SLOTTED_PAGE_HEADER_SIZE 32
+// longest key of a slotted page, four of them still fit into one page so that a split always makes room
+#define SLOTTED_PAGE_MAX_KEY_SIZE 1000
+
+/**
+ * Leaf or internal page of VarlenBPlusTree, holding variable-length byte
+ * string keys in memcmp order. ValueType is the RID for leaves and the child
+ * page id for internal pages, where the key at index 0 is unused, as in
+ * BPlusTreeInternalPage.
+ *
+ * The page stores the common prefix of its keys once, and each key only with
+ * the rest (prefix compression). The prefix is recomputed when the page is
+ * rebuilt: on splits and merges, when deleted keys left holes in the key
+ * heap, and when a new key does not start with the prefix. The slot array
+ * grows from the header, and the key heap grows down from the end of the page.
+ *
+ * Slotted page format:
+ *  ----------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | ... | SLOT(n) | free space | SUFFIX(n) | ... | PREFIX |
+ *  ----------------------------------------------------------------------------
+ *  A slot is KeyOffset (2) | KeySize (2) | VALUE
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ---------------------------------------------------------------------
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ *  ---------------------------------------------------------------------
+ *  -----------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrefixSize (2) | HeapOffset (2)
+ *  -----------------------------------------------------------------------------
+ */
+template <typename ValueType>
+class BPlusTreeSlottedPage : public BPlusTreePage {
+ public:
+  using Entry = std::pair<std::string, ValueType>;
+
+  void Init(page_id_t page_id, page_id_t parent_id, IndexPageType page_type);
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  int GetPrefixSize() const { return prefix_size_; }
+
+  // the whole key at index, prefix included
+  std::string KeyAt(int index) const;
+  ValueType ValueAt(int index) const { return Slots()[index].value_; }
+  void SetValueAt(int index, const ValueType &value) { Slots()[index].value_ = value; }
+  int ValueIndex(const ValueType &value) const;
+
+  // index of the first key >= key (LowerBound) or > key (UpperBound)
+  int LowerBound(const std::string &key) const { return Bound(key, false); }
+  int UpperBound(const std::string &key) const { return Bound(key, true); }
+  // internal pages: the child whose subtree covers key
+  ValueType Lookup(const std::string &key) const { return ValueAt(UpperBound(key) - 1); }
+
+  // @return false if the page has no room for the entry, even when rebuilt
+  bool Insert(int index, const std::string &key, const ValueType &value);
+  void RemoveAt(int index);
+
+  // bytes taken by the slot and the key suffix at index
+  int EntryBytes(int index) const;
+  // bytes taken by slots, prefix and suffixes, that is without the holes of the key heap
+  int UsedBytes() const;
+
+  void GetEntries(int begin, int end, std::vector<Entry> *entries) const;
+  // replace the content of the page with entries; false, and the page is left alone, if they do not fit
+  bool Rebuild(const std::vector<Entry> &entries);
+  // bytes the entries take once prefix compressed
+  static int RequiredBytes(const std::vector<Entry> &entries, bool leaf);
+
+  static constexpr int CAPACITY = PAGE_SIZE - SLOTTED_PAGE_HEADER_SIZE;
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t size_;
+    ValueType value_;
+  };
+
+  static int CommonPrefixSize(const std::vector<Entry> &entries, bool leaf);
+
+  int Bound(const std::string &key, bool upper) const;
+  int FirstKeyIndex() const { return IsLeafPage() ? 0 : 1; }
+  const char *Data() const { return reinterpret_cast<const char *>(this); }
+  char *Data() { return reinterpret_cast<char *>(this); }
+  Slot *Slots() { return reinterpret_cast<Slot *>(slots_); }
+  const Slot *Slots() const { return reinterpret_cast<const Slot *>(slots_); }
+  int FreeBytes() const { return heap_offset_ - SLOTTED_PAGE_HEADER_SIZE - GetSize() * static_cast<int>(sizeof(Slot)); }
+
+  page_id_t next_page_id_;
+  uint16_t prefix_size_;
+  uint16_t heap_offset_;
+  char slots_[0];
+};
+
+}  // namespace bustub
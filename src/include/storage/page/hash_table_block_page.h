@@ -36,9 +36,17 @@ namespace bustub {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
  public:
+  // slots in the block
+  static constexpr size_t SLOT_COUNT = BLOCK_ARRAY_SIZE;
+  // slots a MatchGroup() call covers, one byte of the bitmaps
+  static constexpr slot_offset_t GROUP_SIZE = 8;
+
   // Delete all constructor / destructor to ensure memory safety
   HashTableBlockPage() = delete;
 
+  // the block stores no tags, see HashTableTagBlockPage
+  static uint8_t Tag(uint64_t hash) { return 0; }
+
   /**
    * Gets the key at an index in the block.
    *
@@ -70,6 +78,11 @@ class HashTableBlockPage {
    */
   bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
 
+  // Insert() with the interface of HashTableTagBlockPage, the tag is ignored
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t tag) {
+    return Insert(bucket_ind, key, value);
+  }
+
   /**
    * Removes a key and value at index.
    *
@@ -93,6 +106,16 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Reads the flags of the GROUP_SIZE slots from group_start, a multiple of
+   * GROUP_SIZE. Bit i of the results stands for slot group_start + i.
+   *
+   * @param tag ignored, the block has no tags, so every readable slot is a candidate
+   * @param[out] candidates the readable slots
+   * @param[out] empty the slots that were never occupied
+   */
+  void MatchGroup(slot_offset_t group_start, uint8_t tag, uint32_t *candidates, uint32_t *empty) const;
+
  private:
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Bucket page of an extendible hash table, laid out like HashTableBlockPage.
+ * Supports non-unique keys, but no duplicate (key, value) pairs.
+ *
+ * Bucket page format:
+ *  ----------------------------------------------------------------
+ * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------
+ *
+ * Unlike the slots of a block page, the slot of a removed pair is reused by
+ * the next insert, the whole bucket is scanned on every lookup. The caller
+ * latches the page.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /**
+   * Appends the values of every pair with the given key to result.
+   *
+   * @return true if there is at least one
+   */
+  bool GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result) const;
+
+  /**
+   * Inserts a pair into a free slot.
+   *
+   * @return false if the bucket is full or already holds the pair
+   */
+  bool Insert(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Removes a pair.
+   *
+   * @return false if the bucket does not hold the pair
+   */
+  bool Remove(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  KeyType KeyAt(slot_offset_t bucket_ind) const;
+
+  ValueType ValueAt(slot_offset_t bucket_ind) const;
+
+  /**
+   * Removes the pair at a slot.
+   */
+  void RemoveAt(slot_offset_t bucket_ind);
+
+  /**
+   * @return true if the slot ever held a pair, removed or not
+   */
+  bool IsOccupied(slot_offset_t bucket_ind) const;
+
+  /**
+   * @return true if the slot holds a pair
+   */
+  bool IsReadable(slot_offset_t bucket_ind) const;
+
+  /**
+   * @return the number of pairs in the bucket
+   */
+  uint32_t NumReadable() const;
+
+  bool IsFull() const;
+
+  bool IsEmpty() const;
+
+ private:
+  char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+
+  // 0 if tombstone/brand new (never occupied), 1 otherwise.
+  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Directory Page for extendible hash table.
+ *
+ * Directory format (size in byte):
+ * --------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
+ * --------------------------------------------------------------------------------------------
+ *
+ * Slot i of the directory holds the bucket of the keys whose hash ends with
+ * the GlobalDepth low bits of i. A bucket of local depth d is shared by the
+ * 2^(GlobalDepth - d) slots that agree on the d low bits.
+ *
+ * A directory deeper than MAX_DEPTH spans several of these pages, see
+ * HashTableRootDirectoryPage. Each of them then holds DIRECTORY_ARRAY_SIZE
+ * slots and the global depth of the whole directory.
+ */
+class HashTableDirectoryPage {
+ public:
+  // the deepest directory that fits the page
+  static constexpr uint32_t MAX_DEPTH = 9;
+
+  static_assert(1U << MAX_DEPTH == DIRECTORY_ARRAY_SIZE);
+
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the number of low hash bits the directory is indexed by
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return a mask of the GlobalDepth low bits
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Doubles the directory, the new upper half points to the buckets of the lower half. Past MAX_DEPTH only the depth
+   * changes, the upper half is a copy of the page that the caller makes.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halves the directory, which is only allowed if CanShrink().
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return true if no bucket has a local depth equal to the global depth
+   */
+  bool CanShrink() const;
+
+  /**
+   * @return the number of slots of this page, 2^GlobalDepth up to DIRECTORY_ARRAY_SIZE
+   */
+  uint32_t Size() const;
+
+  /**
+   * @param bucket_idx slot of the directory
+   * @return the page id of the bucket of the slot
+   */
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx slot of the directory
+   * @param bucket_page_id the page id of its bucket
+   */
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  /**
+   * @param bucket_idx slot of the directory
+   * @return the local depth of the bucket of the slot
+   */
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx slot of the directory
+   * @param local_depth the local depth of the bucket of the slot
+   */
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  /**
+   * @param bucket_idx slot of the directory
+   * @return a mask of the local depth low bits of the bucket of the slot
+   */
+  uint32_t GetLocalDepthMask(uint32_t bucket_idx) const;
+
+  /**
+   * The split image of a bucket is the bucket that differs from it in the
+   * highest of its local depth bits, the one it was split from or merges into.
+   *
+   * @param bucket_idx slot of the directory, its bucket has a local depth of at least 1
+   * @return the slot of the split image
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  /**
+   * Asserts that the local depths are at most the global depth, and that
+   * every bucket of local depth d is shared by exactly 2^(GlobalDepth - d)
+   * slots with the same local depth. Only for a directory that fits the page.
+   */
+  void VerifyIntegrity() const;
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+}  // namespace bustub
@@ -33,6 +33,9 @@ namespace bustub {
  */
 class HashTableHeaderPage {
  public:
+  // the most block page ids that fit behind the fixed fields
+  static constexpr size_t MAX_BLOCKS = (PAGE_SIZE - 4 * sizeof(size_t)) / sizeof(page_id_t);
+
   /**
    * @return the number of buckets in the hash table;
    */
@@ -90,11 +93,11 @@ class HashTableHeaderPage {
   size_t NumBlocks();
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  __attribute__((unused)) page_id_t block_page_ids_[0];
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
+  page_id_t block_page_ids_[0];
 };
 
 }  // namespace bustub
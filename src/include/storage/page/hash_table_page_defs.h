@@ -22,3 +22,19 @@
 #define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs a bucket page of an extendible hash table holds, computed like
+ * BLOCK_ARRAY_SIZE. */
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+
+/** DIRECTORY_ARRAY_SIZE is the number of slots of a directory page of an extendible hash table, a bucket page id and
+ * a local depth each. A deeper directory spans several pages. */
+#define DIRECTORY_ARRAY_SIZE 512
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+
+/** TAG_BLOCK_ARRAY_SIZE is the number of (key, value) pairs a HashTableTagBlockPage holds: one tag byte per pair, and
+ * up to 31 bytes of padding so that the tag array is a whole number of 32 byte groups. */
+#define TAG_BLOCK_ARRAY_SIZE ((PAGE_SIZE - 32) / (sizeof(MappingType) + 1))
+
+#define HASH_TABLE_TAG_BLOCK_TYPE HashTableTagBlockPage<KeyType, ValueType, KeyComparator>
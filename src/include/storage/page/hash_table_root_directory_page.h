@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_root_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_root_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Root Page of the directory of an extendible hash table.
+ *
+ * Root format (size in byte):
+ * ------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | SegmentPageIds(2048) | Free(2036)
+ * ------------------------------------------------------------------------
+ *
+ * The directory is cut into segments of DIRECTORY_ARRAY_SIZE slots, each a
+ * HashTableDirectoryPage, and the root holds their page ids. Slot i of the
+ * directory is slot i % DIRECTORY_ARRAY_SIZE of segment i / DIRECTORY_ARRAY_SIZE.
+ * Up to a global depth of HashTableDirectoryPage::MAX_DEPTH there is a single
+ * segment, past it the directory doubles by copying every segment.
+ */
+class HashTableRootDirectoryPage {
+ public:
+  // the global depth at which the directory fills its first segment
+  static constexpr uint32_t SEGMENT_DEPTH = HashTableDirectoryPage::MAX_DEPTH;
+  // the most segment page ids the root holds, a power of two
+  static constexpr uint32_t MAX_SEGMENTS = 512;
+  // the deepest directory that the segments hold
+  static constexpr uint32_t MAX_DEPTH = SEGMENT_DEPTH + 9;
+
+  static_assert(1U << SEGMENT_DEPTH == DIRECTORY_ARRAY_SIZE);
+  static_assert(1U << (MAX_DEPTH - SEGMENT_DEPTH) == MAX_SEGMENTS);
+
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the number of low hash bits the directory is indexed by
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return a mask of the GlobalDepth low bits
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Counts one more hash bit, the caller doubles the segments.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Counts one hash bit less, the caller halves the segments.
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return the number of slots of the directory, 2^GlobalDepth
+   */
+  uint32_t Size() const;
+
+  /**
+   * @return the number of segments the directory spans
+   */
+  uint32_t NumSegments() const;
+
+  /**
+   * @param segment_idx index of the segment
+   * @return the page id of the segment
+   */
+  page_id_t GetSegmentPageId(uint32_t segment_idx) const;
+
+  /**
+   * @param segment_idx index of the segment
+   * @param segment_page_id the page id of the segment
+   */
+  void SetSegmentPageId(uint32_t segment_idx, page_id_t segment_page_id);
+
+  /**
+   * @param slot slot of the directory
+   * @return the index of the segment that holds the slot
+   */
+  static uint32_t SegmentIndex(uint32_t slot) { return slot >> SEGMENT_DEPTH; }
+
+  /**
+   * @param slot slot of the directory
+   * @return the slot within its segment
+   */
+  static uint32_t SegmentOffset(uint32_t slot) { return slot & (DIRECTORY_ARRAY_SIZE - 1); }
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  page_id_t segment_page_ids_[MAX_SEGMENTS];
+};
+
+}  // namespace bustub
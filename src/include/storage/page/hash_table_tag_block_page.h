@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_tag_block_page.h
+//
+// Identification: src/include/storage/page/hash_table_tag_block_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Block page of a linear probing hash table with one tag byte per slot, in
+ * the style of Swiss tables. A drop-in alternative to HashTableBlockPage.
+ *
+ * Tag block page format:
+ *  --------------------------------------------------------------------------------------
+ * | TAG(1) | TAG(2) | ... | TAG(n) | padding | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  --------------------------------------------------------------------------------------
+ *
+ * A tag is EMPTY (0) for a slot that was never claimed, DELETED for a
+ * tombstone, CLAIMED while an insert writes the pair, and 0x80 plus 7 bits of
+ * the hash of the key for a readable pair. MatchGroup() compares a group of
+ * tags with the tag of a key at once, with AVX2 or SSE2 where available, so
+ * that a probe reads the key of a slot only if its tag matches.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableTagBlockPage {
+ public:
+  // slots in the block
+  static constexpr size_t SLOT_COUNT = TAG_BLOCK_ARRAY_SIZE;
+  // slots a MatchGroup() call covers
+#if defined(__AVX2__)
+  static constexpr slot_offset_t GROUP_SIZE = 32;
+#else
+  static constexpr slot_offset_t GROUP_SIZE = 16;
+#endif
+
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableTagBlockPage() = delete;
+
+  /**
+   * @param hash the hash of a key
+   * @return the tag of the key, from the high bits of the hash since the low bits pick its bucket
+   */
+  static uint8_t Tag(uint64_t hash) { return static_cast<uint8_t>(0x80 | (hash >> 57)); }
+
+  KeyType KeyAt(slot_offset_t bucket_ind) const;
+
+  ValueType ValueAt(slot_offset_t bucket_ind) const;
+
+  /**
+   * Attempts to insert a key and value into an index in the block. Like
+   * HashTableBlockPage::Insert(), the slot is claimed with compare and swap,
+   * and the tag is set once the pair is written.
+   *
+   * @param tag the tag of the key, see Tag()
+   * @return false if the slot was claimed before
+   */
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t tag);
+
+  /**
+   * Turns the pair at an index into a tombstone.
+   */
+  void Remove(slot_offset_t bucket_ind);
+
+  /**
+   * @return true if the index is occupied (key/value pair or tombstone)
+   */
+  bool IsOccupied(slot_offset_t bucket_ind) const;
+
+  /**
+   * @return true if the index holds a key/value pair
+   */
+  bool IsReadable(slot_offset_t bucket_ind) const;
+
+  /**
+   * Scans the GROUP_SIZE tags from group_start, a multiple of GROUP_SIZE. Bit
+   * i of the results stands for slot group_start + i; the bits of slots past
+   * SLOT_COUNT are to be ignored.
+   *
+   * @param tag the tag of the key looked for
+   * @param[out] candidates the slots whose tag is tag
+   * @param[out] empty the slots that were never claimed
+   */
+  void MatchGroup(slot_offset_t group_start, uint8_t tag, uint32_t *candidates, uint32_t *empty) const;
+
+ private:
+  static constexpr uint8_t EMPTY = 0;
+  static constexpr uint8_t DELETED = 1;
+  static constexpr uint8_t CLAIMED = 2;
+
+  uint8_t tags_[(TAG_BLOCK_ARRAY_SIZE + 31) / 32 * 32];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
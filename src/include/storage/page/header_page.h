@@ -21,14 +21,19 @@ namespace bustub {
  * our case, we will contain information about table/index name (length less than
  * 32 bytes) and their corresponding root_id
  *
+ * The records form an open addressing hash table keyed by name: a record lives
+ * in the slot its name hashes to, or in one of the slots after it (wrapping
+ * around), and a slot with an empty name is free. Lookups probe from the home
+ * slot up to the first free slot instead of comparing every record.
+ *
  * Format (size in byte):
  *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ * | RecordCount (4) | Slot_1 name (32) | Slot_1 root_id (4) | ... |
  *  -----------------------------------------------------------------
  */
 class HeaderPage : public Page {
  public:
-  void Init() { SetRecordCount(0); }
+  void Init() { memset(GetData(), 0, PAGE_SIZE); }
   /**
    * Record related
    */
@@ -40,11 +45,21 @@ class HeaderPage : public Page {
   bool GetRootId(const std::string &name, page_id_t *root_id);
   int GetRecordCount();
 
+  static constexpr int NAME_SIZE = 32;
+  static constexpr int RECORD_SIZE = NAME_SIZE + sizeof(page_id_t);
+  static constexpr int SLOT_COUNT = (PAGE_SIZE - sizeof(int)) / RECORD_SIZE;
+
  private:
   /**
    * helper functions
    */
+  // @return the slot holding name, or -1 if there is none
   int FindRecord(const std::string &name);
+  // the slot a name is probed from
+  static int HomeSlot(const char *name);
+
+  char *SlotName(int slot) { return GetData() + sizeof(int) + slot * RECORD_SIZE; }
+  page_id_t *SlotRootId(int slot) { return reinterpret_cast<page_id_t *>(SlotName(slot) + NAME_SIZE); }
 
   void SetRecordCount(int record_count);
 };
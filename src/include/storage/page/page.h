@@ -13,6 +13,7 @@
 #pragma once
 
 #include <common/logger.h>
+#include <atomic>
 #include <cstring>
 #include <iostream>
 
@@ -53,21 +54,39 @@ class Page {
     page_id_=page_id;
   }
   inline void IncPinCount(){
-
     pin_count_++;
-    LOG_INFO("page %d inc pincount %d",GetPageId(),GetPinCount());
   }
   inline void DecPinCount(){
     pin_count_--;
-    LOG_INFO("page %d dec pincount %d",GetPageId(),GetPinCount());
   }
 
 
-  /** Acquire the page write latch_. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch_. The version is odd while the latch is held. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_acq_rel);
+  }
 
   /** Release the page write latch_. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
+
+  /**
+   * Start an optimistic read, which takes no latch and writes nothing.
+   * @return false if a writer holds the page, otherwise the version to pass to ValidateVersion()
+   */
+  inline bool TryReadVersion(uint64_t *version) const {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /** @return true if the page was not write latched since TryReadVersion() returned version */
+  inline bool ValidateVersion(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
 
   /** Acquire the page read latch_. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -103,6 +122,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch_. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped on every write latch and unlatch, see TryReadVersion(). */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
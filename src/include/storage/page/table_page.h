@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
@@ -137,6 +138,16 @@ class TablePage : public Page {
    */
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
+  /**
+   * Collect the live tuples of this page without copying them. The tuples point into the page, so the caller must hold
+   * the read latch of the page for as long as it uses them.
+   * @param[in,out] slot the first slot to look at; the slot after the last one looked at
+   * @param max_tuples the most tuples to collect
+   * @param[out] tuples the tuples, appended
+   * @return true if the page has slots after the ones looked at
+   */
+  bool GetTuplesInPlace(uint32_t *slot, size_t max_tuples, std::vector<Tuple> *tuples);
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -99,6 +102,19 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read tuples of the table in place, under the read latch of their page, for a scan that filters them before it
+   * copies them out. Each call reads from one page.
+   * @param[in,out] cursor the page and the first slot to read, RID(GetFirstPageId(), 0) to start; moved past the tuples
+   * read, to the INVALID_PAGE_ID page after the last page
+   * @param max_tuples the most tuples to read
+   * @param visit called with the live tuples read, which point into the page and are only valid during the call
+   * @param txn transaction performing the read
+   * @return false if the cursor was at the end or its page could not be read
+   */
+  bool ScanInPlace(RID *cursor, size_t max_tuples, const std::function<void(const std::vector<Tuple> &)> &visit,
+                   Transaction *txn);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -34,6 +34,8 @@ class Tuple {
 
   friend class TableIterator;
 
+  friend class TupleBatch;
+
  public:
   // Default constructor (to create a dummy tuple)
   Tuple() = default;
@@ -66,6 +68,9 @@ class Tuple {
   // return RID of current tuple
   inline RID GetRid() const { return rid_; }
 
+  // set the RID of a tuple built from values, e.g. one that stands for a table tuple
+  inline void SetRid(const RID &rid) { rid_ = rid; }
+
   // Get the address of this tuple in the table's backing store
   inline char *GetData() const { return data_; }
 
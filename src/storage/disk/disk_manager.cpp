@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -27,6 +28,7 @@ static char *buffer_used;
 
 /**
  * Constructor: open/create a single database file & log file
+ * An existing database file is reopened, new pages are allocated after its last page.
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file)
@@ -65,6 +67,7 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open db file");
     }
   }
+  next_page_id_ = (std::max(GetFileSize(db_file), 0) + PAGE_SIZE - 1) / PAGE_SIZE;
   buffer_used = nullptr;
 }
 
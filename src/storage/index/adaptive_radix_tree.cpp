@@ -0,0 +1,774 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "common/rid.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * EPOCHS
+ *****************************************************************************/
+ArtEpochManager &ArtEpochManager::Instance() {
+  static ArtEpochManager manager;
+  return manager;
+}
+
+ArtEpochManager::~ArtEpochManager() {
+  for (const auto &retired : retired_) {
+    retired.deleter_(retired.node_);
+  }
+}
+
+/*
+ * The slot of the calling thread, claimed on its first call and given back
+ * when the thread exits.
+ */
+ArtEpochManager::Slot *ArtEpochManager::ThreadSlot() {
+  struct SlotHolder {
+    ~SlotHolder() {
+      if (slot_ != nullptr) {
+        slot_->in_use_.store(false);
+      }
+    }
+    Slot *slot_{nullptr};
+  };
+  thread_local SlotHolder holder;
+  if (holder.slot_ == nullptr) {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &slot : slots_) {
+      bool in_use = false;
+      if (slot.in_use_.compare_exchange_strong(in_use, true)) {
+        holder.slot_ = &slot;
+        break;
+      }
+    }
+    if (holder.slot_ == nullptr) {
+      holder.slot_ = &slots_.emplace_back();
+      holder.slot_->in_use_.store(true);
+    }
+  }
+  return holder.slot_;
+}
+
+void ArtEpochManager::Enter() {
+  Slot *slot = ThreadSlot();
+  if (slot->depth_++ == 0) {
+    slot->epoch_.store(global_epoch_.load());
+  }
+}
+
+void ArtEpochManager::Exit() {
+  Slot *slot = ThreadSlot();
+  if (--slot->depth_ == 0) {
+    slot->epoch_.store(0);
+  }
+}
+
+/*
+ * The node was unlinked before the epoch is advanced, so an operation that
+ * enters the new epoch cannot reach it any more.
+ */
+void ArtEpochManager::Retire(void *node, void (*deleter)(void *)) {
+  std::lock_guard<std::mutex> guard(latch_);
+  retired_.push_back({node, deleter, global_epoch_.fetch_add(1)});
+  if (retired_.size() >= ART_RECLAIM_BATCH) {
+    Reclaim();
+  }
+}
+
+void ArtEpochManager::Reclaim() {
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  for (const auto &slot : slots_) {
+    uint64_t epoch = slot.epoch_.load();
+    if (epoch != 0) {
+      oldest = std::min(oldest, epoch);
+    }
+  }
+  auto reachable = std::partition(retired_.begin(), retired_.end(),
+                                  [oldest](const Retired &retired) { return retired.epoch_ >= oldest; });
+  for (auto iter = reachable; iter != retired_.end(); ++iter) {
+    iter->deleter_(iter->node_);
+  }
+  retired_.erase(reachable, retired_.end());
+}
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::Node *AdaptiveRadixTree<ValueType>::NewNode(NodeType type) {
+  switch (type) {
+    case NodeType::NODE4:
+      return new Node4();
+    case NodeType::NODE16:
+      return new Node16();
+    case NodeType::NODE48:
+      return new Node48();
+    default:
+      return new Node256();
+  }
+}
+
+template <typename ValueType>
+int AdaptiveRadixTree<ValueType>::Capacity(NodeType type) {
+  switch (type) {
+    case NodeType::NODE4:
+      return 4;
+    case NodeType::NODE16:
+      return 16;
+    case NodeType::NODE48:
+      return 48;
+    default:
+      return 256;
+  }
+}
+
+/*
+ * Readers call this without a latch, so it only relies on count_ never being
+ * past the capacity and on slots holding either the old or the new child.
+ */
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::Node *AdaptiveRadixTree<ValueType>::FindChild(const Node *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *n = static_cast<const Node4 *>(node);
+      for (int i = 0; i < std::min<int>(n->count_, 4); i++) {
+        if (n->keys_[i] == byte) {
+          return n->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE16: {
+      auto *n = static_cast<const Node16 *>(node);
+      for (int i = 0; i < std::min<int>(n->count_, 16); i++) {
+        if (n->keys_[i] == byte) {
+          return n->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE48: {
+      auto *n = static_cast<const Node48 *>(node);
+      int index = n->child_index_[byte];
+      return index == 0 ? nullptr : n->children_[index - 1];
+    }
+    default:
+      return static_cast<const Node256 *>(node)->children_[byte];
+  }
+}
+
+// the keys of a NODE4 or NODE16 stay sorted, so that their children come out in key order
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::AddChild(Node *node, uint8_t byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      uint8_t *keys = node->type_ == NodeType::NODE4 ? static_cast<Node4 *>(node)->keys_ : static_cast<Node16 *>(node)->keys_;
+      Node **children =
+          node->type_ == NodeType::NODE4 ? static_cast<Node4 *>(node)->children_ : static_cast<Node16 *>(node)->children_;
+      int pos = std::lower_bound(keys, keys + node->count_, byte) - keys;
+      std::memmove(keys + pos + 1, keys + pos, node->count_ - pos);
+      std::memmove(children + pos + 1, children + pos, (node->count_ - pos) * sizeof(Node *));
+      keys[pos] = byte;
+      children[pos] = child;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *n = static_cast<Node48 *>(node);
+      int slot = 0;
+      while (n->children_[slot] != nullptr) {
+        slot++;
+      }
+      n->children_[slot] = child;
+      n->child_index_[byte] = slot + 1;
+      break;
+    }
+    default:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+  }
+  node->count_++;
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::RemoveChild(Node *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4:
+    case NodeType::NODE16: {
+      uint8_t *keys = node->type_ == NodeType::NODE4 ? static_cast<Node4 *>(node)->keys_ : static_cast<Node16 *>(node)->keys_;
+      Node **children =
+          node->type_ == NodeType::NODE4 ? static_cast<Node4 *>(node)->children_ : static_cast<Node16 *>(node)->children_;
+      int pos = std::find(keys, keys + node->count_, byte) - keys;
+      std::memmove(keys + pos, keys + pos + 1, node->count_ - pos - 1);
+      std::memmove(children + pos, children + pos + 1, (node->count_ - pos - 1) * sizeof(Node *));
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *n = static_cast<Node48 *>(node);
+      n->children_[n->child_index_[byte] - 1] = nullptr;
+      n->child_index_[byte] = 0;
+      break;
+    }
+    default:
+      static_cast<Node256 *>(node)->children_[byte] = nullptr;
+  }
+  node->count_--;
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::ChangeChild(Node *node, uint8_t byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *n = static_cast<Node4 *>(node);
+      n->children_[std::find(n->keys_, n->keys_ + n->count_, byte) - n->keys_] = child;
+      break;
+    }
+    case NodeType::NODE16: {
+      auto *n = static_cast<Node16 *>(node);
+      n->children_[std::find(n->keys_, n->keys_ + n->count_, byte) - n->keys_] = child;
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *n = static_cast<Node48 *>(node);
+      n->children_[n->child_index_[byte] - 1] = child;
+      break;
+    }
+    default:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+  }
+}
+
+/*
+ * A reader racing with a writer can see an emptied slot, so only the slots
+ * that hold a child count.
+ */
+template <typename ValueType>
+int AdaptiveRadixTree<ValueType>::Children(const Node *node, uint8_t *bytes, Node **children) {
+  int count = 0;
+  auto add = [&](uint8_t byte, Node *child) {
+    if (child != nullptr) {
+      bytes[count] = byte;
+      children[count++] = child;
+    }
+  };
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *n = static_cast<const Node4 *>(node);
+      for (int i = 0; i < std::min<int>(n->count_, 4); i++) {
+        add(n->keys_[i], n->children_[i]);
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      auto *n = static_cast<const Node16 *>(node);
+      for (int i = 0; i < std::min<int>(n->count_, 16); i++) {
+        add(n->keys_[i], n->children_[i]);
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *n = static_cast<const Node48 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        if (n->child_index_[byte] != 0) {
+          add(byte, n->children_[n->child_index_[byte] - 1]);
+        }
+      }
+      break;
+    }
+    default: {
+      auto *n = static_cast<const Node256 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        add(byte, n->children_[byte]);
+      }
+    }
+  }
+  return count;
+}
+
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::Node *AdaptiveRadixTree<ValueType>::CopyNode(const Node *node, NodeType type,
+                                                                                    int skip) {
+  Node *copy = NewNode(type);
+  copy->prefix_length_ = node->prefix_length_;
+  std::memcpy(copy->prefix_, node->prefix_, ART_MAX_PREFIX);
+  uint8_t bytes[256];
+  Node *children[256];
+  int count = Children(node, bytes, children);
+  for (int i = 0; i < count; i++) {
+    if (bytes[i] != skip) {
+      AddChild(copy, bytes[i], children[i]);
+    }
+  }
+  return copy;
+}
+
+/*
+ * A prefix longer than ART_MAX_PREFIX is read from the key of any leaf below
+ * the node, they all share it.
+ */
+template <typename ValueType>
+std::string AdaptiveRadixTree<ValueType>::FullPrefix(const Node *node, size_t depth) {
+  if (node->prefix_length_ <= ART_MAX_PREFIX) {
+    return std::string(reinterpret_cast<const char *>(node->prefix_), node->prefix_length_);
+  }
+  uint8_t bytes[256];
+  Node *children[256];
+  const Node *cur = node;
+  while (!IsLeaf(cur)) {
+    if (Children(cur, bytes, children) == 0) {
+      return std::string(reinterpret_cast<const char *>(node->prefix_), ART_MAX_PREFIX);
+    }
+    cur = children[0];
+  }
+  return AsLeaf(cur)->key_.substr(depth, node->prefix_length_);
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::SetPrefix(Node *node, const char *prefix, uint32_t length) {
+  node->prefix_length_ = length;
+  std::memcpy(node->prefix_, prefix, std::min(length, ART_MAX_PREFIX));
+}
+
+template <typename ValueType>
+bool AdaptiveRadixTree<ValueType>::PrefixMatches(const Node *node, const std::string &key, size_t depth) {
+  uint32_t stored = std::min(node->prefix_length_, ART_MAX_PREFIX);
+  for (uint32_t i = 0; i < stored; i++) {
+    if (depth + i >= key.size() || node->prefix_[i] != KeyByte(key, depth + i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::DeleteNode(void *node) {
+  auto *n = static_cast<Node *>(node);
+  switch (n->type_) {
+    case NodeType::NODE4:
+      delete static_cast<Node4 *>(n);
+      break;
+    case NodeType::NODE16:
+      delete static_cast<Node16 *>(n);
+      break;
+    case NodeType::NODE48:
+      delete static_cast<Node48 *>(n);
+      break;
+    default:
+      delete static_cast<Node256 *>(n);
+  }
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::DeleteLeaf(void *leaf) {
+  delete static_cast<Leaf *>(leaf);
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::FreeSubtree(Node *node) {
+  if (IsLeaf(node)) {
+    delete AsLeaf(node);
+    return;
+  }
+  uint8_t bytes[256];
+  Node *children[256];
+  int count = Children(node, bytes, children);
+  for (int i = 0; i < count; i++) {
+    FreeSubtree(children[i]);
+  }
+  DeleteNode(node);
+}
+
+/*****************************************************************************
+ * TREE
+ *****************************************************************************/
+template <typename ValueType>
+AdaptiveRadixTree<ValueType>::AdaptiveRadixTree() : root_(new Node256()) {}
+
+template <typename ValueType>
+AdaptiveRadixTree<ValueType>::~AdaptiveRadixTree() {
+  FreeSubtree(root_);
+}
+
+template <typename ValueType>
+bool AdaptiveRadixTree<ValueType>::Insert(const std::string &key, const ValueType &value) {
+  ArtEpochGuard guard;
+  while (true) {
+    OpResult result = InsertOnce(key, value);
+    if (result != OpResult::RESTART) {
+      return result == OpResult::SUCCESS;
+    }
+  }
+}
+
+template <typename ValueType>
+bool AdaptiveRadixTree<ValueType>::Remove(const std::string &key) {
+  ArtEpochGuard guard;
+  while (true) {
+    OpResult result = RemoveOnce(key);
+    if (result != OpResult::RESTART) {
+      return result == OpResult::SUCCESS;
+    }
+  }
+}
+
+template <typename ValueType>
+bool AdaptiveRadixTree<ValueType>::GetValue(const std::string &key, ValueType *value) {
+  ArtEpochGuard guard;
+  while (true) {
+    OpResult result = GetValueOnce(key, value);
+    if (result != OpResult::RESTART) {
+      return result == OpResult::SUCCESS;
+    }
+  }
+}
+
+template <typename ValueType>
+void AdaptiveRadixTree<ValueType>::ScanPrefix(const std::string &prefix, std::vector<ValueType> *result) {
+  ArtEpochGuard guard;
+  std::vector<const Leaf *> leaves;
+  while (ScanOnce(prefix, &leaves) == OpResult::RESTART) {
+    leaves.clear();
+  }
+  for (const Leaf *leaf : leaves) {
+    if (leaf->key_.compare(0, prefix.size(), prefix) == 0) {
+      result->push_back(leaf->value_);
+    }
+  }
+}
+
+/*
+ * Descend to the node the key leaves the tree at, and change only that node
+ * (and its parent, if the node is replaced):
+ * (1) the key differs from the prefix of the node: a new NODE4 in its place
+ *     takes the common part, with the node and the new leaf below it
+ * (2) the node has no child for the next key byte: the leaf is added to it,
+ *     or to a larger copy that replaces it if it is full
+ * (3) the child is a leaf: a new NODE4 takes the bytes the two keys share and
+ *     branches where they part
+ */
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::OpResult AdaptiveRadixTree<ValueType>::InsertOnce(const std::string &key,
+                                                                                        const ValueType &value) {
+  Node *parent = nullptr;
+  Node *node = nullptr;
+  Node *next = root_;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  uint8_t node_byte = 0;
+  size_t depth = 0;
+  while (true) {
+    parent = node;
+    parent_byte = node_byte;
+    node = next;
+    uint64_t version;
+    if (!node->ReadLock(&version)) {
+      return OpResult::RESTART;
+    }
+
+    if (node->prefix_length_ > 0) {
+      std::string prefix = FullPrefix(node, depth);
+      if (!node->Validate(version)) {
+        return OpResult::RESTART;
+      }
+      uint32_t match = 0;
+      while (match < prefix.size() && depth + match < key.size() && prefix[match] == key[depth + match]) {
+        match++;
+      }
+      if (match < prefix.size()) {
+        if (!parent->Upgrade(parent_version)) {
+          return OpResult::RESTART;
+        }
+        if (!node->Upgrade(version)) {
+          parent->WriteUnlock();
+          return OpResult::RESTART;
+        }
+        Node *split = new Node4();
+        SetPrefix(split, prefix.data(), match);
+        AddChild(split, static_cast<uint8_t>(prefix[match]), node);
+        AddChild(split, KeyByte(key, depth + match), MakeLeaf(key, value));
+        SetPrefix(node, prefix.data() + match + 1, prefix.size() - match - 1);
+        ChangeChild(parent, parent_byte, split);
+        node->WriteUnlock();
+        parent->WriteUnlock();
+        return OpResult::SUCCESS;
+      }
+      depth += node->prefix_length_;
+    }
+
+    node_byte = KeyByte(key, depth);
+    next = FindChild(node, node_byte);
+    if (!node->Validate(version)) {
+      return OpResult::RESTART;
+    }
+
+    if (next == nullptr) {
+      if (node->count_ < Capacity(node->type_)) {
+        if (!node->Upgrade(version)) {
+          return OpResult::RESTART;
+        }
+        AddChild(node, node_byte, MakeLeaf(key, value));
+        node->WriteUnlock();
+        return OpResult::SUCCESS;
+      }
+      if (!parent->Upgrade(parent_version)) {
+        return OpResult::RESTART;
+      }
+      if (!node->Upgrade(version)) {
+        parent->WriteUnlock();
+        return OpResult::RESTART;
+      }
+      Node *grown = CopyNode(node, static_cast<NodeType>(static_cast<int>(node->type_) + 1), -1);
+      AddChild(grown, node_byte, MakeLeaf(key, value));
+      ChangeChild(parent, parent_byte, grown);
+      node->WriteUnlockObsolete();
+      ArtEpochManager::Instance().Retire(node, DeleteNode);
+      parent->WriteUnlock();
+      return OpResult::SUCCESS;
+    }
+
+    if (IsLeaf(next)) {
+      if (!node->Upgrade(version)) {
+        return OpResult::RESTART;
+      }
+      const Leaf *leaf = AsLeaf(next);
+      if (leaf->key_ == key) {
+        node->WriteUnlock();
+        return OpResult::FAILURE;
+      }
+      size_t start = depth + 1;
+      size_t common = 0;
+      while (start + common < key.size() && start + common < leaf->key_.size() &&
+             key[start + common] == leaf->key_[start + common]) {
+        common++;
+      }
+      Node *split = new Node4();
+      SetPrefix(split, key.data() + start, common);
+      AddChild(split, KeyByte(leaf->key_, start + common), next);
+      AddChild(split, KeyByte(key, start + common), MakeLeaf(key, value));
+      ChangeChild(node, node_byte, split);
+      node->WriteUnlock();
+      return OpResult::SUCCESS;
+    }
+
+    parent_version = version;
+    depth++;
+  }
+}
+
+/*
+ * Remove the leaf of key from its node. A NODE4 left with one child is
+ * replaced by that child, whose prefix then starts with the prefix of the
+ * node and the byte to the child; other nodes that drop well below the size
+ * of the next smaller type are replaced by a copy of that type.
+ */
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::OpResult AdaptiveRadixTree<ValueType>::RemoveOnce(const std::string &key) {
+  Node *parent = nullptr;
+  Node *node = nullptr;
+  Node *next = root_;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  uint8_t node_byte = 0;
+  size_t depth = 0;
+  while (true) {
+    parent = node;
+    parent_byte = node_byte;
+    node = next;
+    uint64_t version;
+    if (!node->ReadLock(&version)) {
+      return OpResult::RESTART;
+    }
+    size_t prefix_depth = depth;
+    depth += node->prefix_length_;
+    if (!PrefixMatches(node, key, prefix_depth) || depth >= key.size()) {
+      return node->Validate(version) ? OpResult::FAILURE : OpResult::RESTART;
+    }
+    node_byte = KeyByte(key, depth);
+    next = FindChild(node, node_byte);
+    if (!node->Validate(version)) {
+      return OpResult::RESTART;
+    }
+    if (next == nullptr) {
+      return OpResult::FAILURE;
+    }
+    if (!IsLeaf(next)) {
+      parent_version = version;
+      depth++;
+      continue;
+    }
+    if (AsLeaf(next)->key_ != key) {
+      return OpResult::FAILURE;
+    }
+
+    int remaining = node->count_ - 1;
+    bool shrink = (node->type_ == NodeType::NODE4 && remaining == 1) ||
+                  (node->type_ == NodeType::NODE16 && remaining <= 3) ||
+                  (node->type_ == NodeType::NODE48 && remaining <= 12) ||
+                  (node->type_ == NodeType::NODE256 && remaining <= 37);
+    if (node == root_ || !shrink) {
+      if (!node->Upgrade(version)) {
+        return OpResult::RESTART;
+      }
+      RemoveChild(node, node_byte);
+      node->WriteUnlock();
+      ArtEpochManager::Instance().Retire(AsLeaf(next), DeleteLeaf);
+      return OpResult::SUCCESS;
+    }
+
+    if (!parent->Upgrade(parent_version)) {
+      return OpResult::RESTART;
+    }
+    if (!node->Upgrade(version)) {
+      parent->WriteUnlock();
+      return OpResult::RESTART;
+    }
+    Node *replacement;
+    if (node->type_ == NodeType::NODE4) {
+      uint8_t bytes[4];
+      Node *children[4];
+      Children(node, bytes, children);
+      int other = bytes[0] == node_byte ? 1 : 0;
+      replacement = children[other];
+      if (!IsLeaf(replacement)) {
+        uint64_t child_version;
+        if (!replacement->ReadLock(&child_version) || !replacement->Upgrade(child_version)) {
+          node->WriteUnlock();
+          parent->WriteUnlock();
+          return OpResult::RESTART;
+        }
+        std::string prefix = FullPrefix(node, prefix_depth);
+        prefix.push_back(static_cast<char>(bytes[other]));
+        prefix += FullPrefix(replacement, depth + 1);
+        SetPrefix(replacement, prefix.data(), prefix.size());
+        replacement->WriteUnlock();
+      }
+    } else {
+      replacement = CopyNode(node, static_cast<NodeType>(static_cast<int>(node->type_) - 1), node_byte);
+    }
+    ChangeChild(parent, parent_byte, replacement);
+    node->WriteUnlockObsolete();
+    parent->WriteUnlock();
+    ArtEpochManager::Instance().Retire(node, DeleteNode);
+    ArtEpochManager::Instance().Retire(AsLeaf(next), DeleteLeaf);
+    return OpResult::SUCCESS;
+  }
+}
+
+/*
+ * Only the stored prefix bytes are compared on the way down, the key of the
+ * leaf is compared as a whole at the end.
+ */
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::OpResult AdaptiveRadixTree<ValueType>::GetValueOnce(const std::string &key,
+                                                                                          ValueType *value) {
+  const Node *node = root_;
+  size_t depth = 0;
+  while (true) {
+    uint64_t version;
+    if (!node->ReadLock(&version)) {
+      return OpResult::RESTART;
+    }
+    size_t prefix_depth = depth;
+    depth += node->prefix_length_;
+    if (!PrefixMatches(node, key, prefix_depth) || depth >= key.size()) {
+      return node->Validate(version) ? OpResult::FAILURE : OpResult::RESTART;
+    }
+    const Node *next = FindChild(node, KeyByte(key, depth));
+    if (!node->Validate(version)) {
+      return OpResult::RESTART;
+    }
+    if (next == nullptr) {
+      return OpResult::FAILURE;
+    }
+    if (IsLeaf(next)) {
+      if (AsLeaf(next)->key_ != key) {
+        return OpResult::FAILURE;
+      }
+      *value = AsLeaf(next)->value_;
+      return OpResult::SUCCESS;
+    }
+    node = next;
+    depth++;
+  }
+}
+
+template <typename ValueType>
+typename AdaptiveRadixTree<ValueType>::OpResult AdaptiveRadixTree<ValueType>::ScanOnce(
+    const std::string &prefix, std::vector<const Leaf *> *leaves) {
+  const Node *node = root_;
+  size_t depth = 0;
+  while (true) {
+    uint64_t version;
+    if (!node->ReadLock(&version)) {
+      return OpResult::RESTART;
+    }
+    uint32_t stored = std::min(node->prefix_length_, ART_MAX_PREFIX);
+    for (uint32_t i = 0; i < stored && depth + i < prefix.size(); i++) {
+      if (node->prefix_[i] != KeyByte(prefix, depth + i)) {
+        return node->Validate(version) ? OpResult::SUCCESS : OpResult::RESTART;
+      }
+    }
+    depth += node->prefix_length_;
+    if (depth >= prefix.size()) {
+      // the whole subtree starts with the prefix, as far as the stored bytes tell
+      if (!node->Validate(version)) {
+        return OpResult::RESTART;
+      }
+      return CollectLeaves(node, leaves) ? OpResult::SUCCESS : OpResult::RESTART;
+    }
+    const Node *next = FindChild(node, KeyByte(prefix, depth));
+    if (!node->Validate(version)) {
+      return OpResult::RESTART;
+    }
+    if (next == nullptr) {
+      return OpResult::SUCCESS;
+    }
+    if (IsLeaf(next)) {
+      leaves->push_back(AsLeaf(next));
+      return OpResult::SUCCESS;
+    }
+    node = next;
+    depth++;
+  }
+}
+
+template <typename ValueType>
+bool AdaptiveRadixTree<ValueType>::CollectLeaves(const Node *node, std::vector<const Leaf *> *leaves) {
+  uint64_t version;
+  if (!node->ReadLock(&version)) {
+    return false;
+  }
+  uint8_t bytes[256];
+  Node *children[256];
+  int count = Children(node, bytes, children);
+  if (!node->Validate(version)) {
+    return false;
+  }
+  for (int i = 0; i < count; i++) {
+    if (IsLeaf(children[i])) {
+      leaves->push_back(AsLeaf(children[i]));
+    } else if (!CollectLeaves(children[i], leaves)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template class AdaptiveRadixTree<RID>;
+
+}  // namespace bustub
@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.cpp
+//
+// Identification: src/storage/index/art_index.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art_index.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+ArtIndex::ArtIndex(IndexMetadata *metadata) : Index(metadata), encoder_(metadata->GetKeySchema()) {}
+
+std::string ArtIndex::EncodeKey(const Tuple &key) const {
+  std::string encoded;
+  encoder_.Encode(key, &encoded);
+  return encoded;
+}
+
+// the rid is appended big-endian, so the entries of a key come out by page id and then by slot
+std::string ArtIndex::EncodeEntry(const Tuple &key, RID rid) const {
+  std::string encoded = EncodeKey(key);
+  auto page_id = static_cast<uint32_t>(rid.GetPageId());
+  uint32_t slot_num = rid.GetSlotNum();
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    encoded.push_back(static_cast<char>((page_id >> shift) & 0xFF));
+  }
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    encoded.push_back(static_cast<char>((slot_num >> shift) & 0xFF));
+  }
+  return encoded;
+}
+
+void ArtIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  FilterAdd(key);
+  container_.Insert(EncodeEntry(key, rid), rid);
+}
+
+void ArtIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(EncodeEntry(key, rid));
+  FilterRemove(key);
+}
+
+void ArtIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (FilterMayContain(key)) {
+    container_.ScanPrefix(EncodeKey(key), result);
+  }
+}
+
+}  // namespace bustub
@@ -9,22 +9,70 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/page/header_page.h"
 namespace bustub {
+// optimistic lookups that keep colliding with writers fall back to read latches after this many attempts
+static constexpr int OPTIMISTIC_READ_RETRIES = 8;
+
+/*
+ * Number of entries bulk loading puts into a page. A page splits once it
+ * reaches max_size, so it holds at most max_size - 1 entries, and every page
+ * but the root must keep max_size / 2 of them.
+ */
+static int BulkLoadFillSize(int max_size, double fill_factor) {
+  int fill = static_cast<int>((max_size - 1) * fill_factor);
+  return std::max(std::min(std::max(fill, max_size / 2), max_size - 1), 1);
+}
+
+/*
+ * Split count entries into pages of fill entries. If the last page would
+ * underflow it takes entries from the one before it, or the two are merged
+ * when that is not enough for both (they then fit into one page).
+ */
+static std::vector<int> BulkLoadPageSizes(int count, int fill, int min_size) {
+  std::vector<int> sizes;
+  for (int left = count; left > 0; left -= std::min(left, fill)) {
+    sizes.push_back(std::min(left, fill));
+  }
+  if (sizes.size() > 1 && sizes.back() < min_size) {
+    int total = sizes[sizes.size() - 2] + sizes.back();
+    sizes.pop_back();
+    if (total >= 2 * min_size) {
+      sizes.back() = total - min_size;
+      sizes.push_back(min_size);
+    } else {
+      sizes.back() = total;
+    }
+  }
+  return sizes;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool unique_keys, double merge_threshold)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      unique_keys_(unique_keys),
+      merge_threshold_(merge_threshold) {
+  if (index_name_.empty() || index_name_.length() >= HeaderPage::NAME_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "index name does not fit in the header page");
+  }
+  std::fill(posting_free_page_, posting_free_page_ + POSTING_PAGE_CLASS, INVALID_PAGE_ID);
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -35,27 +83,234 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID;
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values that associated with input key
  * This method is used for point query
+ * A posting list is read on the latched path, since its pages carry no version.
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  if (IsEmpty()) {
-    return false;
+  ValueType query_res;
+  bool exist = false;
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; attempt++) {
+    if (OptimisticLookup(key, &query_res, &exist)) {
+      if (exist && IsPostingList(query_res)) {
+        break;
+      }
+      if (exist) {
+        result->push_back(query_res);
+      }
+      return exist;
+    }
+    std::this_thread::yield();
   }
+
   Page *leaf_page = FindLeafPage(key, Operation::SEARCH);
+  if (leaf_page == nullptr) {
+    return false;
+  }
   LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-  ValueType query_res;
-  bool exist = node->Lookup(key, &query_res, comparator_);
-  UnlockAndUnpinPageOfNode(leaf_page, false, LockMode::READ);
-
-  if (exist) {
+  exist = node->Lookup(key, &query_res, comparator_);
+  if (exist && IsPostingList(query_res)) {
+    CollectPostingList(query_res, result);
+  } else if (exist) {
     result->push_back(query_res);
   }
+  UnlatchAndUnpinPage(leaf_page, LockMode::READ, false);
   return exist;
 }
 
+/*
+ * Optimistic lock coupling: walk down without latching, remembering the
+ * version of each page. A child pointer is only followed after the parent's
+ * version is validated, and the parent is validated again once the child's
+ * version is read, so the child was still linked from the parent at that
+ * point. Pages are pinned, which keeps the frames from being reused under us.
+ * @return : false if some page changed while it was read; *value and *found
+ * are only meaningful when true is returned
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticLookup(const KeyType &key, ValueType *value, bool *found) {
+  page_id_t root_page_id = root_page_id_;
+  if (root_page_id == INVALID_PAGE_ID) {
+    *found = false;
+    return true;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  uint64_t version;
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  // the root may have split or shrunk since root_page_id_ was loaded
+  if (!page->TryReadVersion(&version) || !node->IsRootPage() || !page->ValidateVersion(version)) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+
+  while (!node->IsLeafPage()) {
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+    if (!page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw "out of memory";
+    }
+    uint64_t child_version;
+    bool valid = child_page->TryReadVersion(&child_version) && page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_page->GetPageId(), false);
+      return false;
+    }
+    page = child_page;
+    version = child_version;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+
+  ValueType leaf_value;
+  bool exist = reinterpret_cast<LeafPage *>(node)->Lookup(key, &leaf_value, comparator_);
+  bool valid = page->ValidateVersion(version);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (!valid) {
+    return false;
+  }
+  *found = exist;
+  if (exist) {
+    *value = leaf_value;
+  }
+  return true;
+}
+
+/*
+ * Batched point lookups. The keys are probed in sorted order, and each probe
+ * starts from the path the previous one left behind: the pages stay pinned
+ * with the version they were read at, and the next key only walks back up to
+ * the deepest page that still covers it, for neighboring keys usually the
+ * leaf itself. Keys that run into a concurrent write go through GetValue().
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), std::vector<ValueType>());
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this, &keys](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  std::vector<PathEntry> path;
+  for (size_t i : order) {
+    if (!PathLookup(keys[i], &path, &(*results)[i])) {
+      ReleasePath(&path);
+      GetValue(keys[i], &(*results)[i], transaction);
+    }
+  }
+  ReleasePath(&path);
+}
+
+/*
+ * One probe of GetValues(), keys must come in ascending order. Since the
+ * previous key was routed to every page of the path, such a page covers any
+ * key from there up to its last key (the last separator for internal pages),
+ * as long as its version did not change: splits, merges and redistributions
+ * all write the page whose range they change. The descent below that page is
+ * the one of OptimisticLookup(), and a posting list is read with the leaf
+ * read latched.
+ * @return : false if some page changed while it was read, result is untouched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::PathLookup(const KeyType &key, std::vector<PathEntry> *path, std::vector<ValueType> *result) {
+  while (!path->empty()) {
+    PathEntry entry = path->back();
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(entry.page_->GetData());
+    bool covers;
+    if (node->IsLeafPage()) {
+      LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
+      covers = leaf->GetSize() > 0 && comparator_(key, leaf->KeyAt(leaf->GetSize() - 1)) <= 0;
+    } else {
+      InternalPage *internal = reinterpret_cast<InternalPage *>(node);
+      covers = internal->GetSize() > 1 && comparator_(key, internal->KeyAt(internal->GetSize() - 1)) < 0;
+    }
+    if (!entry.page_->ValidateVersion(entry.version_)) {
+      return false;
+    }
+    // the root covers every key
+    if (covers || path->size() == 1) {
+      break;
+    }
+    buffer_pool_manager_->UnpinPage(entry.page_->GetPageId(), false);
+    path->pop_back();
+  }
+
+  if (path->empty()) {
+    page_id_t root_page_id = root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return true;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id);
+    if (page == nullptr) {
+      throw "out of memory";
+    }
+    uint64_t version;
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!page->TryReadVersion(&version) || !node->IsRootPage() || !page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    path->push_back({page, version});
+  }
+
+  while (!reinterpret_cast<BPlusTreePage *>(path->back().page_->GetData())->IsLeafPage()) {
+    PathEntry entry = path->back();
+    page_id_t child_page_id = reinterpret_cast<InternalPage *>(entry.page_->GetData())->Lookup(key, comparator_);
+    if (!entry.page_->ValidateVersion(entry.version_)) {
+      return false;
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      throw "out of memory";
+    }
+    uint64_t child_version;
+    if (!child_page->TryReadVersion(&child_version) || !entry.page_->ValidateVersion(entry.version_)) {
+      buffer_pool_manager_->UnpinPage(child_page->GetPageId(), false);
+      return false;
+    }
+    path->push_back({child_page, child_version});
+  }
+
+  PathEntry entry = path->back();
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(entry.page_->GetData());
+  ValueType value;
+  bool exist = leaf->Lookup(key, &value, comparator_);
+  if (!entry.page_->ValidateVersion(entry.version_)) {
+    return false;
+  }
+  if (exist && IsPostingList(value)) {
+    // posting pages carry no version, the latch keeps the list from changing while it is copied
+    entry.page_->RLatch();
+    bool valid = entry.page_->ValidateVersion(entry.version_);
+    if (valid) {
+      CollectPostingList(value, result);
+    }
+    entry.page_->RUnlatch();
+    return valid;
+  }
+  if (exist) {
+    result->push_back(value);
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePath(std::vector<PathEntry> *path) {
+  for (const auto &entry : *path) {
+    buffer_pool_manager_->UnpinPage(entry.page_->GetPageId(), false);
+  }
+  path->clear();
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -63,44 +318,59 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
+ * The insert is first tried on the optimistic path, which only write latches
+ * the leaf; if the leaf is full it restarts with InsertIntoLeaf().
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  latch_.lock();
-
-  if (IsEmpty()) {
-    StartNewTree(key, value);
+  Page *leaf_page = FindLeafPage(key, Operation::INSERT);
+  if (leaf_page != nullptr) {
+    LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    if (node->Lookup(key, nullptr, comparator_)) {
+      // another value of an existing key never splits the leaf
+      bool inserted = !unique_keys_ && AddToPostingList(node, node->KeyIndex(key, comparator_), value);
+      UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, inserted);
+      return inserted;
+    }
+    if (IsSafe(node, Operation::INSERT)) {
+      node->Insert(key, value, comparator_);
+      UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, true);
+      return true;
+    }
+    UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, false);
+  }
 
-    latch_.unlock();
-    return true;
-  } else {
-    latch_.unlock();
-    return InsertIntoLeaf(key, value);
+  if (transaction != nullptr) {
+    return InsertIntoLeaf(key, value, transaction);
   }
+  Transaction local_transaction(INVALID_TXN_ID);
+  return InsertIntoLeaf(key, value, &local_transaction);
 }
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * NOTE: the caller must hold the root latch in write mode
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
-  Page *root_page = buffer_pool_manager_->NewPage(&root_page_id_);
+  page_id_t root_page_id;
+  Page *root_page = buffer_pool_manager_->NewPage(&root_page_id);
   if (root_page == nullptr) {
     throw "out of memory";
   }
 
-  LockPage(root_page, LockMode::WRITE);
-  LOG_INFO("create lock page %d, insert key %d", root_page->GetPageId(), (int)key.ToString());
   LeafPage *node = reinterpret_cast<LeafPage *>(root_page->GetData());
-  node->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
+  node->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_);
   node->Insert(key, value, comparator_);
 
+  // publish the root only once it is initialized, optimistic readers do not take the root latch
+  root_page_id_ = root_page_id;
   UpdateRootPageId(1);
-  UnlockAndUnpinPageOfNode(root_page, true, LockMode::WRITE);
+  buffer_pool_manager_->UnpinPage(root_page_id, true);
 }
 
 /*
@@ -108,34 +378,38 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
+ * This is the pessimistic path: every page that may split stays write latched
+ * in the transaction's page set until the insert is done.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  Page *leaf_page = FindLeafPage(key, Operation::INSERT);
-  LOG_INFO("findleaf return page %d pincount %d",leaf_page->GetPageId(),leaf_page->GetPinCount());
+  Page *leaf_page = FindLeafPageExclusive(key, Operation::INSERT, transaction);
+  if (leaf_page == nullptr) {
+    StartNewTree(key, value);
+    ReleaseLatchedPages(transaction, true);
+    return true;
+  }
   LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
   if (node->Lookup(key, nullptr, comparator_)) {
-    UnlockAndUnpinPageOfNode(leaf_page, false, LockMode::WRITE);
-    return false;
+    bool inserted = !unique_keys_ && AddToPostingList(node, node->KeyIndex(key, comparator_), value);
+    ReleaseLatchedPages(transaction, inserted);
+    return inserted;
   }
 
-  LOG_INFO("befor lock page %d pincount %d, insert key %d", leaf_page->GetPageId(),leaf_page->GetPinCount(), (int)key.ToString());
   int after_insert_size = node->Insert(key, value, comparator_);
-  LOG_INFO("after lock page %d pincount %d, insert key %d", leaf_page->GetPageId(),leaf_page->GetPinCount(), (int)key.ToString());
   if (after_insert_size >= node->GetMaxSize()) {
     LeafPage *l2_node = Split(node);
     l2_node->SetNextPageId(node->GetNextPageId());
+    l2_node->SetPrevPageId(node->GetPageId());
     node->SetNextPageId(l2_node->GetPageId());
-    KeyType middle_key = l2_node->KeyAt(0);
-    LOG_INFO("node page %d pincount %d",leaf_page->GetPageId(),leaf_page->GetPinCount());
-    InsertIntoParent(node, middle_key, l2_node);
-
-  } else {
-    UnlockAndUnpinPageOfNode(leaf_page, true, LockMode::WRITE);
+    SetPrevLink(l2_node->GetNextPageId(), l2_node->GetPageId());
+    InsertIntoParent(node, l2_node->KeyAt(0), l2_node, transaction);
+    buffer_pool_manager_->UnpinPage(l2_node->GetPageId(), true);
   }
+  ReleaseLatchedPages(transaction, true);
   return true;
 }
 
@@ -145,20 +419,21 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page is pinned but not latched: it cannot be reached before the
+ * write latched parent links it. The caller unpins it.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
   page_id_t l2_page_id;
   Page *l2_page = buffer_pool_manager_->NewPage(&l2_page_id);
-  LOG_INFO("AFTER SPLIT PAGE %d", l2_page->GetPageId());
-  LockPage(l2_page, LockMode::WRITE);
   if (l2_page == nullptr) {
     throw "out of memory";
   }
   N *l2_node = reinterpret_cast<N *>(l2_page->GetData());
   l2_node->Init(l2_page_id, node->GetParentPageId(), node->GetMaxSize());
   node->MoveHalfTo(l2_node, buffer_pool_manager_);
+  splits_++;
   return l2_node;
 }
 
@@ -170,44 +445,247 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * NOTE: old_node was unsafe, so its parent (or the root latch, if old_node is
+ * the root) is still write latched in the transaction's page set.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
-  Page *parent_page;
-  InternalPage *parent_node;
-  // the old_node and new_node have been WLock by caller
   if (old_node->IsRootPage()) {
     page_id_t new_root_page_id;
-    parent_page = buffer_pool_manager_->NewPage(&new_root_page_id);
-    LOG_INFO("NEW ROOT %d", new_root_page_id);
-    root_page_id_ = new_root_page_id;
-    UpdateRootPageId(0);
-    new_node->SetParentPageId(new_root_page_id);
-    old_node->SetParentPageId(new_root_page_id);
-    LockPage(parent_page, LockMode::WRITE);
-    parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
-    parent_node->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
-  } else {
-    parent_page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
-    if (parent_page == nullptr) {
+    Page *root_page = buffer_pool_manager_->NewPage(&new_root_page_id);
+    if (root_page == nullptr) {
       throw "out of memory";
     }
-    LockPage(parent_page, LockMode::WRITE);
-    parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    InternalPage *root_node = reinterpret_cast<InternalPage *>(root_page->GetData());
+    root_node->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root_node->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(new_root_page_id);
+    new_node->SetParentPageId(new_root_page_id);
+    root_page_id_ = new_root_page_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(new_root_page_id, true);
+    return;
   }
-  LOG_INFO("SPLIT:old %d new %d parent %d", old_node->GetPageId(), new_node->GetPageId(), parent_node->GetPageId());
-  int after_insert_size = parent_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-  UnlockAndUnpinPageOfNode(old_node, true, LockMode::WRITE);
-  UnlockAndUnpinPageOfNode(new_node, true, LockMode::WRITE);
 
+  Page *parent_page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
+  if (parent_page == nullptr) {
+    throw "out of memory";
+  }
+  InternalPage *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int after_insert_size = parent_node->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
   if (after_insert_size >= parent_node->GetMaxSize()) {
     InternalPage *l2_node = Split(parent_node);
-    KeyType middle_key = l2_node->KeyAt(0);
-    InsertIntoParent(parent_node, middle_key, l2_node);
-  } else {
-    UnlockAndUnpinPageOfNode(parent_page, true, LockMode::WRITE);
+    InsertIntoParent(parent_node, l2_node->KeyAt(0), l2_node, transaction);
+    buffer_pool_manager_->UnpinPage(l2_node->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * BATCHED UPDATES
+ *****************************************************************************/
+/*
+ * Apply the inserts and deletes of messages, which are sorted by key (the
+ * messages of one key in the order they were made). The descent to a leaf
+ * also finds the separator that bounds it on the right, and the messages
+ * after the first go into the same write latched leaf as long as their key is
+ * below it, so a batch with many messages per leaf fetches and writes every
+ * leaf once. A message that would split or merge the leaf goes through
+ * Insert() or Remove() on its own.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ApplyMessages(const std::vector<BPlusTreeMessage<KeyType, ValueType>> &messages,
+                                   Transaction *transaction) {
+  size_t i = 0;
+  while (i < messages.size()) {
+    KeyType upper;
+    bool has_upper;
+    Page *leaf_page = FindLeafPage(messages[i].key_, Operation::INSERT, false, false, &upper, &has_upper);
+    bool applied = false;
+    if (leaf_page != nullptr) {
+      LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+      while (i < messages.size() && (!has_upper || comparator_(messages[i].key_, upper) < 0) &&
+             ApplyToLeaf(node, messages[i])) {
+        applied = true;
+        i++;
+      }
+      UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, applied);
+    }
+    if (!applied) {
+      if (messages[i].insert_) {
+        Insert(messages[i].key_, messages[i].value_, transaction);
+      } else {
+        Remove(messages[i].key_, messages[i].value_, transaction);
+      }
+      i++;
+    }
+  }
+}
+
+/*
+ * The leaf-only part of Insert() and Remove(): an insert of a new key needs
+ * room for it, and a delete of a key (rather than of one value of its posting
+ * list) must not underflow the leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::ApplyToLeaf(LeafPage *node, const BPlusTreeMessage<KeyType, ValueType> &message) {
+  ValueType leaf_value;
+  bool exist = node->Lookup(message.key_, &leaf_value, comparator_);
+  if (message.insert_) {
+    if (exist) {
+      if (!unique_keys_) {
+        AddToPostingList(node, node->KeyIndex(message.key_, comparator_), message.value_);
+      }
+      return true;
+    }
+    if (!IsSafe(node, Operation::INSERT)) {
+      return false;
+    }
+    node->Insert(message.key_, message.value_, comparator_);
+    return true;
+  }
+  if (!exist || (!IsPostingList(leaf_value) && !(leaf_value == message.value_))) {
+    return true;
+  }
+  if (IsPostingList(leaf_value)) {
+    RemoveFromPostingList(node, node->KeyIndex(message.key_, comparator_), message.value_);
+    return true;
+  }
+  if (!IsSafe(node, Operation::DELETE)) {
+    return false;
+  }
+  node->RemoveAndDeleteRecord(message.key_, comparator_);
+  return true;
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree bottom-up from the pairs of sorter, which is finished here.
+ * The leaves are filled left to right with BulkLoadFillSize() pairs each and
+ * then every internal level is built from the first keys of the level below,
+ * so no page is split and every page is written once. Pairs with a key that
+ * was already loaded are skipped like Insert() does, or go to the key's
+ * posting list if the keys are not unique.
+ * @return: false if the tree is not empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(ExternalMergeSort<KeyType, ValueType, KeyComparator> *sorter, double fill_factor) {
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  sorter->Finish();
+
+  int leaf_fill = BulkLoadFillSize(leaf_max_size_, fill_factor);
+  // (first key, page id) of every page on the level that was built last
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  // the previous leaf stays pinned, so that the last leaf can be balanced against it
+  LeafPage *prev_leaf = nullptr;
+  LeafPage *leaf = nullptr;
+  KeyType key;
+  ValueType value;
+  while (sorter->Next(&key, &value)) {
+    if (leaf != nullptr && comparator_(leaf->KeyAt(leaf->GetSize() - 1), key) == 0) {
+      if (!unique_keys_) {
+        AddToPostingList(leaf, leaf->GetSize() - 1, value);
+      }
+      continue;
+    }
+    if (leaf == nullptr || leaf->GetSize() >= leaf_fill) {
+      page_id_t leaf_page_id;
+      Page *leaf_page = buffer_pool_manager_->NewPage(&leaf_page_id);
+      if (leaf_page == nullptr) {
+        throw "out of memory";
+      }
+      auto *next_leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+      next_leaf->Init(leaf_page_id, INVALID_PAGE_ID, leaf_max_size_);
+      if (leaf != nullptr) {
+        leaf->SetNextPageId(leaf_page_id);
+        next_leaf->SetPrevPageId(leaf->GetPageId());
+      }
+      if (prev_leaf != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+      }
+      prev_leaf = leaf;
+      leaf = next_leaf;
+      level.emplace_back(key, leaf_page_id);
+    }
+    leaf->Insert(key, value, comparator_);
+  }
+  if (leaf == nullptr) {
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  int leaf_min_size = leaf_max_size_ / 2;
+  if (prev_leaf != nullptr && leaf->GetSize() < leaf_min_size) {
+    if (prev_leaf->GetSize() + leaf->GetSize() >= 2 * leaf_min_size) {
+      while (leaf->GetSize() < leaf_min_size) {
+        prev_leaf->MoveLastToFrontOf(leaf, key, buffer_pool_manager_);
+      }
+      level.back().first = leaf->KeyAt(0);
+    } else {
+      leaf->MoveAllTo(prev_leaf, key, buffer_pool_manager_);
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+      buffer_pool_manager_->DeletePage(leaf->GetPageId());
+      level.pop_back();
+      leaf = nullptr;
+    }
+  }
+  if (prev_leaf != nullptr) {
+    buffer_pool_manager_->UnpinPage(prev_leaf->GetPageId(), true);
+  }
+  if (leaf != nullptr) {
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  }
+
+  while (level.size() > 1) {
+    BuildInternalLevel(&level, fill_factor);
+  }
+  root_page_id_ = level[0].second;
+  UpdateRootPageId(1);
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BuildInternalLevel(std::vector<std::pair<KeyType, page_id_t>> *level, double fill_factor) {
+  std::vector<std::pair<KeyType, page_id_t>> parent_level;
+  // every internal page needs two children, otherwise the level would not shrink
+  int fill = std::max(BulkLoadFillSize(internal_max_size_, fill_factor), 2);
+  std::vector<int> sizes = BulkLoadPageSizes(static_cast<int>(level->size()), fill, internal_max_size_ / 2);
+  size_t begin = 0;
+  for (int size : sizes) {
+    page_id_t internal_page_id;
+    Page *internal_page = buffer_pool_manager_->NewPage(&internal_page_id);
+    if (internal_page == nullptr) {
+      throw "out of memory";
+    }
+    auto *node = reinterpret_cast<InternalPage *>(internal_page->GetData());
+    node->Init(internal_page_id, INVALID_PAGE_ID, internal_max_size_);
+    // the first child has no key
+    node->PopulateNewRoot((*level)[begin].second, (*level)[begin].first, (*level)[begin].second);
+    node->SetSize(1);
+    for (size_t i = begin + 1; i < begin + size; i++) {
+      node->InsertNodeAfter((*level)[i - 1].second, (*level)[i].first, (*level)[i].second);
+    }
+    for (size_t i = begin; i < begin + size; i++) {
+      Page *child_page = buffer_pool_manager_->FetchPage((*level)[i].second);
+      if (child_page == nullptr) {
+        throw "out of memory";
+      }
+      reinterpret_cast<BPlusTreePage *>(child_page->GetData())->SetParentPageId(internal_page_id);
+      buffer_pool_manager_->UnpinPage((*level)[i].second, true);
+    }
+    parent_level.emplace_back((*level)[begin].first, internal_page_id);
+    buffer_pool_manager_->UnpinPage(internal_page_id, true);
+    begin += size;
   }
+  level->swap(parent_level);
 }
 
 /*****************************************************************************
@@ -219,186 +697,593 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * Like Insert(), the delete is first tried on the optimistic path and restarts
+ * with RemoveFromLeaf() if the leaf would underflow.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  LOG_INFO("delete %d start",(int)key.ToString());
+  RemoveEntry(key, nullptr, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  return RemoveEntry(key, &value, transaction);
+}
+
+/*
+ * Removing one value of a key with a posting list only changes the posting
+ * list. Otherwise the key leaves the tree, which may merge pages.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
   Page *leaf_page = FindLeafPage(key, Operation::DELETE);
-  LOG_INFO("FIND LEAF RETURN");
+  if (leaf_page == nullptr) {
+    return false;
+  }
   LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
-  LOG_INFO("LEAF PAGE %d", leaf_page->GetPageId());
-  if (!leaf_node->Lookup(key, nullptr, comparator_)) {
-    LOG_INFO("cannot find key %d", (int)key.ToString());
-    UnlockAndUnpinPageOfNode(leaf_page, false, LockMode::WRITE);
-    return;
+  ValueType leaf_value;
+  if (!leaf_node->Lookup(key, &leaf_value, comparator_) || (value != nullptr && !IsPostingList(leaf_value) &&
+                                                            !(leaf_value == *value))) {
+    UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, false);
+    return false;
+  }
+  if (value != nullptr && IsPostingList(leaf_value)) {
+    bool removed = RemoveFromPostingList(leaf_node, leaf_node->KeyIndex(key, comparator_), *value);
+    UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, removed);
+    return removed;
+  }
+  if (IsSafe(leaf_node, Operation::DELETE)) {
+    if (IsPostingList(leaf_value)) {
+      DeletePostingList(leaf_value);
+    }
+    leaf_node->RemoveAndDeleteRecord(key, comparator_);
+    UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, true);
+    return true;
+  }
+  UnlatchAndUnpinPage(leaf_page, LockMode::WRITE, false);
+
+  if (transaction != nullptr) {
+    return RemoveFromLeaf(key, value, transaction);
+  }
+  Transaction local_transaction(INVALID_TXN_ID);
+  return RemoveFromLeaf(key, value, &local_transaction);
+}
+
+/*
+ * Pessimistic delete: every page that may merge stays write latched in the
+ * transaction's page set. Pages emptied by a merge are collected in the
+ * transaction's deleted page set and given back to the buffer pool after all
+ * latches are released. The leaf may have changed since the optimistic
+ * attempt, so the value is checked again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, const ValueType *value, Transaction *transaction) {
+  Page *leaf_page = FindLeafPageExclusive(key, Operation::DELETE, transaction);
+  if (leaf_page == nullptr) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+  LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  ValueType leaf_value;
+  if (!leaf_node->Lookup(key, &leaf_value, comparator_) || (value != nullptr && !IsPostingList(leaf_value) &&
+                                                            !(leaf_value == *value))) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+  if (value != nullptr && IsPostingList(leaf_value)) {
+    bool removed = RemoveFromPostingList(leaf_node, leaf_node->KeyIndex(key, comparator_), *value);
+    ReleaseLatchedPages(transaction, removed);
+    return removed;
+  }
+  if (IsPostingList(leaf_value)) {
+    DeletePostingList(leaf_value);
   }
   int after_delete_size = leaf_node->RemoveAndDeleteRecord(key, comparator_);
-  LOG_INFO("page %d delete key %d, after_delete_size %d", leaf_page->GetPageId(), (int)key.ToString(),
-           after_delete_size);
-  if (after_delete_size < leaf_node->GetMinSize()) {
-    bool should_delete = CoalesceOrRedistribute(leaf_node);
-    LOG_INFO("SHOULD DELETE %d",should_delete);
-    if (should_delete) {
-      buffer_pool_manager_->DeletePage(leaf_page->GetPageId());
-    }
-    LOG_INFO("DELETE %d finished",leaf_page->GetPageId());
-  } else {
-    UnlockAndUnpinPageOfNode(leaf_page, true, LockMode::WRITE);
+  if (after_delete_size < MergeSize(leaf_node)) {
+    CoalesceOrRedistribute(leaf_node, transaction);
+  }
+  ReleaseLatchedPages(transaction, true);
+  DeleteReleasedPages(transaction);
+  return true;
+}
+
+/*
+ * Size below which a delete merges or redistributes node. Leaves go down to
+ * merge_threshold_ of their capacity (at least one entry, so an empty leaf
+ * always goes away); internal pages and the root keep the usual minimum.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::MergeSize(BPlusTreePage *node) const {
+  if (!node->IsLeafPage() || node->IsRootPage()) {
+    return node->GetMinSize();
   }
+  return std::min(std::max(static_cast<int>(node->GetMaxSize() * merge_threshold_), 1), node->GetMinSize());
 }
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * The parent is write latched by the caller, the sibling is latched here.
+ * With merge_only (for Compact()) nothing happens if the two do not fit.
  * @return: true means target leaf page should be deleted, false means no
  * deletion happens
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, bool merge_only) {
   if (node->IsRootPage()) {
-    LOG_INFO("CR RETURN");
-    return AdjustRoot(node);
+    bool root_should_delete = AdjustRoot(node);
+    if (root_should_delete) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+    }
+    return root_should_delete;
   }
-  page_id_t parent_page_id = node->GetParentPageId();
-  Page *parent_page = buffer_pool_manager_->FetchPage(parent_page_id);
+  Page *parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
   if (parent_page == nullptr) {
     throw "out of memory";
   }
-  InternalPage *parent_page_as_internal = reinterpret_cast<InternalPage *>(parent_page->GetData());
-  LockPage(parent_page, LockMode::WRITE);
-  int index = parent_page_as_internal->ValueIndex(node->GetPageId());
-  int sibling_index;
-  if (index == 0) {
-    sibling_index = 1;
-  } else {
-    sibling_index = index - 1;
+  InternalPage *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int index = parent_node->ValueIndex(node->GetPageId());
+  int sibling_index = index == 0 ? 1 : index - 1;
+  Page *sibling_page = buffer_pool_manager_->FetchPage(parent_node->ValueAt(sibling_index));
+  if (sibling_page == nullptr) {
+    throw "out of memory";
   }
-  page_id_t sibling_page_id = parent_page_as_internal->ValueAt(sibling_index);
-  Page *sibling_page = buffer_pool_manager_->FetchPage(sibling_page_id);
-  LockPage(sibling_page, LockMode::WRITE);
+  LatchPage(sibling_page, LockMode::WRITE);
   N *sibling_node = reinterpret_cast<N *>(sibling_page->GetData());
 
+  bool node_should_delete = false;
   if (sibling_node->GetSize() + node->GetSize() < node->GetMaxSize()) {
-    LOG_INFO("COALESCE %d %d to %d %d",node->GetPageId(),node->GetSize(),sibling_node->GetPageId(),sibling_node->GetSize());
-    bool parent_should_delete = Coalesce(&sibling_node, &node, &parent_page_as_internal, index);
-    LOG_INFO("parent should delete %d",parent_should_delete);
-    if (parent_should_delete) {
-      buffer_pool_manager_->DeletePage(parent_page_as_internal->GetPageId());
+    // always merge the right page into the left one
+    if (index == 0) {
+      Coalesce(&node, &sibling_node, &parent_node, sibling_index, transaction);
+    } else {
+      Coalesce(&sibling_node, &node, &parent_node, index, transaction);
+      node_should_delete = true;
     }
+  } else if (!merge_only) {
+    Redistribute(sibling_node, node, parent_node, index);
+  }
+  UnlatchAndUnpinPage(sibling_page, LockMode::WRITE, true);
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  return node_should_delete;
+}
 
-    return true;
+/*
+ * Move all the key & value pairs from one page to its sibling page, and notify
+ * buffer pool manager to delete this page. Parent page must be adjusted to
+ * take info of deletion into account. Remember to deal with coalesce or
+ * redistribute recursively if necessary.
+ * Using template N to represent either internal page or leaf page.
+ * @param   neighbor_node      left sibling, receives the entries
+ * @param   node               right page, emptied and deleted
+ * @param   parent             parent page of input "node"
+ * @param   index              index of "node" in parent
+ * @return  true means parent node should be deleted, false means no deletion
+ * happend
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
+                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
+                              Transaction *transaction) {
+  KeyType middle_key = (*parent)->KeyAt(index);
+  (*node)->MoveAllTo(*neighbor_node, middle_key, buffer_pool_manager_);
+  if ((*node)->IsLeafPage()) {
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(*neighbor_node);
+    SetPrevLink(leaf->GetNextPageId(), leaf->GetPageId());
+  }
+  transaction->AddIntoDeletedPageSet((*node)->GetPageId());
+  merges_++;
+  (*parent)->Remove(index);
+  if ((*parent)->GetSize() < (*parent)->GetMinSize()) {
+    return CoalesceOrRedistribute(*parent, transaction);
+  }
+  return false;
+}
+
+/*
+ * Redistribute key & value pairs from one page to its sibling page. If index ==
+ * 0, move sibling page's first key & value pair into end of input "node",
+ * otherwise move sibling page's last key & value pair into head of input
+ * "node".
+ * Using template N to represent either internal page or leaf page.
+ * @param   neighbor_node      sibling page of input "node"
+ * @param   node               input from method coalesceOrRedistribute()
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node,
+                                  BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent_node, int index) {
+  KeyType middle_key;
+  redistributions_++;
+  if (index == 0) {
+    middle_key = parent_node->KeyAt(1);
+    parent_node->SetKeyAt(1, neighbor_node->KeyAt(1));
+    neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_);
   } else {
-    LOG_INFO("REDISTRIBUTE %d %d to %d %d",node->GetPageId(),node->GetSize(),sibling_node->GetPageId(),sibling_node->GetSize());
-    Redistribute(sibling_node, node, parent_page_as_internal, index);
+    middle_key = parent_node->KeyAt(index);
+    parent_node->SetKeyAt(index, neighbor_node->KeyAt(neighbor_node->GetSize() - 1));
+    neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
+  }
+}
+/*
+ * Update root page if necessary
+ * NOTE: size of root page can be less than min size and this method is only
+ * called within coalesceOrRedistribute() method
+ * case 1: when you delete the last element in root page, but root page still
+ * has one last child
+ * case 2: when you delete the last element in whole b+ tree
+ * The root latch is held in write mode, as the root was unsafe.
+ * @return : true means root page should be deleted, false means no deletion
+ * happend
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() < 1) {
+      root_page_id_ = INVALID_PAGE_ID;
+      UpdateRootPageId(0);
+      return true;
+    }
+    return false;
+  }
+  if (old_root_node->GetSize() == 1) {
+    InternalPage *old_root_node_as_internal = reinterpret_cast<InternalPage *>(old_root_node);
+    page_id_t child_page_id = old_root_node_as_internal->RemoveAndReturnOnlyChild();
+    // the only child is the page that absorbed the merge, it is already write latched by this thread
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      throw "out of memory";
+    }
+    BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    child_node->SetParentPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(child_page_id, true);
+    root_page_id_ = child_page_id;
+    UpdateRootPageId(0);
+    return true;
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * COMPACTION
+ *****************************************************************************/
+/*
+ * Re-pack the leaves that lazy merging left below half full. The sparse
+ * leaves are found with the tree read latched top-down, then each one is
+ * merged on its own pessimistic descent, like a delete that underflowed. A
+ * leaf is only merged into a neighbor it fits into, and is checked again
+ * since it may have changed in between, so this can run concurrently with
+ * the other operations.
+ * @return : the number of leaves that were merged away
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  std::vector<KeyType> keys;
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return 0;
+  }
+  Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (root_page == nullptr) {
+    root_latch_.RUnlock();
+    throw "out of memory";
+  }
+  LatchPage(root_page, LockMode::READ);
+  root_latch_.RUnlock();
+  if (!reinterpret_cast<BPlusTreePage *>(root_page->GetData())->IsLeafPage()) {
+    CollectSparseLeaves(root_page, &keys);
+  }
+  UnlatchAndUnpinPage(root_page, LockMode::READ, false);
+
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  size_t merged = 0;
+  for (const KeyType &key : keys) {
+    if (CompactLeaf(key, transaction)) {
+      merged++;
+    }
+  }
+  return merged;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectSparseLeaves(Page *page, std::vector<KeyType> *keys) {
+  InternalPage *node = reinterpret_cast<InternalPage *>(page->GetData());
+  for (int i = 0; i < node->GetSize(); i++) {
+    Page *child_page = buffer_pool_manager_->FetchPage(node->ValueAt(i));
+    if (child_page == nullptr) {
+      throw "out of memory";
+    }
+    LatchPage(child_page, LockMode::READ);
+    BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    if (!child_node->IsLeafPage()) {
+      CollectSparseLeaves(child_page, keys);
+    } else if (child_node->GetSize() < child_node->GetMinSize()) {
+      keys->push_back(reinterpret_cast<LeafPage *>(child_node)->KeyAt(0));
+    }
+    UnlatchAndUnpinPage(child_page, LockMode::READ, false);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CompactLeaf(const KeyType &key, Transaction *transaction) {
+  Page *leaf_page = FindLeafPageExclusive(key, Operation::COMPACT, transaction);
+  if (leaf_page == nullptr) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+  LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+  if (leaf_node->IsRootPage() || leaf_node->GetSize() >= leaf_node->GetMinSize()) {
+    ReleaseLatchedPages(transaction, false);
+    return false;
+  }
+  CoalesceOrRedistribute(leaf_node, transaction, true);
+  bool merged = !transaction->GetDeletedPageSet()->empty();
+  ReleaseLatchedPages(transaction, merged);
+  DeleteReleasedPages(transaction);
+  if (merged) {
+    compactions_++;
+  }
+  return merged;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartCompaction(std::chrono::milliseconds interval) {
+  if (compaction_thread_.joinable()) {
+    return;
+  }
+  enable_compaction_ = true;
+  compaction_thread_ = std::thread([this, interval] {
+    std::unique_lock<std::mutex> guard(compaction_latch_);
+    while (!compaction_cv_.wait_for(guard, interval, [this] { return !enable_compaction_; })) {
+      guard.unlock();
+      Compact();
+      guard.lock();
+    }
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopCompaction() {
+  if (!compaction_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(compaction_latch_);
+    enable_compaction_ = false;
+  }
+  compaction_cv_.notify_all();
+  compaction_thread_.join();
+}
 
+/*****************************************************************************
+ * POSTING LISTS
+ *****************************************************************************/
+/*
+ * Add value to the key at index of the leaf. The second value of a key turns
+ * its leaf value into a posting list in a segment of the smallest size class.
+ * A full segment is copied into one of the next class, and a list that fills
+ * a whole page gets a new first page in front of it. Values of a key are
+ * expected to be distinct (they are RIDs), only the inline value is checked.
+ * @return: false if the key already has exactly this value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::AddToPostingList(LeafPage *node, int index, const ValueType &value) {
+  ValueType leaf_value = node->ValueAt(index);
+  if (!IsPostingList(leaf_value)) {
+    if (leaf_value == value) {
+      return false;
+    }
+    ValueType reference = NewPostingSegment(0, INVALID_PAGE_ID);
+    PostingPage *posting = FetchPostingPage(PostingPage::ReferencedPageId(reference));
+    posting->Append(PostingPage::ReferencedSegment(reference), leaf_value);
+    posting->Append(PostingPage::ReferencedSegment(reference), value);
+    buffer_pool_manager_->UnpinPage(posting->GetPageId(), true);
+    node->SetValueAt(index, reference);
+    return true;
+  }
+
+  page_id_t head_page_id = PostingPage::ReferencedPageId(leaf_value);
+  int segment = PostingPage::ReferencedSegment(leaf_value);
+  PostingPage *head = FetchPostingPage(head_page_id);
+  if (!head->IsFull(segment)) {
+    head->Append(segment, value);
+    buffer_pool_manager_->UnpinPage(head_page_id, true);
+    return true;
+  }
+  int size_class = head->GetSizeClass();
+  if (size_class == POSTING_PAGE_CLASS) {
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
+    ValueType reference = NewPostingSegment(POSTING_PAGE_CLASS, head_page_id);
+    PostingPage *posting = FetchPostingPage(PostingPage::ReferencedPageId(reference));
+    posting->Append(PostingPage::ReferencedSegment(reference), value);
+    buffer_pool_manager_->UnpinPage(posting->GetPageId(), true);
+    node->SetValueAt(index, reference);
+    return true;
+  }
+
+  ValueType reference = NewPostingSegment(size_class + 1, INVALID_PAGE_ID);
+  PostingPage *posting = FetchPostingPage(PostingPage::ReferencedPageId(reference));
+  int new_segment = PostingPage::ReferencedSegment(reference);
+  for (int i = 0; i < head->GetSize(segment); i++) {
+    posting->Append(new_segment, head->ValueAt(segment, i));
+  }
+  posting->Append(new_segment, value);
+  buffer_pool_manager_->UnpinPage(posting->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(head_page_id, false);
+  FreePostingSegment(leaf_value);
+  node->SetValueAt(index, reference);
+  return true;
+}
+
+/*
+ * Remove value from the posting list of the key at index of the leaf. The hole
+ * is filled with the last value of the first segment, so only the first one
+ * shrinks and its page is dropped once empty. A list left with one value is
+ * turned back into an inline leaf value. Lists do not move back to a smaller
+ * size class.
+ * @return: false if value is not in the posting list
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveFromPostingList(LeafPage *node, int index, const ValueType &value) {
+  ValueType reference = node->ValueAt(index);
+  page_id_t head_page_id = PostingPage::ReferencedPageId(reference);
+  int segment = PostingPage::ReferencedSegment(reference);
+  PostingPage *head = FetchPostingPage(head_page_id);
+  PostingPage *posting = head;
+  int value_index = head->ValueIndex(segment, value);
+  while (value_index < 0 && posting->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = posting->GetNextPageId();
+    if (posting != head) {
+      buffer_pool_manager_->UnpinPage(posting->GetPageId(), false);
+    }
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(head_page_id, false);
+      throw "out of memory";
+    }
+    // the pages after the first one of a chain hold a single segment
+    posting = reinterpret_cast<PostingPage *>(next_page->GetData());
+    value_index = posting->ValueIndex(0, value);
+  }
+  if (value_index < 0) {
+    if (posting != head) {
+      buffer_pool_manager_->UnpinPage(posting->GetPageId(), false);
+    }
+    buffer_pool_manager_->UnpinPage(head_page_id, false);
     return false;
   }
+  if (posting == head) {
+    head->RemoveAt(segment, value_index);
+  } else {
+    posting->SetValueAt(0, value_index, head->RemoveAt(segment, head->GetSize(segment) - 1));
+    buffer_pool_manager_->UnpinPage(posting->GetPageId(), true);
+  }
+
+  if (head->GetSize(segment) == 0) {
+    // a list has at least two values, so only the first page of a chain runs empty
+    page_id_t next_page_id = head->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(head_page_id, true);
+    FreePostingSegment(reference);
+    node->SetValueAt(index, PostingPage::MakeReference(next_page_id, 0));
+    return true;
+  }
+  if (head->GetSize(segment) == 1 && head->GetNextPageId() == INVALID_PAGE_ID) {
+    node->SetValueAt(index, head->ValueAt(segment, 0));
+    buffer_pool_manager_->UnpinPage(head_page_id, true);
+    FreePostingSegment(reference);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(head_page_id, true);
+  return true;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
- * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion
- * happend
+ * Append every value of the posting list to result, the leaf must be latched
  */
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N>
-bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) {
-  KeyType middle_key = (*parent)->KeyAt(index);
-  (*node)->MoveAllTo(*neighbor_node, middle_key, buffer_pool_manager_);
-  (*parent)->Remove(index);
-  if ((*parent)->GetSize() < (*parent)->GetMinSize()) {
-    UnlockAndUnpinPageOfNode(*neighbor_node, true, LockMode::WRITE);
-    UnlockAndUnpinPageOfNode(*node, true, LockMode::WRITE);
-    return CoalesceOrRedistribute(*parent);
-  } else {
-    UnlockAndUnpinPageOfNode(*neighbor_node, true, LockMode::WRITE);
-    UnlockAndUnpinPageOfNode(*node, true, LockMode::WRITE);
-    UnlockAndUnpinPageOfNode(*parent, true, LockMode::WRITE);
-    return false;
+void BPLUSTREE_TYPE::CollectPostingList(const ValueType &reference, std::vector<ValueType> *result) {
+  page_id_t posting_page_id = PostingPage::ReferencedPageId(reference);
+  int segment = PostingPage::ReferencedSegment(reference);
+  while (posting_page_id != INVALID_PAGE_ID) {
+    PostingPage *posting = FetchPostingPage(posting_page_id);
+    for (int i = 0; i < posting->GetSize(segment); i++) {
+      result->push_back(posting->ValueAt(segment, i));
+    }
+    page_id_t next_page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(posting_page_id, false);
+    posting_page_id = next_page_id;
+    segment = 0;
   }
 }
 
 /*
- * Redistribute key & value pairs from one page to its sibling page. If index ==
- * 0, move sibling page's first key & value pair into end of input "node",
- * otherwise move sibling page's last key & value pair into head of input
- * "node".
- * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
- * @param   node               input from method coalesceOrRedistribute()
+ * Free every segment of the posting list
  */
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node,
-                                  BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent_node, int index) {
-  KeyType middle_key;
-  if (index == 0) {
-    middle_key = parent_node->KeyAt(1);
-    parent_node->SetKeyAt(1, neighbor_node->KeyAt(1));
-    neighbor_node->MoveFirstToEndOf(node, middle_key, buffer_pool_manager_);
-  } else {
-    middle_key = parent_node->KeyAt(index);
-    parent_node->SetKeyAt(index, neighbor_node->KeyAt(neighbor_node->GetSize() - 1));
-    neighbor_node->MoveLastToFrontOf(node, middle_key, buffer_pool_manager_);
+void BPLUSTREE_TYPE::DeletePostingList(const ValueType &reference) {
+  ValueType segment_reference = reference;
+  while (true) {
+    page_id_t posting_page_id = PostingPage::ReferencedPageId(segment_reference);
+    page_id_t next_page_id = FetchPostingPage(posting_page_id)->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(posting_page_id, false);
+    FreePostingSegment(segment_reference);
+    if (next_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    segment_reference = PostingPage::MakeReference(next_page_id, 0);
   }
-  UnlockAndUnpinPageOfNode(node, true, LockMode::WRITE);
-  UnlockAndUnpinPageOfNode(parent_node, true, LockMode::WRITE);
-  UnlockAndUnpinPageOfNode(neighbor_node, true, LockMode::WRITE);
 }
+
 /*
- * Update root page if necessary
- * NOTE: size of root page can be less than min size and this method is only
- * called within coalesceOrRedistribute() method
- * case 1: when you delete the last element in root page, but root page still
- * has one last child
- * case 2: when you delete the last element in whole b+ tree
- * @return : true means root page should be deleted, false means no deletion
- * happend
+ * Segments of the small size classes come from the page remembered for the
+ * class while it has room, then from a new page. The page class always takes
+ * a new page of its own.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
-  if (old_root_node->IsLeafPage()) {
-    if (old_root_node->GetSize() < 1) {
-      root_page_id_ = INVALID_PAGE_ID;
-      UpdateRootPageId(0);
-      UnlockAndUnpinPageOfNode(old_root_node, true, LockMode::WRITE);
-      return true;
-    } else {
-      UnlockAndUnpinPageOfNode(old_root_node, true, LockMode::WRITE);
-      return false;
+ValueType BPLUSTREE_TYPE::NewPostingSegment(int size_class, page_id_t next_page_id) {
+  std::lock_guard<std::mutex> guard(posting_latch_);
+  if (size_class != POSTING_PAGE_CLASS && posting_free_page_[size_class] != INVALID_PAGE_ID) {
+    page_id_t posting_page_id = posting_free_page_[size_class];
+    PostingPage *posting = FetchPostingPage(posting_page_id);
+    int segment = posting->AllocateSegment();
+    if (!posting->HasFreeSegment()) {
+      posting_free_page_[size_class] = INVALID_PAGE_ID;
     }
+    buffer_pool_manager_->UnpinPage(posting_page_id, true);
+    return PostingPage::MakeReference(posting_page_id, segment);
+  }
 
-  } else {
-    if (old_root_node->GetSize() == 1) {
-      InternalPage *old_root_node_as_internal = reinterpret_cast<InternalPage *>(old_root_node);
-      page_id_t child_page_id = old_root_node_as_internal->ValueAt(0);
-      Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
-      if (child_page == nullptr) {
-        throw "out of memory";
-      }
-      LockPage(child_page, LockMode::WRITE);
-      BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-      child_node->SetParentPageId(INVALID_PAGE_ID);
-      UpdateRootPageId(0);
-      UnlockAndUnpinPageOfNode(child_node, true, LockMode::WRITE);
-      UnlockAndUnpinPageOfNode(old_root_node, true, LockMode::WRITE);
-      return true;
-    } else {
-      UnlockAndUnpinPageOfNode(old_root_node, true, LockMode::WRITE);
-      return false;
-    }
+  page_id_t posting_page_id;
+  Page *posting_page = buffer_pool_manager_->NewPage(&posting_page_id);
+  if (posting_page == nullptr) {
+    throw "out of memory";
+  }
+  auto *posting = reinterpret_cast<PostingPage *>(posting_page->GetData());
+  posting->Init(posting_page_id, size_class, next_page_id);
+  int segment = posting->AllocateSegment();
+  if (size_class != POSTING_PAGE_CLASS && posting->HasFreeSegment()) {
+    posting_free_page_[size_class] = posting_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(posting_page_id, true);
+  return PostingPage::MakeReference(posting_page_id, segment);
+}
+
+/*
+ * The page of a freed segment becomes the one new segments of its class come
+ * from. A page left without segments is deleted, unless it is that page. Free
+ * segments of other pages are picked up again once one more of their segments
+ * is freed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FreePostingSegment(const ValueType &reference) {
+  std::lock_guard<std::mutex> guard(posting_latch_);
+  page_id_t posting_page_id = PostingPage::ReferencedPageId(reference);
+  PostingPage *posting = FetchPostingPage(posting_page_id);
+  posting->FreeSegment(PostingPage::ReferencedSegment(reference));
+  int size_class = posting->GetSizeClass();
+  if (posting->IsEmpty() && (size_class == POSTING_PAGE_CLASS || posting_free_page_[size_class] != posting_page_id)) {
+    buffer_pool_manager_->UnpinPage(posting_page_id, false);
+    buffer_pool_manager_->DeletePage(posting_page_id);
+    return;
+  }
+  posting_free_page_[size_class] = posting_page_id;
+  buffer_pool_manager_->UnpinPage(posting_page_id, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::PostingPage *BPLUSTREE_TYPE::FetchPostingPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw "out of memory";
   }
+  return reinterpret_cast<PostingPage *>(page->GetData());
 }
 
 /*****************************************************************************
@@ -412,8 +1297,12 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
   Page *leftMost_leaf_page = FindLeafPage(KeyType{}, Operation::SEARCH, true);
+  if (leftMost_leaf_page == nullptr) {
+    throw Exception(ExceptionType::INVALID, "cannot iterate an empty b+ tree");
+  }
   page_id_t p_id = leftMost_leaf_page->GetPageId();
-  return INDEXITERATOR_TYPE(p_id, buffer_pool_manager_);
+  UnlatchAndUnpinPage(leftMost_leaf_page, LockMode::READ, false);
+  return INDEXITERATOR_TYPE(p_id, buffer_pool_manager_, 0, !unique_keys_);
 }
 
 /*
@@ -423,13 +1312,61 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  Page *p = FindLeafPage(KeyType{key}, Operation::SEARCH, false);
+  Page *p = FindLeafPage(key, Operation::SEARCH, false);
+  if (p == nullptr) {
+    throw Exception(ExceptionType::INVALID, "cannot iterate an empty b+ tree");
+  }
   LeafPage *node = reinterpret_cast<LeafPage *>(p->GetData());
   page_id_t p_id = node->GetPageId();
   int key_index = node->KeyIndex(key, comparator_);
-  UnlockAndUnpinPageOfNode(node, false, LockMode::READ);
-  LOG_INFO("return iterator page %d index %d", p_id, key_index);
-  return INDEXITERATOR_TYPE(p_id, buffer_pool_manager_, key_index);
+  UnlatchAndUnpinPage(p, LockMode::READ, false);
+  return INDEXITERATOR_TYPE(p_id, buffer_pool_manager_, key_index, !unique_keys_);
+}
+
+/*
+ * Iterator over the keys in range. A forward scan starts at the lower bound
+ * and stops at the upper one, a reverse scan walks the prev links of the
+ * leaves from the upper bound down to the lower one. The stop bound is checked
+ * as the iterator moves, so a scan reads no leaf beyond the range.
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const IndexKeyRange<KeyType> &range, bool reverse) {
+  bool has_start = reverse ? range.has_upper_ : range.has_lower_;
+  const KeyType &start = reverse ? range.upper_ : range.lower_;
+  bool start_inclusive = reverse ? range.upper_inclusive_ : range.lower_inclusive_;
+  Page *p = FindLeafPage(start, Operation::SEARCH, !reverse && !has_start, reverse && !has_start);
+  if (p == nullptr) {
+    throw Exception(ExceptionType::INVALID, "cannot iterate an empty b+ tree");
+  }
+  LeafPage *node = reinterpret_cast<LeafPage *>(p->GetData());
+  page_id_t p_id = node->GetPageId();
+  int key_index;
+  if (!has_start) {
+    key_index = reverse ? node->GetSize() - 1 : 0;
+  } else {
+    // the first key not below start, the iterator steps over leaf ends itself
+    key_index = node->KeyIndex(start, comparator_);
+    bool at_start = key_index < node->GetSize() && comparator_(node->KeyAt(key_index), start) == 0;
+    if (reverse && !(at_start && start_inclusive)) {
+      key_index--;
+    } else if (!reverse && at_start && !start_inclusive) {
+      key_index++;
+    }
+  }
+  UnlatchAndUnpinPage(p, LockMode::READ, false);
+
+  INDEXITERATOR_TYPE iterator(p_id, buffer_pool_manager_, key_index, !unique_keys_, reverse);
+  if (reverse) {
+    iterator.SetLeafFinder([this](const KeyType &key, int *index) { return FindLeafBefore(key, index); },
+                           comparator_);
+  }
+  if (reverse && range.has_lower_) {
+    iterator.SetStopKey(range.lower_, range.lower_inclusive_, comparator_);
+  } else if (!reverse && range.has_upper_) {
+    iterator.SetStopKey(range.upper_, range.upper_inclusive_, comparator_);
+  }
+  return iterator;
 }
 
 /*
@@ -456,7 +1393,261 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() {
   page_id_t p_id = cur_page_as_tree->GetPageId();
   int index = cur_page_as_tree->GetSize();
   buffer_pool_manager_->UnpinPage(p_id, false);
-  return INDEXITERATOR_TYPE(p_id, buffer_pool_manager_, index);
+  return INDEXITERATOR_TYPE(p_id, buffer_pool_manager_, index, !unique_keys_);
+}
+
+/*
+ * Partition range for a parallel scan. The cut points are separators of the
+ * internal pages, which split the range roughly by the number of leaves
+ * below them: the levels are searched from the root down, one more level per
+ * round, until they hold at least parts - 1 separators inside the range, and
+ * the cuts are then picked evenly among them. The pages are read latched top
+ * down, so the separators of a round are consistent; a later split or merge
+ * only makes the partitions less even, since every sub-range is scanned with
+ * its own bounds.
+ * @return : the sub-ranges in key order, they cover range without overlap
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<IndexKeyRange<KeyType>> BPLUSTREE_TYPE::PartitionRange(const IndexKeyRange<KeyType> &range, int parts) {
+  std::vector<KeyType> separators;
+  for (int depth = 0; parts > 1; depth++) {
+    separators.clear();
+    root_latch_.RLock();
+    if (IsEmpty()) {
+      root_latch_.RUnlock();
+      break;
+    }
+    Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
+    if (root_page == nullptr) {
+      root_latch_.RUnlock();
+      throw "out of memory";
+    }
+    LatchPage(root_page, LockMode::READ);
+    root_latch_.RUnlock();
+    bool deeper = false;
+    if (!reinterpret_cast<BPlusTreePage *>(root_page->GetData())->IsLeafPage()) {
+      CollectSeparators(root_page, range, depth, &separators, &deeper);
+    }
+    UnlatchAndUnpinPage(root_page, LockMode::READ, false);
+    if (separators.size() + 1 >= static_cast<size_t>(parts) || !deeper) {
+      break;
+    }
+  }
+  std::sort(separators.begin(), separators.end(),
+            [this](const KeyType &a, const KeyType &b) { return comparator_(a, b) < 0; });
+
+  std::vector<IndexKeyRange<KeyType>> partitions;
+  IndexKeyRange<KeyType> partition = range;
+  size_t cuts = std::min(static_cast<size_t>(std::max(parts - 1, 0)), separators.size());
+  for (size_t i = 1; i <= cuts; i++) {
+    const KeyType &cut = separators[i * separators.size() / (cuts + 1)];
+    partition.SetUpper(cut, false);
+    partitions.push_back(partition);
+    partition = range;
+    partition.SetLower(cut, true);
+  }
+  partitions.push_back(partition);
+  return partitions;
+}
+
+/*
+ * Range cardinality for choosing between a sequential and an index scan. The
+ * tree keeps no counts, so the estimate is taken from the pages on the paths
+ * to the two bounds. Below the page where the paths part, the subtrees
+ * between them are counted level by level, each taken to be as large as a
+ * subtree of average pages, where the average size of the pages of a level is
+ * that of the pages seen there: those on the two paths and on the left most
+ * paths of a few sampled subtrees in between. A range within one leaf is
+ * counted exactly. A key with a posting list counts as one entry.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::EstimateRangeCount(const IndexKeyRange<KeyType> &range) {
+  std::vector<std::pair<int, int>> lower;
+  std::vector<std::pair<int, int>> upper;
+  std::vector<std::vector<int>> samples;
+  EstimatePath(range.has_upper_ ? &range.upper_ : nullptr, range.upper_inclusive_, &upper);
+  EstimatePath(range.has_lower_ ? &range.lower_ : nullptr, !range.lower_inclusive_, &lower, &upper, &samples);
+  // a split or merge between the two descents can change the height
+  size_t height = lower.size();
+  if (height == 0 || height != upper.size()) {
+    return 0;
+  }
+  size_t level = 0;
+  while (level + 1 < height && lower[level].first == upper[level].first) {
+    level++;
+  }
+  if (level + 1 == height) {
+    return std::max(upper[level].first - lower[level].first, 0);
+  }
+  if (lower[level].first > upper[level].first) {
+    return 0;
+  }
+
+  // entries[l]: those of an average subtree rooted at level l, for the levels below the one the paths part at
+  std::vector<double> entries(height + 1, 1);
+  for (size_t l = height; l-- > level + 1;) {
+    double sum = lower[l].second + upper[l].second;
+    int count = 2;
+    for (const auto &sample : samples) {
+      if (l >= height - sample.size()) {
+        sum += sample[l - (height - sample.size())];
+        count++;
+      }
+    }
+    entries[l] = sum / count * entries[l + 1];
+  }
+  double estimate = (upper[level].first - lower[level].first - 1) * entries[level + 1];
+  for (size_t l = level + 1; l < height; l++) {
+    // the subtrees right of the lower path and left of the upper one
+    estimate += (lower[l].second - lower[l].first - (l + 1 < height ? 1 : 0)) * entries[l + 1];
+    estimate += upper[l].first * entries[l + 1];
+  }
+  return static_cast<size_t>(estimate + 0.5);
+}
+
+/*
+ * One read latched descent towards key, or to the left most leaf if there is
+ * no key and past_key is not set, and to the right most one if it is. *path
+ * gets the (child index, size) of the pages on the way, from the root down;
+ * for the leaf the index of the first key at or, if past_key is set, past key.
+ * *path stays empty for an empty tree.
+ * If upper_path is given, the page where the descent leaves it has up to
+ * RANGE_ESTIMATE_SAMPLES of its children between the two paths sampled into
+ * *samples.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::EstimatePath(const KeyType *key, bool past_key, std::vector<std::pair<int, int>> *path,
+                                  const std::vector<std::pair<int, int>> *upper_path,
+                                  std::vector<std::vector<int>> *samples) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw "out of memory";
+  }
+  LatchPage(page, LockMode::READ);
+  root_latch_.RUnlock();
+
+  bool on_upper_path = upper_path != nullptr;
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    InternalPage *internal = reinterpret_cast<InternalPage *>(node);
+    int index;
+    if (key != nullptr) {
+      index = internal->ValueIndex(internal->Lookup(*key, comparator_));
+    } else {
+      index = past_key ? internal->GetSize() - 1 : 0;
+    }
+    size_t level = path->size();
+    if (on_upper_path && (level + 1 >= upper_path->size() || (*upper_path)[level].first != index)) {
+      on_upper_path = false;
+      int last = level + 1 < upper_path->size() ? std::min((*upper_path)[level].first, internal->GetSize()) : index;
+      int between = last - index - 1;
+      for (int i = 1; i <= std::min(between, RANGE_ESTIMATE_SAMPLES); i++) {
+        Page *child_page = buffer_pool_manager_->FetchPage(
+            internal->ValueAt(index + i * between / (std::min(between, RANGE_ESTIMATE_SAMPLES) + 1) + 1));
+        if (child_page == nullptr) {
+          UnlatchAndUnpinPage(page, LockMode::READ, false);
+          throw "out of memory";
+        }
+        samples->emplace_back();
+        SamplePath(child_page, &samples->back());
+      }
+    }
+    path->emplace_back(index, internal->GetSize());
+    Page *child_page = buffer_pool_manager_->FetchPage(internal->ValueAt(index));
+    if (child_page == nullptr) {
+      UnlatchAndUnpinPage(page, LockMode::READ, false);
+      throw "out of memory";
+    }
+    LatchPage(child_page, LockMode::READ);
+    UnlatchAndUnpinPage(page, LockMode::READ, false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
+  int index;
+  if (key != nullptr) {
+    index = leaf->KeyIndex(*key, comparator_);
+    if (past_key && index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *key) == 0) {
+      index++;
+    }
+  } else {
+    index = past_key ? leaf->GetSize() : 0;
+  }
+  path->emplace_back(index, leaf->GetSize());
+  UnlatchAndUnpinPage(page, LockMode::READ, false);
+}
+
+/*
+ * The sizes of the pages on the left most path from the pinned page down to a
+ * leaf. The path is read latched hand over hand, and the page is unpinned.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SamplePath(Page *page, std::vector<int> *sizes) {
+  LatchPage(page, LockMode::READ);
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    sizes->push_back(node->GetSize());
+    Page *child_page = buffer_pool_manager_->FetchPage(reinterpret_cast<InternalPage *>(node)->ValueAt(0));
+    if (child_page == nullptr) {
+      UnlatchAndUnpinPage(page, LockMode::READ, false);
+      throw "out of memory";
+    }
+    LatchPage(child_page, LockMode::READ);
+    UnlatchAndUnpinPage(page, LockMode::READ, false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  sizes->push_back(node->GetSize());
+  UnlatchAndUnpinPage(page, LockMode::READ, false);
+}
+
+/*
+ * Child i of an internal page covers [KeyAt(i), KeyAt(i + 1)). The children
+ * that overlap range are latched under their parent and searched while depth
+ * lasts; *deeper is set if there are internal pages below the last level
+ * searched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectSeparators(Page *page, const IndexKeyRange<KeyType> &range, int depth,
+                                       std::vector<KeyType> *separators, bool *deeper) {
+  InternalPage *node = reinterpret_cast<InternalPage *>(page->GetData());
+  // all children of a page are on the same level, the first one tells whether they are leaves
+  Page *first_child = buffer_pool_manager_->FetchPage(node->ValueAt(0));
+  if (first_child == nullptr) {
+    throw "out of memory";
+  }
+  // the type of a page never changes, so it can be read without the latch
+  bool leaf_children = reinterpret_cast<BPlusTreePage *>(first_child->GetData())->IsLeafPage();
+  buffer_pool_manager_->UnpinPage(first_child->GetPageId(), false);
+  if (!leaf_children && depth == 0) {
+    *deeper = true;
+  }
+  for (int i = 0; i < node->GetSize(); i++) {
+    bool after_lower = !range.has_lower_ || i + 1 == node->GetSize() || comparator_(node->KeyAt(i + 1), range.lower_) > 0;
+    bool before_upper = !range.has_upper_ || i == 0 || comparator_(node->KeyAt(i), range.upper_) < 0;
+    if (!after_lower || !before_upper) {
+      continue;
+    }
+    if (i > 0 && (!range.has_lower_ || comparator_(node->KeyAt(i), range.lower_) > 0)) {
+      separators->push_back(node->KeyAt(i));
+    }
+    if (leaf_children || depth == 0) {
+      continue;
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(node->ValueAt(i));
+    if (child_page == nullptr) {
+      throw "out of memory";
+    }
+    LatchPage(child_page, LockMode::READ);
+    CollectSeparators(child_page, range, depth - 1, separators, deeper);
+    UnlatchAndUnpinPage(child_page, LockMode::READ, false);
+  }
 }
 
 /*****************************************************************************
@@ -464,66 +1655,139 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() {
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
- * the left most leaf page
+ * the left most leaf page, if rightMost flag == true the right most one
+ * If upper is given, it gets the separator right of the path's child at the
+ * deepest level that has one: the leaf holds the keys below it.
+ * This is the optimistic descent: internal pages are read latched hand over
+ * hand, the leaf is read latched for SEARCH and write latched otherwise.
+ * @return : the latched and pinned leaf, nullptr if the tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, Operation op, bool leftMost) {
-  LOG_INFO("FIND LEAF");
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, Operation op, bool leftMost, bool rightMost, KeyType *upper,
+                                   bool *has_upper) {
+  LockMode leaf_mode = op == Operation::SEARCH ? LockMode::READ : LockMode::WRITE;
+  if (has_upper != nullptr) {
+    *has_upper = false;
+  }
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
   Page *cur_page = buffer_pool_manager_->FetchPage(root_page_id_);
   if (cur_page == nullptr) {
-    LOG_INFO("FindLeafPage fetch page %d fail", root_page_id_);
+    root_latch_.RUnlock();
     throw "out of memory";
   }
-  BPlusTreePage *cur_page_as_tree = reinterpret_cast<BPlusTreePage *>(cur_page->GetData());
-  if (cur_page_as_tree->IsLeafPage()) {
-    LOG_INFO("curpage is leaf %d", cur_page->GetPageId());
-    if (op == Operation::SEARCH) {
-      LockPage(cur_page, LockMode::READ);
+  // the type of a page never changes, and the page cannot be freed while its parent (here the root latch) is held
+  BPlusTreePage *cur_node = reinterpret_cast<BPlusTreePage *>(cur_page->GetData());
+  LockMode cur_mode = cur_node->IsLeafPage() ? leaf_mode : LockMode::READ;
+  LatchPage(cur_page, cur_mode);
+  root_latch_.RUnlock();
+
+  while (!cur_node->IsLeafPage()) {
+    InternalPage *cur_node_as_internal = reinterpret_cast<InternalPage *>(cur_node);
+    page_id_t child_page_id;
+    if (leftMost) {
+      child_page_id = cur_node_as_internal->ValueAt(0);
+    } else if (rightMost) {
+      child_page_id = cur_node_as_internal->ValueAt(cur_node_as_internal->GetSize() - 1);
     } else {
-      LockPage(cur_page, LockMode::WRITE);
+      child_page_id = cur_node_as_internal->Lookup(key, comparator_);
+    }
+    // a deeper separator bounds the leaf tighter than the ones above it
+    if (upper != nullptr) {
+      int index = cur_node_as_internal->ValueIndex(child_page_id);
+      if (index + 1 < cur_node_as_internal->GetSize()) {
+        *upper = cur_node_as_internal->KeyAt(index + 1);
+        *has_upper = true;
+      }
     }
-    return cur_page;
-  } else {
-    LOG_INFO("curpage is internal %d", cur_page->GetPageId());
-    LockPage(cur_page, LockMode::READ);
-    InternalPage *cur_page_as_internal = reinterpret_cast<InternalPage *>(cur_page->GetData());
-
-    page_id_t child_page_id =
-        leftMost ? cur_page_as_internal->ValueAt(0) : cur_page_as_internal->Lookup(key, comparator_);
-    LOG_INFO("child page id %d", child_page_id);
     Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
-    LOG_INFO("CHILD PAGE ID %d", child_page->GetPageId());
     if (child_page == nullptr) {
-      LOG_INFO("FindLeafPage fetch page %d fail", root_page_id_);
+      UnlatchAndUnpinPage(cur_page, cur_mode, false);
       throw "out of memory";
     }
+    BPlusTreePage *child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    LockMode child_mode = child_node->IsLeafPage() ? leaf_mode : LockMode::READ;
+    LatchPage(child_page, child_mode);
+    UnlatchAndUnpinPage(cur_page, cur_mode, false);
+    cur_page = child_page;
+    cur_node = child_node;
+    cur_mode = child_mode;
+  }
+  return cur_page;
+}
 
-    BPlusTreePage *child_page_as_tree = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
-    while (!child_page_as_tree->IsLeafPage()) {
-      LOG_INFO("childpage is internal %d", child_page_as_tree->GetPageId());
-      LockPage(child_page, LockMode::READ);
-      UnlockAndUnpinPageOfNode(cur_page, false, LockMode::READ);
-      cur_page = child_page;
-      cur_page_as_internal = reinterpret_cast<InternalPage *>(cur_page->GetData());
-      child_page_id = leftMost ? cur_page_as_internal->ValueAt(0) : cur_page_as_internal->Lookup(key, comparator_);
-
-      child_page = buffer_pool_manager_->FetchPage(child_page_id);
-      if (child_page == nullptr) {
-        LOG_INFO("FindLeafPage fetch page %d fail", root_page_id_);
-        throw "out of memory";
-      }
-      child_page_as_tree = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+/*
+ * Pessimistic descent for Insert/Remove: take the root latch and write latch
+ * every page on the path. Once a page is safe for op, the root latch and all
+ * latched ancestors are released, since nothing above it can change. The
+ * remaining latches are kept in the transaction's page set, oldest first.
+ * @return : the write latched leaf (also in the page set), nullptr if the tree
+ * is empty; the root latch is then still held
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageExclusive(const KeyType &key, Operation op, Transaction *transaction) {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (IsEmpty()) {
+    return nullptr;
+  }
+  page_id_t cur_page_id = root_page_id_;
+  while (true) {
+    Page *cur_page = buffer_pool_manager_->FetchPage(cur_page_id);
+    if (cur_page == nullptr) {
+      ReleaseLatchedPages(transaction, false);
+      throw "out of memory";
     }
+    LatchPage(cur_page, LockMode::WRITE);
+    BPlusTreePage *cur_node = reinterpret_cast<BPlusTreePage *>(cur_page->GetData());
+    if (IsSafe(cur_node, op)) {
+      ReleaseLatchedPages(transaction, false);
+    }
+    transaction->AddIntoPageSet(cur_page);
+    if (cur_node->IsLeafPage()) {
+      return cur_page;
+    }
+    cur_page_id = reinterpret_cast<InternalPage *>(cur_node)->Lookup(key, comparator_);
+  }
+}
 
-    if (op == Operation::SEARCH) {
-      LockPage(child_page, LockMode::READ);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatchedPages(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
     } else {
-      LockPage(child_page, LockMode::WRITE);
+      UnlatchAndUnpinPage(page, LockMode::WRITE, is_dirty);
     }
-    LOG_INFO("child page %d", child_page->GetPageId());
-    UnlockAndUnpinPageOfNode(cur_page, false, LockMode::READ);
-    return child_page;
   }
+  page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeleteReleasedPages(Transaction *transaction) {
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const {
+  if (op == Operation::INSERT) {
+    return node->GetSize() + 1 < node->GetMaxSize();
+  }
+  if (op == Operation::DELETE) {
+    return node->GetSize() - 1 >= MergeSize(node);
+  }
+  if (op == Operation::COMPACT) {
+    return node->GetSize() - 1 >= node->GetMinSize();
+  }
+  return true;
 }
 
 /*
@@ -536,16 +1800,41 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, Operation op, bool leftMo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
-    // update root_page_id in header_page
-    header_page->UpdateRecord(index_name_, root_page_id_);
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  HeaderPage *header_page = static_cast<HeaderPage *>(page);
+  // the header page is shared by every index
+  page->WLatch();
+  // update root_page_id in header_page, or create a new record<index_name + root_page_id> in it. The record is
+  // still there if the tree was emptied before
+  bool recorded = header_page->UpdateRecord(index_name_, root_page_id_) ||
+                  (insert_record != 0 && header_page->InsertRecord(index_name_, root_page_id_));
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, recorded);
+  if (!recorded) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "header page is full");
+  }
+}
+
+/*
+ * Reopen the tree of an earlier instance of this index: the header page keeps
+ * the root of every index by name, so nothing but the header page is read.
+ * The tree must not be in use yet.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Open() {
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    throw "out of memory";
   }
-  LOG_INFO("NOW ROOT %d", root_page_id_);
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  page->RLatch();
+  bool found = static_cast<HeaderPage *>(page)->GetRootId(index_name_, &root_page_id);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  if (found) {
+    root_page_id_ = root_page_id;
+  }
+  return found;
 }
 
 /*
@@ -706,35 +1995,95 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-template <typename N>
-void BPLUSTREE_TYPE::UnlockAndUnpinPageOfNode(N *node, bool is_dirty, LockMode mode) {
-  page_id_t p_id = node->GetPageId();
-  LOG_INFO("Unlock page %d", p_id);
-  if (lock_map_.count(p_id) == 0) {
-    LOG_ERROR("# Unlock fail page: %d", p_id);
+void BPLUSTREE_TYPE::LatchPage(Page *page, LockMode mode) {
+  if (mode == LockMode::READ) {
+    page->RLatch();
+  } else {
+    page->WLatch();
   }
-  Page *page = lock_map_[p_id];
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UnlatchAndUnpinPage(Page *page, LockMode mode, bool is_dirty) {
   if (mode == LockMode::READ) {
     page->RUnlatch();
   } else {
     page->WUnlatch();
   }
-  lock_map_.erase(p_id);
-  buffer_pool_manager_->UnpinPage(p_id, is_dirty);
-  LOG_INFO("UnLock page %d data %d pointer %p", page->GetPageId(), page->GetPinCount(),page);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
 }
 
+/*
+ * Point the prev link of leaf page_id at prev_page_id, after the leaf to its
+ * left was split or merged. The caller holds the left leaf write latched,
+ * which makes it the only writer of this link. The leaf itself is not
+ * latched: a merge further right may hold it while it waits for a latch this
+ * writer holds, so latching it here could deadlock. The link is stored atomically
+ * instead, and a reverse iterator only trusts it once the leaf it points to
+ * links back (see IndexIterator::MoveToEntry()).
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::LockPage(Page *page, LockMode mode) {
-  page_id_t p_id = page->GetPageId();
-  if (mode == LockMode::READ) {
-    page->RLatch();
-  } else {
-    page->WLatch();
+void BPLUSTREE_TYPE::SetPrevLink(page_id_t page_id, page_id_t prev_page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(prev_page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+/*
+ * Descend to the leaf of the greatest key below key: unlike FindLeafPage(),
+ * a separator equal to key sends the search to the child on its left. The
+ * pages are read latched hand over hand, the leaf is returned pinned only.
+ * @param[out] index : position of that key in the leaf, -1 if the leaf holds
+ * none below key (they were deleted); the iterator then goes on to its prev
+ * @return : the leaf, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafBefore(const KeyType &key, int *index) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *cur_page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (cur_page == nullptr) {
+    root_latch_.RUnlock();
+    throw "out of memory";
+  }
+  LatchPage(cur_page, LockMode::READ);
+  root_latch_.RUnlock();
+  BPlusTreePage *cur_node = reinterpret_cast<BPlusTreePage *>(cur_page->GetData());
+  while (!cur_node->IsLeafPage()) {
+    InternalPage *internal = reinterpret_cast<InternalPage *>(cur_node);
+    // the first separator not below key, its left child holds the keys just below key
+    int lo = 1;
+    int hi = internal->GetSize();
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (comparator_(internal->KeyAt(mid), key) < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    Page *child_page = buffer_pool_manager_->FetchPage(internal->ValueAt(lo - 1));
+    if (child_page == nullptr) {
+      UnlatchAndUnpinPage(cur_page, LockMode::READ, false);
+      throw "out of memory";
+    }
+    LatchPage(child_page, LockMode::READ);
+    UnlatchAndUnpinPage(cur_page, LockMode::READ, false);
+    cur_page = child_page;
+    cur_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
   }
-  lock_map_[p_id] = page;
-  LOG_INFO("Lock page %d pointer %p pincount %d", lock_map_[p_id]->GetPageId(), page,page->GetPinCount());
+  *index = reinterpret_cast<LeafPage *>(cur_node)->KeyIndex(key, comparator_) - 1;
+  cur_page->RUnlatch();
+  return cur_page;
 }
 
 template class BPlusTree<GenericKey<4>, RID, GenericComparator<4>>;
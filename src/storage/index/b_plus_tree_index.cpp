@@ -16,18 +16,20 @@ namespace bustub {
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+                                     bool unique_keys)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetRootRecordName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 unique_keys) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
   index_key.SetFromKey(key);
+  FilterAdd(key);
   container_.Insert(index_key, rid, transaction);
-
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -36,12 +38,15 @@ void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *t
   KeyType index_key;
   index_key.SetFromKey(key);
 
-  container_.Remove(index_key, transaction);
-  LOG_INFO("delete %d finished ",(int)index_key.ToString());
+  container_.Remove(index_key, rid, transaction);
+  FilterRemove(key);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (!FilterMayContain(key)) {
+    return;
+  }
   // construct scan index key
   KeyType index_key;
   index_key.SetFromKey(key);
@@ -49,12 +54,53 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                    Transaction *transaction) {
+  // only the keys the Bloom filter leaves are looked up
+  std::vector<size_t> positions = FilterKeys(keys);
+  std::vector<KeyType> index_keys(positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    index_keys[i].SetFromKey(keys[positions[i]]);
+  }
+  std::vector<std::vector<RID>> found;
+  container_.GetValues(index_keys, &found, transaction);
+  results->assign(keys.size(), std::vector<RID>());
+  for (size_t i = 0; i < positions.size(); i++) {
+    (*results)[positions[i]] = std::move(found[i]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(ExternalMergeSort<KeyType, ValueType, KeyComparator> *sorter, double fill_factor) {
+  return container_.BulkLoad(sorter, fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::Open() { return container_.Open(); }
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) { return container_.Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRangeIterator(const IndexKeyRange<KeyType> &range, bool reverse) {
+  return container_.Begin(range, reverse);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<IndexKeyRange<KeyType>> BPLUSTREE_INDEX_TYPE::PartitionRange(const IndexKeyRange<KeyType> &range,
+                                                                          int parts) {
+  return container_.PartitionRange(range, parts);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_INDEX_TYPE::EstimateRangeCount(const IndexKeyRange<KeyType> &range) {
+  return container_.EstimateRangeCount(range);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/storage/index/bloom_filter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/bloom_filter.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+#include "murmur3/MurmurHash3.h"
+
+namespace bustub {
+
+namespace {
+// odd multipliers that pick the bit of a hash in each word of a block
+constexpr uint32_t SALT[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+}  // namespace
+
+BlockedBloomFilter::BlockedBloomFilter(size_t num_keys)
+    : blocks_((std::max(num_keys, BLOOM_FILTER_MIN_KEYS) * BLOOM_FILTER_BITS_PER_KEY + 255) / 256) {}
+
+void BlockedBloomFilter::Insert(uint64_t hash) {
+  Block &block = blocks_[BlockIndex(hash)];
+  auto low = static_cast<uint32_t>(hash);
+  for (int i = 0; i < 8; i++) {
+    __atomic_fetch_or(&block.words_[i], 1U << ((low * SALT[i]) >> 27), __ATOMIC_RELAXED);
+  }
+}
+
+bool BlockedBloomFilter::MayContain(uint64_t hash) const {
+  const Block &block = blocks_[BlockIndex(hash)];
+  auto low = static_cast<uint32_t>(hash);
+#if defined(__AVX2__)
+  const __m256i salt = _mm256_setr_epi32(SALT[0], SALT[1], SALT[2], SALT[3], SALT[4], SALT[5], SALT[6], SALT[7]);
+  __m256i shifts = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(low), salt), 27);
+  __m256i bits = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+  // every bit of bits is set in the block
+  return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(block.words_)), bits) != 0;
+#else
+  for (int i = 0; i < 8; i++) {
+    if ((__atomic_load_n(&block.words_[i], __ATOMIC_RELAXED) & (1U << ((low * SALT[i]) >> 27))) == 0) {
+      return false;
+    }
+  }
+  return true;
+#endif
+}
+
+IndexBloomFilter::IndexBloomFilter(Refill refill) : refill_(std::move(refill)) { Rebuild(); }
+
+uint64_t IndexBloomFilter::Hash(const Tuple &key) {
+  uint64_t hash[2];
+  murmur3::MurmurHash3_x64_128(key.GetData(), static_cast<int>(key.GetLength()), 0, hash);
+  return hash[0];
+}
+
+/*
+ * A key added while a rebuild runs goes into the old filter for the lookups
+ * until the rebuild ends, and into pending_ for the new filter. A key added
+ * before the rebuild started is in its table already, so the refill finds it.
+ */
+void IndexBloomFilter::Add(const Tuple &key) {
+  uint64_t hash = Hash(key);
+  std::shared_ptr<BlockedBloomFilter> filter = std::atomic_load(&filter_);
+  filter->Insert(hash);
+  keys_++;
+  if (rebuilding_ || std::atomic_load(&filter_) != filter) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (rebuilding_) {
+      pending_.push_back(hash);
+    } else {
+      std::atomic_load(&filter_)->Insert(hash);
+    }
+  }
+}
+
+void IndexBloomFilter::Remove(const Tuple &key) {
+  if (++deletes_ <= keys_ / 2 + BLOOM_FILTER_MIN_KEYS / 2 || rebuilding_.exchange(true)) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(thread_latch_);
+  // the previous rebuild is done, it cleared rebuilding_
+  if (rebuild_thread_.joinable()) {
+    rebuild_thread_.join();
+  }
+  rebuild_thread_ = std::thread([this] { Build(); });
+}
+
+void IndexBloomFilter::WaitForRebuild() {
+  std::lock_guard<std::mutex> guard(thread_latch_);
+  if (rebuild_thread_.joinable()) {
+    rebuild_thread_.join();
+  }
+}
+
+bool IndexBloomFilter::MayContain(const Tuple &key) const {
+  return std::atomic_load(&filter_)->MayContain(Hash(key));
+}
+
+void IndexBloomFilter::Rebuild() {
+  if (rebuilding_.exchange(true)) {
+    return;
+  }
+  Build();
+}
+
+void IndexBloomFilter::Build() {
+  std::vector<uint64_t> hashes;
+  refill_([&hashes](const Tuple &key) { hashes.push_back(Hash(key)); });
+  std::lock_guard<std::mutex> guard(latch_);
+  // room for the keys added meanwhile and as many again
+  auto filter = std::make_shared<BlockedBloomFilter>(2 * (hashes.size() + pending_.size()));
+  for (uint64_t hash : hashes) {
+    filter->Insert(hash);
+  }
+  for (uint64_t hash : pending_) {
+    filter->Insert(hash);
+  }
+  keys_ = hashes.size() + pending_.size();
+  deletes_ = 0;
+  pending_.clear();
+  std::atomic_store(&filter_, std::shared_ptr<BlockedBloomFilter>(std::move(filter)));
+  builds_++;
+  rebuilding_ = false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/buffered_b_plus_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "storage/index/buffered_b_plus_tree_index.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+BUFFERED_BPLUSTREE_INDEX_TYPE::BufferedBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+                                                      size_t buffer_size, bool unique_keys)
+    : BPlusTreeIndex<KeyType, ValueType, KeyComparator>(metadata, buffer_pool_manager, unique_keys),
+      buffer_(KeyLess{this->comparator_}),
+      buffer_size_(buffer_size) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  this->FilterAdd(key);
+  buffer_latch_.WLock();
+  AddMessage(index_key, rid, true, transaction);
+  buffer_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  buffer_latch_.WLock();
+  AddMessage(index_key, rid, false, transaction);
+  buffer_latch_.WUnlock();
+  this->FilterRemove(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (!this->FilterMayContain(key)) {
+    return;
+  }
+  KeyType index_key;
+  index_key.SetFromKey(key);
+  buffer_latch_.RLock();
+  this->container_.GetValue(index_key, result, transaction);
+  MergeMessages(index_key, result);
+  buffer_latch_.RUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                                             Transaction *transaction) {
+  // only the keys the Bloom filter leaves are looked up
+  std::vector<size_t> positions = this->FilterKeys(keys);
+  std::vector<KeyType> index_keys(positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    index_keys[i].SetFromKey(keys[positions[i]]);
+  }
+  std::vector<std::vector<RID>> found;
+  buffer_latch_.RLock();
+  this->container_.GetValues(index_keys, &found, transaction);
+  for (size_t i = 0; i < positions.size(); i++) {
+    MergeMessages(index_keys[i], &found[i]);
+  }
+  buffer_latch_.RUnlock();
+  results->assign(keys.size(), std::vector<RID>());
+  for (size_t i = 0; i < positions.size(); i++) {
+    (*results)[positions[i]] = std::move(found[i]);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BUFFERED_BPLUSTREE_INDEX_TYPE::GetBeginIterator() {
+  Flush();
+  return this->container_.begin();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BUFFERED_BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
+  Flush();
+  return this->container_.Begin(key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BUFFERED_BPLUSTREE_INDEX_TYPE::GetRangeIterator(const IndexKeyRange<KeyType> &range,
+                                                                   bool reverse) {
+  Flush();
+  return this->container_.Begin(range, reverse);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BUFFERED_BPLUSTREE_INDEX_TYPE::EstimateRangeCount(const IndexKeyRange<KeyType> &range) {
+  buffer_latch_.RLock();
+  auto count = static_cast<int64_t>(this->container_.EstimateRangeCount(range));
+  auto iter = range.has_lower_ ? (range.lower_inclusive_ ? buffer_.lower_bound(range.lower_)
+                                                         : buffer_.upper_bound(range.lower_))
+                               : buffer_.begin();
+  for (; iter != buffer_.end(); ++iter) {
+    int cmp = range.has_upper_ ? this->comparator_(iter->first, range.upper_) : -1;
+    if (cmp > 0 || (cmp == 0 && !range.upper_inclusive_)) {
+      break;
+    }
+    for (const auto &message : iter->second) {
+      count += message.second ? 1 : -1;
+    }
+  }
+  buffer_latch_.RUnlock();
+  return static_cast<size_t>(std::max<int64_t>(count, 0));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::Flush(Transaction *transaction) {
+  buffer_latch_.WLock();
+  FlushBuffer(transaction);
+  buffer_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BUFFERED_BPLUSTREE_INDEX_TYPE::GetBufferedCount() {
+  buffer_latch_.RLock();
+  size_t count = buffered_count_;
+  buffer_latch_.RUnlock();
+  return count;
+}
+
+/*
+ * Queue an insert or delete of value. It cancels out a buffered message of
+ * the opposite kind for the same value: an insert followed by a delete never
+ * reaches the tree, and neither does a delete followed by an insert of a value
+ * the tree already has.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::AddMessage(const KeyType &key, const ValueType &value, bool insert,
+                                               Transaction *transaction) {
+  auto &messages = buffer_[key];
+  for (auto iter = messages.begin(); iter != messages.end(); ++iter) {
+    if (iter->first == value && iter->second != insert) {
+      messages.erase(iter);
+      buffered_count_--;
+      if (messages.empty()) {
+        buffer_.erase(key);
+      }
+      return;
+    }
+  }
+  messages.emplace_back(value, insert);
+  buffered_count_++;
+  if (buffered_count_ >= buffer_size_) {
+    FlushBuffer(transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::FlushBuffer(Transaction *transaction) {
+  if (buffer_.empty()) {
+    return;
+  }
+  std::vector<Message> messages;
+  messages.reserve(buffered_count_);
+  for (const auto &entry : buffer_) {
+    for (const auto &message : entry.second) {
+      messages.push_back({entry.first, message.first, message.second});
+    }
+  }
+  this->container_.ApplyMessages(messages, transaction);
+  buffer_.clear();
+  buffered_count_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BUFFERED_BPLUSTREE_INDEX_TYPE::MergeMessages(const KeyType &key, std::vector<ValueType> *result) {
+  auto entry = buffer_.find(key);
+  if (entry == buffer_.end()) {
+    return;
+  }
+  for (const auto &message : entry->second) {
+    auto position = std::find(result->begin(), result->end(), message.first);
+    if (message.second && position == result->end()) {
+      result->push_back(message.first);
+    } else if (!message.second && position != result->end()) {
+      result->erase(position);
+    }
+  }
+}
+
+template class BufferedBPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
+template class BufferedBPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+template class BufferedBPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+template class BufferedBPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
+template class BufferedBPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -3,6 +3,7 @@
  */
 #include <common/logger.h>
 #include <cassert>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
@@ -13,7 +14,8 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(page_id_t p_id,BufferPoolManager *buffer_pool_manager,int specific_index){
+INDEXITERATOR_TYPE::IndexIterator(page_id_t p_id, BufferPoolManager *buffer_pool_manager, int specific_index,
+                                  bool posting_lists, bool reverse) {
   buffer_pool_manager_=buffer_pool_manager;
   Page *p=buffer_pool_manager_->FetchPage(p_id);
   if (p== nullptr){
@@ -21,34 +23,210 @@ INDEXITERATOR_TYPE::IndexIterator(page_id_t p_id,BufferPoolManager *buffer_pool_
   }
   cur_node_=reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE*>(p->GetData());
   index_=specific_index;
+  posting_lists_ = posting_lists;
+  reverse_ = reverse;
+  MoveToEntry();
+  EnterPostingList();
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetStopKey(const KeyType &key, bool inclusive, const KeyComparator &comparator) {
+  has_stop_key_ = true;
+  stop_key_ = key;
+  stop_inclusive_ = inclusive;
+  comparator_ = &comparator;
+  CheckStopKey();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetLeafFinder(LeafFinder finder, const KeyComparator &comparator) {
+  find_leaf_before_ = std::move(finder);
+  comparator_ = &comparator;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator(){
-  buffer_pool_manager_->UnpinPage(cur_node_->GetPageId(),false);
+  Unpin();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(const INDEXITERATOR_TYPE &other) {
+  if (this == &other) {
+    return *this;
+  }
+  Unpin();
+  cur_node_=other.cur_node_;
+  index_=other.index_;
+  buffer_pool_manager_=other.buffer_pool_manager_;
+  posting_lists_ = other.posting_lists_;
+  posting_page_ = other.posting_page_;
+  posting_segment_ = other.posting_segment_;
+  posting_index_ = other.posting_index_;
+  reverse_ = other.reverse_;
+  has_stop_key_ = other.has_stop_key_;
+  stop_key_ = other.stop_key_;
+  stop_inclusive_ = other.stop_inclusive_;
+  comparator_ = other.comparator_;
+  stopped_ = other.stopped_;
+  find_leaf_before_ = other.find_leaf_before_;
+  has_low_key_ = other.has_low_key_;
+  low_key_ = other.low_key_;
+  if (cur_node_ != nullptr) {
+    buffer_pool_manager_->FetchPage(cur_node_->GetPageId());
+  }
+  if (posting_page_ != nullptr) {
+    buffer_pool_manager_->FetchPage(posting_page_->GetPageId());
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Unpin() {
+  if (posting_page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(posting_page_->GetPageId(), false);
+    posting_page_ = nullptr;
+  }
+  if (cur_node_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(cur_node_->GetPageId(), false);
+    cur_node_ = nullptr;
+  }
 }
 
+/*
+ * MoveToEntry() only leaves the index outside of the leaf when there is no
+ * leaf left in that direction
+ */
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { return cur_node_->GetNextPageId()==INVALID_PAGE_ID&&index_==cur_node_->GetSize();}
+bool INDEXITERATOR_TYPE::isEnd() const {
+  if (stopped_ || cur_node_ == nullptr) {
+    return true;
+  }
+  return posting_page_ == nullptr && (index_ < 0 || index_ >= cur_node_->GetSize());
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 const MappingType &INDEXITERATOR_TYPE::operator*() {
+  if (posting_page_ != nullptr) {
+    current_ = MappingType(cur_node_->KeyAt(index_), posting_page_->ValueAt(posting_segment_, posting_index_));
+    return current_;
+  }
   return cur_node_->GetItem(index_);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
-  index_++;
-  if (cur_node_->GetNextPageId()!=INVALID_PAGE_ID&&index_==cur_node_->GetSize()){
-    Page *p=buffer_pool_manager_->FetchPage(cur_node_->GetNextPageId());
-    buffer_pool_manager_->UnpinPage(cur_node_->GetPageId(),false);
-    index_=0;
-    cur_node_=reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE*>(p->GetData());
+  if (posting_page_ != nullptr) {
+    posting_index_++;
+    if (posting_index_ < posting_page_->GetSize(posting_segment_)) {
+      return *this;
+    }
+    page_id_t next_page_id = posting_page_->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(posting_page_->GetPageId(), false);
+    posting_page_ = nullptr;
+    posting_index_ = 0;
+    if (next_page_id != INVALID_PAGE_ID) {
+      Page *p = buffer_pool_manager_->FetchPage(next_page_id);
+      if (p == nullptr) {
+        throw "out of memory";
+      }
+      // the pages after the first one of a chain hold a single segment
+      posting_page_ = reinterpret_cast<PostingPage *>(p->GetData());
+      posting_segment_ = 0;
+      return *this;
+    }
   }
+  index_ += reverse_ ? -1 : 1;
+  MoveToEntry();
+  CheckStopKey();
+  EnterPostingList();
   return *this;
 }
 
+/*
+ * A reverse step only follows a prev link if the leaf it points to links
+ * back, checked under that leaf's read latch. The prev link is written
+ * without the latch of its own leaf (see BPlusTree::SetPrevLink()), so after
+ * a split of the left neighbor it can still point past the new leaf for a
+ * while; the iterator then re-descends to the greatest key below the leaves
+ * it has left instead of skipping that leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MoveToEntry() {
+  while (true) {
+    page_id_t sibling_page_id;
+    if (!reverse_ && index_ >= cur_node_->GetSize()) {
+      sibling_page_id = cur_node_->GetNextPageId();
+    } else if (reverse_ && index_ < 0) {
+      sibling_page_id = cur_node_->GetPrevPageId();
+      if (find_leaf_before_ && cur_node_->GetSize() > 0 &&
+          (!has_low_key_ || (*comparator_)(cur_node_->KeyAt(0), low_key_) < 0)) {
+        has_low_key_ = true;
+        low_key_ = cur_node_->KeyAt(0);
+      }
+    } else {
+      return;
+    }
+    if (sibling_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    Page *p = buffer_pool_manager_->FetchPage(sibling_page_id);
+    if (p == nullptr) {
+      throw "out of memory";
+    }
+    if (reverse_ && find_leaf_before_ && has_low_key_) {
+      p->RLatch();
+      auto *prev_node = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(p->GetData());
+      bool linked = prev_node->IsLeafPage() && prev_node->GetNextPageId() == cur_node_->GetPageId();
+      p->RUnlatch();
+      if (!linked) {
+        buffer_pool_manager_->UnpinPage(sibling_page_id, false);
+        int index;
+        p = find_leaf_before_(low_key_, &index);
+        if (p == nullptr) {
+          return;
+        }
+        buffer_pool_manager_->UnpinPage(cur_node_->GetPageId(), false);
+        cur_node_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(p->GetData());
+        index_ = index;
+        continue;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(cur_node_->GetPageId(), false);
+    cur_node_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(p->GetData());
+    index_ = reverse_ ? cur_node_->GetSize() - 1 : 0;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckStopKey() {
+  if (!has_stop_key_ || isEnd()) {
+    return;
+  }
+  int cmp = (*comparator_)(cur_node_->KeyAt(index_), stop_key_);
+  if (reverse_) {
+    cmp = -cmp;
+  }
+  if (cmp > 0 || (cmp == 0 && !stop_inclusive_)) {
+    stopped_ = true;
+    Unpin();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::EnterPostingList() {
+  if (!posting_lists_ || isEnd() || !PostingPage::IsPostingList(cur_node_->ValueAt(index_))) {
+    return;
+  }
+  ValueType reference = cur_node_->ValueAt(index_);
+  Page *p = buffer_pool_manager_->FetchPage(PostingPage::ReferencedPageId(reference));
+  if (p == nullptr) {
+    throw "out of memory";
+  }
+  posting_page_ = reinterpret_cast<PostingPage *>(p->GetData());
+  posting_segment_ = PostingPage::ReferencedSegment(reference);
+  posting_index_ = 0;
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
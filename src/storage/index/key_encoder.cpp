@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.cpp
+//
+// Identification: src/storage/index/key_encoder.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "type/limits.h"
+
+namespace bustub {
+
+template <typename T>
+static T Load(const char *data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// append the low bytes bytes of value, most significant first
+static void AppendBigEndian(uint64_t value, int bytes, std::string *out) {
+  for (int i = bytes - 1; i >= 0; i--) {
+    out->push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+// signed integers: flipping the sign bit makes their two's complement sort as unsigned
+template <typename T>
+static void AppendSigned(const char *data, std::string *out) {
+  auto value = static_cast<uint64_t>(static_cast<int64_t>(Load<T>(data)));
+  AppendBigEndian(value ^ (1ULL << (8 * sizeof(T) - 1)), sizeof(T), out);
+}
+
+KeyEncoder::KeyEncoder(Schema *key_schema) {
+  for (const auto &col : key_schema->GetColumns()) {
+    columns_.push_back(KeyColumn{col.GetType(), col.GetOffset(), col.GetFixedLength()});
+  }
+}
+
+void KeyEncoder::Encode(const char *data, uint32_t size, std::string *out) const {
+  out->clear();
+  for (const auto &col : columns_) {
+    if (col.offset_ + col.fixed_length_ > size) {
+      break;
+    }
+    const char *column = data + col.offset_;
+    switch (col.type_) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendSigned<int8_t>(column, out);
+        break;
+      case TypeId::SMALLINT:
+        AppendSigned<int16_t>(column, out);
+        break;
+      case TypeId::INTEGER:
+        AppendSigned<int32_t>(column, out);
+        break;
+      case TypeId::BIGINT:
+        AppendSigned<int64_t>(column, out);
+        break;
+      case TypeId::TIMESTAMP:
+        // NULL is ULLONG_MAX in storage, it sorts first as zero
+        AppendBigEndian(Load<uint64_t>(column) + 1, sizeof(uint64_t), out);
+        break;
+      case TypeId::DECIMAL: {
+        // negative doubles sort in reverse as raw bits, so all of their bits are flipped
+        auto bits = Load<uint64_t>(column);
+        // -0.0 equals 0.0
+        bits = bits == (1ULL << 63) ? 0 : bits;
+        bits = (bits >> 63) != 0 ? ~bits : bits ^ (1ULL << 63);
+        AppendBigEndian(bits, sizeof(uint64_t), out);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        auto varlen_offset = static_cast<uint32_t>(Load<int32_t>(column));
+        uint32_t len = 0;
+        if (varlen_offset + sizeof(uint32_t) <= size) {
+          len = Load<uint32_t>(data + varlen_offset);
+          if (len == BUSTUB_VALUE_NULL) {
+            out->push_back('\0');
+            break;
+          }
+          // the stored length counts the trailing '\0'
+          len = len == 0 ? 0 : std::min<uint32_t>(len - 1, size - varlen_offset - sizeof(uint32_t));
+        }
+        out->push_back('\1');
+        const char *str = data + varlen_offset + sizeof(uint32_t);
+        for (uint32_t i = 0; i < len; i++) {
+          out->push_back(str[i]);
+          if (str[i] == '\0') {
+            out->push_back('\xFF');
+          }
+        }
+        out->push_back('\0');
+        out->push_back('\0');
+        break;
+      }
+      default:
+        break;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -19,6 +19,7 @@ void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *
   KeyType index_key;
   index_key.SetFromKey(key);
 
+  FilterAdd(key);
   container_.Insert(transaction, index_key, rid);
 }
 
@@ -29,10 +30,14 @@ void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *
   index_key.SetFromKey(key);
 
   container_.Remove(transaction, index_key, rid);
+  FilterRemove(key);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (!FilterMayContain(key)) {
+    return;
+  }
   // construct scan index key
   KeyType index_key;
   index_key.SetFromKey(key);
@@ -0,0 +1,444 @@
+/**
+ * varlen_b_plus_tree.cpp
+ */
+#include "storage/index/varlen_b_plus_tree.h"
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+template <typename ValueType>
+VarlenBPlusTree<ValueType>::VarlenBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager)
+    : index_name_(std::move(name)), root_page_id_(INVALID_PAGE_ID), buffer_pool_manager_(buffer_pool_manager) {
+  if (index_name_.empty() || index_name_.length() >= HeaderPage::NAME_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "index name does not fit in the header page");
+  }
+}
+
+template <typename ValueType>
+bool VarlenBPlusTree<ValueType>::IsEmpty() const {
+  return root_page_id_ == INVALID_PAGE_ID;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename ValueType>
+bool VarlenBPlusTree<ValueType>::GetValue(const std::string &key, std::vector<ValueType> *result,
+                                          Transaction *transaction) {
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return false;
+  }
+  Page *page = FindLeafPage(key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->LowerBound(key);
+  bool found = leaf->UpperBound(key) != index;
+  if (found) {
+    result->push_back(leaf->ValueAt(index));
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  latch_.RUnlock();
+  return found;
+}
+
+template <typename ValueType>
+int VarlenBPlusTree<ValueType>::GetHeight() {
+  latch_.RLock();
+  int height = 0;
+  page_id_t page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      latch_.RUnlock();
+      throw "out of memory";
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id = node->IsLeafPage() ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    height++;
+  }
+  latch_.RUnlock();
+  return height;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * A leaf that has no room for the entry is split, and the entry goes into
+ * the half that covers its key. That half is split again in the rare case
+ * that the new key shortens its prefix so much that the entries still do not
+ * fit.
+ */
+template <typename ValueType>
+bool VarlenBPlusTree<ValueType>::Insert(const std::string &key, const ValueType &value, Transaction *transaction) {
+  if (key.size() > SLOTTED_PAGE_MAX_KEY_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long");
+  }
+  latch_.WLock();
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+    latch_.WUnlock();
+    return true;
+  }
+  Page *page = FindLeafPage(key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->LowerBound(key);
+  if (leaf->UpperBound(key) != index) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    latch_.WUnlock();
+    return false;
+  }
+  while (!leaf->Insert(index, key, value)) {
+    std::string middle_key;
+    LeafPage *new_leaf = Split(leaf, &middle_key);
+    InsertIntoParent(leaf, middle_key, new_leaf);
+    if (key < middle_key) {
+      buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+    } else {
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+      leaf = new_leaf;
+    }
+    index = leaf->LowerBound(key);
+  }
+  buffer_pool_manager_->UnpinPage(leaf->GetPageId(), true);
+  latch_.WUnlock();
+  return true;
+}
+
+template <typename ValueType>
+void VarlenBPlusTree<ValueType>::StartNewTree(const std::string &key, const ValueType &value) {
+  Page *page = buffer_pool_manager_->NewPage(&root_page_id_);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(root_page_id_, INVALID_PAGE_ID, IndexPageType::LEAF_PAGE);
+  root->Insert(0, key, value);
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+}
+
+/*
+ * Both pages stay pinned. A leaf split pushes up the shortest prefix of the
+ * first key of the new page that is still greater than the last key left
+ * behind; an internal split pushes up the first key of the new page, whose
+ * slot then only keeps the child.
+ */
+template <typename ValueType>
+template <typename N>
+N *VarlenBPlusTree<ValueType>::Split(N *node, std::string *middle_key) {
+  int size = node->GetSize();
+  // split at the middle of the bytes, keeping at least one entry on each side
+  int half = (node->UsedBytes() - node->GetPrefixSize()) / 2;
+  int split = 1;
+  int bytes = node->EntryBytes(0);
+  while (split < size - 1 && bytes + node->EntryBytes(split) <= half) {
+    bytes += node->EntryBytes(split++);
+  }
+  std::vector<typename N::Entry> entries;
+  node->GetEntries(0, size, &entries);
+  std::vector<typename N::Entry> left(entries.begin(), entries.begin() + split);
+  std::vector<typename N::Entry> right(entries.begin() + split, entries.end());
+
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same<N, LeafPage>::value) {
+    new_node->Init(page_id, node->GetParentPageId(), IndexPageType::LEAF_PAGE);
+    const std::string &low = left.back().first;
+    const std::string &high = right.front().first;
+    auto mismatch = std::mismatch(low.begin(), low.begin() + std::min(low.size(), high.size()), high.begin());
+    *middle_key = high.substr(0, mismatch.first - low.begin() + 1);
+    new_node->SetNextPageId(node->GetNextPageId());
+    node->SetNextPageId(page_id);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), IndexPageType::INTERNAL_PAGE);
+    *middle_key = right.front().first;
+    for (const auto &entry : right) {
+      SetParentPageId(entry.second, page_id);
+    }
+  }
+  // each half takes at most the bytes it took before, its prefix can only get longer
+  if (!node->Rebuild(left) || !new_node->Rebuild(right)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "split page does not fit");
+  }
+  return new_node;
+}
+
+template <typename ValueType>
+void VarlenBPlusTree<ValueType>::InsertIntoParent(BPlusTreePage *old_node, const std::string &key,
+                                                  BPlusTreePage *new_node) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw "out of memory";
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, IndexPageType::INTERNAL_PAGE);
+    root->Rebuild({{std::string(), old_node->GetPageId()}, {key, new_node->GetPageId()}});
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    root_page_id_ = root_page_id;
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  Page *page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *parent = reinterpret_cast<InternalPage *>(page->GetData());
+  while (!parent->Insert(parent->ValueIndex(old_node->GetPageId()) + 1, key, new_node->GetPageId())) {
+    std::string middle_key;
+    InternalPage *new_parent = Split(parent, &middle_key);
+    InsertIntoParent(parent, middle_key, new_parent);
+    if (new_parent->ValueIndex(old_node->GetPageId()) < 0) {
+      buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+    } else {
+      buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+      parent = new_parent;
+    }
+  }
+  new_node->SetParentPageId(parent->GetPageId());
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename ValueType>
+void VarlenBPlusTree<ValueType>::Remove(const std::string &key, Transaction *transaction) {
+  latch_.WLock();
+  if (IsEmpty()) {
+    latch_.WUnlock();
+    return;
+  }
+  Page *page = FindLeafPage(key);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->LowerBound(key);
+  if (leaf->UpperBound(key) == index) {
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    latch_.WUnlock();
+    return;
+  }
+  leaf->RemoveAt(index);
+  CoalesceIfUnderfull(leaf);
+  latch_.WUnlock();
+}
+
+template <typename ValueType>
+void VarlenBPlusTree<ValueType>::CoalesceIfUnderfull(BPlusTreePage *node) {
+  if (node->IsRootPage()) {
+    page_id_t page_id = node->GetPageId();
+    if (node->IsLeafPage() && node->GetSize() == 0) {
+      root_page_id_ = INVALID_PAGE_ID;
+    } else if (!node->IsLeafPage() && node->GetSize() == 1) {
+      root_page_id_ = reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+      SetParentPageId(root_page_id_, INVALID_PAGE_ID);
+    } else {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      return;
+    }
+    UpdateRootPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    return;
+  }
+
+  int used_bytes = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->UsedBytes()
+                                      : reinterpret_cast<InternalPage *>(node)->UsedBytes();
+  if (used_bytes >= LeafPage::CAPACITY / 2) {
+    buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *parent = reinterpret_cast<InternalPage *>(page->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  bool merged = node->IsLeafPage() ? Coalesce(reinterpret_cast<LeafPage *>(node), parent, index)
+                                   : Coalesce(reinterpret_cast<InternalPage *>(node), parent, index);
+  if (merged) {
+    CoalesceIfUnderfull(parent);
+  } else {
+    buffer_pool_manager_->UnpinPage(parent->GetPageId(), false);
+  }
+}
+
+/*
+ * Merge node, the child at index of parent, with its left or else its right
+ * sibling into the left one of the two, if their entries fit into one page.
+ * Unpins node and the sibling.
+ * @return: true if the pages were merged and parent lost an entry
+ */
+template <typename ValueType>
+template <typename N>
+bool VarlenBPlusTree<ValueType>::Coalesce(N *node, InternalPage *parent, int index) {
+  for (int sibling_index : {index - 1, index + 1}) {
+    if (sibling_index < 0 || sibling_index >= parent->GetSize()) {
+      continue;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index));
+    if (page == nullptr) {
+      throw "out of memory";
+    }
+    auto *sibling = reinterpret_cast<N *>(page->GetData());
+    N *left = sibling_index < index ? sibling : node;
+    N *right = sibling_index < index ? node : sibling;
+    int right_index = std::max(index, sibling_index);
+
+    std::vector<typename N::Entry> entries;
+    left->GetEntries(0, left->GetSize(), &entries);
+    size_t right_begin = entries.size();
+    right->GetEntries(0, right->GetSize(), &entries);
+    if constexpr (std::is_same<N, InternalPage>::value) {
+      // the separator comes down in front of the first child of the right page
+      entries[right_begin].first = parent->KeyAt(right_index);
+    }
+    if (!left->Rebuild(entries)) {
+      buffer_pool_manager_->UnpinPage(sibling->GetPageId(), false);
+      continue;
+    }
+    if constexpr (std::is_same<N, LeafPage>::value) {
+      left->SetNextPageId(right->GetNextPageId());
+    } else {
+      for (size_t i = right_begin; i < entries.size(); i++) {
+        SetParentPageId(entries[i].second, left->GetPageId());
+      }
+    }
+    parent->RemoveAt(right_index);
+    page_id_t right_page_id = right->GetPageId();
+    buffer_pool_manager_->UnpinPage(left->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(right_page_id, false);
+    buffer_pool_manager_->DeletePage(right_page_id);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+  return false;
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+template <typename ValueType>
+VarlenIndexIterator<ValueType> VarlenBPlusTree<ValueType>::begin() {
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return end();
+  }
+  Page *page = FindLeafPage(std::string(), true);
+  latch_.RUnlock();
+  return VarlenIndexIterator<ValueType>(buffer_pool_manager_, page, 0);
+}
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType> VarlenBPlusTree<ValueType>::Begin(const std::string &key) {
+  latch_.RLock();
+  if (IsEmpty()) {
+    latch_.RUnlock();
+    return end();
+  }
+  Page *page = FindLeafPage(key);
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->LowerBound(key);
+  latch_.RUnlock();
+  return VarlenIndexIterator<ValueType>(buffer_pool_manager_, page, index);
+}
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType> VarlenBPlusTree<ValueType>::end() {
+  return VarlenIndexIterator<ValueType>();
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+template <typename ValueType>
+Page *VarlenBPlusTree<ValueType>::FindLeafPage(const std::string &key, bool left_most) {
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = left_most ? internal->ValueAt(0) : internal->Lookup(key);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (page == nullptr) {
+      throw "out of memory";
+    }
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+template <typename ValueType>
+void VarlenBPlusTree<ValueType>::SetParentPageId(page_id_t child_page_id, page_id_t parent_page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(child_page_id);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_page_id);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+}
+
+/*
+ * Update/Insert root page id in header page(where page_id = 0, header_page is
+ * defined under include/page/header_page.h)
+ * @parameter: insert_record      defualt value is false. When set to true,
+ * insert a record <index_name, root_page_id> into header page instead of
+ * updating it.
+ */
+template <typename ValueType>
+void VarlenBPlusTree<ValueType>::UpdateRootPageId(int insert_record) {
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  auto *header_page = static_cast<HeaderPage *>(page);
+  // the header page is shared by every index
+  page->WLatch();
+  bool recorded = header_page->UpdateRecord(index_name_, root_page_id_) ||
+                  (insert_record != 0 && header_page->InsertRecord(index_name_, root_page_id_));
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, recorded);
+  if (!recorded) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "header page is full");
+  }
+}
+
+template <typename ValueType>
+bool VarlenBPlusTree<ValueType>::Open() {
+  Page *page = buffer_pool_manager_->FetchPage(HEADER_PAGE_ID);
+  if (page == nullptr) {
+    throw "out of memory";
+  }
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  page->RLatch();
+  bool found = static_cast<HeaderPage *>(page)->GetRootId(index_name_, &root_page_id);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  if (found) {
+    root_page_id_ = root_page_id;
+  }
+  return found;
+}
+
+template class VarlenBPlusTree<RID>;
+
+}  // namespace bustub
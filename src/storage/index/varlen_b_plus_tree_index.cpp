@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/varlen_b_plus_tree_index.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/varlen_b_plus_tree_index.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+/*
+ * Constructor
+ */
+VarlenBPlusTreeIndex::VarlenBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(metadata),
+      encoder_(metadata->GetKeySchema()),
+      container_(metadata->GetRootRecordName(), buffer_pool_manager) {}
+
+std::string VarlenBPlusTreeIndex::EncodeKey(const Tuple &key) const {
+  std::string encoded;
+  encoder_.Encode(key, &encoded);
+  return encoded;
+}
+
+// the rid is appended big-endian, so the entries of a key sort by page id and then by slot
+std::string VarlenBPlusTreeIndex::EncodeEntry(const Tuple &key, RID rid) const {
+  std::string encoded = EncodeKey(key);
+  if (encoded.size() > MAX_KEY_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long");
+  }
+  auto page_id = static_cast<uint32_t>(rid.GetPageId());
+  uint32_t slot_num = rid.GetSlotNum();
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    encoded.push_back(static_cast<char>((page_id >> shift) & 0xFF));
+  }
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    encoded.push_back(static_cast<char>((slot_num >> shift) & 0xFF));
+  }
+  return encoded;
+}
+
+void VarlenBPlusTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  FilterAdd(key);
+  container_.Insert(EncodeEntry(key, rid), rid, transaction);
+}
+
+void VarlenBPlusTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(EncodeEntry(key, rid), transaction);
+  FilterRemove(key);
+}
+
+void VarlenBPlusTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  if (!FilterMayContain(key)) {
+    return;
+  }
+  std::string encoded = EncodeKey(key);
+  for (auto iterator = container_.Begin(encoded); iterator != container_.end(); ++iterator) {
+    const auto &entry = *iterator;
+    if (entry.first.compare(0, encoded.size(), encoded) != 0) {
+      break;
+    }
+    result->push_back(entry.second);
+  }
+}
+
+bool VarlenBPlusTreeIndex::Open() { return container_.Open(); }
+
+VarlenIndexIterator<RID> VarlenBPlusTreeIndex::GetBeginIterator() { return container_.begin(); }
+
+VarlenIndexIterator<RID> VarlenBPlusTreeIndex::GetBeginIterator(const Tuple &key) {
+  return container_.Begin(EncodeKey(key));
+}
+
+VarlenIndexIterator<RID> VarlenBPlusTreeIndex::GetEndIterator() { return container_.end(); }
+
+}  // namespace bustub
@@ -0,0 +1,79 @@
+/**
+ * varlen_index_iterator.cpp
+ */
+#include "storage/index/varlen_index_iterator.h"
+
+#include "common/rid.h"
+
+namespace bustub {
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType>::VarlenIndexIterator(BufferPoolManager *buffer_pool_manager, Page *leaf_page,
+                                                    int index)
+    : buffer_pool_manager_(buffer_pool_manager),
+      leaf_(reinterpret_cast<LeafPage *>(leaf_page->GetData())),
+      index_(index) {
+  SkipExhaustedLeaves();
+}
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType>::VarlenIndexIterator(VarlenIndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_), leaf_(other.leaf_), index_(other.index_) {
+  other.leaf_ = nullptr;
+}
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType> &VarlenIndexIterator<ValueType>::operator=(VarlenIndexIterator &&other) noexcept {
+  if (this != &other) {
+    if (leaf_ != nullptr) {
+      buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
+    }
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    leaf_ = other.leaf_;
+    index_ = other.index_;
+    other.leaf_ = nullptr;
+  }
+  return *this;
+}
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType>::~VarlenIndexIterator() {
+  if (leaf_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
+  }
+}
+
+template <typename ValueType>
+const std::pair<std::string, ValueType> &VarlenIndexIterator<ValueType>::operator*() {
+  current_.first = leaf_->KeyAt(index_);
+  current_.second = leaf_->ValueAt(index_);
+  return current_;
+}
+
+template <typename ValueType>
+VarlenIndexIterator<ValueType> &VarlenIndexIterator<ValueType>::operator++() {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+template <typename ValueType>
+void VarlenIndexIterator<ValueType>::SkipExhaustedLeaves() {
+  while (leaf_ != nullptr && index_ >= leaf_->GetSize()) {
+    page_id_t next_page_id = leaf_->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(leaf_->GetPageId(), false);
+    leaf_ = nullptr;
+    index_ = 0;
+    if (next_page_id != INVALID_PAGE_ID) {
+      Page *page = buffer_pool_manager_->FetchPage(next_page_id);
+      if (page == nullptr) {
+        throw "out of memory";
+      }
+      leaf_ = reinterpret_cast<LeafPage *>(page->GetData());
+    }
+  }
+}
+
+template class VarlenIndexIterator<RID>;
+
+}  // namespace bustub
@@ -15,6 +15,7 @@
 
 #include "common/exception.h"
 #include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_key_search.h"
 
 namespace bustub {
 /*****************************************************************************
@@ -78,16 +79,9 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return arra
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-
-
-  for (int i = 1; i < GetSize(); ++i) {
-    if (comparator(key, KeyAt(i)) == -1) {
-      LOG_INFO("lookup index %d key %d keyati %d value %d",i-1,(int)key.ToString(),(int)KeyAt(i).ToString(),ValueAt(i - 1));
-      return ValueAt(i - 1);
-    }
-  }
-
-  return ValueAt(GetSize() - 1);
+  // the child left of the first separator > key covers the key
+  int index = KeySearch<KeyType, ValueType, KeyComparator>::UpperBound(array, 1, GetSize(), key, comparator);
+  return ValueAt(index - 1);
 }
 
 /*****************************************************************************
@@ -118,12 +112,11 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
     array[0].second = old_value;
     array[1] = MappingType{new_key, new_value};
     SetSize(2);
-    LOG_INFO("insert page %d [0].second %d [1].first %d [1].second %d",GetPageId(),old_value,(int)new_key.ToString(),new_value);
     return GetSize();
   }
   int old_value_index = ValueIndex(old_value);
-  for (int i = GetSize(); i > old_value_index; --i) {
-    array[i + 1] = array[i];
+  for (int i = GetSize(); i > old_value_index + 1; --i) {
+    array[i] = array[i - 1];
   }
   array[old_value_index + 1] = MappingType{new_key, new_value};
   SetSize(GetSize() + 1);
@@ -226,7 +219,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
     array[i] = array[i + 1];
   }
   SetSize(GetSize() - 1);
-  CopyLastFrom(first_pair, buffer_pool_manager);
+  recipient->CopyLastFrom(first_pair, buffer_pool_manager);
 }
 
 /* Append an entry at the end.
@@ -235,7 +228,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  array[GetSize() + 1] = MappingType{pair};
+  array[GetSize()] = MappingType{pair};
   SetSize(GetSize() + 1);
   Page *pair_page = buffer_pool_manager->FetchPage(pair.second);
   BPlusTreePage *pair_page_internal = reinterpret_cast<BPlusTreePage *>(pair_page->GetData());
@@ -253,10 +246,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
-  MappingType last_pair = array[GetSize()];
+  MappingType last_pair = array[GetSize() - 1];
   last_pair.first = middle_key;
   SetSize(GetSize() - 1);
-  CopyFirstFrom(last_pair, buffer_pool_manager);
+  recipient->CopyFirstFrom(last_pair, buffer_pool_manager);
 }
 
 /* Append an entry at the beginning.
@@ -10,10 +10,12 @@
 //===----------------------------------------------------------------------===//
 
 #include <common/logger.h>
+#include <algorithm>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/page/b_plus_tree_key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -25,7 +27,7 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
@@ -34,17 +36,27 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, in
   SetMaxSize(max_size);
   SetPageType(IndexPageType(1));
   SetNextPageId(INVALID_PAGE_ID);
-  LOG_INFO("LEAFPAGESIZE %lu",LEAF_PAGE_SIZE);
+  SetPrevPageId(INVALID_PAGE_ID);
 }
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and prev page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_.load(std::memory_order_acquire); }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_.store(next_page_id, std::memory_order_release);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_.load(std::memory_order_acquire); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+  prev_page_id_.store(prev_page_id, std::memory_order_release);
+}
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
@@ -52,13 +64,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_pa
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  for (int i = 0; i < GetSize(); ++i) {
-    int cmp_res = comparator(array[i].first, key);
-    if (cmp_res == 0 || cmp_res == 1) {
-      return i;
-    }
-  }
-  return GetSize();
+  return KeySearch<KeyType, ValueType, KeyComparator>::LowerBound(array, 0, GetSize(), key, comparator);
 }
 
 /*
@@ -73,6 +79,16 @@ KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
   return key;
 }
 
+/*
+ * Helper methods to get/set the value associated with input "index", used for
+ * the posting list references of non-unique trees
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const { return array[index].second; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array[index].second = value; }
+
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
@@ -92,21 +108,11 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-
-  int insert_index;
-  for (insert_index = 0; insert_index < GetSize(); ++insert_index) {
-    int cmp_res = comparator(key, array[insert_index].first);
-    if (cmp_res == -1) {
-      break;
-    }
-  }
-
-  for (int i = GetSize(); i > insert_index; --i) {
-    array[i] = array[i - 1];
-  }
+  // insert after every key <= key
+  int insert_index = KeySearch<KeyType, ValueType, KeyComparator>::UpperBound(array, 0, GetSize(), key, comparator);
+  std::copy_backward(array + insert_index, array + GetSize(), array + GetSize() + 1);
   array[insert_index] = MappingType{key, value};
   IncreaseSize(1);
-  LOG_INFO("insert in %d,after insert size %d",insert_index,GetSize());
   return GetSize();
 }
 
@@ -145,7 +151,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
   int key_index = KeyIndex(key, comparator);
-  if (comparator(KeyAt(key_index), key) == 0) {
+  if (key_index < GetSize() && comparator(array[key_index].first, key) == 0) {
     if (value != nullptr) {
       *value = ValueType{array[key_index].second};
     }
@@ -170,7 +176,6 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
   if (delete_index==GetSize()||comparator(KeyAt(delete_index), key) != 0) {
     return GetSize();
   }
-  LOG_INFO("delete index %d",delete_index);
   for (int i = delete_index; i < GetSize() - 1; ++i) {
     array[i] = array[i + 1];
   }
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+// table pages never get close to this many slots, so no real RID has the bit set
+static constexpr uint32_t POSTING_LIST_TAG = 0x80000000;
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::SegmentCapacity(int size_class) {
+  if (size_class == POSTING_PAGE_CLASS) {
+    return static_cast<int>((PAGE_SIZE - POSTING_PAGE_HEADER_SIZE - sizeof(int32_t)) / sizeof(ValueType));
+  }
+  return 2 << size_class;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Init(page_id_t page_id, int size_class, page_id_t next_page_id) {
+  page_id_ = page_id;
+  next_page_id_ = next_page_id;
+  size_class_ = size_class;
+  segment_count_ = std::min((PAGE_SIZE - POSTING_PAGE_HEADER_SIZE) / SegmentBytes(size_class), MAX_SEGMENTS);
+  used_count_ = 0;
+  memset(used_, 0, sizeof(used_));
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::AllocateSegment() {
+  for (int segment = 0; segment < segment_count_; segment++) {
+    if ((used_[segment / 32] & (1U << (segment % 32))) == 0) {
+      used_[segment / 32] |= 1U << (segment % 32);
+      used_count_++;
+      *SegmentSize(segment) = 0;
+      return segment;
+    }
+  }
+  return -1;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::FreeSegment(int segment) {
+  used_[segment / 32] &= ~(1U << (segment % 32));
+  used_count_--;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Append(int segment, const ValueType &value) {
+  int32_t *size = SegmentSize(segment);
+  SegmentValues(segment)[*size] = value;
+  (*size)++;
+}
+
+template <typename ValueType>
+ValueType B_PLUS_TREE_POSTING_PAGE_TYPE::RemoveAt(int segment, int index) {
+  int32_t *size = SegmentSize(segment);
+  ValueType *values = SegmentValues(segment);
+  ValueType value = values[index];
+  values[index] = values[*size - 1];
+  (*size)--;
+  return value;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::ValueIndex(int segment, const ValueType &value) const {
+  const ValueType *values = SegmentValues(segment);
+  for (int i = 0; i < GetSize(segment); i++) {
+    if (values[i] == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+template <>
+bool BPlusTreePostingPage<RID>::IsPostingList(const RID &value) {
+  return (value.GetSlotNum() & POSTING_LIST_TAG) != 0;
+}
+
+template <>
+RID BPlusTreePostingPage<RID>::MakeReference(page_id_t page_id, int segment) {
+  return RID(page_id, POSTING_LIST_TAG | static_cast<uint32_t>(segment));
+}
+
+template <>
+page_id_t BPlusTreePostingPage<RID>::ReferencedPageId(const RID &value) {
+  return value.GetPageId();
+}
+
+template <>
+int BPlusTreePostingPage<RID>::ReferencedSegment(const RID &value) {
+  return static_cast<int>(value.GetSlotNum() & ~POSTING_LIST_TAG);
+}
+
+template class BPlusTreePostingPage<RID>;
+}  // namespace bustub
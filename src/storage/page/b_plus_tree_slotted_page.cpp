@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_slotted_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, IndexPageType page_type) {
+  SetPageType(page_type);
+  SetSize(0);
+  // pages split by bytes, not by number of entries
+  SetMaxSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetLSN();
+  next_page_id_ = INVALID_PAGE_ID;
+  prefix_size_ = 0;
+  heap_offset_ = PAGE_SIZE;
+}
+
+template <typename ValueType>
+std::string B_PLUS_TREE_SLOTTED_PAGE_TYPE::KeyAt(int index) const {
+  const Slot &slot = Slots()[index];
+  std::string key;
+  key.reserve(prefix_size_ + slot.size_);
+  key.append(Data() + PAGE_SIZE - prefix_size_, prefix_size_);
+  key.append(Data() + slot.offset_, slot.size_);
+  return key;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (Slots()[i].value_ == value) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/*
+ * The probe is compared against the prefix once, then only the key suffixes
+ * are searched.
+ */
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::Bound(const std::string &key, bool upper) const {
+  int low = FirstKeyIndex();
+  int high = GetSize();
+  if (low >= high) {
+    return low;
+  }
+  int result = memcmp(Data() + PAGE_SIZE - prefix_size_, key.data(), std::min<size_t>(prefix_size_, key.size()));
+  if (result > 0 || (result == 0 && key.size() < prefix_size_)) {
+    return low;
+  }
+  if (result < 0) {
+    return high;
+  }
+  const char *rest = key.data() + prefix_size_;
+  size_t rest_size = key.size() - prefix_size_;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    const Slot &slot = Slots()[mid];
+    result = memcmp(Data() + slot.offset_, rest, std::min<size_t>(slot.size_, rest_size));
+    if (result == 0) {
+      result = (slot.size_ > rest_size) - (slot.size_ < rest_size);
+    }
+    if (result < 0 || (upper && result == 0)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::EntryBytes(int index) const {
+  return static_cast<int>(sizeof(Slot)) + Slots()[index].size_;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::UsedBytes() const {
+  int bytes = prefix_size_;
+  for (int i = 0; i < GetSize(); i++) {
+    bytes += EntryBytes(i);
+  }
+  return bytes;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::GetEntries(int begin, int end, std::vector<Entry> *entries) const {
+  for (int i = begin; i < end; i++) {
+    entries->emplace_back(KeyAt(i), ValueAt(i));
+  }
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+/*
+ * A key that starts with the prefix goes into the free space, after the key
+ * heap is compacted if that is what it takes. Any other key shortens the
+ * prefix, so the page is rebuilt around it.
+ */
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::Insert(int index, const std::string &key, const ValueType &value) {
+  bool keyed = index >= FirstKeyIndex();
+  bool has_prefix = !keyed || (key.size() >= prefix_size_ && memcmp(key.data(), Data() + PAGE_SIZE - prefix_size_,
+                                                                    prefix_size_) == 0);
+  int suffix_size = keyed ? static_cast<int>(key.size()) - prefix_size_ : 0;
+  if (!has_prefix || FreeBytes() < static_cast<int>(sizeof(Slot)) + suffix_size) {
+    if (has_prefix && UsedBytes() + static_cast<int>(sizeof(Slot)) + suffix_size > CAPACITY) {
+      return false;
+    }
+    std::vector<Entry> entries;
+    GetEntries(0, GetSize(), &entries);
+    entries.insert(entries.begin() + index, Entry(key, value));
+    return Rebuild(entries);
+  }
+
+  heap_offset_ -= suffix_size;
+  memcpy(Data() + heap_offset_, key.data() + key.size() - suffix_size, suffix_size);
+  Slot *slots = Slots();
+  memmove(slots + index + 1, slots + index, (GetSize() - index) * sizeof(Slot));
+  slots[index] = Slot{heap_offset_, static_cast<uint16_t>(suffix_size), value};
+  IncreaseSize(1);
+  return true;
+}
+
+// the suffix stays behind in the key heap until the page is rebuilt
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::RemoveAt(int index) {
+  Slot *slots = Slots();
+  memmove(slots + index, slots + index + 1, (GetSize() - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+}
+
+/*****************************************************************************
+ * REBUILD
+ *****************************************************************************/
+// entries are sorted, so the common prefix of all keys is the one of the first and the last key
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::CommonPrefixSize(const std::vector<Entry> &entries, bool leaf) {
+  size_t first = leaf ? 0 : 1;
+  if (entries.size() <= first) {
+    return 0;
+  }
+  const std::string &low = entries[first].first;
+  const std::string &high = entries.back().first;
+  auto mismatch = std::mismatch(low.begin(), low.begin() + std::min(low.size(), high.size()), high.begin());
+  return static_cast<int>(mismatch.first - low.begin());
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::RequiredBytes(const std::vector<Entry> &entries, bool leaf) {
+  int prefix_size = CommonPrefixSize(entries, leaf);
+  int bytes = prefix_size + static_cast<int>(entries.size() * sizeof(Slot));
+  for (size_t i = leaf ? 0 : 1; i < entries.size(); i++) {
+    bytes += static_cast<int>(entries[i].first.size()) - prefix_size;
+  }
+  return bytes;
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_SLOTTED_PAGE_TYPE::Rebuild(const std::vector<Entry> &entries) {
+  bool leaf = IsLeafPage();
+  if (RequiredBytes(entries, leaf) > CAPACITY) {
+    return false;
+  }
+  int first = FirstKeyIndex();
+  int prefix_size = CommonPrefixSize(entries, leaf);
+  int heap_offset = PAGE_SIZE - prefix_size;
+  if (prefix_size > 0) {
+    memcpy(Data() + heap_offset, entries[first].first.data(), prefix_size);
+  }
+  Slot *slots = Slots();
+  for (size_t i = 0; i < entries.size(); i++) {
+    const std::string &key = entries[i].first;
+    int suffix_size = static_cast<int>(i) < first ? 0 : static_cast<int>(key.size()) - prefix_size;
+    heap_offset -= suffix_size;
+    memcpy(Data() + heap_offset, key.data() + prefix_size, suffix_size);
+    slots[i] = Slot{static_cast<uint16_t>(heap_offset), static_cast<uint16_t>(suffix_size), entries[i].second};
+  }
+  SetSize(static_cast<int>(entries.size()));
+  prefix_size_ = static_cast<uint16_t>(prefix_size);
+  heap_offset_ = static_cast<uint16_t>(heap_offset);
+  return true;
+}
+
+template class BPlusTreeSlottedPage<RID>;
+template class BPlusTreeSlottedPage<page_id_t>;
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_page.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "common/logger.h"
+
+namespace bustub {
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  if (global_depth_ < MAX_DEPTH) {
+    uint32_t size = Size();
+    memcpy(local_depths_ + size, local_depths_, size * sizeof(uint8_t));
+    memcpy(bucket_page_ids_ + size, bucket_page_ids_, size * sizeof(page_id_t));
+  }
+  global_depth_++;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  assert(CanShrink());
+  global_depth_--;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] == global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t HashTableDirectoryPage::Size() const { return 1U << std::min(global_depth_, MAX_DEPTH); }
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const { return bucket_page_ids_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const { return local_depths_[bucket_idx]; }
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  assert(local_depth <= global_depth_);
+  local_depths_[bucket_idx] = local_depth;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) const {
+  return (1U << local_depths_[bucket_idx]) - 1;
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  assert(local_depths_[bucket_idx] > 0);
+  return (bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1))) & GetLocalDepthMask(bucket_idx);
+}
+
+void HashTableDirectoryPage::VerifyIntegrity() const {
+  assert(global_depth_ <= MAX_DEPTH);
+  std::unordered_map<page_id_t, uint32_t> slot_count;
+  std::unordered_map<page_id_t, uint32_t> local_depth;
+  for (uint32_t i = 0; i < Size(); i++) {
+    page_id_t page_id = bucket_page_ids_[i];
+    assert(local_depths_[i] <= global_depth_);
+    assert(local_depth.count(page_id) == 0 || local_depth[page_id] == local_depths_[i]);
+    // the slots of a bucket agree on its local depth bits
+    assert(bucket_page_ids_[i & GetLocalDepthMask(i)] == page_id);
+    local_depth[page_id] = local_depths_[i];
+    slot_count[page_id]++;
+  }
+  for (const auto &[page_id, count] : slot_count) {
+    if (count != 1U << (global_depth_ - local_depth[page_id])) {
+      LOG_WARN("bucket page %d has %u slots at local depth %u", page_id, count, local_depth[page_id]);
+      assert(false);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_root_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_root_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_root_directory_page.h"
+
+namespace bustub {
+page_id_t HashTableRootDirectoryPage::GetPageId() const { return page_id_; }
+
+void HashTableRootDirectoryPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableRootDirectoryPage::GetLSN() const { return lsn_; }
+
+void HashTableRootDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableRootDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableRootDirectoryPage::GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+void HashTableRootDirectoryPage::IncrGlobalDepth() {
+  assert(global_depth_ < MAX_DEPTH);
+  global_depth_++;
+}
+
+void HashTableRootDirectoryPage::DecrGlobalDepth() {
+  assert(global_depth_ > 0);
+  global_depth_--;
+}
+
+uint32_t HashTableRootDirectoryPage::Size() const { return 1U << global_depth_; }
+
+uint32_t HashTableRootDirectoryPage::NumSegments() const {
+  return global_depth_ > SEGMENT_DEPTH ? 1U << (global_depth_ - SEGMENT_DEPTH) : 1;
+}
+
+page_id_t HashTableRootDirectoryPage::GetSegmentPageId(uint32_t segment_idx) const {
+  assert(segment_idx < MAX_SEGMENTS);
+  return segment_page_ids_[segment_idx];
+}
+
+void HashTableRootDirectoryPage::SetSegmentPageId(uint32_t segment_idx, page_id_t segment_page_id) {
+  assert(segment_idx < MAX_SEGMENTS);
+  segment_page_ids_[segment_idx] = segment_page_id;
+}
+
+}  // namespace bustub
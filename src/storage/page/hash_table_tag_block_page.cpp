@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_tag_block_page.cpp
+//
+// Identification: src/storage/page/hash_table_tag_block_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_tag_block_page.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <atomic>
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+KeyType HASH_TABLE_TAG_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].first;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_TAG_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const {
+  return array_[bucket_ind].second;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TAG_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value,
+                                       uint8_t tag) {
+  uint8_t expected = EMPTY;
+  if (!__atomic_compare_exchange_n(&tags_[bucket_ind], &expected, CLAIMED, false, __ATOMIC_ACQ_REL,
+                                   __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  array_[bucket_ind] = MappingType(key, value);
+  __atomic_store_n(&tags_[bucket_ind], tag, __ATOMIC_RELEASE);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TAG_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  __atomic_store_n(&tags_[bucket_ind], DELETED, __ATOMIC_RELEASE);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TAG_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const {
+  return __atomic_load_n(&tags_[bucket_ind], __ATOMIC_ACQUIRE) != EMPTY;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TAG_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const {
+  return (__atomic_load_n(&tags_[bucket_ind], __ATOMIC_ACQUIRE) & 0x80) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TAG_BLOCK_TYPE::MatchGroup(slot_offset_t group_start, uint8_t tag, uint32_t *candidates,
+                                           uint32_t *empty) const {
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(tags_ + group_start));
+  *candidates = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8(tag))));
+  *empty = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_setzero_si256())));
+#elif defined(__SSE2__)
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tags_ + group_start));
+  *candidates = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+  *empty = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_setzero_si128())));
+#else
+  *candidates = 0;
+  *empty = 0;
+  for (slot_offset_t i = 0; i < GROUP_SIZE; i++) {
+    *candidates |= static_cast<uint32_t>(tags_[group_start + i] == tag) << i;
+    *empty |= static_cast<uint32_t>(tags_[group_start + i] == EMPTY) << i;
+  }
+#endif
+  // the pairs behind the tags are read after the tags
+  std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+// DO NOT REMOVE ANYTHING BELOW THIS LINE
+template class HashTableTagBlockPage<int, int, IntComparator>;
+template class HashTableTagBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableTagBlockPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableTagBlockPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableTagBlockPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableTagBlockPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
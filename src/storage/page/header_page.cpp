@@ -12,6 +12,7 @@
 #include <cassert>
 #include <iostream>
 
+#include "common/util/hash_util.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
@@ -20,18 +21,22 @@ namespace bustub {
  * Record related
  */
 bool HeaderPage::InsertRecord(const std::string &name, const page_id_t root_id) {
-  assert(name.length() < 32);
+  assert(!name.empty() && name.length() < NAME_SIZE);
   assert(root_id > INVALID_PAGE_ID);
 
   int record_num = GetRecordCount();
-  int offset = 4 + record_num * 36;
   // check for duplicate name
-  if (FindRecord(name) != -1) {
+  if (FindRecord(name) != -1 || record_num == SLOT_COUNT) {
     return false;
   }
+  // take the first free slot from the home slot on
+  int slot = HomeSlot(name.c_str());
+  while (SlotName(slot)[0] != '\0') {
+    slot = (slot + 1) % SLOT_COUNT;
+  }
   // copy record content
-  memcpy(GetData() + offset, name.c_str(), (name.length() + 1));
-  memcpy((GetData() + offset + 32), &root_id, 4);
+  memcpy(SlotName(slot), name.c_str(), (name.length() + 1));
+  memcpy(SlotRootId(slot), &root_id, 4);
 
   SetRecordCount(record_num + 1);
   return true;
@@ -41,43 +46,50 @@ bool HeaderPage::DeleteRecord(const std::string &name) {
   int record_num = GetRecordCount();
   assert(record_num > 0);
 
-  int index = FindRecord(name);
+  int hole = FindRecord(name);
   // record does not exsit
-  if (index == -1) {
+  if (hole == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
-  memmove(GetData() + offset, GetData() + offset + 36, (record_num - index - 1) * 36);
+  memset(SlotName(hole), 0, RECORD_SIZE);
+  // shift the records after the hole back, so that no probe sequence runs into a free slot before its record
+  for (int slot = (hole + 1) % SLOT_COUNT; SlotName(slot)[0] != '\0'; slot = (slot + 1) % SLOT_COUNT) {
+    int home = HomeSlot(SlotName(slot));
+    bool reachable = hole < slot ? (hole < home && home <= slot) : (hole < home || home <= slot);
+    if (!reachable) {
+      memcpy(SlotName(hole), SlotName(slot), RECORD_SIZE);
+      memset(SlotName(slot), 0, RECORD_SIZE);
+      hole = slot;
+    }
+  }
 
   SetRecordCount(record_num - 1);
   return true;
 }
 
 bool HeaderPage::UpdateRecord(const std::string &name, const page_id_t root_id) {
-  assert(name.length() < 32);
+  assert(name.length() < NAME_SIZE);
 
   int index = FindRecord(name);
   // record does not exsit
   if (index == -1) {
     return false;
   }
-  int offset = index * 36 + 4;
   // update record content, only root_id
-  memcpy((GetData() + offset + 32), &root_id, 4);
+  memcpy(SlotRootId(index), &root_id, 4);
 
   return true;
 }
 
 bool HeaderPage::GetRootId(const std::string &name, page_id_t *root_id) {
-  assert(name.length() < 32);
+  assert(name.length() < NAME_SIZE);
 
   int index = FindRecord(name);
   // record does not exsit
   if (index == -1) {
     return false;
   }
-  int offset = (index + 1) * 36;
-  *root_id = *reinterpret_cast<page_id_t *>(GetData() + offset);
+  *root_id = *SlotRootId(index);
 
   return true;
 }
@@ -90,14 +102,20 @@ int HeaderPage::GetRecordCount() { return *reinterpret_cast<int *>(GetData()); }
 
 void HeaderPage::SetRecordCount(int record_count) { memcpy(GetData(), &record_count, 4); }
 
-int HeaderPage::FindRecord(const std::string &name) {
-  int record_num = GetRecordCount();
+int HeaderPage::HomeSlot(const char *name) {
+  return static_cast<int>(HashUtil::HashBytes(name, strlen(name)) % SLOT_COUNT);
+}
 
-  for (int i = 0; i < record_num; i++) {
-    char *raw_name = reinterpret_cast<char *>(GetData() + (4 + i * 36));
-    if (strcmp(raw_name, name.c_str()) == 0) {
-      return i;
+int HeaderPage::FindRecord(const std::string &name) {
+  if (name.empty()) {
+    return -1;
+  }
+  int slot = HomeSlot(name.c_str());
+  for (int probes = 0; probes < SLOT_COUNT && SlotName(slot)[0] != '\0'; probes++) {
+    if (strcmp(SlotName(slot), name.c_str()) == 0) {
+      return slot;
     }
+    slot = (slot + 1) % SLOT_COUNT;
   }
   return -1;
 }
@@ -335,4 +335,21 @@ bool TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) {
   next_rid->Set(INVALID_PAGE_ID, 0);
   return false;
 }
+
+bool TablePage::GetTuplesInPlace(uint32_t *slot, size_t max_tuples, std::vector<Tuple> *tuples) {
+  size_t collected = 0;
+  for (; *slot < GetTupleCount() && collected < max_tuples; ++*slot) {
+    uint32_t tuple_size = GetTupleSize(*slot);
+    if (IsDeleted(tuple_size)) {
+      continue;
+    }
+    // a tuple that is not allocated does not own its data
+    Tuple tuple(RID(GetTablePageId(), *slot));
+    tuple.size_ = tuple_size;
+    tuple.data_ = GetData() + GetTupleOffsetAtSlot(*slot);
+    tuples->push_back(tuple);
+    collected++;
+  }
+  return *slot < GetTupleCount();
+}
 }  // namespace bustub
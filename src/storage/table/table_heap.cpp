@@ -171,6 +171,28 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
+bool TableHeap::ScanInPlace(RID *cursor, size_t max_tuples,
+                            const std::function<void(const std::vector<Tuple> &)> &visit, Transaction *txn) {
+  if (cursor->GetPageId() == INVALID_PAGE_ID) {
+    return false;
+  }
+  page_id_t page_id = cursor->GetPageId();
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->RLatch();
+  std::vector<Tuple> tuples;
+  uint32_t slot = cursor->GetSlotNum();
+  bool more = page->GetTuplesInPlace(&slot, max_tuples, &tuples);
+  visit(tuples);
+  cursor->Set(more ? page_id : page->GetNextPageId(), more ? slot : 0);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
@@ -10,12 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/bustub_instance.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
 
@@ -48,4 +51,451 @@ TEST(CatalogTest, CreateTableTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  // the indexes keep their root page ids in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  // insert the keys in reverse order, the index is built from the sorted keys
+  std::vector<RID> rids;
+  for (int64_t i = 999; i >= 0; i--) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetIntegerValue(static_cast<int32_t>(i))}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+    rids.push_back(rid);
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::BIGINT);
+  Schema key_schema(key_columns);
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(&txn, "potato_a", "potato", schema,
+                                                                                  key_schema, {0}, 8);
+  EXPECT_EQ(catalog->GetIndex("potato_a", "potato"), index_info);
+
+  std::vector<RID> result;
+  for (int64_t i = 0; i < 1000; i++) {
+    result.clear();
+    Tuple key({ValueFactory::GetBigIntValue(i)}, &key_schema);
+    index_info->index_->ScanKey(key, &result, &txn);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0], rids[999 - i]);
+  }
+
+  delete catalog;
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreatePostingListIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  // every key is shared by four tuples
+  std::vector<std::vector<RID>> rids(100);
+  for (int32_t i = 0; i < 400; i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i % 100), ValueFactory::GetIntegerValue(i)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+    rids[i % 100].push_back(rid);
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::BIGINT);
+  Schema key_schema(key_columns);
+  // an index keeps one rid per key unless it is asked for posting lists
+  auto *unique_info = catalog->CreateIndex(&txn, "potato_a", "potato", schema, key_schema, {0}, IndexType::B_PLUS_TREE);
+  auto *posting_info =
+      catalog->CreateIndex(&txn, "potato_a_all", "potato", schema, key_schema, {0}, IndexType::B_PLUS_TREE, false);
+  EXPECT_TRUE(unique_info->unique_keys_);
+  EXPECT_FALSE(posting_info->unique_keys_);
+
+  auto by_rid = [](const RID &a, const RID &b) { return a.Get() < b.Get(); };
+  std::vector<RID> result;
+  for (int64_t i = 0; i < 100; i++) {
+    Tuple key({ValueFactory::GetBigIntValue(i)}, &key_schema);
+    result.clear();
+    unique_info->index_->ScanKey(key, &result, &txn);
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_NE(std::find(rids[i].begin(), rids[i].end(), result[0]), rids[i].end());
+    result.clear();
+    posting_info->index_->ScanKey(key, &result, &txn);
+    std::sort(result.begin(), result.end(), by_rid);
+    EXPECT_EQ(result, rids[i]);
+  }
+
+  // a later insert of an existing key is refused by the unique index only
+  Tuple key({ValueFactory::GetBigIntValue(7)}, &key_schema);
+  unique_info->index_->InsertEntry(key, RID(100, 7), &txn);
+  posting_info->index_->InsertEntry(key, RID(100, 7), &txn);
+  result.clear();
+  unique_info->index_->ScanKey(key, &result, &txn);
+  EXPECT_EQ(result.size(), 1);
+  result.clear();
+  posting_info->index_->ScanKey(key, &result, &txn);
+  EXPECT_EQ(result.size(), 5);
+
+  delete catalog;
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateVarlenIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::VARCHAR, 300);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+
+  // 50 keys that only differ past their first 200 bytes, each shared by 6 tuples
+  std::string prefix(200, 'p');
+  std::vector<std::vector<RID>> rids(50);
+  for (int i = 0; i < 300; i++) {
+    Tuple tuple({ValueFactory::GetVarcharValue(prefix + std::to_string(i % 50)), ValueFactory::GetIntegerValue(i)},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+    rids[i % 50].push_back(rid);
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::VARCHAR, 300);
+  Schema key_schema(key_columns);
+  auto *index_info =
+      catalog->CreateIndex(&txn, "potato_a", "potato", schema, key_schema, {0}, IndexType::VARLEN_B_PLUS_TREE);
+  EXPECT_EQ(index_info->index_type_, IndexType::VARLEN_B_PLUS_TREE);
+
+  std::vector<RID> result;
+  for (int i = 0; i < 50; i++) {
+    result.clear();
+    Tuple key({ValueFactory::GetVarcharValue(prefix + std::to_string(i))}, &key_schema);
+    index_info->index_->ScanKey(key, &result, &txn);
+    // the tuples of a key come back in rid order
+    EXPECT_EQ(result, rids[i]);
+  }
+  Tuple key({ValueFactory::GetVarcharValue(prefix + "7")}, &key_schema);
+  index_info->index_->DeleteEntry(key, rids[7][0], &txn);
+  result.clear();
+  index_info->index_->ScanKey(key, &result, &txn);
+  EXPECT_EQ(result, std::vector<RID>(rids[7].begin() + 1, rids[7].end()));
+  result.clear();
+  index_info->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(prefix)}, &key_schema), &result, &txn);
+  EXPECT_TRUE(result.empty());
+
+  // keys longer than the index takes are refused instead of truncated
+  Tuple long_key({ValueFactory::GetVarcharValue(std::string(2000, 'x'))}, &key_schema);
+  EXPECT_THROW(index_info->index_->InsertEntry(long_key, RID(0, 0), &txn), Exception);
+
+  // a fixed-width index would truncate the strings
+  EXPECT_THROW(catalog->CreateIndex(&txn, "potato_a_fixed", "potato", schema, key_schema, {0}, IndexType::B_PLUS_TREE),
+               NotImplementedException);
+
+  // a fixed-width index gets the narrowest key that fits
+  std::vector<Column> int_key_columns;
+  int_key_columns.emplace_back("B", TypeId::INTEGER);
+  Schema int_key_schema(int_key_columns);
+  auto *int_index_info =
+      catalog->CreateIndex(&txn, "potato_b", "potato", schema, int_key_schema, {1}, IndexType::B_PLUS_TREE);
+  EXPECT_EQ(int_index_info->key_size_, 4);
+  result.clear();
+  int_index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(57)}, &int_key_schema), &result, &txn);
+  EXPECT_EQ(result, std::vector<RID>{rids[7][1]});
+
+  delete catalog;
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateBufferedIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+  std::vector<RID> rids;
+  for (int i = 0; i < 100; i++) {
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(i)}, &schema), &rid, &txn));
+    rids.push_back(rid);
+  }
+
+  // the existing tuples are bulk loaded, later entries wait in the buffer
+  auto *index_info = catalog->CreateIndex(&txn, "potato_a", "potato", schema, schema, {0},
+                                          IndexType::BUFFERED_B_PLUS_TREE);
+  EXPECT_EQ(index_info->index_type_, IndexType::BUFFERED_B_PLUS_TREE);
+  EXPECT_EQ(index_info->key_size_, 4);
+  index_info->index_->InsertEntry(Tuple({ValueFactory::GetIntegerValue(5)}, &schema), RID(100, 5), &txn);
+  index_info->index_->DeleteEntry(Tuple({ValueFactory::GetIntegerValue(6)}, &schema), rids[6], &txn);
+
+  std::vector<RID> result;
+  index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(5)}, &schema), &result, &txn);
+  EXPECT_EQ(result, (std::vector<RID>{rids[5], RID(100, 5)}));
+  result.clear();
+  index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(6)}, &schema), &result, &txn);
+  EXPECT_TRUE(result.empty());
+
+  delete catalog;
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, ReopenPersistentCatalogTest) {
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  auto *instance = new BustubInstance("catalog_test.db");
+  Catalog *catalog = instance->catalog_;
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::VARCHAR, 32);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+  std::vector<RID> rids;
+  for (int64_t i = 0; i < 1000; i++) {
+    Tuple tuple({ValueFactory::GetBigIntValue(i), ValueFactory::GetVarcharValue("key" + std::to_string(i))}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+    rids.push_back(rid);
+  }
+  Schema key_a(std::vector<Column>{columns[0]});
+  Schema key_b(std::vector<Column>{columns[1]});
+  catalog->CreateIndex(&txn, "potato_a", "potato", schema, key_a, {0}, IndexType::B_PLUS_TREE);
+  catalog->CreateIndex(&txn, "potato_b", "potato", schema, key_b, {1}, IndexType::VARLEN_B_PLUS_TREE);
+  auto *buffered =
+      catalog->CreateIndex(&txn, "potato_a_buffered", "potato", schema, key_a, {0}, IndexType::BUFFERED_B_PLUS_TREE,
+                           false);
+  // still in the buffer, it is written to the tree when the catalog goes away
+  buffered->index_->InsertEntry(Tuple({ValueFactory::GetBigIntValue(5)}, &key_a), RID(100, 5), &txn);
+
+  // shutting down writes everything, a new instance on the same file finds the table and the indexes without
+  // scanning the table
+  delete instance;
+  instance = new BustubInstance("catalog_test.db");
+  catalog = instance->catalog_;
+
+  table_metadata = catalog->GetTable("potato");
+  EXPECT_EQ(table_metadata->oid_, 1);
+  ASSERT_EQ(table_metadata->schema_.GetColumnCount(), 2);
+  EXPECT_EQ(table_metadata->schema_.GetColumn(1).GetType(), TypeId::VARCHAR);
+  int64_t count = 0;
+  for (auto iter = table_metadata->table_->Begin(&txn); iter != table_metadata->table_->End(); ++iter) {
+    EXPECT_EQ(iter->GetValue(&schema, 0).GetAs<int64_t>(), count++);
+  }
+  EXPECT_EQ(count, 1000);
+  EXPECT_EQ(catalog->GetTableIndexes("potato").size(), 3);
+
+  auto *index_a = catalog->GetIndex("potato_a", "potato");
+  auto *index_b = catalog->GetIndex("potato_b", "potato");
+  buffered = catalog->GetIndex("potato_a_buffered", "potato");
+  EXPECT_EQ(index_a->key_size_, 8);
+  EXPECT_EQ(index_b->index_type_, IndexType::VARLEN_B_PLUS_TREE);
+  EXPECT_EQ(buffered->index_type_, IndexType::BUFFERED_B_PLUS_TREE);
+  EXPECT_TRUE(index_a->unique_keys_);
+  EXPECT_FALSE(buffered->unique_keys_);
+  std::vector<RID> result;
+  for (int64_t i = 0; i < 1000; i++) {
+    result.clear();
+    index_a->index_->ScanKey(Tuple({ValueFactory::GetBigIntValue(i)}, &index_a->key_schema_), &result, &txn);
+    ASSERT_EQ(result, std::vector<RID>{rids[i]});
+    result.clear();
+    index_b->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue("key" + std::to_string(i))}, &index_b->key_schema_),
+                             &result, &txn);
+    ASSERT_EQ(result, std::vector<RID>{rids[i]});
+  }
+  result.clear();
+  buffered->index_->ScanKey(Tuple({ValueFactory::GetBigIntValue(5)}, &buffered->key_schema_), &result, &txn);
+  std::sort(result.begin(), result.end(), [](const RID &a, const RID &b) { return a.Get() < b.Get(); });
+  EXPECT_EQ(result, (std::vector<RID>{rids[5], RID(100, 5)}));
+
+  // new pages do not overwrite the reopened ones
+  auto *table2 = catalog->CreateTable(&txn, "tomato", schema);
+  EXPECT_EQ(table2->oid_, 2);
+  RID rid;
+  ASSERT_TRUE(table2->table_->InsertTuple(
+      Tuple({ValueFactory::GetBigIntValue(0), ValueFactory::GetVarcharValue("tomato")}, &schema), &rid, &txn));
+  result.clear();
+  index_a->index_->ScanKey(Tuple({ValueFactory::GetBigIntValue(999)}, &index_a->key_schema_), &result, &txn);
+  EXPECT_EQ(result, std::vector<RID>{rids[999]});
+
+  delete instance;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, ReopenSameIndexNameTest) {
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  auto *instance = new BustubInstance("catalog_test.db");
+  Catalog *catalog = instance->catalog_;
+  Transaction txn(0);
+
+  // two tables with an index of the same name each, both B+ trees and varlen B+ trees
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 16);
+  Schema schema(columns);
+  Schema key_a(std::vector<Column>{columns[0]});
+  Schema key_b(std::vector<Column>{columns[1]});
+  std::vector<std::string> table_names{"potato", "tomato"};
+  std::vector<std::vector<RID>> rids(2);
+  for (size_t t = 0; t < table_names.size(); t++) {
+    auto *table_metadata = catalog->CreateTable(&txn, table_names[t], schema);
+    for (int i = 0; i < 100; i++) {
+      Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(table_names[t])}, &schema);
+      RID rid;
+      ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+      rids[t].push_back(rid);
+    }
+    catalog->CreateIndex(&txn, "index_a", table_names[t], schema, key_a, {0}, IndexType::B_PLUS_TREE);
+    catalog->CreateIndex(&txn, "index_b", table_names[t], schema, key_b, {1}, IndexType::VARLEN_B_PLUS_TREE, false);
+  }
+
+  delete instance;
+  instance = new BustubInstance("catalog_test.db");
+  catalog = instance->catalog_;
+
+  // every index reopens its own tree
+  std::vector<RID> result;
+  for (size_t t = 0; t < table_names.size(); t++) {
+    auto *index_a = catalog->GetIndex("index_a", table_names[t]);
+    auto *index_b = catalog->GetIndex("index_b", table_names[t]);
+    for (int i = 0; i < 100; i++) {
+      result.clear();
+      index_a->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(i)}, &key_a), &result, &txn);
+      ASSERT_EQ(result, std::vector<RID>{rids[t][i]});
+    }
+    result.clear();
+    index_b->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(table_names[t])}, &key_b), &result, &txn);
+    EXPECT_EQ(result, rids[t]);
+  }
+
+  delete instance;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateArtIndexTest) {
+  remove("catalog_test.db");
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = new Catalog(bpm, nullptr, nullptr, true);
+  Transaction txn(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::VARCHAR, 64);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+  // 100 keys sharing a long prefix, each shared by 3 tuples
+  std::string prefix(40, 'p');
+  std::vector<std::vector<RID>> rids(100);
+  for (int i = 0; i < 300; i++) {
+    Tuple tuple({ValueFactory::GetVarcharValue(prefix + std::to_string(i % 100)), ValueFactory::GetIntegerValue(i)},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, &txn));
+    rids[i % 100].push_back(rid);
+  }
+  Schema key_schema(std::vector<Column>{columns[0]});
+  auto *index_info = catalog->CreateIndex(&txn, "potato_a", "potato", schema, key_schema, {0}, IndexType::ART);
+  EXPECT_EQ(index_info->index_type_, IndexType::ART);
+
+  std::vector<RID> result;
+  for (int i = 0; i < 100; i++) {
+    result.clear();
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(prefix + std::to_string(i))}, &key_schema),
+                                &result, &txn);
+    // the tuples of a key come back in rid order
+    ASSERT_EQ(result, rids[i]);
+  }
+  Tuple key({ValueFactory::GetVarcharValue(prefix + "7")}, &key_schema);
+  index_info->index_->DeleteEntry(key, rids[7][0], &txn);
+  result.clear();
+  index_info->index_->ScanKey(key, &result, &txn);
+  EXPECT_EQ(result, std::vector<RID>(rids[7].begin() + 1, rids[7].end()));
+  result.clear();
+  index_info->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(prefix)}, &key_schema), &result, &txn);
+  EXPECT_TRUE(result.empty());
+
+  delete catalog;
+  bpm->UnpinPage(header_page_id, true);
+  bpm->FlushAllPages();
+  delete bpm;
+  delete disk_manager;
+
+  // the index is not on disk, a reopened catalog rebuilds it from the table
+  disk_manager = new DiskManager("catalog_test.db");
+  bpm = new BufferPoolManager(32, disk_manager);
+  catalog = new Catalog(bpm, nullptr, nullptr, true);
+  index_info = catalog->GetIndex("potato_a", "potato");
+  EXPECT_EQ(index_info->index_type_, IndexType::ART);
+  for (int i = 0; i < 100; i++) {
+    result.clear();
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(prefix + std::to_string(i))}, &key_schema),
+                                &result, &txn);
+    ASSERT_EQ(result, rids[i]);
+  }
+
+  delete catalog;
+  delete bpm;
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/logger.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "murmur3/MurmurHash3.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+  }
+  // duplicate values for the same key are not allowed
+  EXPECT_FALSE(ht.Insert(nullptr, 3, 3));
+
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    std::sort(res.begin(), res.end());
+    EXPECT_EQ(res, (std::vector<int>{i, 2 * i + 1}));
+  }
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    res.clear();
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(res, std::vector<int>{2 * i + 1});
+  }
+  EXPECT_EQ(ht.GetGlobalDepth(), 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // buckets split one at a time as they fill up
+  const int keys = 20000;
+  uint32_t global_depth = 0;
+  for (int i = 0; i < keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i));
+    uint32_t depth = ht.GetGlobalDepth();
+    ASSERT_LE(depth, global_depth + 1);
+    global_depth = depth;
+    if (i % 1000 == 0) {
+      ht.VerifyIntegrity();
+    }
+  }
+  EXPECT_GE(global_depth, 5);
+  ht.VerifyIntegrity();
+
+  std::vector<int> res;
+  for (int i = 0; i < keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(res, std::vector<int>{i});
+  }
+
+  // emptied buckets merge, and the directory shrinks back
+  for (int i = 0; i < keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, i, i));
+    if (i % 1000 == 0) {
+      ht.VerifyIntegrity();
+    }
+  }
+  EXPECT_EQ(ht.GetGlobalDepth(), 0);
+  ht.VerifyIntegrity();
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, DeepDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<64> comparator(&key_schema);
+  // wide keys fill the buckets early, the directory outgrows its first page
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator,
+                                                                     HashFunction<GenericKey<64>>());
+  auto Key = [](int64_t key) {
+    GenericKey<64> index_key;
+    index_key.SetFromInteger(key);
+    return index_key;
+  };
+
+  const int keys = 60000;
+  for (int i = 0; i < keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, Key(i), RID(i)));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), HashTableDirectoryPage::MAX_DEPTH);
+  ht.VerifyIntegrity();
+  std::vector<RID> res;
+  for (int i = 0; i < keys; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, Key(i), &res));
+    ASSERT_EQ(res, std::vector<RID>{RID(i)});
+  }
+
+  for (int i = 0; i < keys; i++) {
+    ASSERT_TRUE(ht.Remove(nullptr, Key(i), RID(i)));
+    if (i % 10000 == 0) {
+      ht.VerifyIntegrity();
+    }
+  }
+  EXPECT_EQ(ht.GetGlobalDepth(), 0);
+  ht.VerifyIntegrity();
+
+  // keys that agree on every hash bit the directory can use end up in one bucket, which cannot split
+  HashFunction<GenericKey<64>> hash_fn;
+  uint32_t mask = (1U << HashTableRootDirectoryPage::MAX_DEPTH) - 1;
+  uint32_t bits = hash_fn.GetHash(Key(0)) & mask;
+  std::vector<int64_t> colliding;
+  for (int64_t i = 0; colliding.size() < 60; i++) {
+    if ((hash_fn.GetHash(Key(i)) & mask) == bits) {
+      colliding.push_back(i);
+    }
+  }
+  size_t inserted = 0;
+  auto InsertAll = [&] {
+    for (; inserted < colliding.size(); inserted++) {
+      ht.Insert(nullptr, Key(colliding[inserted]), RID(colliding[inserted]));
+    }
+  };
+  EXPECT_THROW(InsertAll(), Exception);
+  EXPECT_LT(inserted, colliding.size());
+  EXPECT_EQ(ht.GetGlobalDepth(), HashTableRootDirectoryPage::MAX_DEPTH);
+  ht.VerifyIntegrity();
+  for (size_t i = 0; i < inserted; i++) {
+    res.clear();
+    ASSERT_TRUE(ht.GetValue(nullptr, Key(colliding[i]), &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(100, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // every thread inserts and removes its own keys while splits and merges go on
+  const int threads = 4;
+  const int keys_per_thread = 5000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&ht, t] {
+      std::vector<int> res;
+      for (int i = 0; i < keys_per_thread; i++) {
+        int key = i * threads + t;
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+        res.clear();
+        ht.GetValue(nullptr, key, &res);
+        EXPECT_EQ(res, std::vector<int>{key});
+      }
+      for (int i = 0; i < keys_per_thread; i += 2) {
+        EXPECT_TRUE(ht.Remove(nullptr, i * threads + t, i * threads + t));
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  ht.VerifyIntegrity();
+  std::vector<int> res;
+  for (int key = 0; key < threads * keys_per_thread; key++) {
+    res.clear();
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(res.size(), (key / threads) % 2);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
@@ -18,12 +18,15 @@
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_block_page.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
 #include "storage/page/hash_table_header_page.h"
+#include "storage/page/hash_table_tag_block_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -61,7 +64,7 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -111,4 +114,113 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, TagBlockPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  using TagBlockPage = HashTableTagBlockPage<int, int, IntComparator>;
+  auto block_page = reinterpret_cast<TagBlockPage *>(bpm->NewPage(&block_page_id, nullptr)->GetData());
+  const uint8_t tag = TagBlockPage::Tag(0x1234567890ABCDEF);
+  const uint8_t other_tag = TagBlockPage::Tag(0);
+  ASSERT_NE(tag, other_tag);
+
+  // the slots of the second group get the tag every third slot, and another tag otherwise
+  const size_t group = TagBlockPage::GROUP_SIZE;
+  for (size_t i = group; i < 2 * group - 2; i++) {
+    EXPECT_TRUE(block_page->Insert(i, i, i, i % 3 == 0 ? tag : other_tag));
+  }
+  EXPECT_FALSE(block_page->Insert(group, 0, 0, tag));
+  EXPECT_EQ(group, block_page->KeyAt(group));
+  block_page->Remove(group + 3);
+  EXPECT_TRUE(block_page->IsOccupied(group + 3));
+  EXPECT_FALSE(block_page->IsReadable(group + 3));
+  EXPECT_TRUE(block_page->IsReadable(group + 1));
+
+  uint32_t candidates;
+  uint32_t empty;
+  block_page->MatchGroup(group, tag, &candidates, &empty);
+  uint32_t expected_candidates = 0;
+  for (size_t i = group; i < 2 * group - 2; i++) {
+    if (i % 3 == 0 && i != group + 3) {
+      expected_candidates |= 1U << (i - group);
+    }
+  }
+  EXPECT_EQ(expected_candidates, candidates);
+  EXPECT_EQ(3U << (group - 2), empty);
+
+  // the last group may be cut short by the end of the block
+  size_t last_group = (TagBlockPage::SLOT_COUNT - 1) / group * group;
+  EXPECT_TRUE(block_page->Insert(TagBlockPage::SLOT_COUNT - 1, 7, 7, tag));
+  EXPECT_EQ(7, block_page->ValueAt(TagBlockPage::SLOT_COUNT - 1));
+  block_page->MatchGroup(last_group, tag, &candidates, &empty);
+  EXPECT_EQ(1U << (TagBlockPage::SLOT_COUNT - 1 - last_group), candidates);
+
+  bpm->UnpinPage(block_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, DirectoryPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  auto directory_page =
+      reinterpret_cast<HashTableDirectoryPage *>(bpm->NewPage(&directory_page_id, nullptr)->GetData());
+  directory_page->SetBucketPageId(0, 10);
+  directory_page->SetLocalDepth(0, 0);
+  EXPECT_EQ(directory_page->Size(), 1);
+  EXPECT_FALSE(directory_page->CanShrink());
+
+  // split bucket 10 into 10 and 11, the new slot starts out as a copy
+  directory_page->IncrGlobalDepth();
+  EXPECT_EQ(directory_page->Size(), 2);
+  EXPECT_EQ(directory_page->GetBucketPageId(1), 10);
+  EXPECT_TRUE(directory_page->CanShrink());
+  directory_page->SetBucketPageId(1, 11);
+  directory_page->SetLocalDepth(0, 1);
+  directory_page->SetLocalDepth(1, 1);
+  EXPECT_EQ(directory_page->GetSplitImageIndex(1), 0);
+
+  // split 11 into 11 and 12, 10 is shared by two slots now
+  directory_page->IncrGlobalDepth();
+  directory_page->SetBucketPageId(3, 12);
+  directory_page->SetLocalDepth(1, 2);
+  directory_page->SetLocalDepth(3, 2);
+  EXPECT_EQ(directory_page->GetGlobalDepthMask(), 3);
+  EXPECT_EQ(directory_page->GetLocalDepthMask(2), 1);
+  EXPECT_EQ(directory_page->GetSplitImageIndex(3), 1);
+  EXPECT_FALSE(directory_page->CanShrink());
+  directory_page->VerifyIntegrity();
+
+  // a bucket page reuses the slots of removed pairs
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  uint32_t capacity = 0;
+  while (!bucket_page->IsFull()) {
+    ASSERT_TRUE(bucket_page->Insert(capacity, capacity, IntComparator()));
+    capacity++;
+  }
+  EXPECT_EQ(capacity, 4 * PAGE_SIZE / (4 * sizeof(std::pair<int, int>) + 1));
+  EXPECT_FALSE(bucket_page->Insert(-1, -1, IntComparator()));
+  EXPECT_TRUE(bucket_page->Remove(7, 7, IntComparator()));
+  EXPECT_FALSE(bucket_page->IsReadable(7));
+  EXPECT_TRUE(bucket_page->Insert(-1, -1, IntComparator()));
+  EXPECT_EQ(bucket_page->KeyAt(7), -1);
+  EXPECT_EQ(bucket_page->NumReadable(), capacity);
+
+  bpm->UnpinPage(directory_page_id, true, nullptr);
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
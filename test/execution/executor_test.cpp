@@ -10,9 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <memory>
+#include <random>
 #include <string>
+#include <tuple>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -23,15 +27,18 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/table_generator.h"
 #include "concurrency/transaction_manager.h"
+#include "execution/compiled_expression.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
@@ -109,6 +116,41 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
+  /**
+   * Runs a plan with a new executor and returns its rows read with schema, tuple by tuple with Next() or batch by
+   * batch with NextBatch().
+   */
+  std::vector<std::string> RunExecutor(const AbstractPlanNode *plan, const Schema *schema, bool batched) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), plan);
+    executor->Init();
+    std::vector<std::string> rows;
+    if (batched) {
+      TupleBatch batch(GetExecutorContext()->GetBatchSize());
+      while (executor->NextBatch(&batch)) {
+        EXPECT_EQ(batch.GetSchema(), schema);
+        EXPECT_LE(batch.Size(), batch.GetCapacity());
+        for (uint32_t row : batch.Selection()) {
+          std::string values;
+          for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+            values += batch.Column(i)[row].ToString() + ",";
+          }
+          rows.push_back(values);
+        }
+      }
+    } else {
+      Tuple tuple;
+      RID rid;
+      while (executor->Next(&tuple, &rid)) {
+        std::string values;
+        for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+          values += tuple.GetValue(schema, i).ToString() + ",";
+        }
+        rows.push_back(values);
+      }
+    }
+    return rows;
+  }
+
   const Schema *MakeOutputSchema(const std::vector<std::pair<std::string, const AbstractExpression *>> &exprs) {
     std::vector<Column> cols;
     cols.reserve(exprs.size());
@@ -496,6 +538,95 @@ TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
   ASSERT_EQ(result_set.size(), 1);
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexScanRangeTest) {
+  // an index on test_1.colA, which holds 0 .. TEST1_SIZE - 1
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema key_schema({Column("colA", TypeId::INTEGER)});
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index_colA", "test_1", schema, key_schema, {0}, 8);
+
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto ColA = [out_schema](const Tuple &tuple) {
+    return tuple.GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>();
+  };
+
+  // SELECT colA, colB FROM test_1 WHERE colA >= 100 AND colA < 200
+  std::vector<const AbstractExpression *> lower{MakeConstantValueExpression(ValueFactory::GetIntegerValue(100))};
+  std::vector<const AbstractExpression *> upper{MakeConstantValueExpression(ValueFactory::GetIntegerValue(200))};
+  IndexScanPlanNode between_plan{out_schema, nullptr, index_info->index_oid_, lower, true, upper, false};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&between_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(ColA(result_set[i]), 100 + static_cast<int32_t>(i));
+  }
+
+  // SELECT colA, colB FROM test_1 WHERE colA <= 200 ORDER BY colA DESC
+  IndexScanPlanNode reverse_plan{out_schema, nullptr, index_info->index_oid_, {}, true, upper, true, true};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&reverse_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 201);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(ColA(result_set[i]), 200 - static_cast<int32_t>(i));
+  }
+
+  // SELECT colA, colB FROM test_1 WHERE colA > 100 AND colB < 5, scanned by 4 threads
+  auto *predicate = MakeComparisonExpression(colB, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5)),
+                                             ComparisonType::LessThan);
+  SeqScanPlanNode seq_plan{out_schema, predicate, table_info->oid_};
+  std::vector<Tuple> expected;
+  GetExecutionEngine()->Execute(&seq_plan, &expected, GetTxn(), GetExecutorContext());
+  expected.erase(std::remove_if(expected.begin(), expected.end(), [&](const Tuple &tuple) { return ColA(tuple) <= 100; }),
+                 expected.end());
+  for (bool reverse : {false, true}) {
+    IndexScanPlanNode parallel_plan{out_schema, predicate, index_info->index_oid_, lower, false, {}, true, reverse, 4};
+    result_set.clear();
+    GetExecutionEngine()->Execute(&parallel_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(result_set.size(), expected.size());
+    for (size_t i = 0; i < result_set.size(); i++) {
+      ASSERT_EQ(ColA(result_set[i]), ColA(expected[reverse ? expected.size() - 1 - i : i]));
+    }
+  }
+
+  // SELECT colA, colB FROM test_1 by 2 threads, each with more rows than its queue holds
+  IndexScanPlanNode full_plan{out_schema, nullptr, index_info->index_oid_, {}, true, {}, true, false, 2};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&full_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(ColA(result_set[i]), static_cast<int32_t>(i));
+  }
+
+  // a scan that is dropped before its end stops the workers waiting on a full queue
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &full_plan);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(executor->Next(&tuple, &rid));
+    ASSERT_EQ(ColA(tuple), i);
+  }
+  executor->Init();
+  ASSERT_TRUE(executor->Next(&tuple, &rid));
+  ASSERT_EQ(ColA(tuple), 0);
+  executor.reset();
+
+  // other indexes have no iterator to scan
+  auto *narrow_info = GetExecutorContext()->GetCatalog()->CreateIndex(GetTxn(), "index_colA_narrow", "test_1", schema,
+                                                                      key_schema, {0}, IndexType::B_PLUS_TREE);
+  auto *art_info = GetExecutorContext()->GetCatalog()->CreateIndex(GetTxn(), "index_colA_art", "test_1", schema,
+                                                                   key_schema, {0}, IndexType::ART);
+  for (IndexInfo *other_info : {narrow_info, art_info}) {
+    IndexScanPlanNode other_plan{out_schema, nullptr, other_info->index_oid_};
+    executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &other_plan);
+    EXPECT_THROW(executor->Init(), NotImplementedException);
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   // SELECT count(colA), colB, sum(colC) FROM test_1 Group By colB HAVING count(colA) > 100
@@ -556,4 +687,430 @@ TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchMatchesTupleAtATime) {
+  // SELECT colA, colB FROM test_1 WHERE colA < 500
+  auto *table_1 = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *colA = MakeColumnValueExpression(table_1->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table_1->schema_, 0, "colB");
+  auto *colC = MakeColumnValueExpression(table_1->schema_, 0, "colC");
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)),
+                                             ComparisonType::LessThan);
+  auto *scan_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+  SeqScanPlanNode scan_plan1{scan_schema1, predicate, table_1->oid_};
+  SeqScanPlanNode full_scan_plan1{scan_schema1, nullptr, table_1->oid_};
+
+  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+  auto *table_2 = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *col1 = MakeColumnValueExpression(table_2->schema_, 0, "col1");
+  auto *col3 = MakeColumnValueExpression(table_2->schema_, 0, "col3");
+  auto *scan_schema2 = MakeOutputSchema({{"col1", col1}, {"col3", col3}});
+  SeqScanPlanNode scan_plan2{scan_schema2, nullptr, table_2->oid_};
+  auto *join_colA = MakeColumnValueExpression(*scan_schema1, 0, "colA");
+  auto *join_colB = MakeColumnValueExpression(*scan_schema1, 0, "colB");
+  auto *join_col1 = MakeColumnValueExpression(*scan_schema2, 1, "col1");
+  auto *join_col3 = MakeColumnValueExpression(*scan_schema2, 1, "col3");
+  auto *join_schema =
+      MakeOutputSchema({{"colA", join_colA}, {"colB", join_colB}, {"col1", join_col1}, {"col3", join_col3}});
+  NestedLoopJoinPlanNode join_plan{join_schema,
+                                   {&full_scan_plan1, &scan_plan2},
+                                   MakeComparisonExpression(join_colA, join_col1, ComparisonType::Equal)};
+
+  // SELECT count(colA), colB, sum(colC) FROM test_1 WHERE colA < 500 GROUP BY colB HAVING count(colA) > 40
+  auto *countA = MakeAggregateValueExpression(false, 0);
+  auto *agg_schema =
+      MakeOutputSchema({{"countA", countA}, {"colB", MakeAggregateValueExpression(true, 0)},
+                        {"sumC", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &scan_plan1,
+                               MakeComparisonExpression(countA,
+                                                        MakeConstantValueExpression(ValueFactory::GetIntegerValue(40)),
+                                                        ComparisonType::GreaterThan),
+                               {colB},
+                               {colA, colC},
+                               {AggregationType::CountAggregate, AggregationType::SumAggregate}};
+
+  // batches of a single row, batches that do not divide the tables, and batches larger than them
+  for (size_t batch_size : {static_cast<size_t>(1), static_cast<size_t>(7), DEFAULT_BATCH_SIZE}) {
+    GetExecutorContext()->SetBatchSize(batch_size);
+    // the plans, the schema to read their rows with, and the number of rows if known
+    std::vector<std::tuple<const AbstractPlanNode *, const Schema *, int>> plans{
+        {&scan_plan1, &table_1->schema_, 500}, {&join_plan, join_schema, 100}, {&agg_plan, agg_schema, -1}};
+    for (auto [plan, schema, size] : plans) {
+      auto rows = RunExecutor(plan, schema, false);
+      auto batched_rows = RunExecutor(plan, schema, true);
+      if (size >= 0) {
+        ASSERT_EQ(rows.size(), size);
+      }
+      ASSERT_FALSE(rows.empty());
+      ASSERT_EQ(rows, batched_rows);
+    }
+  }
+}
+
+/*
+ * SELECT colB, count(colA), sum(colC) FROM test_1 WHERE colA < 800 GROUP BY colB, tuple-at-a-time and a batch at a
+ * time. Tuple-at-a-time runs the same executors with batches of one row.
+ */
+TEST_F(ExecutorTest, DISABLED_ScanFilterAggregateBenchmark) {
+  auto *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *colC = MakeColumnValueExpression(schema, 0, "colC");
+  auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(800)),
+                                             ComparisonType::LessThan);
+  auto *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}});
+  SeqScanPlanNode scan_plan{scan_schema, predicate, table_info->oid_};
+  auto *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                       {"countA", MakeAggregateValueExpression(false, 0)},
+                                       {"sumC", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &scan_plan,
+                               nullptr,
+                               {colB},
+                               {colA, colC},
+                               {AggregationType::CountAggregate, AggregationType::SumAggregate}};
+
+  const int runs = 200;
+  std::cout << "batch size | ns per scanned row" << std::endl;
+  for (size_t batch_size : {static_cast<size_t>(1), static_cast<size_t>(64), DEFAULT_BATCH_SIZE}) {
+    GetExecutorContext()->SetBatchSize(batch_size);
+    size_t groups = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+      auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &agg_plan);
+      executor->Init();
+      if (batch_size == 1) {
+        Tuple tuple;
+        RID rid;
+        while (executor->Next(&tuple, &rid)) {
+          groups++;
+        }
+      } else {
+        TupleBatch batch(batch_size);
+        while (executor->NextBatch(&batch)) {
+          groups += batch.SelectedCount();
+        }
+      }
+    }
+    double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(groups, runs * 10);
+    std::cout << batch_size << " | " << nanos / (runs * TEST1_SIZE) << std::endl;
+  }
+}
+
+// the rows of batch that predicate keeps, evaluated as an expression
+static std::vector<uint32_t> InterpretedSelection(const AbstractExpression *predicate, const TupleBatch &batch) {
+  std::vector<Value> result;
+  predicate->EvaluateBatch(batch, batch.Selection(), &result);
+  std::vector<uint32_t> selection;
+  for (uint32_t row : batch.Selection()) {
+    if (result[row].GetAs<bool>()) {
+      selection.push_back(row);
+    }
+  }
+  return selection;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CompiledPredicateMatchesExpression) {
+  GetExecutorContext()->SetBatchSize(TEST1_SIZE);
+  for (const char *table : {"test_1", "test_2"}) {
+    auto *table_info = GetExecutorContext()->GetCatalog()->GetTable(table);
+    auto &schema = table_info->schema_;
+    std::vector<const AbstractExpression *> columns;
+    for (const auto &column : schema.GetColumns()) {
+      columns.push_back(MakeColumnValueExpression(schema, 0, column.GetName()));
+    }
+    SeqScanPlanNode scan_plan{&schema, nullptr, table_info->oid_};
+    SeqScanExecutor scan(GetExecutorContext(), &scan_plan);
+    scan.Init();
+    TupleBatch batch(TEST1_SIZE);
+    ASSERT_TRUE(scan.NextBatch(&batch));
+    const std::vector<uint32_t> all_rows = batch.Selection();
+
+    auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+    auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+    auto *big_const = MakeConstantValueExpression(ValueFactory::GetBigIntValue(700));
+    auto *decimal_const = MakeConstantValueExpression(ValueFactory::GetDecimalValue(49.5));
+    // test_1 has four INTEGER columns, test_2 has SMALLINT, nullable INTEGER, BIGINT and nullable INTEGER ones
+    std::vector<const AbstractExpression *> predicates{
+        MakeComparisonExpression(columns[0], const500, ComparisonType::LessThan),
+        MakeComparisonExpression(const500, columns[0], ComparisonType::LessThanOrEqual),
+        MakeComparisonExpression(columns[1], const5, ComparisonType::Equal),
+        MakeComparisonExpression(columns[1], columns[3], ComparisonType::NotEqual),
+        MakeComparisonExpression(columns[2], big_const, ComparisonType::GreaterThan),
+        MakeComparisonExpression(columns[0], decimal_const, ComparisonType::GreaterThanOrEqual),
+        MakeComparisonExpression(columns[2], columns[3], ComparisonType::GreaterThan),
+        MakeComparisonExpression(MakeComparisonExpression(columns[0], const500, ComparisonType::LessThan),
+                                 MakeComparisonExpression(columns[1], const5, ComparisonType::LessThan),
+                                 ComparisonType::Equal),
+        MakeComparisonExpression(MakeComparisonExpression(columns[0], const500, ComparisonType::LessThan),
+                                 MakeComparisonExpression(columns[1], const5, ComparisonType::LessThan),
+                                 ComparisonType::LessThan),
+        MakeComparisonExpression(MakeComparisonExpression(columns[2], big_const, ComparisonType::GreaterThan),
+                                 MakeConstantValueExpression(ValueFactory::GetBooleanValue(true)),
+                                 ComparisonType::GreaterThanOrEqual)};
+    for (const auto *predicate : predicates) {
+      auto compiled = CompiledExpression::Compile(predicate, &schema);
+      ASSERT_NE(compiled, nullptr);
+      batch.SetSelection(std::vector<uint32_t>(all_rows));
+      auto expected = InterpretedSelection(predicate, batch);
+      compiled->Filter(&batch);
+      ASSERT_EQ(batch.Selection(), expected);
+      // the same rows read from tuple data
+      std::vector<Tuple> tuples;
+      for (uint32_t row : all_rows) {
+        tuples.push_back(batch.RowTuple(row));
+      }
+      std::vector<uint32_t> tuple_selection(all_rows);
+      compiled->FilterTuples(tuples, &tuple_selection);
+      ASSERT_EQ(tuple_selection, expected);
+      // a selection that was filtered before
+      std::vector<uint32_t> odd_rows;
+      for (uint32_t row : all_rows) {
+        if (row % 2 == 1) {
+          odd_rows.push_back(row);
+        }
+      }
+      batch.SetSelection(std::vector<uint32_t>(odd_rows));
+      expected = InterpretedSelection(predicate, batch);
+      compiled->Filter(&batch);
+      ASSERT_EQ(batch.Selection(), expected);
+    }
+  }
+
+  // nulls, which the generated tables do not have: a comparison with a null is null and keeps the row
+  Schema null_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::DECIMAL)});
+  TupleBatch null_batch(8);
+  null_batch.Reset(&null_schema);
+  for (int32_t i = 0; i < 8; i++) {
+    null_batch.AppendRow({i % 3 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i),
+                          i % 4 == 0 ? ValueFactory::GetNullValueByType(TypeId::DECIMAL)
+                                     : ValueFactory::GetDecimalValue(i * 0.5 + 2)},
+                         RID());
+  }
+  auto *a = MakeColumnValueExpression(null_schema, 0, "a");
+  auto *b = MakeColumnValueExpression(null_schema, 0, "b");
+  for (const auto *predicate :
+       {MakeComparisonExpression(a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(4)),
+                                 ComparisonType::GreaterThan),
+        MakeComparisonExpression(a, b, ComparisonType::Equal),
+        MakeComparisonExpression(MakeComparisonExpression(a, b, ComparisonType::LessThan),
+                                 MakeComparisonExpression(b, a, ComparisonType::GreaterThanOrEqual),
+                                 ComparisonType::NotEqual),
+        MakeComparisonExpression(b, MakeConstantValueExpression(ValueFactory::GetNullValueByType(TypeId::INTEGER)),
+                                 ComparisonType::LessThan)}) {
+    auto compiled = CompiledExpression::Compile(predicate, &null_schema);
+    ASSERT_NE(compiled, nullptr);
+    auto expected = InterpretedSelection(predicate, null_batch);
+    TupleBatch filtered = null_batch;
+    compiled->Filter(&filtered);
+    ASSERT_EQ(filtered.Selection(), expected);
+    // a null is stored in a tuple as the null value of its type
+    std::vector<Tuple> tuples;
+    for (uint32_t row : null_batch.Selection()) {
+      tuples.push_back(null_batch.RowTuple(row));
+    }
+    std::vector<uint32_t> tuple_selection(null_batch.Selection());
+    compiled->FilterTuples(tuples, &tuple_selection);
+    ASSERT_EQ(tuple_selection, expected);
+  }
+
+  // a predicate that is not boolean, and a comparison of a boolean with an integer, are left to the expression
+  auto &schema = GetExecutorContext()->GetCatalog()->GetTable("test_1")->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colA_lt_5 =
+      MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5)), ComparisonType::LessThan);
+  EXPECT_EQ(CompiledExpression::Compile(colA, &schema), nullptr);
+  EXPECT_EQ(CompiledExpression::Compile(MakeComparisonExpression(colA_lt_5, colA, ComparisonType::Equal), &schema),
+            nullptr);
+  // the constant is an operand of the comparison kernel rather than a register
+  EXPECT_EQ(CompiledExpression::Compile(colA_lt_5, &schema)->GetStepCount(), 2);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SeqScanPushdownMatchesExpression) {
+  // a table with nulls and deleted tuples, which the generated ones do not have
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::DECIMAL), Column("c", TypeId::BOOLEAN),
+                 Column("d", TypeId::VARCHAR, 16)});
+  auto *table_info = GetExecutorContext()->GetCatalog()->CreateTable(GetTxn(), "pushdown", schema);
+  std::vector<std::pair<RID, Tuple>> live;
+  for (int32_t i = 0; i < 2000; i++) {
+    Tuple tuple({i % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i),
+                 ValueFactory::GetDecimalValue(i % 100 * 0.5),
+                 i % 13 == 0 ? ValueFactory::GetNullValueByType(TypeId::BOOLEAN) : ValueFactory::GetBooleanValue(i % 2 == 0),
+                 ValueFactory::GetVarcharValue(std::to_string(i))},
+                &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+    if (i % 7 == 3) {
+      ASSERT_TRUE(table_info->table_->MarkDelete(rid, GetTxn()));
+    } else {
+      live.emplace_back(rid, tuple);
+    }
+  }
+
+  auto *a = MakeColumnValueExpression(schema, 0, "a");
+  auto *b = MakeColumnValueExpression(schema, 0, "b");
+  auto *c = MakeColumnValueExpression(schema, 0, "c");
+  auto *a_lt_1000 = MakeComparisonExpression(a, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1000)),
+                                             ComparisonType::LessThan);
+  std::vector<const AbstractExpression *> predicates{
+      nullptr, a_lt_1000,
+      MakeComparisonExpression(b, MakeConstantValueExpression(ValueFactory::GetDecimalValue(10)),
+                               ComparisonType::GreaterThanOrEqual),
+      MakeComparisonExpression(c, a_lt_1000, ComparisonType::Equal),
+      // a comparison of strings does not compile and is evaluated on the batch
+      MakeComparisonExpression(MakeColumnValueExpression(schema, 0, "d"),
+                               MakeConstantValueExpression(ValueFactory::GetVarcharValue("1500")),
+                               ComparisonType::GreaterThan)};
+  for (const auto *predicate : predicates) {
+    std::vector<std::string> expected;
+    for (const auto &[rid, tuple] : live) {
+      if (predicate == nullptr || predicate->Evaluate(&tuple, &schema).GetAs<bool>()) {
+        expected.push_back(rid.ToString() + tuple.ToString(&schema));
+      }
+    }
+    for (size_t batch_size : {static_cast<size_t>(1), static_cast<size_t>(100), DEFAULT_BATCH_SIZE}) {
+      SeqScanPlanNode plan{&schema, predicate, table_info->oid_};
+      SeqScanExecutor scan(GetExecutorContext(), &plan);
+      scan.Init();
+      std::vector<std::string> rows;
+      TupleBatch batch(batch_size);
+      while (scan.NextBatch(&batch)) {
+        for (uint32_t row : batch.Selection()) {
+          rows.push_back(batch.GetRid(row).ToString() + batch.RowTuple(row).ToString(&schema));
+        }
+      }
+      ASSERT_EQ(rows, expected);
+    }
+  }
+}
+
+/*
+ * Nanoseconds per table row of SELECT colA, colB FROM t WHERE colA < x at 1%,
+ * 10% and 100% selectivity, over a table of four INTEGER columns: with a
+ * TableIterator that copies out every tuple before the predicate is
+ * evaluated, as the scan did before, and with the scan that evaluates the
+ * compiled predicate inside the table page.
+ */
+TEST_F(ExecutorTest, DISABLED_ScanPushdownBenchmark) {
+  // a buffer pool that holds the whole table, and no locks, which would be the same for both scans
+  DiskManager disk_manager("executor_benchmark.db");
+  BufferPoolManager bpm(1000, &disk_manager);
+  page_id_t header_page_id;
+  bpm.NewPage(&header_page_id);
+  Catalog catalog(&bpm, nullptr, nullptr);
+  Transaction txn(1, IsolationLevel::READ_UNCOMMITTED);
+  ExecutorContext exec_ctx(&txn, &catalog, &bpm, GetTxnManager(), nullptr);
+
+  Schema schema({Column("colA", TypeId::INTEGER), Column("colB", TypeId::INTEGER), Column("colC", TypeId::INTEGER),
+                 Column("colD", TypeId::INTEGER)});
+  auto *table_info = catalog.CreateTable(&txn, "benchmark", schema);
+  const int32_t rows = 100000;
+  std::mt19937 random(15445);
+  for (int32_t i = 0; i < rows; i++) {
+    RID rid;
+    table_info->table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(static_cast<int32_t>(random() % 1000)),
+                                           ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i),
+                                           ValueFactory::GetIntegerValue(i)},
+                                          &schema),
+                                    &rid, &txn);
+  }
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+
+  const int runs = 5;
+  std::cout << "selectivity | iterator ns/row | pushdown ns/row" << std::endl;
+  for (int32_t bound : {10, 100, 1000}) {
+    auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(bound)),
+                                               ComparisonType::LessThan);
+    std::cout << bound / 10 << "%";
+    int64_t expected_sum = 0;
+    for (bool pushdown : {false, true}) {
+      int64_t sum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int run = 0; run < runs; run++) {
+        if (pushdown) {
+          SeqScanPlanNode plan{&schema, predicate, table_info->oid_};
+          SeqScanExecutor scan(&exec_ctx, &plan);
+          scan.Init();
+          TupleBatch batch;
+          while (scan.NextBatch(&batch)) {
+            const std::vector<Value> &column = batch.Column(1);
+            for (uint32_t row : batch.Selection()) {
+              sum += column[row].GetAs<int32_t>();
+            }
+          }
+        } else {
+          for (auto iter = table_info->table_->Begin(&txn); iter != table_info->table_->End(); ++iter) {
+            if (predicate->Evaluate(&*iter, &schema).GetAs<bool>()) {
+              sum += iter->GetValue(&schema, 1).GetAs<int32_t>();
+            }
+          }
+        }
+      }
+      double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      if (!pushdown) {
+        expected_sum = sum;
+      }
+      ASSERT_EQ(sum, expected_sum);
+      std::cout << " | " << nanos / (static_cast<double>(runs) * rows);
+    }
+    std::cout << std::endl;
+  }
+
+  bpm.UnpinPage(header_page_id, true);
+  remove("executor_benchmark.db");
+  remove("executor_benchmark.log");
+}
+
+/*
+ * Rows per microsecond that a predicate colA < x over a batch of INTEGER values
+ * keeps, at several selectivities, evaluated as an expression and as a compiled
+ * program.
+ */
+TEST_F(ExecutorTest, DISABLED_FilterThroughputBenchmark) {
+  Schema schema({Column("colA", TypeId::INTEGER)});
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  TupleBatch batch(DEFAULT_BATCH_SIZE);
+  batch.Reset(&schema);
+  std::mt19937 random(15445);
+  for (size_t i = 0; i < DEFAULT_BATCH_SIZE; i++) {
+    batch.AppendRow({ValueFactory::GetIntegerValue(static_cast<int32_t>(random() % 1000))}, RID());
+  }
+  const std::vector<uint32_t> all_rows = batch.Selection();
+
+  const int runs = 20000;
+  std::cout << "selectivity | expression rows/us | compiled rows/us" << std::endl;
+  for (int32_t bound : {10, 500, 1000}) {
+    auto *predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(bound)),
+                                               ComparisonType::LessThan);
+    auto compiled = CompiledExpression::Compile(predicate, &schema);
+    std::cout << bound / 10 << "%";
+    size_t expected_kept = 0;
+    for (bool use_compiled : {false, true}) {
+      size_t kept = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < runs; i++) {
+        batch.SetSelection(std::vector<uint32_t>(all_rows));
+        if (use_compiled) {
+          compiled->Filter(&batch);
+        } else {
+          batch.SetSelection(InterpretedSelection(predicate, batch));
+        }
+        kept += batch.SelectedCount();
+      }
+      double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+      if (!use_compiled) {
+        expected_kept = kept;
+      }
+      ASSERT_EQ(kept, expected_kept);
+      std::cout << " | " << runs * DEFAULT_BATCH_SIZE / micros;
+    }
+    std::cout << std::endl;
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// filter_kernels_test.cpp
+//
+// Identification: test/execution/filter_kernels_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "execution/filter_kernels.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+const ComparisonType ALL_COMPARISONS[] = {ComparisonType::Equal,       ComparisonType::NotEqual,
+                                          ComparisonType::LessThan,    ComparisonType::LessThanOrEqual,
+                                          ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual};
+const SimdLevel ALL_LEVELS[] = {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2};
+
+template <typename T>
+bool Compare(ComparisonType op, T lhs, T rhs) {
+  switch (op) {
+    case ComparisonType::Equal:
+      return lhs == rhs;
+    case ComparisonType::NotEqual:
+      return lhs != rhs;
+    case ComparisonType::LessThan:
+      return lhs < rhs;
+    case ComparisonType::LessThanOrEqual:
+      return lhs <= rhs;
+    case ComparisonType::GreaterThan:
+      return lhs > rhs;
+    case ComparisonType::GreaterThanOrEqual:
+      return lhs >= rhs;
+  }
+  return false;
+}
+
+// checks every kernel of T against the C++ operators, over values drawn from a few of them so that they repeat
+template <typename T>
+void CheckKernels(const std::vector<T> &domain) {
+  std::mt19937 random(15445);
+  for (size_t n : {0, 1, 3, 31, 64, 65, 127, 1000}) {
+    std::vector<T> lhs(n);
+    std::vector<T> rhs(n);
+    for (size_t i = 0; i < n; i++) {
+      lhs[i] = domain[random() % domain.size()];
+      rhs[i] = domain[random() % domain.size()];
+    }
+    T constant = domain[random() % domain.size()];
+    for (auto op : ALL_COMPARISONS) {
+      for (auto level : ALL_LEVELS) {
+        FilterKernel<T> kernel = GetFilterKernel<T>(op, level);
+        for (bool with_constant : {false, true}) {
+          // stale bits in the bitmap are overwritten
+          std::vector<uint64_t> bitmap((n + 63) / 64, ~uint64_t{0});
+          kernel(lhs.data(), with_constant ? nullptr : rhs.data(), constant, n, bitmap.data());
+          for (size_t i = 0; i < bitmap.size() * 64; i++) {
+            bool expected = i < n && Compare(op, lhs[i], with_constant ? constant : rhs[i]);
+            ASSERT_EQ((bitmap[i / 64] >> (i % 64)) & 1, uint64_t{expected})
+                << "n " << n << " op " << static_cast<int>(op) << " level " << static_cast<int>(level) << " row " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(FilterKernelsTest, MatchesScalarComparisons) {
+  CheckKernels<int8_t>({std::numeric_limits<int8_t>::min(), -1, 0, 1, 7, std::numeric_limits<int8_t>::max()});
+  CheckKernels<int16_t>({std::numeric_limits<int16_t>::min(), -300, 0, 1, 300, std::numeric_limits<int16_t>::max()});
+  CheckKernels<int32_t>({std::numeric_limits<int32_t>::min(), -70000, 0, 1, 70000,
+                         std::numeric_limits<int32_t>::max()});
+  CheckKernels<int64_t>({std::numeric_limits<int64_t>::min(), -(int64_t{1} << 40), 0, 1, int64_t{1} << 40,
+                         std::numeric_limits<int64_t>::max()});
+  CheckKernels<double>({std::numeric_limits<double>::lowest(), -0.5, 0.0, -0.0, 1.5,
+                        std::numeric_limits<double>::infinity(), std::nan("")});
+}
+
+// NOLINTNEXTLINE
+TEST(FilterKernelsTest, LevelAboveCpuFallsBack) {
+  // asking for more than the CPU has gets the best it has, which is the same kernel
+  SimdLevel level = DetectSimdLevel();
+  EXPECT_EQ(GetFilterKernel<int32_t>(ComparisonType::LessThan, SimdLevel::AVX2),
+            GetFilterKernel<int32_t>(ComparisonType::LessThan, level));
+  EXPECT_EQ(GetFilterKernel<int32_t>(ComparisonType::LessThan), GetFilterKernel<int32_t>(ComparisonType::LessThan, level));
+}
+
+/*
+ * Values per nanosecond that colA < x over an array of INTEGER values
+ * compares, at several selectivities, for every instruction set.
+ */
+TEST(FilterKernelsTest, DISABLED_KernelThroughputBenchmark) {
+  const size_t n = 1024;
+  std::vector<int32_t> values(n);
+  std::mt19937 random(15445);
+  for (auto &value : values) {
+    value = static_cast<int32_t>(random() % 1000);
+  }
+  std::vector<uint64_t> bitmap(n / 64);
+
+  const int runs = 200000;
+  std::cout << "selectivity | scalar values/ns | sse4.2 values/ns | avx2 values/ns" << std::endl;
+  for (int32_t bound : {10, 500, 1000}) {
+    std::cout << bound / 10 << "%";
+    for (auto level : ALL_LEVELS) {
+      FilterKernel<int32_t> kernel = GetFilterKernel<int32_t>(ComparisonType::LessThan, level);
+      size_t kept = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < runs; i++) {
+        kernel(values.data(), nullptr, bound, n, bitmap.data());
+        kept += __builtin_popcountll(bitmap[i % bitmap.size()]);
+      }
+      double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      EXPECT_GT(kept, 0);
+      std::cout << " | " << runs * n / nanos;
+    }
+    std::cout << std::endl;
+  }
+}
+
+}  // namespace bustub
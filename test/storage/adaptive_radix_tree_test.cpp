@@ -0,0 +1,179 @@
+/**
+ * adaptive_radix_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/art_index.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// fixed-width big-endian keys, so that no key is a prefix of another one
+static std::string ArtKey(uint64_t key) {
+  std::string encoded;
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    encoded.push_back(static_cast<char>((key >> shift) & 0xFF));
+  }
+  return encoded;
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, InsertRemoveTest) {
+  AdaptiveRadixTree<RID> tree;
+  std::mt19937 rng(15445);
+  std::map<std::string, RID> expected;
+
+  // dense keys fill nodes up to 256 children, sparse ones leave long prefixes
+  std::vector<std::string> keys;
+  for (uint64_t i = 0; i < 5000; i++) {
+    keys.push_back(ArtKey(i));
+    keys.push_back(ArtKey(rng()) + std::string(20, 'x') + ArtKey(i));
+  }
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (size_t i = 0; i < keys.size(); i++) {
+    RID rid(static_cast<page_id_t>(i), static_cast<uint32_t>(i));
+    ASSERT_TRUE(tree.Insert(keys[i], rid));
+    expected[keys[i]] = rid;
+  }
+  EXPECT_FALSE(tree.Insert(keys[0], RID()));
+
+  RID rid;
+  for (const auto &entry : expected) {
+    ASSERT_TRUE(tree.GetValue(entry.first, &rid));
+    EXPECT_EQ(rid, entry.second);
+  }
+  EXPECT_FALSE(tree.GetValue(ArtKey(5000), &rid));
+
+  // nodes shrink and collapse as their children go away
+  for (size_t i = 0; i < keys.size(); i += 3) {
+    ASSERT_TRUE(tree.Remove(keys[i]));
+    expected.erase(keys[i]);
+  }
+  EXPECT_FALSE(tree.Remove(keys[0]));
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(tree.GetValue(keys[i], &rid), i % 3 != 0);
+  }
+
+  // a prefix scan returns the values in key order
+  std::vector<RID> result;
+  tree.ScanPrefix(std::string(6, '\0'), &result);
+  std::vector<RID> scanned;
+  for (auto iter = expected.begin(); iter != expected.end() && iter->first.compare(0, 6, std::string(6, '\0')) == 0;
+       ++iter) {
+    scanned.push_back(iter->second);
+  }
+  EXPECT_EQ(result, scanned);
+  result.clear();
+  tree.ScanPrefix("", &result);
+  EXPECT_EQ(result.size(), expected.size());
+
+  for (const auto &entry : expected) {
+    ASSERT_TRUE(tree.Remove(entry.first));
+  }
+  result.clear();
+  tree.ScanPrefix("", &result);
+  EXPECT_TRUE(result.empty());
+}
+
+// NOLINTNEXTLINE
+TEST(AdaptiveRadixTreeTest, ConcurrentTest) {
+  AdaptiveRadixTree<RID> tree;
+  const uint64_t keys_per_thread = 5000;
+  const int threads = 4;
+  // every thread inserts and removes its own keys while looking up the keys of the others
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; t++) {
+    workers.emplace_back([&tree, t] {
+      RID rid;
+      for (uint64_t i = 0; i < keys_per_thread; i++) {
+        uint64_t key = i * threads + t;
+        EXPECT_TRUE(tree.Insert(ArtKey(key), RID(t, i)));
+        tree.GetValue(ArtKey(key ^ 1), &rid);
+        if (i % 2 == 0) {
+          EXPECT_TRUE(tree.Remove(ArtKey(key)));
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  RID rid;
+  for (uint64_t key = 0; key < keys_per_thread * threads; key++) {
+    uint64_t i = key / threads;
+    ASSERT_EQ(tree.GetValue(ArtKey(key), &rid), i % 2 == 1);
+    if (i % 2 == 1) {
+      EXPECT_EQ(rid, RID(key % threads, i));
+    }
+  }
+}
+
+/*
+ * Point lookup latency of ArtIndex against BPlusTreeIndex on the same bigint
+ * keys.
+ */
+TEST(AdaptiveRadixTreeTest, DISABLED_PointLookupBenchmark) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(10000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // the indexes own their metadata
+  ArtIndex art_index(new IndexMetadata("art", "foo", schema, {0}));
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> tree_index(new IndexMetadata("tree", "foo", schema, {0}),
+                                                                      bpm);
+
+  const int64_t rows = 1000000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < rows; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (int64_t key : keys) {
+    Tuple tuple({ValueFactory::GetBigIntValue(key)}, schema);
+    art_index.InsertEntry(tuple, RID(key >> 16, key & 0xFFFF), nullptr);
+    tree_index.InsertEntry(tuple, RID(key >> 16, key & 0xFFFF), nullptr);
+  }
+
+  std::vector<Tuple> probes;
+  for (int64_t i = 0; i < rows; i++) {
+    probes.emplace_back(std::vector<Value>{ValueFactory::GetBigIntValue(keys[(i * 7919) % rows])}, schema);
+  }
+  std::cout << "index | ns/lookup" << std::endl;
+  for (Index *index : std::vector<Index *>{&art_index, &tree_index}) {
+    std::vector<RID> result;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &probe : probes) {
+      result.clear();
+      index->ScanKey(probe, &result, nullptr);
+      EXPECT_EQ(result.size(), 1);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << index->GetName() << " | "
+              << std::chrono::duration<double, std::nano>(end - start).count() / probes.size() << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,166 @@
+/**
+ * b_plus_tree_buffered_index_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/buffered_b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using BufferedIndex = BufferedBPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
+
+// the (key, rid) entries of key, in rid order
+static std::vector<int64_t> Entries(const std::set<std::pair<int64_t, int64_t>> &entries, int64_t key) {
+  std::vector<int64_t> rids;
+  for (auto iter = entries.lower_bound({key, INT64_MIN}); iter != entries.end() && iter->first == key; ++iter) {
+    rids.push_back(iter->second);
+  }
+  return rids;
+}
+
+static std::vector<int64_t> Sorted(const std::vector<RID> &rids) {
+  std::vector<int64_t> sorted;
+  for (const auto &rid : rids) {
+    sorted.push_back(rid.Get());
+  }
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
+TEST(BPlusTreeTests, BufferedIndexTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto *index = new BufferedIndex(new IndexMetadata("foo_idx", "foo", key_schema, {0}), bpm, 64, false);
+  auto Key = [key_schema](int64_t key) { return Tuple({ValueFactory::GetBigIntValue(key)}, key_schema); };
+
+  // an insert and a delete of the same entry cancel out in the buffer
+  index->InsertEntry(Key(7), RID(1, 7), nullptr);
+  EXPECT_EQ(index->GetBufferedCount(), 1);
+  index->DeleteEntry(Key(7), RID(1, 7), nullptr);
+  EXPECT_EQ(index->GetBufferedCount(), 0);
+
+  // random inserts and deletes of 200 keys with several rids each, checked against a model on the way
+  std::set<std::pair<int64_t, int64_t>> entries;
+  std::mt19937 generator(15445);
+  std::vector<RID> result;
+  for (int i = 0; i < 5000; i++) {
+    int64_t key = generator() % 200;
+    if (generator() % 3 != 0 || entries.empty()) {
+      RID rid(1, i);
+      index->InsertEntry(Key(key), rid, nullptr);
+      entries.insert({key, rid.Get()});
+    } else {
+      auto victim = entries.lower_bound({key, INT64_MIN});
+      if (victim == entries.end()) {
+        victim = entries.begin();
+      }
+      RID rid(victim->second);
+      index->DeleteEntry(Key(victim->first), rid, nullptr);
+      entries.erase(victim);
+    }
+    if (i % 50 == 0) {
+      int64_t probe = generator() % 200;
+      result.clear();
+      index->ScanKey(Key(probe), &result, nullptr);
+      EXPECT_EQ(Sorted(result), Entries(entries, probe));
+    }
+  }
+  // keys that only exist in the buffer
+  for (int64_t key = 200; key < 210; key++) {
+    index->InsertEntry(Key(key), RID(2, key), nullptr);
+    entries.insert({key, RID(2, key).Get()});
+  }
+  EXPECT_GT(index->GetBufferedCount(), 0);
+  IndexKeyRange<GenericKey<8>> range;
+  GenericKey<8> bound;
+  bound.SetFromInteger(200);
+  range.SetLower(bound, true);
+  EXPECT_EQ(index->EstimateRangeCount(range), 10);
+
+  std::vector<Tuple> keys;
+  for (int64_t key = 0; key < 210; key++) {
+    keys.push_back(Key(key));
+  }
+  std::vector<std::vector<RID>> results;
+  index->ScanKeys(keys, &results, nullptr);
+  for (int64_t key = 0; key < 210; key++) {
+    EXPECT_EQ(Sorted(results[key]), Entries(entries, key));
+  }
+
+  // a scan sees everything, since it flushes the buffer first
+  std::set<std::pair<int64_t, int64_t>> scanned;
+  for (auto iterator = index->GetBeginIterator(); iterator != index->GetEndIterator(); ++iterator) {
+    scanned.insert({(*iterator).first.ToString(), (*iterator).second.Get()});
+  }
+  EXPECT_EQ(index->GetBufferedCount(), 0);
+  EXPECT_EQ(scanned, entries);
+
+  delete index;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Random inserts into an index that is much larger than the buffer pool,
+ * with and without the message buffer.
+ */
+TEST(BPlusTreeTests, DISABLED_BufferedInsertBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 200000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  std::cout << "index | ms | page writes" << std::endl;
+  for (bool buffered : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    auto *metadata = new IndexMetadata("foo_idx", "foo", key_schema, {0});
+    Index *index = buffered ? new BufferedIndex(metadata, bpm)
+                            : new BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(metadata, bpm);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      index->InsertEntry(Tuple({ValueFactory::GetBigIntValue(key)}, key_schema), RID(key), nullptr);
+    }
+    if (buffered) {
+      static_cast<BufferedIndex *>(index)->Flush();
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << (buffered ? "buffered" : "b+ tree") << " | "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " | "
+              << disk_manager->GetNumWrites() << std::endl;
+
+    delete index;
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+}  // namespace bustub
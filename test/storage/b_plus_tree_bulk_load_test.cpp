@@ -0,0 +1,232 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sort.h"
+
+namespace bustub {
+
+using Sorter = ExternalMergeSort<GenericKey<8>, RID, GenericComparator<8>>;
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static const int LEAF_CAPACITY = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+static const int INTERNAL_CAPACITY = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, int>);
+
+static void AddKeys(Sorter *sorter, const std::vector<int64_t> &keys) {
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    sorter->Add(index_key, RID(key));
+  }
+}
+
+// every key can be found and a full scan returns exactly the expected keys in order
+static void CheckTree(Tree *tree, std::vector<int64_t> keys) {
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree->GetValue(index_key, &rids));
+    EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>(key));
+  }
+  if (keys.empty()) {
+    EXPECT_TRUE(tree->IsEmpty());
+    return;
+  }
+  size_t i = 0;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    ASSERT_LT(i, keys.size());
+    EXPECT_EQ((*iterator).first.ToString(), keys[i++]);
+  }
+  EXPECT_EQ(i, keys.size());
+}
+
+TEST(BPlusTreeBulkLoadTest, ExternalSortTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 5000; key++) {
+    keys.push_back(key * 7 % 5000 - 2500);
+  }
+
+  for (size_t memory_limit : {Sorter::DEFAULT_MEMORY_LIMIT, sizeof(std::pair<GenericKey<8>, RID>) * 300}) {
+    Sorter sorter(comparator, memory_limit);
+    AddKeys(&sorter, keys);
+    sorter.Finish();
+    EXPECT_EQ(sorter.GetRunCount(), memory_limit == Sorter::DEFAULT_MEMORY_LIMIT ? 0 : 17);
+    GenericKey<8> key;
+    RID rid;
+    int64_t expected = -2500;
+    while (sorter.Next(&key, &rid)) {
+      EXPECT_EQ(key.ToString(), expected);
+      EXPECT_EQ(rid.GetSlotNum(), static_cast<uint32_t>(expected));
+      expected++;
+    }
+    EXPECT_EQ(expected, 2500);
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  std::mt19937 rng(15445);
+  for (double fill_factor : {0.0, 0.5, 0.9, 1.0}) {
+    for (int count : {0, 1, 2, 3, 4, 5, 9, 17, 100, 1000}) {
+      // small pages for deep trees and underfull last pages, default pages for a two level tree
+      for (auto sizes : {std::make_pair(3, 3), std::make_pair(4, 5), std::make_pair(7, 4),
+                         std::make_pair(LEAF_CAPACITY, INTERNAL_CAPACITY)}) {
+        Tree tree("foo_pk", bpm, comparator, sizes.first, sizes.second);
+        std::vector<int64_t> keys;
+        for (int i = 0; i < count; i++) {
+          // a few duplicates, bulk loading keeps the first one
+          keys.push_back(static_cast<int64_t>(rng() % (count + count / 10 + 1)));
+        }
+        Sorter sorter(comparator, sizeof(std::pair<GenericKey<8>, RID>) * 64);
+        AddKeys(&sorter, keys);
+        ASSERT_TRUE(tree.BulkLoad(&sorter, fill_factor));
+        CheckTree(&tree, keys);
+
+        // only an empty tree can be bulk loaded
+        Sorter again(comparator);
+        AddKeys(&again, {1, 2, 3});
+        EXPECT_EQ(tree.BulkLoad(&again, fill_factor), count == 0);
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, ModifyAfterBulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  for (double fill_factor : {0.5, 1.0}) {
+    Tree tree("foo_pk", bpm, comparator, 4, 5);
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 2000; key += 2) {
+      keys.push_back(key);
+    }
+    Sorter sorter(comparator);
+    AddKeys(&sorter, keys);
+    ASSERT_TRUE(tree.BulkLoad(&sorter, fill_factor));
+
+    // the loaded pages split and merge like any other
+    GenericKey<8> index_key;
+    std::vector<int64_t> odd_keys;
+    for (int64_t key = 1; key < 2000; key += 2) {
+      odd_keys.push_back(key);
+    }
+    std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(15445));
+    for (auto key : odd_keys) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(key)));
+    }
+    keys.insert(keys.end(), odd_keys.begin(), odd_keys.end());
+    CheckTree(&tree, keys);
+
+    std::vector<int64_t> remaining;
+    for (auto key : keys) {
+      if (key % 3 == 0) {
+        remaining.push_back(key);
+        continue;
+      }
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    CheckTree(&tree, remaining);
+    for (auto key : remaining) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Index build time and size, one insert per key against a bulk load.
+ */
+TEST(BPlusTreeBulkLoadTest, DISABLED_BulkLoadBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 200000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (int round = 0; round < 2; round++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(2000, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    Tree tree("foo_pk", bpm, comparator);
+
+    auto start = std::chrono::steady_clock::now();
+    if (round == 0) {
+      GenericKey<8> index_key;
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(key));
+      }
+    } else {
+      // small memory limit, so that the sort spills runs
+      Sorter sorter(comparator, 1 << 20);
+      AddKeys(&sorter, keys);
+      tree.BulkLoad(&sorter, 1.0);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // page ids are handed out in order, so the next one tells how many pages the tree took
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, false);
+    std::cout << (round == 0 ? "insert" : "bulk load") << " | ms "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " | pages " << page_id - 1
+              << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+  }
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -2,9 +2,12 @@
  * b_plus_tree_test.cpp
  */
 
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <iostream>
+#include <random>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
@@ -92,7 +95,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -145,7 +148,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -243,7 +246,7 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -287,7 +290,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -333,4 +336,428 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, SplitMergeTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // tiny pages, so that most inserts and deletes restart on the pessimistic path
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  GenericKey<8> index_key;
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  }
+
+  // remove every key but the multiples of 3
+  std::vector<int64_t> remove_keys;
+  for (auto key : keys) {
+    if (key % 3 != 0) {
+      remove_keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+
+  int64_t current_key = 3;
+  index_key.SetFromInteger(current_key);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 3;
+  }
+  EXPECT_EQ(current_key, 2001);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, CompactionDuringSplitMergeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // leaves only merge once empty, the background compaction re-packs them while the writers run
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5, true, 0.0);
+  GenericKey<8> index_key;
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  tree.StartCompaction(std::chrono::milliseconds(1));
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+  std::vector<int64_t> remove_keys;
+  for (auto key : keys) {
+    if (key % 3 != 0) {
+      remove_keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+  tree.StopCompaction();
+  tree.Compact();
+
+  int64_t current_key = 3;
+  index_key.SetFromInteger(current_key);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 3;
+  }
+  EXPECT_EQ(current_key, 2001);
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), key % 3 == 0);
+  }
+
+  // stopping does not wait out the interval, and a tree that goes away stops its thread
+  tree.StartCompaction(std::chrono::hours(1));
+  auto start = std::chrono::steady_clock::now();
+  tree.StopCompaction();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+  tree.StartCompaction(std::chrono::hours(1));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, LookupDuringSplitTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // tiny pages, so that the writers keep splitting the pages the readers walk through
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // even keys exist before the readers start, odd keys are inserted concurrently
+  std::vector<int64_t> even_keys;
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 0; key < 2000; key++) {
+    (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+  }
+  InsertHelper(&tree, even_keys);
+  std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(15445));
+
+  auto worker = [&](uint64_t thread_itr) {
+    if (thread_itr < 2) {
+      InsertHelperSplit(&tree, odd_keys, 2, thread_itr);
+      return;
+    }
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (int round = 0; round < 3; round++) {
+      for (auto key : even_keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids));
+        EXPECT_EQ(rids.size(), 1);
+      }
+    }
+  };
+  LaunchParallelTest(4, worker);
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 2000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, BatchLookupTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5, false);
+
+  // multiples of 3 are in the tree, every 30th with a posting list of 10 values
+  std::vector<std::vector<RID>> expected(1000);
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 1000; key += 3) {
+    index_key.SetFromInteger(key);
+    for (int i = 0; i < (key % 30 == 0 ? 10 : 1); i++) {
+      tree.Insert(index_key, RID(static_cast<int32_t>(key), i));
+      expected[key].emplace_back(static_cast<int32_t>(key), i);
+    }
+  }
+
+  // unsorted probes with repeats and misses, in batches of every size
+  std::mt19937 rng(15445);
+  for (size_t batch : {0, 1, 2, 7, 100, 1000}) {
+    std::vector<GenericKey<8>> keys(batch);
+    std::vector<int64_t> probes(batch);
+    for (size_t i = 0; i < batch; i++) {
+      probes[i] = static_cast<int64_t>(rng() % 1000);
+      keys[i].SetFromInteger(probes[i]);
+    }
+    std::vector<std::vector<RID>> results;
+    tree.GetValues(keys, &results);
+    ASSERT_EQ(results.size(), batch);
+    for (size_t i = 0; i < batch; i++) {
+      std::sort(results[i].begin(), results[i].end(),
+                [](const RID &a, const RID &b) { return a.GetSlotNum() < b.GetSlotNum(); });
+      EXPECT_EQ(results[i], expected[probes[i]]);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, BatchLookupDuringSplitMergeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // tiny pages, so that the writers keep changing the pages the kept paths point at
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // even keys stay in the tree, odd keys are inserted and removed again concurrently
+  std::vector<int64_t> even_keys;
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 0; key < 2000; key++) {
+    (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+  }
+  InsertHelper(&tree, even_keys);
+  std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(15445));
+
+  auto worker = [&](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    if (thread_itr == 0) {
+      for (int round = 0; round < 3; round++) {
+        InsertHelper(&tree, odd_keys);
+        for (auto key : odd_keys) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+      }
+      return;
+    }
+    std::mt19937 rng(thread_itr);
+    std::vector<GenericKey<8>> keys(64);
+    std::vector<int64_t> probes(64);
+    std::vector<std::vector<RID>> results;
+    for (int round = 0; round < 200; round++) {
+      for (size_t i = 0; i < keys.size(); i++) {
+        probes[i] = even_keys[rng() % even_keys.size()];
+        keys[i].SetFromInteger(probes[i]);
+      }
+      tree.GetValues(keys, &results);
+      for (size_t i = 0; i < keys.size(); i++) {
+        ASSERT_EQ(results[i].size(), 1);
+        EXPECT_EQ(results[i][0].GetSlotNum(), probes[i]);
+      }
+    }
+  };
+  LaunchParallelTest(3, worker);
+
+  std::vector<GenericKey<8>> keys(2000);
+  for (int64_t key = 0; key < 2000; key++) {
+    keys[key].SetFromInteger(key);
+  }
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(keys, &results);
+  for (int64_t key = 0; key < 2000; key++) {
+    EXPECT_EQ(results[key].size(), key % 2 == 0 ? 1 : 0);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Insert throughput with a growing number of writer threads.
+ */
+TEST(BPlusTreeConcurrentTest, DISABLED_InsertBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 100000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  std::cout << "threads | inserts/s" << std::endl;
+  for (int threads : {1, 2, 4, 8}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(threads, InsertHelperSplit, &tree, keys, threads);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << threads << " | " << keys.size() / seconds << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+/*
+ * Point lookup throughput with a growing number of reader threads.
+ */
+TEST(BPlusTreeConcurrentTest, DISABLED_LookupBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 100000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  InsertHelper(&tree, keys);
+
+  const int lookups_per_thread = 200000;
+  std::cout << "threads | lookups/s" << std::endl;
+  for (int threads : {1, 2, 4, 8}) {
+    auto lookup = [&](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int i = 0; i < lookups_per_thread; i++) {
+        rids.clear();
+        index_key.SetFromInteger(keys[(i * 7 + thread_itr * 13) % keys.size()]);
+        tree.GetValue(index_key, &rids);
+        EXPECT_EQ(rids.size(), 1);
+      }
+    };
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(threads, lookup);
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::cout << threads << " | " << threads * lookups_per_thread / seconds << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Batched lookups against one GetValue() per key, for probe batches that are
+ * dense or sparse in the key space.
+ */
+TEST(BPlusTreeConcurrentTest, DISABLED_BatchLookupBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  InsertHelper(&tree, keys);
+
+  const int lookups = 1000000;
+  std::mt19937 rng(15445);
+  std::cout << "batch | key spread | one by one lookups/s | batched lookups/s" << std::endl;
+  for (size_t batch : {16, 128, 1024}) {
+    for (int64_t spread : {1000, 1000000}) {
+      std::vector<GenericKey<8>> probes(batch);
+      std::vector<std::vector<RID>> results;
+      std::vector<RID> rids;
+      double seconds[2];
+      for (int round = 0; round < 2; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int done = 0; done < lookups; done += batch) {
+          int64_t base = static_cast<int64_t>(rng() % (1000000 - spread + 1));
+          for (auto &probe : probes) {
+            probe.SetFromInteger(base + 1 + static_cast<int64_t>(rng() % spread));
+          }
+          if (round == 0) {
+            for (const auto &probe : probes) {
+              rids.clear();
+              tree.GetValue(probe, &rids);
+            }
+          } else {
+            tree.GetValues(probes, &results);
+          }
+        }
+        seconds[round] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      std::cout << batch << " | " << spread << " | " << lookups / seconds[0] << " | " << lookups / seconds[1]
+                << std::endl;
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -3,7 +3,10 @@
  */
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <random>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
@@ -172,4 +175,130 @@ TEST(BPlusTreeTests, DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, LazyMergeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // sequential inserts leave every leaf exactly half full
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> eager("eager", bpm, comparator, 8, 8);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> lazy("lazy", bpm, comparator, 8, 8, true, 0.25);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> sparse("sparse", bpm, comparator, 8, 8, true, 0.0);
+  GenericKey<8> index_key;
+  RID rid;
+  for (auto *tree : {&eager, &lazy, &sparse}) {
+    for (int64_t key = 1; key <= 400; key++) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree->Insert(index_key, rid);
+    }
+  }
+
+  // deleting from a half full leaf and inserting the key back merges and splits again, unless merges are lazy
+  BPlusTreeStats eager_before = eager.GetStats();
+  BPlusTreeStats lazy_before = lazy.GetStats();
+  for (int64_t key = 10; key <= 400; key += 40) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    for (auto *tree : {&eager, &lazy}) {
+      tree->Remove(index_key);
+      tree->Insert(index_key, rid);
+    }
+  }
+  // the parents are half full as well, so some of the merges and splits go up a level
+  EXPECT_GE(eager.GetStats().merges_, eager_before.merges_ + 10);
+  EXPECT_GE(eager.GetStats().splits_, eager_before.splits_ + 10);
+  EXPECT_EQ(lazy.GetStats().merges_, lazy_before.merges_);
+  EXPECT_EQ(lazy.GetStats().splits_, lazy_before.splits_);
+
+  // with a threshold of 0 only empty leaves merge, compaction re-packs the rest
+  for (int64_t key = 1; key <= 400; key++) {
+    if (key % 4 != 0) {
+      index_key.SetFromInteger(key);
+      sparse.Remove(index_key);
+    }
+  }
+  EXPECT_EQ(sparse.GetStats().merges_, 0);
+  EXPECT_EQ(sparse.GetStats().redistributions_, 0);
+  size_t merged = sparse.Compact();
+  EXPECT_GT(merged, 0);
+  EXPECT_EQ(sparse.GetStats().compactions_, merged);
+
+  int64_t current_key = 4;
+  for (auto iterator = sparse.begin(); iterator != sparse.end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 4;
+  }
+  EXPECT_EQ(current_key, 404);
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 400; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(sparse.GetValue(index_key, &rids), key % 4 == 0);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Structure modifications of a workload that keeps deleting and inserting
+ * keys of half full leaves, for several merge thresholds.
+ */
+TEST(BPlusTreeTests, DISABLED_MergeThresholdBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t key_count = 100000;
+  std::vector<int64_t> keys(50000);
+  std::mt19937 generator(15445);
+  std::uniform_int_distribution<int64_t> distribution(1, key_count);
+  for (auto &key : keys) {
+    key = distribution(generator);
+  }
+
+  std::cout << "merge threshold | splits | merges | redistributions | ms" << std::endl;
+  for (double threshold : {0.5, 0.25, 0.0}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 128, 128, true, threshold);
+    GenericKey<8> index_key;
+    RID rid;
+    for (int64_t key = 1; key <= key_count; key++) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, rid);
+    }
+
+    BPlusTreeStats before = tree.GetStats();
+    auto start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      rid.Set(0, key);
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+      tree.Insert(index_key, rid);
+    }
+    auto end = std::chrono::steady_clock::now();
+    BPlusTreeStats after = tree.GetStats();
+    std::cout << threshold << " | " << after.splits_ - before.splits_ << " | " << after.merges_ - before.merges_
+              << " | " << after.redistributions_ - before.redistributions_ << " | "
+              << std::chrono::duration<double, std::milli>(end - start).count() << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
 }  // namespace bustub
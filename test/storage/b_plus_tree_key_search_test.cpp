@@ -0,0 +1,160 @@
+/**
+ * b_plus_tree_key_search_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_key_search.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+static const int LEAF_CAPACITY = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+static const int INTERNAL_CAPACITY = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, int>);
+
+// the search before binary search: first index with key >= target
+static int LinearKeyIndex(LeafPage *leaf, const GenericKey<8> &key, const GenericComparator<8> &comparator) {
+  for (int i = 0; i < leaf->GetSize(); ++i) {
+    if (comparator(leaf->KeyAt(i), key) >= 0) {
+      return i;
+    }
+  }
+  return leaf->GetSize();
+}
+
+static void FillLeaf(LeafPage *leaf, int max_size, const std::vector<int64_t> &keys,
+                     const GenericComparator<8> &comparator) {
+  leaf->Init(1, INVALID_PAGE_ID, max_size);
+  leaf->SetSize(0);
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    leaf->Insert(index_key, RID(key), comparator);
+  }
+}
+
+static void CheckLeafSearch(const char *create_stmt) {
+  Schema *key_schema = ParseCreateStatement(create_stmt);
+  GenericComparator<8> comparator(key_schema);
+  std::vector<char> buffer(PAGE_SIZE, 0);
+  auto *leaf = reinterpret_cast<LeafPage *>(buffer.data());
+
+  std::mt19937 rng(15445);
+  for (int size : {0, 1, 2, 3, 7, 16, 17, 33, 100, LEAF_CAPACITY - 1}) {
+    std::vector<int64_t> keys;
+    for (int i = 0; i < size; i++) {
+      keys.push_back(static_cast<int64_t>(rng() % 1000) - 500);
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    std::shuffle(keys.begin(), keys.end(), rng);
+    FillLeaf(leaf, LEAF_CAPACITY, keys, comparator);
+    ASSERT_EQ(leaf->GetSize(), static_cast<int>(keys.size()));
+    for (int i = 1; i < leaf->GetSize(); i++) {
+      EXPECT_LT(comparator(leaf->KeyAt(i - 1), leaf->KeyAt(i)), 0);
+    }
+
+    GenericKey<8> index_key;
+    for (int64_t probe = -510; probe <= 510; probe++) {
+      index_key.SetFromInteger(probe);
+      EXPECT_EQ(leaf->KeyIndex(index_key, comparator), LinearKeyIndex(leaf, index_key, comparator));
+      RID rid;
+      bool found = leaf->Lookup(index_key, &rid, comparator);
+      EXPECT_EQ(found, std::find(keys.begin(), keys.end(), probe) != keys.end());
+      if (found) {
+        EXPECT_EQ(rid.GetSlotNum(), static_cast<uint32_t>(probe));
+      }
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeKeySearchTest, LeafSearchTest) {
+  // single bigint key, uses the SIMD specialization
+  CheckLeafSearch("a bigint");
+  // two int columns in the same 8 bytes, uses the branchless binary search
+  CheckLeafSearch("a integer,b integer");
+}
+
+TEST(BPlusTreeKeySearchTest, InternalLookupTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<char> buffer(PAGE_SIZE, 0);
+  auto *internal = reinterpret_cast<InternalPage *>(buffer.data());
+  internal->Init(1, INVALID_PAGE_ID, INTERNAL_CAPACITY);
+
+  // children 100, 101, ... separated by keys 10, 20, 30, ...
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(10);
+  internal->PopulateNewRoot(100, index_key, 101);
+  for (int i = 2; i < 50; i++) {
+    index_key.SetFromInteger(i * 10);
+    internal->InsertNodeAfter(100 + i - 1, index_key, 100 + i);
+  }
+  ASSERT_EQ(internal->GetSize(), 50);
+  for (int64_t probe = -5; probe < 520; probe++) {
+    index_key.SetFromInteger(probe);
+    page_id_t expected = 100 + static_cast<page_id_t>(std::min<int64_t>(std::max<int64_t>(probe / 10, 0), 49));
+    if (probe < 0) {
+      expected = 100;
+    }
+    EXPECT_EQ(internal->Lookup(index_key, comparator), expected);
+  }
+  delete key_schema;
+}
+
+/*
+ * Lookup cost per page size.
+ */
+TEST(BPlusTreeKeySearchTest, DISABLED_LookupBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  std::vector<char> buffer(PAGE_SIZE, 0);
+  auto *leaf = reinterpret_cast<LeafPage *>(buffer.data());
+  std::mt19937 rng(15445);
+  const int lookups = 100000;
+
+  std::cout << "page size | linear ns/lookup | binary ns/lookup" << std::endl;
+  for (int size : {8, 16, 32, 64, 128, LEAF_CAPACITY - 1}) {
+    std::vector<int64_t> keys;
+    for (int i = 0; i < size; i++) {
+      keys.push_back(i * 2);
+    }
+    FillLeaf(leaf, LEAF_CAPACITY, keys, comparator);
+    std::vector<GenericKey<8>> probes(1024);
+    for (auto &probe : probes) {
+      probe.SetFromInteger(static_cast<int64_t>(rng() % (2 * size)));
+    }
+
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+      checksum += LinearKeyIndex(leaf, probes[i & 1023], comparator);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+      checksum -= leaf->KeyIndex(probes[i & 1023], comparator);
+    }
+    auto end = std::chrono::steady_clock::now();
+    EXPECT_EQ(checksum, 0);
+
+    double linear_ns = std::chrono::duration<double, std::nano>(mid - start).count() / lookups;
+    double binary_ns = std::chrono::duration<double, std::nano>(end - mid).count() / lookups;
+    std::cout << size << " | " << linear_ns << " | " << binary_ns << std::endl;
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,251 @@
+/**
+ * b_plus_tree_posting_list_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static const int LEAF_CAPACITY = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+static const int INTERNAL_CAPACITY = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, int>);
+
+static std::vector<int64_t> SortedRids(std::vector<RID> rids) {
+  std::vector<int64_t> result;
+  for (const auto &rid : rids) {
+    result.push_back(rid.Get());
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// point lookups and a full scan both return exactly the expected (key, rid) pairs
+static void CheckTree(Tree *tree, const std::map<int64_t, std::vector<RID>> &expected) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  size_t pairs = 0;
+  for (const auto &entry : expected) {
+    rids.clear();
+    index_key.SetFromInteger(entry.first);
+    EXPECT_EQ(tree->GetValue(index_key, &rids), !entry.second.empty());
+    EXPECT_EQ(SortedRids(rids), SortedRids(entry.second));
+    pairs += entry.second.size();
+  }
+  if (pairs == 0) {
+    EXPECT_TRUE(tree->IsEmpty());
+    return;
+  }
+
+  std::map<int64_t, std::vector<RID>> scanned;
+  int64_t last_key = INT64_MIN;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    int64_t key = (*iterator).first.ToString();
+    EXPECT_LE(last_key, key);
+    last_key = key;
+    scanned[key].push_back((*iterator).second);
+  }
+  for (const auto &entry : expected) {
+    EXPECT_EQ(SortedRids(scanned[entry.first]), SortedRids(entry.second));
+  }
+}
+
+TEST(BPlusTreePostingListTest, DuplicateInsertTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5, false);
+
+  // key k gets (k % 4) * 300 + 1 values, so some lists span several posting pages
+  std::map<int64_t, std::vector<RID>> expected;
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (int64_t key = 0; key < 40; key++) {
+    for (int i = 0; i < (key % 4) * 300 + 1; i++) {
+      pairs.emplace_back(key, RID(static_cast<page_id_t>(key), i));
+    }
+  }
+  std::shuffle(pairs.begin(), pairs.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (const auto &pair : pairs) {
+    index_key.SetFromInteger(pair.first);
+    EXPECT_TRUE(tree.Insert(index_key, pair.second));
+    expected[pair.first].push_back(pair.second);
+  }
+  // the same pair is refused while the key has a single value
+  index_key.SetFromInteger(0);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, 0)));
+  CheckTree(&tree, expected);
+
+  // a range scan that starts in the middle of the duplicates of a key
+  index_key.SetFromInteger(3);
+  size_t count = 0;
+  for (auto iterator = tree.Begin(index_key); iterator != tree.end() && (*iterator).first.ToString() == 3;
+       ++iterator) {
+    count++;
+  }
+  EXPECT_EQ(count, 901);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreePostingListTest, DuplicateRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5, false);
+
+  std::map<int64_t, std::vector<RID>> expected;
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (int64_t key = 0; key < 30; key++) {
+    for (int i = 0; i < (key % 3) * 600 + 1; i++) {
+      pairs.emplace_back(key, RID(static_cast<page_id_t>(key), i));
+    }
+  }
+  GenericKey<8> index_key;
+  for (const auto &pair : pairs) {
+    index_key.SetFromInteger(pair.first);
+    tree.Insert(index_key, pair.second);
+    expected[pair.first].push_back(pair.second);
+  }
+
+  // values that are not there
+  index_key.SetFromInteger(1);
+  EXPECT_FALSE(tree.Remove(index_key, RID(1, 100000)));
+  index_key.SetFromInteger(0);
+  EXPECT_FALSE(tree.Remove(index_key, RID(0, 1)));
+
+  // drop half of the pairs in random order, lists shrink, lose pages and turn back into inline values
+  std::mt19937 rng(15445);
+  std::shuffle(pairs.begin(), pairs.end(), rng);
+  for (size_t i = 0; i < pairs.size() / 2; i++) {
+    index_key.SetFromInteger(pairs[i].first);
+    EXPECT_TRUE(tree.Remove(index_key, pairs[i].second));
+    auto &rids = expected[pairs[i].first];
+    rids.erase(std::find(rids.begin(), rids.end(), pairs[i].second));
+  }
+  CheckTree(&tree, expected);
+
+  // the rest goes key by key: a key with a posting list is removed as a whole
+  for (int64_t key = 0; key < 30; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+    expected[key].clear();
+  }
+  CheckTree(&tree, expected);
+  for (size_t i = pairs.size() / 2; i < pairs.size(); i++) {
+    index_key.SetFromInteger(pairs[i].first);
+    EXPECT_EQ(tree.Remove(index_key, pairs[i].second), pairs[i].first % 2 == 1);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreePostingListTest, BulkLoadDuplicatesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5, false);
+
+  std::map<int64_t, std::vector<RID>> expected;
+  ExternalMergeSort<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator);
+  GenericKey<8> index_key;
+  for (int i = 0; i < 5000; i++) {
+    int64_t key = i % 7 == 0 ? i : i % 5;
+    RID rid(i, 0);
+    index_key.SetFromInteger(key);
+    sorter.Add(index_key, rid);
+    expected[key].push_back(rid);
+  }
+  ASSERT_TRUE(tree.BulkLoad(&sorter));
+  CheckTree(&tree, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Index size for a column with few distinct values: posting lists against one
+ * entry per duplicate, which is a unique index on (key, rid).
+ */
+TEST(BPlusTreePostingListTest, DISABLED_FootprintBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  Schema *pair_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> pair_comparator(pair_schema);
+  const int rows = 100000;
+
+  std::cout << "distinct keys | posting list pages | one entry per duplicate pages" << std::endl;
+  for (int distinct : {10, 100, 1000, 10000, 50000}) {
+    page_id_t pages[2];
+    for (int round = 0; round < 2; round++) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+      page_id_t page_id;
+      bpm->NewPage(&page_id);
+      Tree posting_tree("foo_pk", bpm, comparator, LEAF_CAPACITY, INTERNAL_CAPACITY, false);
+      BPlusTree<GenericKey<16>, RID, GenericComparator<16>> pair_tree("foo_pk", bpm, pair_comparator);
+      GenericKey<8> index_key;
+      GenericKey<16> pair_key;
+      for (int i = 0; i < rows; i++) {
+        RID rid(i / 100, i % 100);
+        if (round == 0) {
+          index_key.SetFromInteger(i % distinct);
+          posting_tree.Insert(index_key, rid);
+        } else {
+          int64_t values[2] = {i % distinct, rid.Get()};
+          memcpy(pair_key.data_, values, sizeof(values));
+          pair_tree.Insert(pair_key, rid);
+        }
+      }
+      // page ids are handed out in order, so the next one tells how many pages the tree took
+      bpm->NewPage(&page_id);
+      bpm->UnpinPage(page_id, false);
+      pages[round] = page_id - 1;
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+    }
+    std::cout << distinct << " | " << pages[0] << " | " << pages[1] << std::endl;
+  }
+  delete pair_schema;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
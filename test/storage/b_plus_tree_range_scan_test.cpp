@@ -0,0 +1,460 @@
+/**
+ * b_plus_tree_range_scan_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+static std::vector<int64_t> Scan(Tree *tree, const IndexKeyRange<GenericKey<8>> &range, bool reverse) {
+  std::vector<int64_t> keys;
+  for (auto iterator = tree->Begin(range, reverse); iterator != tree->end(); ++iterator) {
+    keys.push_back((*iterator).first.ToString());
+  }
+  return keys;
+}
+
+// the keys of expected in [lower, upper], in descending order if reverse is set
+static std::vector<int64_t> Expected(const std::set<int64_t> &expected, const IndexKeyRange<GenericKey<8>> &range,
+                                     bool reverse) {
+  std::vector<int64_t> keys;
+  for (auto key : expected) {
+    if (range.has_lower_) {
+      int64_t lower = range.lower_.ToString();
+      if (key < lower || (key == lower && !range.lower_inclusive_)) {
+        continue;
+      }
+    }
+    if (range.has_upper_) {
+      int64_t upper = range.upper_.ToString();
+      if (key > upper || (key == upper && !range.upper_inclusive_)) {
+        continue;
+      }
+    }
+    keys.push_back(key);
+  }
+  if (reverse) {
+    std::reverse(keys.begin(), keys.end());
+  }
+  return keys;
+}
+
+static void CheckRanges(Tree *tree, const std::set<int64_t> &expected, std::mt19937 *rng) {
+  GenericKey<8> index_key;
+  for (int i = 0; i < 300; i++) {
+    IndexKeyRange<GenericKey<8>> range;
+    int64_t lower = static_cast<int64_t>((*rng)() % 1100) - 50;
+    int64_t upper = lower + static_cast<int64_t>((*rng)() % 200) - 20;
+    if ((*rng)() % 4 != 0) {
+      index_key.SetFromInteger(lower);
+      range.SetLower(index_key, (*rng)() % 2 == 0);
+    }
+    if ((*rng)() % 4 != 0) {
+      index_key.SetFromInteger(upper);
+      range.SetUpper(index_key, (*rng)() % 2 == 0);
+    }
+    for (bool reverse : {false, true}) {
+      EXPECT_EQ(Scan(tree, range, reverse), Expected(expected, range, reverse));
+    }
+  }
+}
+
+TEST(BPlusTreeRangeScanTest, BoundedScanTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  // small pages, so that ranges span many leaves and the prev links go through splits and merges
+  Tree tree("foo_pk", bpm, comparator, 4, 5);
+
+  // even keys only, so that odd bounds fall between keys
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 1000; key += 2) {
+    keys.push_back(key);
+  }
+  std::mt19937 rng(15445);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::set<int64_t> expected;
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+    expected.insert(key);
+  }
+  CheckRanges(&tree, expected, &rng);
+
+  // merged and redistributed leaves keep both links right
+  for (size_t i = 0; i < keys.size() * 2 / 3; i++) {
+    index_key.SetFromInteger(keys[i]);
+    tree.Remove(index_key);
+    expected.erase(keys[i]);
+  }
+  CheckRanges(&tree, expected, &rng);
+
+  // a stopped iterator lets go of its pages, so a range that ends right away pins nothing
+  IndexKeyRange<GenericKey<8>> range;
+  index_key.SetFromInteger(-1);
+  range.SetUpper(index_key, true);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(tree.Begin(range) == tree.end());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeScanTest, ReverseScanDuplicatesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5, false);
+
+  // key k has k % 5 + 1 values, so that some keys have posting lists
+  GenericKey<8> index_key;
+  size_t pairs = 0;
+  for (int64_t key = 0; key < 200; key++) {
+    index_key.SetFromInteger(key);
+    for (int i = 0; i <= key % 5; i++) {
+      tree.Insert(index_key, RID(static_cast<page_id_t>(key), i));
+      pairs++;
+    }
+  }
+
+  IndexKeyRange<GenericKey<8>> range;
+  std::vector<int64_t> scanned = Scan(&tree, range, true);
+  EXPECT_EQ(scanned.size(), pairs);
+  EXPECT_TRUE(std::is_sorted(scanned.rbegin(), scanned.rend()));
+
+  // every value of both bounds, none beyond
+  index_key.SetFromInteger(50);
+  range.SetLower(index_key, true);
+  index_key.SetFromInteger(54);
+  range.SetUpper(index_key, true);
+  scanned = Scan(&tree, range, true);
+  EXPECT_EQ(scanned.size(), 15);
+  EXPECT_EQ(scanned.front(), 54);
+  EXPECT_EQ(scanned.back(), 50);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeScanTest, StalePrevLinkTest) {
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5);
+
+  GenericKey<8> index_key;
+  std::set<int64_t> expected;
+  for (int64_t key = 0; key < 100; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+    expected.insert(key);
+  }
+
+  // the state between a split of the leaf left of the one of key 50 and the update of its prev link: the link still
+  // points at the leaf left of the new one
+  index_key.SetFromInteger(50);
+  Page *page = tree.FindLeafPage(index_key, Operation::SEARCH);
+  LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t new_page_id = leaf->GetPrevPageId();
+  page->RUnlatch();
+  Page *new_page = bpm->FetchPage(new_page_id);
+  page_id_t stale_page_id = reinterpret_cast<LeafPage *>(new_page->GetData())->GetPrevPageId();
+  ASSERT_NE(stale_page_id, INVALID_PAGE_ID);
+  leaf->SetPrevPageId(stale_page_id);
+  bpm->UnpinPage(new_page_id, false);
+  bpm->UnpinPage(page->GetPageId(), true);
+
+  // the reverse scan does not trust the link, and does not skip the keys of the new leaf
+  IndexKeyRange<GenericKey<8>> range;
+  EXPECT_EQ(Scan(&tree, range, true), Expected(expected, range, true));
+  index_key.SetFromInteger(60);
+  range.SetUpper(index_key, false);
+  EXPECT_EQ(Scan(&tree, range, true), Expected(expected, range, true));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeScanTest, PartitionRangeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 4, 5);
+
+  // a root leaf has no separators to cut at
+  std::set<int64_t> expected;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 3; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+    expected.insert(key);
+  }
+  IndexKeyRange<GenericKey<8>> range;
+  EXPECT_EQ(tree.PartitionRange(range, 4).size(), 1);
+
+  for (int64_t key = 0; key < 2000; key++) {
+    index_key.SetFromInteger(key * 7 % 2000);
+    tree.Insert(index_key, RID(key * 7 % 2000));
+    expected.insert(key * 7 % 2000);
+  }
+  // the partitions follow each other without gaps or overlap, in key order
+  std::mt19937 rng(15445);
+  for (int i = 0; i < 50; i++) {
+    range = IndexKeyRange<GenericKey<8>>();
+    int64_t lower = static_cast<int64_t>(rng() % 2100) - 50;
+    if (i % 3 != 0) {
+      index_key.SetFromInteger(lower);
+      range.SetLower(index_key, i % 2 == 0);
+    }
+    if (i % 5 != 0) {
+      index_key.SetFromInteger(lower + static_cast<int64_t>(rng() % 1000));
+      range.SetUpper(index_key, i % 2 == 1);
+    }
+    for (int parts : {1, 2, 3, 8, 64}) {
+      auto partitions = tree.PartitionRange(range, parts);
+      EXPECT_LE(partitions.size(), parts);
+      std::vector<int64_t> scanned;
+      for (const auto &partition : partitions) {
+        std::vector<int64_t> keys = Scan(&tree, partition, false);
+        scanned.insert(scanned.end(), keys.begin(), keys.end());
+      }
+      EXPECT_EQ(scanned, Expected(expected, range, false));
+    }
+  }
+  // a large range gets as many partitions as asked for
+  EXPECT_EQ(tree.PartitionRange(IndexKeyRange<GenericKey<8>>(), 64).size(), 64);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeScanTest, EstimateRangeCountTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator, 32, 32);
+
+  IndexKeyRange<GenericKey<8>> range;
+  EXPECT_EQ(tree.EstimateRangeCount(range), 0);
+
+  // a range within the root leaf is counted exactly
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < 20; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+  index_key.SetFromInteger(4);
+  range.SetLower(index_key, false);
+  index_key.SetFromInteger(12);
+  range.SetUpper(index_key, true);
+  EXPECT_EQ(tree.EstimateRangeCount(range), 4);
+  EXPECT_EQ(tree.EstimateRangeCount(IndexKeyRange<GenericKey<8>>()), 10);
+
+  std::vector<int64_t> keys(20000);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::mt19937 rng(15445);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+  std::set<int64_t> expected(keys.begin(), keys.end());
+  size_t total = tree.EstimateRangeCount(IndexKeyRange<GenericKey<8>>());
+  EXPECT_NEAR(static_cast<double>(total), 20000.0, 20000 * 0.25);
+
+  // the estimates follow the actual counts: the pages are half to fully occupied, so a single estimate can be off by
+  // a good part, but not on average
+  double error = 0;
+  double actual_sum = 0;
+  for (int i = 0; i < 200; i++) {
+    range = IndexKeyRange<GenericKey<8>>();
+    int64_t lower = static_cast<int64_t>(rng() % 20000);
+    index_key.SetFromInteger(lower);
+    range.SetLower(index_key, i % 2 == 0);
+    index_key.SetFromInteger(lower + static_cast<int64_t>(rng() % (i % 4 == 0 ? 100 : 10000)));
+    range.SetUpper(index_key, i % 3 == 0);
+    auto actual = static_cast<double>(Expected(expected, range, false).size());
+    auto estimate = static_cast<double>(tree.EstimateRangeCount(range));
+    EXPECT_NEAR(estimate, actual, actual * 0.5 + 64);
+    error += std::abs(estimate - actual);
+    actual_sum += actual;
+  }
+  EXPECT_LT(error / actual_sum, 0.15);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * BETWEEN and ORDER BY DESC LIMIT on a bounded or reverse iterator, against
+ * what an unbounded forward scan has to do for them: run from the lower bound,
+ * or from the first key, to the end.
+ */
+TEST(BPlusTreeRangeScanTest, DISABLED_RangeScanBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator);
+  const int64_t count = 200000;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < count; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+
+  const int queries = 50;
+  std::mt19937 rng(15445);
+  auto end = tree.end();
+  std::cout << "query | unbounded forward ms | bounded/reverse ms" << std::endl;
+  for (int round = 0; round < 2; round++) {
+    double ms[2];
+    for (int bounded = 0; bounded < 2; bounded++) {
+      int64_t checksum = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int query = 0; query < queries; query++) {
+        int64_t lower = static_cast<int64_t>(rng() % (count - 100));
+        IndexKeyRange<GenericKey<8>> range;
+        if (round == 0) {
+          // WHERE a BETWEEN lower AND lower + 99
+          index_key.SetFromInteger(lower);
+          range.SetLower(index_key, true);
+          if (bounded == 1) {
+            index_key.SetFromInteger(lower + 99);
+            range.SetUpper(index_key, true);
+          }
+          for (auto iterator = tree.Begin(range); iterator != end; ++iterator) {
+            int64_t key = (*iterator).first.ToString();
+            checksum += key <= lower + 99 ? key : 0;
+          }
+        } else {
+          // ORDER BY a DESC LIMIT 10
+          std::vector<int64_t> top;
+          auto iterator = tree.Begin(range, bounded == 1);
+          for (; iterator != end && (bounded == 0 || top.size() < 10); ++iterator) {
+            top.push_back((*iterator).first.ToString());
+          }
+          checksum += bounded == 0 ? top[top.size() - 10] : top.back();
+        }
+      }
+      ms[bounded] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      EXPECT_NE(checksum, 0);
+    }
+    std::cout << (round == 0 ? "BETWEEN, 100 keys" : "DESC LIMIT 10") << " | " << ms[0] << " | " << ms[1]
+              << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+/*
+ * Full range scan throughput with the range partitioned over a growing number
+ * of threads.
+ */
+TEST(BPlusTreeRangeScanTest, DISABLED_ParallelScanBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(4000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  Tree tree("foo_pk", bpm, comparator);
+  const int64_t count = 1000000;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < count; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+
+  std::cout << "threads | partitions | keys/s" << std::endl;
+  for (int threads : {1, 2, 4, 8}) {
+    auto start = std::chrono::steady_clock::now();
+    auto partitions = tree.PartitionRange(IndexKeyRange<GenericKey<8>>(), threads);
+    std::vector<int64_t> scanned(partitions.size());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < partitions.size(); i++) {
+      workers.emplace_back([&, i] {
+        auto end = tree.end();
+        for (auto iterator = tree.Begin(partitions[i]); iterator != end; ++iterator) {
+          scanned[i]++;
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(std::accumulate(scanned.begin(), scanned.end(), int64_t{0}), count);
+    std::cout << threads << " | " << partitions.size() << " | " << count / seconds << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
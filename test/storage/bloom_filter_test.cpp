@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/storage/bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/index/bloom_filter.h"
+#include "storage/index/linear_probe_hash_table_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, BlockedFilterTest) {
+  const size_t keys = 100000;
+  BlockedBloomFilter filter(keys);
+  EXPECT_EQ(filter.GetBlockCount(), keys * BLOOM_FILTER_BITS_PER_KEY / 256 + 1);
+
+  std::mt19937_64 random(15445);
+  std::vector<uint64_t> hashes(keys);
+  for (auto &hash : hashes) {
+    hash = random();
+    filter.Insert(hash);
+  }
+  for (auto hash : hashes) {
+    ASSERT_TRUE(filter.MayContain(hash));
+  }
+  // about 0.5% false positives at 12 bits per key
+  size_t false_positives = 0;
+  for (size_t i = 0; i < keys; i++) {
+    false_positives += static_cast<size_t>(filter.MayContain(random()));
+  }
+  EXPECT_LT(false_positives, keys / 50);
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, IndexFilterTest) {
+  auto disk_manager = new DiskManager("bloom_filter_test.db");
+  auto bpm = new BufferPoolManager(50, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  Transaction txn(0);
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(&txn, "potato", schema);
+  const int rows = 4000;
+  std::vector<RID> rids;
+  for (int i = 0; i < rows; i++) {
+    RID rid;
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(i)}, &schema), &rid, &txn));
+    rids.push_back(rid);
+  }
+  auto *index_info = catalog->CreateIndex(&txn, "potato_a", "potato", schema, schema, {0}, IndexType::B_PLUS_TREE);
+  Index *index = index_info->index_.get();
+  EXPECT_EQ(index->GetBloomFilter(), nullptr);
+  catalog->EnableBloomFilter(index_info);
+  IndexBloomFilter *filter = index->GetBloomFilter();
+  ASSERT_NE(filter, nullptr);
+  EXPECT_EQ(filter->GetBuildCount(), 1);
+
+  // hits and misses in one batch, the misses stop at the filter
+  std::vector<Tuple> keys;
+  for (int i = 0; i < 2 * rows; i += 7) {
+    keys.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(i)}, &schema);
+  }
+  std::vector<std::vector<RID>> results;
+  index->ScanKeys(keys, &results, &txn);
+  ASSERT_EQ(results.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    int key = static_cast<int>(i) * 7;
+    EXPECT_EQ(results[i], key < rows ? std::vector<RID>{rids[key]} : std::vector<RID>{});
+  }
+  size_t ruled_out = 0;
+  for (int i = rows; i < 2 * rows; i++) {
+    ruled_out += static_cast<size_t>(!filter->MayContain(Tuple({ValueFactory::GetIntegerValue(i)}, &schema)));
+  }
+  EXPECT_GT(ruled_out, rows * 9 / 10);
+
+  // an entry added after the filter was built
+  Tuple new_key({ValueFactory::GetIntegerValue(2 * rows)}, &schema);
+  index->InsertEntry(new_key, RID(100, 1), &txn);
+  std::vector<RID> result;
+  index->ScanKey(new_key, &result, &txn);
+  EXPECT_EQ(result, std::vector<RID>{RID(100, 1)});
+
+  // deleting most of the table makes the filter stale, it is built again without the deleted keys
+  for (int i = 0; i < rows; i++) {
+    if (i % 4 != 0) {
+      ASSERT_TRUE(table_metadata->table_->MarkDelete(rids[i], &txn));
+      index->DeleteEntry(Tuple({ValueFactory::GetIntegerValue(i)}, &schema), rids[i], &txn);
+    }
+  }
+  // the rebuild runs in the background, the deletes did not wait for it
+  filter->WaitForRebuild();
+  EXPECT_GT(filter->GetBuildCount(), 1);
+  ruled_out = 0;
+  for (int i = 0; i < rows; i++) {
+    Tuple key({ValueFactory::GetIntegerValue(i)}, &schema);
+    result.clear();
+    index->ScanKey(key, &result, &txn);
+    if (i % 4 == 0) {
+      ASSERT_EQ(result, std::vector<RID>{rids[i]});
+    } else {
+      ASSERT_TRUE(result.empty());
+      ruled_out += static_cast<size_t>(!filter->MayContain(key));
+    }
+  }
+  EXPECT_GT(ruled_out, rows / 2);
+
+  delete catalog;
+  bpm->UnpinPage(header_page_id, true);
+  delete bpm;
+  delete disk_manager;
+  remove("bloom_filter_test.db");
+  remove("bloom_filter_test.log");
+}
+
+/*
+ * Latency of lookups of missing and of existing keys in a B+ tree and a
+ * linear probe hash table index, with and without a Bloom filter.
+ */
+TEST(BloomFilterTest, DISABLED_MissLatencyBenchmark) {
+  auto *disk_manager = new DiskManager("bloom_filter_test.db");
+  auto *bpm = new BufferPoolManager(5000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  std::vector<Column> columns;
+  columns.emplace_back("a", TypeId::BIGINT);
+  Schema schema(columns);
+
+  const int64_t rows = 100000;
+  std::vector<Tuple> keys;
+  for (int64_t key = 0; key < 2 * rows; key++) {
+    keys.emplace_back(std::vector<Value>{ValueFactory::GetBigIntValue(key)}, &schema);
+  }
+  auto refill = [&keys](const std::function<void(const Tuple &)> &add) {
+    for (int64_t key = 0; key < rows; key++) {
+      add(keys[key]);
+    }
+  };
+
+  std::cout << "index | filter | hit ns | miss ns" << std::endl;
+  for (bool hash : {false, true}) {
+    for (bool filter : {false, true}) {
+      // the indexes own their metadata
+      auto *metadata = new IndexMetadata(hash ? "hash" : "tree", "foo", &schema, {0});
+      std::unique_ptr<Index> index;
+      if (hash) {
+        index = std::make_unique<LinearProbeHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>>(
+            metadata, bpm, 1000, HashFunction<GenericKey<8>>());
+      } else {
+        index = std::make_unique<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(metadata, bpm);
+      }
+      if (filter) {
+        index->EnableBloomFilter(refill);
+      }
+      for (int64_t i = 0; i < rows; i++) {
+        index->InsertEntry(keys[i], RID(i >> 16, i & 0xFFFF), nullptr);
+      }
+
+      std::cout << index->GetName() << " | " << filter;
+      for (bool hit : {true, false}) {
+        const int64_t lookups = 1000000;
+        std::vector<RID> result;
+        auto start = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < lookups; i++) {
+          result.clear();
+          index->ScanKey(keys[(i * 7919) % rows + (hit ? 0 : rows)], &result, nullptr);
+        }
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << " | " << nanos / lookups;
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("bloom_filter_test.db");
+  remove("bloom_filter_test.log");
+}
+
+}  // namespace bustub
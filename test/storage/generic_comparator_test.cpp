@@ -0,0 +1,266 @@
+/**
+ * generic_comparator_test.cpp
+ */
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/*
+ * Reference comparator that materializes every column as a Value, the way
+ * GenericComparator used to work.
+ */
+template <size_t KeySize>
+class ValueComparator {
+ public:
+  explicit ValueComparator(Schema *key_schema) : key_schema_(key_schema) {}
+
+  int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    for (uint32_t i = 0; i < key_schema_->GetColumnCount(); i++) {
+      Value lhs_value = lhs.ToValue(key_schema_, i);
+      Value rhs_value = rhs.ToValue(key_schema_, i);
+      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+        return -1;
+      }
+      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  Schema *key_schema_;
+};
+
+// build a key tuple from values and load it into a generic key
+template <size_t KeySize>
+static GenericKey<KeySize> MakeKey(const std::vector<Value> &values, Schema *key_schema) {
+  Tuple tuple(values, key_schema);
+  GenericKey<KeySize> key;
+  key.SetFromKey(tuple);
+  return key;
+}
+
+TEST(GenericComparatorTest, MatchesValueComparisonTest) {
+  Schema *key_schema = ParseCreateStatement("a tinyint,b smallint,c integer,d bigint");
+  GenericComparator<16> comparator(key_schema);
+  ValueComparator<16> reference(key_schema);
+  EXPECT_FALSE(comparator.IsInt64Key());
+
+  std::mt19937 rng(15445);
+  std::vector<GenericKey<16>> keys;
+  for (int i = 0; i < 200; i++) {
+    // small domains so that prefixes collide and later columns decide the order
+    std::vector<Value> values{ValueFactory::GetTinyIntValue(static_cast<int8_t>(rng() % 3 - 1)),
+                              ValueFactory::GetSmallIntValue(static_cast<int16_t>(rng() % 3 - 1)),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 5) - 2),
+                              ValueFactory::GetBigIntValue(static_cast<int64_t>(rng() % 1000000) - 500000)};
+    keys.push_back(MakeKey<16>(values, key_schema));
+  }
+  for (const auto &lhs : keys) {
+    for (const auto &rhs : keys) {
+      EXPECT_EQ(comparator(lhs, rhs), reference(lhs, rhs));
+    }
+  }
+  delete key_schema;
+}
+
+TEST(GenericComparatorTest, VarcharTest) {
+  Schema *key_schema = ParseCreateStatement("a integer,b varchar(16)");
+  GenericComparator<32> comparator(key_schema);
+  ValueComparator<32> reference(key_schema);
+  std::vector<std::string> samples{"", "a", "ab", "abc", "abd", "b", "ba", "zzzzzzzz"};
+  std::vector<GenericKey<32>> keys;
+  for (int32_t prefix : {-1, 0, 1}) {
+    for (const auto &str : samples) {
+      keys.push_back(MakeKey<32>({ValueFactory::GetIntegerValue(prefix), ValueFactory::GetVarcharValue(str)}, key_schema));
+    }
+  }
+  for (const auto &lhs : keys) {
+    for (const auto &rhs : keys) {
+      EXPECT_EQ(comparator(lhs, rhs), reference(lhs, rhs));
+    }
+  }
+  delete key_schema;
+}
+
+TEST(GenericComparatorTest, DecimalAndBigintTest) {
+  Schema *key_schema = ParseCreateStatement("a double");
+  GenericComparator<8> comparator(key_schema);
+  ValueComparator<8> reference(key_schema);
+  std::vector<double> samples{-1e9, -2.5, -0.0, 0.0, 1.0 / 3, 7.25, 1e12};
+  for (double l : samples) {
+    for (double r : samples) {
+      auto lhs = MakeKey<8>({ValueFactory::GetDecimalValue(l)}, key_schema);
+      auto rhs = MakeKey<8>({ValueFactory::GetDecimalValue(r)}, key_schema);
+      EXPECT_EQ(comparator(lhs, rhs), reference(lhs, rhs));
+    }
+  }
+  delete key_schema;
+
+  key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> bigint_comparator(key_schema);
+  EXPECT_TRUE(bigint_comparator.IsInt64Key());
+  GenericKey<8> lhs;
+  GenericKey<8> rhs;
+  lhs.SetFromInteger(-7);
+  rhs.SetFromInteger(3);
+  EXPECT_EQ(bigint_comparator(lhs, rhs), -1);
+  EXPECT_EQ(bigint_comparator(rhs, lhs), 1);
+  EXPECT_EQ(bigint_comparator(lhs, lhs), 0);
+  delete key_schema;
+}
+
+TEST(GenericComparatorTest, ManyColumnsTest) {
+  // one byte per column, more columns than fit into a 16 byte key
+  std::string statement;
+  for (int i = 0; i < 24; i++) {
+    statement += (i == 0 ? "" : ",") + std::string("c") + std::to_string(i) + (i % 2 == 0 ? " tinyint" : " boolean");
+  }
+  Schema *key_schema = ParseCreateStatement(statement);
+  GenericComparator<32> comparator(key_schema);
+  ValueComparator<32> reference(key_schema);
+
+  std::vector<GenericKey<32>> keys;
+  for (int last = 0; last < 24; last++) {
+    // keys that only differ in column last
+    std::vector<Value> values;
+    for (int i = 0; i < 24; i++) {
+      bool set = i == last;
+      values.push_back(i % 2 == 0 ? ValueFactory::GetTinyIntValue(static_cast<int8_t>(set))
+                                  : ValueFactory::GetBooleanValue(set));
+    }
+    keys.push_back(MakeKey<32>(values, key_schema));
+  }
+  for (const auto &lhs : keys) {
+    for (const auto &rhs : keys) {
+      EXPECT_EQ(comparator(lhs, rhs), reference(lhs, rhs));
+    }
+  }
+  EXPECT_NE(comparator(keys[22], keys[23]), 0);
+  delete key_schema;
+}
+
+TEST(GenericComparatorTest, NullsSortFirstTest) {
+  // the smallest and largest values of every fixed-size type
+  std::vector<std::vector<Value>> samples{
+      {ValueFactory::GetBooleanValue(false), ValueFactory::GetBooleanValue(true)},
+      {ValueFactory::GetTinyIntValue(BUSTUB_INT8_MIN), ValueFactory::GetTinyIntValue(BUSTUB_INT8_MAX)},
+      {ValueFactory::GetSmallIntValue(BUSTUB_INT16_MIN), ValueFactory::GetSmallIntValue(BUSTUB_INT16_MAX)},
+      {ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN), ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX)},
+      {ValueFactory::GetBigIntValue(BUSTUB_INT64_MIN), ValueFactory::GetBigIntValue(BUSTUB_INT64_MAX)},
+      {ValueFactory::GetDecimalValue(BUSTUB_DECIMAL_MIN), ValueFactory::GetDecimalValue(BUSTUB_DECIMAL_MAX)}};
+  for (const auto &values : samples) {
+    TypeId type = values[0].GetTypeId();
+    Schema key_schema({Column("a", type)});
+    GenericComparator<8> comparator(&key_schema);
+    auto null_key = MakeKey<8>({ValueFactory::GetNullValueByType(type)}, &key_schema);
+    EXPECT_EQ(comparator(null_key, null_key), 0);
+    for (const auto &value : values) {
+      auto key = MakeKey<8>({value}, &key_schema);
+      EXPECT_EQ(comparator(null_key, key), -1) << Type::TypeIdToString(type);
+      EXPECT_EQ(comparator(key, null_key), 1) << Type::TypeIdToString(type);
+    }
+  }
+
+  // a TIMESTAMP value cannot be serialized into a tuple, so these keys are written directly; NULL is the largest
+  // value in storage
+  Schema key_schema({Column("a", TypeId::TIMESTAMP)});
+  GenericComparator<8> comparator(&key_schema);
+  std::vector<GenericKey<8>> keys(3);
+  uint64_t timestamps[] = {BUSTUB_TIMESTAMP_NULL, BUSTUB_TIMESTAMP_MIN, BUSTUB_TIMESTAMP_MAX};
+  for (size_t i = 0; i < keys.size(); i++) {
+    memcpy(keys[i].data_, &timestamps[i], sizeof(uint64_t));
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      EXPECT_EQ(comparator(keys[i], keys[j]), (i > j) - (i < j));
+    }
+  }
+}
+
+/*
+ * Comparison cost and B+ tree insert/lookup throughput.
+ */
+TEST(GenericComparatorTest, DISABLED_ComparatorBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a integer,b bigint");
+  GenericComparator<16> comparator(key_schema);
+  ValueComparator<16> reference(key_schema);
+  std::mt19937 rng(15445);
+  std::vector<GenericKey<16>> keys;
+  for (int i = 0; i < 1024; i++) {
+    keys.push_back(MakeKey<16>({ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 4)),
+                                ValueFactory::GetBigIntValue(static_cast<int64_t>(rng()))},
+                               key_schema));
+  }
+  const int comparisons = 1000000;
+  int64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < comparisons; i++) {
+    checksum += reference(keys[i & 1023], keys[(i * 7) & 1023]);
+  }
+  auto mid = std::chrono::steady_clock::now();
+  for (int i = 0; i < comparisons; i++) {
+    checksum -= comparator(keys[i & 1023], keys[(i * 7) & 1023]);
+  }
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(checksum, 0);
+  std::cout << "comparator | Value ns/compare " << std::chrono::duration<double, std::nano>(mid - start).count() / comparisons
+            << " | compiled ns/compare " << std::chrono::duration<double, std::nano>(end - mid).count() / comparisons
+            << std::endl;
+  delete key_schema;
+
+  // whole tree, bigint keys in random order
+  key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> tree_comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, tree_comparator);
+  std::vector<int64_t> tree_keys;
+  for (int64_t key = 0; key < 20000; key++) {
+    tree_keys.push_back(key);
+  }
+  std::shuffle(tree_keys.begin(), tree_keys.end(), rng);
+  GenericKey<8> index_key;
+  start = std::chrono::steady_clock::now();
+  for (auto key : tree_keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(key));
+  }
+  mid = std::chrono::steady_clock::now();
+  std::vector<RID> rids;
+  for (auto key : tree_keys) {
+    index_key.SetFromInteger(key);
+    tree.GetValue(index_key, &rids);
+  }
+  end = std::chrono::steady_clock::now();
+  EXPECT_EQ(rids.size(), tree_keys.size());
+  std::cout << "b+ tree | insert us/key " << std::chrono::duration<double, std::micro>(mid - start).count() / tree_keys.size()
+            << " | lookup us/key " << std::chrono::duration<double, std::micro>(end - mid).count() / tree_keys.size()
+            << std::endl;
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
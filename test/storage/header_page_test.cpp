@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// header_page_test.cpp
+//
+// Identification: test/storage/header_page_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HeaderPageTest, DirectoryTest) {
+  HeaderPage page{};
+  page.Init();
+
+  // fill every slot, so that most records are away from their home slot
+  for (int i = 0; i < HeaderPage::SLOT_COUNT; i++) {
+    ASSERT_TRUE(page.InsertRecord("index_" + std::to_string(i), i + 1));
+  }
+  EXPECT_EQ(page.GetRecordCount(), HeaderPage::SLOT_COUNT);
+  EXPECT_FALSE(page.InsertRecord("one_too_many", 1));
+  EXPECT_FALSE(page.InsertRecord("index_0", 1));
+
+  page_id_t root_id;
+  for (int i = 0; i < HeaderPage::SLOT_COUNT; i++) {
+    ASSERT_TRUE(page.GetRootId("index_" + std::to_string(i), &root_id));
+    EXPECT_EQ(root_id, i + 1);
+  }
+  EXPECT_FALSE(page.GetRootId("index_", &root_id));
+
+  // the records after a deleted one must stay reachable
+  for (int i = 0; i < HeaderPage::SLOT_COUNT; i += 2) {
+    ASSERT_TRUE(page.DeleteRecord("index_" + std::to_string(i)));
+  }
+  EXPECT_FALSE(page.DeleteRecord("index_0"));
+  for (int i = 0; i < HeaderPage::SLOT_COUNT; i++) {
+    EXPECT_EQ(page.GetRootId("index_" + std::to_string(i), &root_id), i % 2 == 1);
+    if (i % 2 == 1) {
+      EXPECT_TRUE(page.UpdateRecord("index_" + std::to_string(i), i + 100));
+      ASSERT_TRUE(page.GetRootId("index_" + std::to_string(i), &root_id));
+      EXPECT_EQ(root_id, i + 100);
+    }
+  }
+  EXPECT_EQ(page.GetRecordCount(), HeaderPage::SLOT_COUNT / 2);
+}
+
+}  // namespace bustub
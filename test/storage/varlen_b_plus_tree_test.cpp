@@ -0,0 +1,321 @@
+/**
+ * varlen_b_plus_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/key_encoder.h"
+#include "storage/index/varlen_b_plus_tree.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+using VarlenTree = VarlenBPlusTree<RID>;
+
+static int Sign(int value) { return (value > 0) - (value < 0); }
+
+// memcmp order of the encoded keys, shorter first on a tie
+static int CompareEncoded(const std::string &lhs, const std::string &rhs) { return Sign(lhs.compare(rhs)); }
+
+template <size_t KeySize>
+static void CheckEncoderOrder(Schema *key_schema, const std::vector<std::vector<Value>> &rows) {
+  GenericComparator<KeySize> comparator(key_schema);
+  KeyEncoder encoder(key_schema);
+  std::vector<GenericKey<KeySize>> keys;
+  std::vector<std::string> encoded;
+  for (const auto &values : rows) {
+    Tuple tuple(values, key_schema);
+    GenericKey<KeySize> key;
+    key.SetFromKey(tuple);
+    keys.push_back(key);
+    encoded.emplace_back();
+    encoder.Encode(key.data_, KeySize, &encoded.back());
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      EXPECT_EQ(CompareEncoded(encoded[i], encoded[j]), comparator(keys[i], keys[j]));
+    }
+  }
+}
+
+TEST(VarlenBPlusTreeTest, KeyEncoderTest) {
+  std::mt19937 rng(15445);
+  Schema *key_schema = ParseCreateStatement("a tinyint,b smallint,c integer,d bigint");
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 200; i++) {
+    rows.push_back({ValueFactory::GetTinyIntValue(static_cast<int8_t>(rng() % 3 - 1)),
+                    ValueFactory::GetSmallIntValue(static_cast<int16_t>(rng() % 3 - 1)),
+                    ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 5) - 2),
+                    ValueFactory::GetBigIntValue(static_cast<int64_t>(rng() % 1000000) - 500000)});
+  }
+  CheckEncoderOrder<16>(key_schema, rows);
+  delete key_schema;
+
+  key_schema = ParseCreateStatement("a varchar(16),b integer");
+  rows.clear();
+  std::string zero("a\0b", 3);
+  for (const std::string &str : {std::string(), std::string("a"), std::string("ab"), zero, std::string("a\xff"),
+                                 std::string("b"), std::string("zzzzzzzzzzzzzzzzzzzz")}) {
+    for (int32_t value : {-1, 0, 1}) {
+      rows.push_back({ValueFactory::GetVarcharValue(str), ValueFactory::GetIntegerValue(value)});
+    }
+  }
+  // the long string is clamped to the key, the same for the comparator and the encoder
+  CheckEncoderOrder<32>(key_schema, rows);
+  delete key_schema;
+
+  key_schema = ParseCreateStatement("a double");
+  rows.clear();
+  for (double value : {-1e9, -2.5, -0.0, 0.0, 1.0 / 3, 7.25, 1e12}) {
+    rows.push_back({ValueFactory::GetDecimalValue(value)});
+  }
+  CheckEncoderOrder<8>(key_schema, rows);
+  delete key_schema;
+
+  // a NULL TIMESTAMP is the largest value in storage but sorts first; TIMESTAMP values cannot be serialized into a
+  // tuple, so the keys are written directly
+  key_schema = new Schema({Column("a", TypeId::TIMESTAMP)});
+  GenericComparator<8> comparator(key_schema);
+  KeyEncoder encoder(key_schema);
+  std::vector<GenericKey<8>> keys(4);
+  std::vector<std::string> encoded(keys.size());
+  uint64_t timestamps[] = {BUSTUB_TIMESTAMP_NULL, 0, 1, BUSTUB_TIMESTAMP_MAX};
+  for (size_t i = 0; i < keys.size(); i++) {
+    memcpy(keys[i].data_, &timestamps[i], sizeof(uint64_t));
+    encoder.Encode(keys[i].data_, 8, &encoded[i]);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      EXPECT_EQ(comparator(keys[i], keys[j]), Sign(static_cast<int>(i) - static_cast<int>(j)));
+      EXPECT_EQ(CompareEncoded(encoded[i], encoded[j]), Sign(static_cast<int>(i) - static_cast<int>(j)));
+    }
+  }
+  delete key_schema;
+}
+
+// lookups, a full scan and a range scan return exactly the expected pairs
+static void CheckTree(VarlenTree *tree, const std::map<std::string, RID> &expected) {
+  std::vector<RID> rids;
+  for (const auto &entry : expected) {
+    rids.clear();
+    ASSERT_TRUE(tree->GetValue(entry.first, &rids));
+    EXPECT_EQ(rids[0], entry.second);
+  }
+  auto expected_it = expected.begin();
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    ASSERT_NE(expected_it, expected.end());
+    EXPECT_EQ((*iterator).first, expected_it->first);
+    EXPECT_EQ((*iterator).second, expected_it->second);
+    ++expected_it;
+  }
+  EXPECT_EQ(expected_it, expected.end());
+  if (expected.empty()) {
+    EXPECT_TRUE(tree->IsEmpty());
+    return;
+  }
+  std::string middle = std::next(expected.begin(), expected.size() / 2)->first;
+  middle.pop_back();
+  auto iterator = tree->Begin(middle);
+  ASSERT_NE(iterator, tree->end());
+  EXPECT_EQ((*iterator).first, expected.lower_bound(middle)->first);
+}
+
+TEST(VarlenBPlusTreeTest, InsertRemoveTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  VarlenTree tree("foo_pk", bpm);
+  EXPECT_EQ(tree.GetHeight(), 0);
+
+  // keys of very different lengths in groups with long shared prefixes, so prefixes get rebuilt, pages split by
+  // bytes and separators inside a group are long enough to split internal pages too
+  std::mt19937 rng(15445);
+  std::vector<std::string> groups;
+  for (int i = 0; i < 20; i++) {
+    groups.emplace_back(rng() % 400, static_cast<char>('a' + i));
+  }
+  std::map<std::string, RID> expected;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 5000; i++) {
+    std::string key = groups[rng() % groups.size()];
+    key += std::to_string(rng() % 100000);
+    key += std::string(rng() % 20, static_cast<char>(rng() % 256));
+    keys.push_back(key);
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    bool inserted = tree.Insert(keys[i], RID(static_cast<page_id_t>(i), 0));
+    EXPECT_EQ(inserted, expected.count(keys[i]) == 0);
+    if (inserted) {
+      expected[keys[i]] = RID(static_cast<page_id_t>(i), 0);
+    }
+  }
+  EXPECT_THROW(tree.Insert(std::string(SLOTTED_PAGE_MAX_KEY_SIZE + 1, 'x'), RID()), Exception);
+  EXPECT_GE(tree.GetHeight(), 3);
+  CheckTree(&tree, expected);
+
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (size_t i = 0; i < keys.size() / 2; i++) {
+    tree.Remove(keys[i]);
+    expected.erase(keys[i]);
+  }
+  tree.Remove("not there");
+  CheckTree(&tree, expected);
+  for (size_t i = keys.size() / 2; i < keys.size(); i++) {
+    tree.Remove(keys[i]);
+  }
+  CheckTree(&tree, {});
+  EXPECT_EQ(tree.GetHeight(), 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// follow the leaf chain from the leftmost leaf
+template <typename LeafPage>
+static int CountLeaves(BufferPoolManager *bpm, page_id_t page_id) {
+  int leaves = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = bpm->FetchPage(page_id);
+    page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    leaves++;
+  }
+  return leaves;
+}
+
+template <size_t KeySize>
+static void RunFanoutBenchmark(const std::string &name, Schema *key_schema,
+                               const std::vector<std::vector<Value>> &rows) {
+  GenericComparator<KeySize> comparator(key_schema);
+  KeyEncoder encoder(key_schema);
+  for (int round = 0; round < 2; round++) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(5000, disk_manager);
+    page_id_t page_id;
+    bpm->NewPage(&page_id);
+    BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>> tree("foo_pk", bpm, comparator);
+    VarlenTree varlen_tree("foo_pk", bpm);
+    size_t key_bytes = 0;
+    for (size_t i = 0; i < rows.size(); i++) {
+      Tuple tuple(rows[i], key_schema);
+      GenericKey<KeySize> key;
+      key.SetFromKey(tuple);
+      RID rid(static_cast<page_id_t>(i));
+      if (round == 0) {
+        tree.Insert(key, rid);
+      } else {
+        std::string encoded;
+        encoder.Encode(key.data_, KeySize, &encoded);
+        key_bytes += encoded.size();
+        varlen_tree.Insert(encoded, rid);
+      }
+    }
+
+    // the leftmost leaf and the height come from a walk down the first children
+    int height = 0;
+    page_id_t leaf_page_id;
+    if (round == 0) {
+      auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+      header_page->GetRootId("foo_pk", &leaf_page_id);
+      bpm->UnpinPage(HEADER_PAGE_ID, false);
+      while (true) {
+        height++;
+        Page *page = bpm->FetchPage(leaf_page_id);
+        auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+        bool leaf = node->IsLeafPage();
+        if (!leaf) {
+          leaf_page_id = reinterpret_cast<BPlusTreeInternalPage<GenericKey<KeySize>, page_id_t,
+                                                               GenericComparator<KeySize>> *>(node)
+                             ->ValueAt(0);
+        }
+        bpm->UnpinPage(page->GetPageId(), false);
+        if (leaf) {
+          break;
+        }
+      }
+    } else {
+      height = varlen_tree.GetHeight();
+      auto iterator = varlen_tree.begin();
+      leaf_page_id = INVALID_PAGE_ID;
+      auto *header_page = reinterpret_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+      header_page->GetRootId("foo_pk", &leaf_page_id);
+      bpm->UnpinPage(HEADER_PAGE_ID, false);
+      for (int level = 1; level < height; level++) {
+        Page *page = bpm->FetchPage(leaf_page_id);
+        page_id_t child = reinterpret_cast<BPlusTreeSlottedPage<page_id_t> *>(page->GetData())->ValueAt(0);
+        bpm->UnpinPage(page->GetPageId(), false);
+        leaf_page_id = child;
+      }
+    }
+    int leaves = round == 0 ? CountLeaves<BPlusTreeLeafPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>>>(
+                                  bpm, leaf_page_id)
+                            : CountLeaves<BPlusTreeSlottedPage<RID>>(bpm, leaf_page_id);
+    // page ids are handed out in order, so the next one tells how many pages the tree took
+    bpm->NewPage(&page_id);
+    bpm->UnpinPage(page_id, false);
+    int pages = page_id - 1;
+    std::cout << name << " | " << (round == 0 ? "GenericKey<" + std::to_string(KeySize) + ">" : "varlen")
+              << " | pages " << pages << " | height " << height << " | entries per leaf "
+              << static_cast<double>(rows.size()) / leaves << " | children per internal page "
+              << (pages > leaves ? static_cast<double>(pages - 1) / (pages - leaves) : 0.0);
+    if (round == 1) {
+      std::cout << " | encoded key bytes " << static_cast<double>(key_bytes) / rows.size();
+    }
+    std::cout << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+/*
+ * Size, height and fan-out of GenericKey<32> and GenericKey<64> trees against
+ * the prefix compressed, suffix truncated varlen tree over the same keys.
+ */
+TEST(VarlenBPlusTreeTest, DISABLED_FanoutBenchmark) {
+  const int rows = 100000;
+  std::mt19937 rng(15445);
+  std::vector<std::vector<Value>> values;
+
+  // (tenant, customer, timestamp, sequence)
+  Schema *key_schema = ParseCreateStatement("a integer,b bigint,c bigint,d bigint");
+  for (int i = 0; i < rows; i++) {
+    values.push_back({ValueFactory::GetIntegerValue(static_cast<int32_t>(rng() % 4)),
+                      ValueFactory::GetBigIntValue(static_cast<int64_t>(rng() % 100000)),
+                      ValueFactory::GetBigIntValue(1600000000000 + static_cast<int64_t>(rng() % 2592000000)),
+                      ValueFactory::GetBigIntValue(i)});
+  }
+  RunFanoutBenchmark<32>("32 byte keys", key_schema, values);
+  delete key_schema;
+
+  // (email, sequence)
+  key_schema = ParseCreateStatement("a varchar(40),b bigint");
+  values.clear();
+  for (int i = 0; i < rows; i++) {
+    std::string customer = std::to_string(rng() % 20000);
+    std::string email = "customer-" + std::string(8 - customer.size(), '0') + customer + "@example.com";
+    values.push_back({ValueFactory::GetVarcharValue(email), ValueFactory::GetBigIntValue(i)});
+  }
+  RunFanoutBenchmark<64>("64 byte keys", key_schema, values);
+  delete key_schema;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
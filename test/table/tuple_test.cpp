@@ -21,6 +21,7 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
@@ -71,4 +72,59 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, ScanInPlaceTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // a few pages of tuples, every third one deleted
+  std::vector<RID> live_rids;
+  for (int32_t i = 0; i < 3000; i++) {
+    RID rid;
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue("row" + std::to_string(i))}, &schema);
+    ASSERT_TRUE(table->InsertTuple(tuple, &rid, transaction));
+    if (i % 3 == 0) {
+      ASSERT_TRUE(table->MarkDelete(rid, transaction));
+    } else {
+      live_rids.push_back(rid);
+    }
+  }
+
+  for (size_t max_tuples : {static_cast<size_t>(1), static_cast<size_t>(7), static_cast<size_t>(10000)}) {
+    std::vector<RID> rids;
+    RID cursor(table->GetFirstPageId(), 0);
+    auto visit = [&](const std::vector<Tuple> &tuples) {
+      ASSERT_LE(tuples.size(), max_tuples);
+      for (const auto &tuple : tuples) {
+        ASSERT_EQ(tuple.GetRid().GetPageId(), tuples[0].GetRid().GetPageId());
+        int32_t a = tuple.GetValue(&schema, 0).GetAs<int32_t>();
+        ASSERT_NE(a % 3, 0);
+        ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), "row" + std::to_string(a));
+        rids.push_back(tuple.GetRid());
+      }
+    };
+    size_t calls = 0;
+    while (table->ScanInPlace(&cursor, max_tuples, visit, transaction)) {
+      calls++;
+    }
+    EXPECT_EQ(cursor.GetPageId(), INVALID_PAGE_ID);
+    EXPECT_EQ(rids, live_rids);
+    EXPECT_GE(calls, (live_rids.size() + max_tuples - 1) / max_tuples);
+  }
+
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub